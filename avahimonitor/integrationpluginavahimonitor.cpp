@@ -48,27 +48,31 @@ IntegrationPluginAvahiMonitor::IntegrationPluginAvahiMonitor()
 
 void IntegrationPluginAvahiMonitor::setupThing(ThingSetupInfo *info)
 {
-    qCDebug(dcAvahiMonitor()) << "Setup" << info->thing()->name() << info->thing()->params();
+    Thing *thing = info->thing();
+    qCDebug(dcAvahiMonitor()) << "Setup" << thing->name() << thing->params();
 
-    if (!m_serviceBrowser) {
-        m_serviceBrowser = hardwareManager()->zeroConfController()->createServiceBrowser();
-        connect(m_serviceBrowser, &ZeroConfServiceBrowser::serviceEntryAdded, this, &IntegrationPluginAvahiMonitor::onServiceEntryAdded);
-        connect(m_serviceBrowser, &ZeroConfServiceBrowser::serviceEntryRemoved, this, &IntegrationPluginAvahiMonitor::onServiceEntryRemoved);
-    }
+    // Things created before the service type was stored have to look at all services
+    QString serviceType = thing->paramValue(avahiThingServiceTypeParamTypeId).toString();
+    ZeroConfServiceBrowser *serviceBrowser = acquireServiceBrowser(serviceType);
+    m_monitoredServices.insert(serviceKey(thing), thing);
 
-    foreach (const ZeroConfServiceEntry &entry, m_serviceBrowser->serviceEntries()) {
-        if (info->thing()->paramValue(avahiThingServiceParamTypeId).toString() == entry.name() &&
-                info->thing()->paramValue(avahiThingHostNameParamTypeId).toString() == entry.hostName()) {
-            info->thing()->setStateValue(avahiIsPresentStateTypeId, true);
-            info->thing()->setStateValue(avahiLastSeenTimeStateTypeId, QDateTime::currentDateTime().toString());
-            info->thing()->setStateValue(avahiAddressStateTypeId, entry.hostAddress().toString());
-            info->thing()->setStateValue(avahiPortStateTypeId, entry.port());
+    foreach (const ZeroConfServiceEntry &entry, serviceBrowser->serviceEntries()) {
+        if (findThing(entry) == thing) {
+            setServicePresent(thing, entry);
+            break;
         }
     }
 
     info->finish(Thing::ThingErrorNoError);
 }
 
+void IntegrationPluginAvahiMonitor::thingRemoved(Thing *thing)
+{
+    m_monitoredServices.remove(serviceKey(thing));
+    delete m_holdDownTimers.take(thing);
+    releaseServiceBrowser(thing->paramValue(avahiThingServiceTypeParamTypeId).toString());
+}
+
 void IntegrationPluginAvahiMonitor::discoverThings(ThingDiscoveryInfo *info)
 {
     if (info->thingClassId() != avahiThingClassId) {
@@ -76,26 +80,30 @@ void IntegrationPluginAvahiMonitor::discoverThings(ThingDiscoveryInfo *info)
         return;
     }
 
-    if (!m_serviceBrowser) {
-        m_serviceBrowser = hardwareManager()->zeroConfController()->createServiceBrowser();
-        connect(m_serviceBrowser, &ZeroConfServiceBrowser::serviceEntryAdded, this, &IntegrationPluginAvahiMonitor::onServiceEntryAdded);
-        connect(m_serviceBrowser, &ZeroConfServiceBrowser::serviceEntryRemoved, this, &IntegrationPluginAvahiMonitor::onServiceEntryRemoved);
-    }
+    // The discovery needs to see all services, only keep that browser around while needed
+    ZeroConfServiceBrowser *serviceBrowser = acquireServiceBrowser(QString());
 
     // give it a bit of time to find things
-    QTimer::singleShot(2000, info, [this, info](){
+    QTimer::singleShot(2000, info, [this, info, serviceBrowser](){
         QList<ThingDescriptor> deviceDescriptors;
-        foreach (const ZeroConfServiceEntry &service, m_serviceBrowser->serviceEntries()) {
+        QStringList serviceKeys;
+        foreach (const ZeroConfServiceEntry &service, serviceBrowser->serviceEntries()) {
+            // Services show up once per address/protocol
+            QString key = serviceKey(service.name(), service.serviceType(), service.hostName());
+            if (serviceKeys.contains(key)) {
+                continue;
+            }
+            serviceKeys.append(key);
+
             ThingDescriptor thingDescriptor(avahiThingClassId, service.name(), service.serviceType() + " (" + service.hostAddress().toString() + ")");
             ParamList params;
             params.append(Param(avahiThingServiceParamTypeId, service.name()));
             params.append(Param(avahiThingHostNameParamTypeId, service.hostName()));
+            params.append(Param(avahiThingServiceTypeParamTypeId, service.serviceType()));
             thingDescriptor.setParams(params);
-            foreach (Thing *existingThing, myThings()) {
-                if (existingThing->paramValue(avahiThingServiceParamTypeId).toString() == service.name() && existingThing->paramValue(avahiThingHostNameParamTypeId).toString() == service.hostName()) {
-                    thingDescriptor.setThingId(existingThing->id());
-                    break;
-                }
+            Thing *existingThing = findThing(service);
+            if (existingThing) {
+                thingDescriptor.setThingId(existingThing->id());
             }
             deviceDescriptors.append(thingDescriptor);
         }
@@ -103,28 +111,117 @@ void IntegrationPluginAvahiMonitor::discoverThings(ThingDiscoveryInfo *info)
         info->addThingDescriptors(deviceDescriptors);
         info->finish(Thing::ThingErrorNoError);
     });
+    connect(info, &ThingDiscoveryInfo::destroyed, this, [this](){
+        releaseServiceBrowser(QString());
+    });
 }
 
 void IntegrationPluginAvahiMonitor::onServiceEntryAdded(const ZeroConfServiceEntry &serviceEntry)
 {
+    Thing *thing = findThing(serviceEntry);
+    if (!thing) {
+        return;
+    }
+
     qCDebug(dcAvahiMonitor()) << "Service entry added:" << serviceEntry;
-    foreach (Thing *thing, myThings()) {
-        if (thing->paramValue(avahiThingServiceParamTypeId).toString() == serviceEntry.name() &&
-                thing->paramValue(avahiThingHostNameParamTypeId).toString() == serviceEntry.hostName()) {
-            thing->setStateValue(avahiIsPresentStateTypeId, true);
-            thing->setStateValue(avahiLastSeenTimeStateTypeId, QDateTime::currentDateTime().toString());
-            thing->setStateValue(avahiAddressStateTypeId, serviceEntry.hostAddress().toString());
-            thing->setStateValue(avahiPortStateTypeId, serviceEntry.port());
-        }
+    QTimer *holdDownTimer = m_holdDownTimers.value(thing);
+    if (holdDownTimer && holdDownTimer->isActive()) {
+        qCDebug(dcAvahiMonitor()) << thing->name() << "is back within the hold-down time";
+        holdDownTimer->stop();
     }
+    setServicePresent(thing, serviceEntry);
 }
 
 void IntegrationPluginAvahiMonitor::onServiceEntryRemoved(const ZeroConfServiceEntry &serviceEntry)
 {
-    foreach (Thing *thing, myThings()) {
-        if (thing->paramValue(avahiThingServiceParamTypeId).toString() == serviceEntry.name() &&
-                thing->paramValue(avahiThingHostNameParamTypeId).toString() == serviceEntry.hostName()) {
+    Thing *thing = findThing(serviceEntry);
+    if (!thing) {
+        return;
+    }
+
+    qCDebug(dcAvahiMonitor()) << "Service entry removed:" << serviceEntry;
+
+    // Services tend to flap, only mark them as gone if they don't come back within the hold-down time
+    QTimer *holdDownTimer = m_holdDownTimers.value(thing);
+    if (!holdDownTimer) {
+        holdDownTimer = new QTimer(this);
+        holdDownTimer->setSingleShot(true);
+        connect(holdDownTimer, &QTimer::timeout, thing, [this, thing](){
+            // Another address of the same service might still be around
+            if (serviceAvailable(thing)) {
+                return;
+            }
+            qCDebug(dcAvahiMonitor()) << thing->name() << "has disappeared";
             thing->setStateValue(avahiIsPresentStateTypeId, false);
+        });
+        m_holdDownTimers.insert(thing, holdDownTimer);
+    }
+
+    holdDownTimer->start(thing->setting(avahiSettingsHoldDownTimeParamTypeId).toUInt() * 1000);
+}
+
+QString IntegrationPluginAvahiMonitor::serviceKey(const QString &name, const QString &serviceType, const QString &hostName)
+{
+    return name + '\n' + serviceType + '\n' + hostName;
+}
+
+QString IntegrationPluginAvahiMonitor::serviceKey(Thing *thing)
+{
+    return serviceKey(thing->paramValue(avahiThingServiceParamTypeId).toString(),
+                      thing->paramValue(avahiThingServiceTypeParamTypeId).toString(),
+                      thing->paramValue(avahiThingHostNameParamTypeId).toString());
+}
+
+ZeroConfServiceBrowser *IntegrationPluginAvahiMonitor::acquireServiceBrowser(const QString &serviceType)
+{
+    m_serviceBrowserUsers[serviceType]++;
+    if (m_serviceBrowsers.contains(serviceType)) {
+        return m_serviceBrowsers.value(serviceType);
+    }
+
+    qCDebug(dcAvahiMonitor()) << "Creating service browser for" << (serviceType.isEmpty() ? "all services" : serviceType);
+    ZeroConfServiceBrowser *serviceBrowser = hardwareManager()->zeroConfController()->createServiceBrowser(serviceType);
+    connect(serviceBrowser, &ZeroConfServiceBrowser::serviceEntryAdded, this, &IntegrationPluginAvahiMonitor::onServiceEntryAdded);
+    connect(serviceBrowser, &ZeroConfServiceBrowser::serviceEntryRemoved, this, &IntegrationPluginAvahiMonitor::onServiceEntryRemoved);
+    m_serviceBrowsers.insert(serviceType, serviceBrowser);
+    return serviceBrowser;
+}
+
+void IntegrationPluginAvahiMonitor::releaseServiceBrowser(const QString &serviceType)
+{
+    if (--m_serviceBrowserUsers[serviceType] > 0) {
+        return;
+    }
+
+    qCDebug(dcAvahiMonitor()) << "Removing service browser for" << (serviceType.isEmpty() ? "all services" : serviceType);
+    m_serviceBrowserUsers.remove(serviceType);
+    m_serviceBrowsers.take(serviceType)->deleteLater();
+}
+
+Thing *IntegrationPluginAvahiMonitor::findThing(const ZeroConfServiceEntry &serviceEntry) const
+{
+    Thing *thing = m_monitoredServices.value(serviceKey(serviceEntry.name(), serviceEntry.serviceType(), serviceEntry.hostName()));
+    if (!thing) {
+        thing = m_monitoredServices.value(serviceKey(serviceEntry.name(), QString(), serviceEntry.hostName()));
+    }
+    return thing;
+}
+
+bool IntegrationPluginAvahiMonitor::serviceAvailable(Thing *thing) const
+{
+    ZeroConfServiceBrowser *serviceBrowser = m_serviceBrowsers.value(thing->paramValue(avahiThingServiceTypeParamTypeId).toString());
+    foreach (const ZeroConfServiceEntry &entry, serviceBrowser->serviceEntries()) {
+        if (findThing(entry) == thing) {
+            return true;
         }
     }
+    return false;
+}
+
+void IntegrationPluginAvahiMonitor::setServicePresent(Thing *thing, const ZeroConfServiceEntry &serviceEntry)
+{
+    thing->setStateValue(avahiIsPresentStateTypeId, true);
+    thing->setStateValue(avahiLastSeenTimeStateTypeId, QDateTime::currentDateTime().toTime_t());
+    thing->setStateValue(avahiAddressStateTypeId, serviceEntry.hostAddress().toString());
+    thing->setStateValue(avahiPortStateTypeId, serviceEntry.port());
 }
@@ -35,7 +35,8 @@
 #include "network/zeroconf/zeroconfservicebrowser.h"
 #include "network/zeroconf/zeroconfserviceentry.h"
 
-#include <QProcess>
+#include <QHash>
+#include <QTimer>
 
 class IntegrationPluginAvahiMonitor : public IntegrationPlugin
 {
@@ -49,13 +50,30 @@ public:
 
     void discoverThings(ThingDiscoveryInfo *info) override;
     void setupThing(ThingSetupInfo *info) override;
+    void thingRemoved(Thing *thing) override;
 
 private slots:
     void onServiceEntryAdded(const ZeroConfServiceEntry &serviceEntry);
     void onServiceEntryRemoved(const ZeroConfServiceEntry &serviceEntry);
 
 private:
-    ZeroConfServiceBrowser *m_serviceBrowser = nullptr;
+    // One browser per monitored service type, the browser for an empty type sees all services
+    QHash<QString, ZeroConfServiceBrowser *> m_serviceBrowsers;
+    QHash<QString, int> m_serviceBrowserUsers;
+
+    // Monitored things by serviceKey()
+    QHash<QString, Thing *> m_monitoredServices;
+    QHash<Thing *, QTimer *> m_holdDownTimers;
+
+    static QString serviceKey(const QString &name, const QString &serviceType, const QString &hostName);
+    static QString serviceKey(Thing *thing);
+
+    ZeroConfServiceBrowser *acquireServiceBrowser(const QString &serviceType);
+    void releaseServiceBrowser(const QString &serviceType);
+
+    Thing *findThing(const ZeroConfServiceEntry &serviceEntry) const;
+    bool serviceAvailable(Thing *thing) const;
+    void setServicePresent(Thing *thing, const ZeroConfServiceEntry &serviceEntry);
 };
 
 #endif // INTEGRATIONPLUGINAVAHIMONITOR_H
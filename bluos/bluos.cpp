@@ -42,7 +42,18 @@ BluOS::BluOS(NetworkAccessManager *networkmanager,  QHostAddress hostAddress, in
     m_port(port),
     m_networkManager(networkmanager)
 {
+    m_statusPollRetryTimer = new QTimer(this);
+    m_statusPollRetryTimer->setSingleShot(true);
+    m_statusPollRetryTimer->setInterval(5000);
+    connect(m_statusPollRetryTimer, &QTimer::timeout, this, [this] {
+        if (m_statusPollingEnabled && m_longPollingSupported)
+            sendStatusPoll();
+    });
+}
 
+BluOS::~BluOS()
+{
+    stopStatusPolling();
 }
 
 int BluOS::port()
@@ -56,30 +67,123 @@ QHostAddress BluOS::hostAddress()
 }
 
 void BluOS::getStatus()
+{
+    QNetworkReply *reply = requestStatus();
+    connect(reply, &QNetworkReply::finished, this, [reply, this] {
+        int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+        // Check HTTP status code
+        if (status != 200 || reply->error() != QNetworkReply::NoError) {
+            if (reply->error() == QNetworkReply::HostNotFoundError) {
+                emit connectionChanged(false);
+            }
+            qCWarning(dcBluOS()) << "Request error:" << status << reply->errorString();
+            return;
+        }
+        emit connectionChanged(true);
+        QByteArray data = reply->readAll();
+        //qCDebug(dcBluOS()) << "Get Status:" << data;
+        parseState(data);
+    });
+    return;
+}
+
+void BluOS::startStatusPolling()
+{
+    m_statusPollingEnabled = true;
+    if (m_longPollingSupported && !m_statusPollReply && !m_statusPollRetryTimer->isActive()) {
+        sendStatusPoll();
+    }
+}
+
+void BluOS::stopStatusPolling()
+{
+    m_statusPollingEnabled = false;
+    m_statusPollRetryTimer->stop();
+    if (m_statusPollReply) {
+        m_statusPollReply->abort();
+    }
+}
+
+bool BluOS::statusPollingActive() const
+{
+    return m_statusPollingEnabled && m_longPollingSupported;
+}
+
+QNetworkReply *BluOS::requestStatus(const QUrlQuery &query)
 {
     QUrl url;
     url.setScheme("http");
     url.setHost(m_hostAddress.toString());
     url.setPort(m_port);
     url.setPath("/Status");
+    url.setQuery(query);
     QNetworkReply *reply = m_networkManager->get(QNetworkRequest(url));
     connect(reply, &QNetworkReply::finished, reply, &QNetworkReply::deleteLater);
+    return reply;
+}
+
+void BluOS::sendStatusPoll()
+{
+    // Without an etag the player answers immediately, the response contains the etag for the next request
+    QUrlQuery query;
+    if (!m_statusEtag.isEmpty()) {
+        query.addQueryItem("timeout", QString::number(m_statusPollTimeout));
+        query.addQueryItem("etag", m_statusEtag);
+    }
+    QNetworkReply *reply = requestStatus(query);
+    m_statusPollReply = reply;
+    m_statusPollTime.start();
+
+    // Don't wait forever if the player dropped the connection silently
+    QTimer::singleShot((m_statusPollTimeout + 15) * 1000, reply, [reply] {
+        reply->abort();
+    });
+
     connect(reply, &QNetworkReply::finished, this, [reply, this] {
+        if (m_statusPollReply == reply)
+            m_statusPollReply.clear();
+
+        if (!m_statusPollingEnabled)
+            return;
+
         int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
-        // Check HTTP status code
         if (status != 200 || reply->error() != QNetworkReply::NoError) {
             if (reply->error() == QNetworkReply::HostNotFoundError) {
                 emit connectionChanged(false);
             }
-            qCWarning(dcBluOS()) << "Request error:" << status << reply->errorString();
+            qCWarning(dcBluOS()) << "Status poll error:" << status << reply->errorString() << "retrying in" << m_statusPollRetryTimer->interval() / 1000 << "seconds";
+            m_statusPollRetryTimer->start();
             return;
         }
         emit connectionChanged(true);
-        QByteArray data = reply->readAll();
-        //qCDebug(dcBluOS()) << "Get Status:" << data;
-        parseState(data);
+
+        QString previousEtag = m_statusEtag;
+        parseState(reply->readAll());
+        if (m_statusEtag.isEmpty()) {
+            disableLongPolling("the status response contains no etag");
+            return;
+        }
+
+        // A player ignoring the timeout parameter would answer every request immediately
+        if (!previousEtag.isEmpty() && m_statusEtag == previousEtag && m_statusPollTime.elapsed() < 1000) {
+            m_immediateStatusResponses++;
+            if (m_immediateStatusResponses >= 3) {
+                disableLongPolling("the timeout parameter is ignored");
+                return;
+            }
+            m_statusPollRetryTimer->start();
+            return;
+        }
+        m_immediateStatusResponses = 0;
+        sendStatusPoll();
     });
-    return;
+}
+
+void BluOS::disableLongPolling(const QString &reason)
+{
+    qCWarning(dcBluOS()) << "Long-polling not supported by" << m_hostAddress.toString() << "because" << reason << "- falling back to periodic status requests";
+    m_longPollingSupported = false;
+    m_statusPollRetryTimer->stop();
 }
 
 QUuid BluOS::setVolume(uint volume)
@@ -647,55 +751,89 @@ bool BluOS::parseState(const QByteArray &state)
     }
 
     StatusResponse statusResponse;
-    if (xml.readNextStartElement()) {
-        if (xml.name() == "status") {
-            while(xml.readNextStartElement()){
-                if(xml.name() == "artist"){
-                    statusResponse.Artist = xml.readElementText();
-                } else if(xml.name() == "album"){
-                    statusResponse.Album = xml.readElementText();
-                } else if(xml.name() == "name"){
-                    statusResponse.Name = xml.readElementText();
-                } else if(xml.name() == "service"){
-                    statusResponse.Service = xml.readElementText();
-                } else if(xml.name() == "serviceIcon"){
-                    statusResponse.ServiceIcon = xml.readElementText();
-                } else if(xml.name() == "shuffle"){
-                    statusResponse.Shuffle = xml.readElementText().toInt();
-                } else if(xml.name() == "repeat"){
-                    statusResponse.Shuffle = xml.readElementText().toInt();
-                } else if(xml.name() == "state"){
-                    QString playback = xml.readElementText();
-                    if (playback == "play") {
-                        statusResponse.State = PlaybackState::Playing;
-                    } else if (playback == "pause") {
-                        statusResponse.State = PlaybackState::Paused;
-                    } else if (playback == "stop") {
-                        statusResponse.State = PlaybackState::Stopped;
-                    } else if (playback == "connecting") {
-                        statusResponse.State = PlaybackState::Connecting;
-                    } else if (playback == "stream") {
-                        statusResponse.State = PlaybackState::Streaming;
-                    }  else {
-                        statusResponse.State = PlaybackState::Stopped;
-                        qCWarning(dcBluOS()) << "State response, unhandled playback mode" << playback;
-                    }
-                } else if(xml.name() == "volume"){
-                    statusResponse.Volume = xml.readElementText().toInt();
-                } else if(xml.name() == "mute"){
-                    statusResponse.Mute = xml.readElementText().toInt();
-                } else if(xml.name() == "image") {
-                    statusResponse.Image = xml.readElementText();
-                } else if(xml.name() == "title1") {
-                    statusResponse.Title = xml.readElementText();
-                } else if(xml.name() == "group") {
-                    statusResponse.Group = xml.readElementText();
-                } else {
-                    xml.skipCurrentElement();
-                }
+    if (!xml.readNextStartElement() || xml.name() != "status") {
+        // Playback commands respond with a <state> element only, the status poll will follow up
+        return false;
+    }
+    m_statusEtag = xml.attributes().value("etag").toString();
+    while(xml.readNextStartElement()){
+        if(xml.name() == "artist"){
+            statusResponse.Artist = xml.readElementText();
+        } else if(xml.name() == "album"){
+            statusResponse.Album = xml.readElementText();
+        } else if(xml.name() == "name"){
+            statusResponse.Name = xml.readElementText();
+        } else if(xml.name() == "service"){
+            statusResponse.Service = xml.readElementText();
+        } else if(xml.name() == "serviceIcon"){
+            statusResponse.ServiceIcon = xml.readElementText();
+        } else if(xml.name() == "shuffle"){
+            statusResponse.Shuffle = xml.readElementText().toInt();
+        } else if(xml.name() == "repeat"){
+            // 0 = repeat queue, 1 = repeat track, 2 = no repeat
+            int repeat = xml.readElementText().toInt();
+            if (repeat == 0) {
+                statusResponse.Repeat = RepeatMode::All;
+            } else if (repeat == 1) {
+                statusResponse.Repeat = RepeatMode::One;
+            } else {
+                statusResponse.Repeat = RepeatMode::None;
             }
+        } else if(xml.name() == "state"){
+            QString playback = xml.readElementText();
+            if (playback == "play") {
+                statusResponse.State = PlaybackState::Playing;
+            } else if (playback == "pause") {
+                statusResponse.State = PlaybackState::Paused;
+            } else if (playback == "stop") {
+                statusResponse.State = PlaybackState::Stopped;
+            } else if (playback == "connecting") {
+                statusResponse.State = PlaybackState::Connecting;
+            } else if (playback == "stream") {
+                statusResponse.State = PlaybackState::Streaming;
+            }  else {
+                statusResponse.State = PlaybackState::Stopped;
+                qCWarning(dcBluOS()) << "State response, unhandled playback mode" << playback;
+            }
+        } else if(xml.name() == "volume"){
+            statusResponse.Volume = xml.readElementText().toInt();
+        } else if(xml.name() == "mute"){
+            statusResponse.Mute = xml.readElementText().toInt();
+        } else if(xml.name() == "image") {
+            statusResponse.Image = xml.readElementText();
+        } else if(xml.name() == "title1") {
+            statusResponse.Title = xml.readElementText();
+        } else if(xml.name() == "group") {
+            statusResponse.Group = xml.readElementText();
+        } else {
+            xml.skipCurrentElement();
         }
     }
+
+    // Only forward actual changes, an unchanged status would just rewrite all states
+    if (m_lastStatusValid && statusResponse == m_lastStatus)
+        return true;
+
+    m_lastStatus = statusResponse;
+    m_lastStatusValid = true;
     emit statusReceived(statusResponse);
     return true;
 }
+
+bool BluOS::StatusResponse::operator==(const BluOS::StatusResponse &other) const
+{
+    return Album == other.Album &&
+            Artist == other.Artist &&
+            Name == other.Name &&
+            Title == other.Title &&
+            Service == other.Service &&
+            ServiceIcon == other.ServiceIcon &&
+            State == other.State &&
+            StationUrl == other.StationUrl &&
+            Volume == other.Volume &&
+            Mute == other.Mute &&
+            Repeat == other.Repeat &&
+            Shuffle == other.Shuffle &&
+            Image == other.Image &&
+            Group == other.Group;
+}
@@ -35,6 +35,10 @@
 #include <QTimer>
 #include <QHostAddress>
 #include <QUuid>
+#include <QUrlQuery>
+#include <QPointer>
+#include <QElapsedTimer>
+#include <QNetworkReply>
 
 #include "network/networkaccessmanager.h"
 #include "integrations/thing.h"
@@ -73,14 +77,17 @@ public:
       QString Title;
       QString Service;
       QUrl ServiceIcon;
-      PlaybackState State;
+      PlaybackState State = Stopped;
       QUrl StationUrl;
-      int Volume;
-      bool Mute;
-      RepeatMode Repeat;
-      bool Shuffle;
+      int Volume = 0;
+      bool Mute = false;
+      RepeatMode Repeat = None;
+      bool Shuffle = false;
       QUrl Image;
       QString Group;
+
+      bool operator==(const StatusResponse &other) const;
+      bool operator!=(const StatusResponse &other) const { return !(*this == other); }
     };
 
     struct Preset {
@@ -98,11 +105,18 @@ public:
     };
 
     explicit BluOS(NetworkAccessManager *networkManager, QHostAddress hostAddress, int port, QObject *parent = nullptr);
+    ~BluOS();
     int port();
     QHostAddress hostAddress();
     
     // Status Queries
     void getStatus();
+
+    // Keeps one long-polling /Status request outstanding, the player answers as soon as its status changes.
+    // Players without etag support need to be polled with getStatus() instead, see statusPollingActive().
+    void startStatusPolling();
+    void stopStatusPolling();
+    bool statusPollingActive() const;
     
     // Volume Control
     QUuid setVolume(uint volume);
@@ -134,6 +148,23 @@ private:
     int m_port;
     NetworkAccessManager *m_networkManager = nullptr;
 
+    // Long-polling
+    int m_statusPollTimeout = 100; // seconds
+    bool m_statusPollingEnabled = false;
+    bool m_longPollingSupported = true;
+    int m_immediateStatusResponses = 0;
+    QString m_statusEtag;
+    QPointer<QNetworkReply> m_statusPollReply;
+    QElapsedTimer m_statusPollTime;
+    QTimer *m_statusPollRetryTimer = nullptr;
+
+    StatusResponse m_lastStatus;
+    bool m_lastStatusValid = false;
+
+    QNetworkReply *requestStatus(const QUrlQuery &query = QUrlQuery());
+    void sendStatusPoll();
+    void disableLongPolling(const QString &reason);
+
     QUuid playBackControl(PlaybackCommand command);
     bool parseState(const QByteArray &state);
 
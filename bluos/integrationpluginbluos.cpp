@@ -113,13 +113,18 @@ void IntegrationPluginBluOS::setupThing(ThingSetupInfo *info)
 
 void IntegrationPluginBluOS::postSetupThing(Thing *thing)
 {
-    Q_UNUSED(thing)
+    BluOS *bluos = m_bluos.value(thing->id());
+    if (bluos) {
+        bluos->startStatusPolling();
+    }
 
     if (!m_pluginTimer) {
         m_pluginTimer = hardwareManager()->pluginTimerManager()->registerTimer(10);
         connect(m_pluginTimer, &PluginTimer::timeout, [this] {
             foreach(BluOS *bluos, m_bluos) {
-                bluos->getStatus();
+                // Long-polling players report changes on their own
+                if (!bluos->statusPollingActive())
+                    bluos->getStatus();
             }
         });
     }
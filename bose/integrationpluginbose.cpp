@@ -425,7 +425,12 @@ void IntegrationPluginBose::updateConsumerKey()
 
 void IntegrationPluginBose::onPluginTimer()
 {
+    m_pluginTimerTicks++;
     foreach(SoundTouch *soundTouch, m_soundTouch.values()) {
+        // Speakers with a connected websocket push their changes, poll them only as a slow consistency check
+        if (soundTouch->websocketConnected() && (m_pluginTimerTicks % m_consistencyCheckTicks) != 0)
+            continue;
+
         soundTouch->getInfo();
         soundTouch->getNowPlaying();
         soundTouch->getVolume();
@@ -66,6 +66,8 @@ private:
     QString m_consumerKey;
     ZeroConfServiceBrowser *m_serviceBrowser = nullptr;
     PluginTimer *m_pluginTimer = nullptr;
+    uint m_pluginTimerTicks = 0;
+    uint m_consistencyCheckTicks = 30; // Every 60 seconds with the 2 second plugin timer
 
     QHash<Thing *, SoundTouch *> m_soundTouch;
     QHash<QUuid, ThingActionInfo *> m_pendingActions;
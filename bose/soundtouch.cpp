@@ -38,19 +38,23 @@ SoundTouch::SoundTouch(NetworkAccessManager *networkAccessManager, QString ipAdd
     m_networkAccessManager(networkAccessManager),
     m_ipAddress(ipAddress)
 {
-    //THIS CODE IS LEFT INTENTIONALLY
-    //m_websocket = new QWebSocket();
-    //connect(m_websocket, &QWebSocket::connected, this, &SoundTouch::onWebsocketConnected);
-    //connect(m_websocket, &QWebSocket::disconnected, this, &SoundTouch::onWebsocketDisconnected);
-    //connect(m_websocket, &QWebSocket::textMessageReceived, this, &SoundTouch::onWebsocketMessageReceived);
-    //QUrl url;
-    //url.setHost(m_ipAddress);
-    //url.setScheme("ws");
-    //url.setPort(8080);
-    //qDebug(dcBose) << "Connecting websocket to" << url;
-    //TODO missing websocket subprotocol "gabbo"
-    //QWebsockets doesn't support subprotocols
-    //m_websocket->open(url);
+    m_websocket = new QWebSocket(QString(), QWebSocketProtocol::VersionLatest, this);
+    connect(m_websocket, &QWebSocket::connected, this, &SoundTouch::onWebsocketConnected);
+    connect(m_websocket, &QWebSocket::disconnected, this, &SoundTouch::onWebsocketDisconnected);
+    connect(m_websocket, &QWebSocket::textMessageReceived, this, &SoundTouch::onWebsocketMessageReceived);
+    connect(m_websocket, SIGNAL(error(QAbstractSocket::SocketError)), this, SLOT(onWebsocketError(QAbstractSocket::SocketError)));
+
+    m_websocketReconnectTimer = new QTimer(this);
+    m_websocketReconnectTimer->setSingleShot(true);
+    m_websocketReconnectTimer->setInterval(5000);
+    connect(m_websocketReconnectTimer, &QTimer::timeout, this, &SoundTouch::connectWebsocket);
+
+    connectWebsocket();
+}
+
+bool SoundTouch::websocketConnected() const
+{
+    return m_websocket->state() == QAbstractSocket::ConnectedState;
 }
 
 QUuid SoundTouch::getInfo()
@@ -496,29 +500,96 @@ QUuid SoundTouch::setSpeaker(PlayInfoObject playInfo)
     return requestId;
 }
 
+void SoundTouch::connectWebsocket()
+{
+    QUrl url;
+    url.setHost(m_ipAddress);
+    url.setScheme("ws");
+    url.setPort(m_websocketPort);
+
+    // QWebSocket has no API for sub-protocols, the speaker only accepts the connection with "gabbo"
+    QNetworkRequest request(url);
+    request.setRawHeader("Sec-WebSocket-Protocol", "gabbo");
+    qCDebug(dcBose()) << "Connecting websocket to" << url.toString();
+    m_websocket->open(request);
+}
+
 void SoundTouch::onWebsocketConnected()
 {
-    qDebug(dcBose) << "Bose websocket connected";
+    qCDebug(dcBose()) << "Bose websocket connected" << m_ipAddress;
     emit connectionChanged(true);
+    emit websocketConnectedChanged(true);
 }
 
 void SoundTouch::onWebsocketDisconnected()
 {
-    qDebug(dcBose) << "Bose websocket disconnected";
-    emit connectionChanged(false);
-    QTimer::singleShot(5000, this, [this](){
-        QUrl url;
-        url.setHost(m_ipAddress);
-        url.setScheme("ws");
-        url.setPort(8080);
-        m_websocket->open(url);
-    });
+    // The HTTP requests keep track of the connection state, the socket just gets reconnected
+    qCDebug(dcBose()) << "Bose websocket disconnected" << m_ipAddress << m_websocket->closeReason() << "reconnecting in" << m_websocketReconnectTimer->interval() / 1000 << "seconds";
+    emit websocketConnectedChanged(false);
+    m_websocketReconnectTimer->start();
 }
 
-void SoundTouch::onWebsocketMessageReceived(QString message)
+void SoundTouch::onWebsocketError(QAbstractSocket::SocketError error)
 {
-    qDebug(dcBose) << "Websocket message received:" << message;
-    //TODO as soon as QWebSocket supports sub-protocols
+    qCDebug(dcBose()) << "Bose websocket error" << m_ipAddress << error << m_websocket->errorString();
+    if (!m_websocketReconnectTimer->isActive())
+        m_websocketReconnectTimer->start();
+}
+
+void SoundTouch::onWebsocketMessageReceived(const QString &message)
+{
+    //qCDebug(dcBose()) << "Websocket message received:" << message;
+    QXmlStreamReader xml(message);
+    if (!xml.readNextStartElement())
+        return;
+
+    if (xml.name() != "updates") {
+        // e.g. <SoundTouchSdkInfo/> after connecting or <userActivityUpdate/>
+        return;
+    }
+
+    // <updates deviceID="..."><volumeUpdated><volume>...</volume></volumeUpdated></updates>
+    while (xml.readNextStartElement()) {
+        if (xml.name() == "nowPlayingUpdated") {
+            while (xml.readNextStartElement()) {
+                if (xml.name() == "nowPlaying") {
+                    emit nowPlayingReceived(QUuid(), parseNowPlaying(xml));
+                } else {
+                    xml.skipCurrentElement();
+                }
+            }
+        } else if (xml.name() == "volumeUpdated") {
+            while (xml.readNextStartElement()) {
+                if (xml.name() == "volume") {
+                    emit volumeReceived(QUuid(), parseVolume(xml));
+                } else {
+                    xml.skipCurrentElement();
+                }
+            }
+        } else if (xml.name() == "zoneUpdated") {
+            while (xml.readNextStartElement()) {
+                if (xml.name() == "zone") {
+                    emit zoneReceived(QUuid(), parseZone(xml));
+                } else {
+                    xml.skipCurrentElement();
+                }
+            }
+        } else if (xml.name() == "bassUpdated") {
+            // Only a notification, the value needs to be fetched
+            xml.skipCurrentElement();
+            getBass();
+        } else if (xml.name() == "infoUpdated" || xml.name() == "nameUpdated") {
+            xml.skipCurrentElement();
+            getInfo();
+        } else {
+            qCDebug(dcBose()) << "Unhandled websocket update" << xml.name();
+            xml.skipCurrentElement();
+        }
+    }
+
+    if (xml.hasError()) {
+        qCWarning(dcBose()) << "Websocket message parse error:" << xml.errorString() << message;
+    }
 }
 
 QUuid SoundTouch::sendGetRequest(QString path)
@@ -670,127 +741,10 @@ void SoundTouch::parseData(QUuid requestId, const QByteArray &data)
             }
             emit infoReceived(requestId, info);
         } else if (xml.name() == "nowPlaying") {
-            NowPlayingObject nowPlaying;
-            if(xml.attributes().hasAttribute("deviceID")) {
-                //qDebug(dcBose) << "Device ID" << xml.attributes().value("deviceID").toString();
-                nowPlaying.deviceID = xml.attributes().value("deviceID").toString();
-            }
-            if(xml.attributes().hasAttribute("source")) {
-                //qDebug(dcBose) << "Source" << xml.attributes().value("source").toString();
-                nowPlaying.source = xml.attributes().value("source").toString();
-            }
-            if(xml.attributes().hasAttribute("sourceAccount")) {
-                //qDebug(dcBose) << "Source Account" << xml.attributes().value("sourceAccount").toString();
-                nowPlaying.sourceAccount = xml.attributes().value("sourceAccount").toString();
-            }
-            while(xml.readNextStartElement()){
-                if (xml.name() == "track") {
-                    //qDebug(dcBose) << "track" << xml.readElementText();
-                    nowPlaying.track = xml.readElementText();
-                } else if(xml.name() == "artist") {
-                    //qDebug(dcBose) << "artist" << xml.readElementText();
-                    nowPlaying.artist = xml.readElementText();
-                } else if(xml.name() == "album") {
-                    //qDebug(dcBose) << "album" << xml.readElementText();
-                    nowPlaying.album = xml.readElementText();
-                } else if(xml.name() == "genre") {
-                    //qDebug(dcBose) << "genre" << xml.readElementText();
-                    nowPlaying.genre = xml.readElementText();
-                } else if(xml.name() == "rating") {
-                    //qDebug(dcBose) << "rating" << xml.readElementText();
-                    nowPlaying.rating = xml.readElementText();
-                } else if(xml.name() == "stationName") {
-                    //qDebug(dcBose) << "Station name" << xml.readElementText();
-                    nowPlaying.stationName = xml.readElementText();
-                } else if(xml.name() == "art") {
-                    ArtObject art;
-                    if(xml.attributes().hasAttribute("artImageStatus")) {
-                        QString artStatus = xml.attributes().value("artImageStatus").toString().toUpper();
-                        //ART_STATUS: INVALID, SHOW_DEFAULT_IMAGE, DOWNLOADING, IMAGE_PRESENT
-                        //qDebug(dcBose) << "Art Image status" << artStatus;
-                        if (artStatus == "INVALID") {
-                            art.artStatus = ART_STATUS_INVALID;
-                        } else if (artStatus == "SHOW_DEFAULT_IMAGE") {
-                            art.artStatus = ART_STATUS_SHOW_DEFAULT_IMAGE;
-                        }  else if (artStatus == "DOWNLOADING") {
-                            art.artStatus = ART_STATUS_DOWNLOADING;
-                        }  else if (artStatus == "IMAGE_PRESENT") {
-                            art.artStatus = ART_STATUS_IMAGE_PRESENT;
-                        }
-                    }
-                    nowPlaying.art.url = xml.readElementText();
-                }else if(xml.name() == "playStatus") {
-                    QString playStatus = xml.readElementText();
-                    //qDebug(dcBose) << "Play Status" << playStatus;
-                    //Modes: PLAY_STATE, PAUSE_STATE, STOP_STATE, BUFFERING_STATE
-                    if (playStatus == "PLAY_STATE") {
-                        nowPlaying.playStatus = PLAY_STATUS_PLAY_STATE;
-                    } else if (playStatus == "PAUSE_STATE") {
-                        nowPlaying.playStatus = PLAY_STATUS_PAUSE_STATE;
-                    } else if (playStatus == "STOP_STATE") {
-                        nowPlaying.playStatus = PLAY_STATUS_STOP_STATE;
-                    } else if (playStatus == "BUFFERING_STATE") {
-                        nowPlaying.playStatus = PLAY_STATUS_BUFFERING_STATE;
-                    }
-                } else if(xml.name() == "shuffleSetting") {
-                    QString shuffle = xml.readElementText().toUpper();
-                    //qDebug(dcBose) << "Shuffle Setting" << shuffle;
-                    if (shuffle == "SHUFFLE_ON") {
-                        nowPlaying.shuffleSetting = SHUFFLE_STATUS_SHUFFLE_ON;
-                    } else {
-                        nowPlaying.shuffleSetting = SHUFFLE_STATUS_SHUFFLE_OFF;
-                    }
-                }else if(xml.name() == "repeatSetting") {
-                    QString repeat = xml.readElementText().toUpper();
-                    //qDebug(dcBose) << "Repeat Setting" << repeat;
-                    //Modes: REPEAT_OFF, REPEAT_ALL, REPEAT_ONE
-                    if (repeat == "REPEAT_OFF") {
-                        nowPlaying.repeatSettings = REPEAT_STATUS_REPEAT_OFF;
-                    } else if (repeat == "REPEAT_ONE") {
-                        nowPlaying.repeatSettings = REPEAT_STATUS_REPEAT_ONE;
-                    } else if (repeat == "REPEAT_ALL") {
-                        nowPlaying.repeatSettings = REPEAT_STATUS_REPEAT_ALL;
-                    }
-                } else if(xml.name() == "streamType") {
-                    QString streamType = xml.readElementText().toUpper();
-                    //qDebug(dcBose) << "Stream Type" << streamType;
-                    //Types: TRACK_ONDEMAND, RADIO_STREAMING, RADIO_TRACKS, NO_TRANSPORT_CONTROLS
-                    if (streamType == "RADIO_TRACKS") {
-                        nowPlaying.streamType = STREAM_STATUS_RADIO_TRACKS;
-                    } else if (streamType == "TRACK_ONDEMAND") {
-                        nowPlaying.streamType = STREAM_STATUS_TRACK_ONDEMAND;
-                    } else if (streamType == "RADIO_STREAMING") {
-                        nowPlaying.streamType = STREAM_STATUS_RADIO_STREAMING;
-                    } else if (streamType == "NO_TRANSPORT_CONTROLS") {
-                        nowPlaying.streamType = STREAM_STATUS_NO_TRANSPORT_CONTROLS;
-                    };
-                } else if(xml.name() == "stationLocation") {
-                    nowPlaying.stationLocation = xml.readElementText();
-                } else {
-                    xml.skipCurrentElement();
-                }
-            }
+            NowPlayingObject nowPlaying = parseNowPlaying(xml);
             emit nowPlayingReceived(requestId, nowPlaying);
         } else if (xml.name() == "volume") {
-            VolumeObject volumeObject;
-            if(xml.attributes().hasAttribute("deviceID")) {
-                //qDebug(dcBose) << "Device ID" << xml.attributes().value("deviceID").toString();
-                volumeObject.deviceID = xml.attributes().value("deviceID").toString();
-            }
-            while(xml.readNextStartElement()){
-                if(xml.name() == "targetvolume"){
-                    //qDebug(dcBose) << "Target volume" << xml.readElementText();
-                    volumeObject.targetVolume = xml.readElementText().toInt();
-                }else if(xml.name() == "actualvolume"){
-                    //qDebug(dcBose) << "Actual volume" << xml.readElementText();
-                    volumeObject.actualVolume = xml.readElementText().toInt();
-                }else if(xml.name() == "muteenabled"){
-                    //qDebug(dcBose) << "Mute enabled" << xml.readElementText();
-                    volumeObject.muteEnabled = ( xml.readElementText().toUpper() == "TRUE" ); //TODO convert from "false" to bool
-                }else {
-                    xml.skipCurrentElement();
-                }
-            }
+            VolumeObject volumeObject = parseVolume(xml);
             emit volumeReceived(requestId, volumeObject);
         } else if (xml.name() == "sources") {
             SourcesObject sourcesObject;
@@ -949,22 +903,7 @@ void SoundTouch::parseData(QUuid requestId, const QByteArray &data)
             }
             emit groupReceived(requestId, group);
         } else if (xml.name() == "zone") {
-            ZoneObject zone;
-            if(xml.attributes().hasAttribute("master")) {
-                zone.deviceID = xml.attributes().value("master").toString();
-            }
-            while(xml.readNextStartElement()){
-                MemberObject member;
-                if(xml.name() == "member") {
-                    if(xml.attributes().hasAttribute("ipaddress")) {
-                        member.ipAddress = xml.attributes().value("ipaddress").toString();
-                    }
-                    member.deviceID = xml.readElementText();
-                } else {
-                    xml.skipCurrentElement();
-                }
-                zone.members.append(member);
-            }
+            ZoneObject zone = parseZone(xml);
             emit zoneReceived(requestId, zone);
         }
         else {
@@ -972,3 +911,153 @@ void SoundTouch::parseData(QUuid requestId, const QByteArray &data)
         }
     }
 }
+
+NowPlayingObject SoundTouch::parseNowPlaying(QXmlStreamReader &xml)
+{
+    NowPlayingObject nowPlaying;
+    if(xml.attributes().hasAttribute("deviceID")) {
+        //qDebug(dcBose) << "Device ID" << xml.attributes().value("deviceID").toString();
+        nowPlaying.deviceID = xml.attributes().value("deviceID").toString();
+    }
+    if(xml.attributes().hasAttribute("source")) {
+        //qDebug(dcBose) << "Source" << xml.attributes().value("source").toString();
+        nowPlaying.source = xml.attributes().value("source").toString();
+    }
+    if(xml.attributes().hasAttribute("sourceAccount")) {
+        //qDebug(dcBose) << "Source Account" << xml.attributes().value("sourceAccount").toString();
+        nowPlaying.sourceAccount = xml.attributes().value("sourceAccount").toString();
+    }
+    while(xml.readNextStartElement()){
+        if (xml.name() == "track") {
+            //qDebug(dcBose) << "track" << xml.readElementText();
+            nowPlaying.track = xml.readElementText();
+        } else if(xml.name() == "artist") {
+            //qDebug(dcBose) << "artist" << xml.readElementText();
+            nowPlaying.artist = xml.readElementText();
+        } else if(xml.name() == "album") {
+            //qDebug(dcBose) << "album" << xml.readElementText();
+            nowPlaying.album = xml.readElementText();
+        } else if(xml.name() == "genre") {
+            //qDebug(dcBose) << "genre" << xml.readElementText();
+            nowPlaying.genre = xml.readElementText();
+        } else if(xml.name() == "rating") {
+            //qDebug(dcBose) << "rating" << xml.readElementText();
+            nowPlaying.rating = xml.readElementText();
+        } else if(xml.name() == "stationName") {
+            //qDebug(dcBose) << "Station name" << xml.readElementText();
+            nowPlaying.stationName = xml.readElementText();
+        } else if(xml.name() == "art") {
+            ArtObject art;
+            if(xml.attributes().hasAttribute("artImageStatus")) {
+                QString artStatus = xml.attributes().value("artImageStatus").toString().toUpper();
+                //ART_STATUS: INVALID, SHOW_DEFAULT_IMAGE, DOWNLOADING, IMAGE_PRESENT
+                //qDebug(dcBose) << "Art Image status" << artStatus;
+                if (artStatus == "INVALID") {
+                    art.artStatus = ART_STATUS_INVALID;
+                } else if (artStatus == "SHOW_DEFAULT_IMAGE") {
+                    art.artStatus = ART_STATUS_SHOW_DEFAULT_IMAGE;
+                }  else if (artStatus == "DOWNLOADING") {
+                    art.artStatus = ART_STATUS_DOWNLOADING;
+                }  else if (artStatus == "IMAGE_PRESENT") {
+                    art.artStatus = ART_STATUS_IMAGE_PRESENT;
+                }
+            }
+            nowPlaying.art.url = xml.readElementText();
+        }else if(xml.name() == "playStatus") {
+            QString playStatus = xml.readElementText();
+            //qDebug(dcBose) << "Play Status" << playStatus;
+            //Modes: PLAY_STATE, PAUSE_STATE, STOP_STATE, BUFFERING_STATE
+            if (playStatus == "PLAY_STATE") {
+                nowPlaying.playStatus = PLAY_STATUS_PLAY_STATE;
+            } else if (playStatus == "PAUSE_STATE") {
+                nowPlaying.playStatus = PLAY_STATUS_PAUSE_STATE;
+            } else if (playStatus == "STOP_STATE") {
+                nowPlaying.playStatus = PLAY_STATUS_STOP_STATE;
+            } else if (playStatus == "BUFFERING_STATE") {
+                nowPlaying.playStatus = PLAY_STATUS_BUFFERING_STATE;
+            }
+        } else if(xml.name() == "shuffleSetting") {
+            QString shuffle = xml.readElementText().toUpper();
+            //qDebug(dcBose) << "Shuffle Setting" << shuffle;
+            if (shuffle == "SHUFFLE_ON") {
+                nowPlaying.shuffleSetting = SHUFFLE_STATUS_SHUFFLE_ON;
+            } else {
+                nowPlaying.shuffleSetting = SHUFFLE_STATUS_SHUFFLE_OFF;
+            }
+        }else if(xml.name() == "repeatSetting") {
+            QString repeat = xml.readElementText().toUpper();
+            //qDebug(dcBose) << "Repeat Setting" << repeat;
+            //Modes: REPEAT_OFF, REPEAT_ALL, REPEAT_ONE
+            if (repeat == "REPEAT_OFF") {
+                nowPlaying.repeatSettings = REPEAT_STATUS_REPEAT_OFF;
+            } else if (repeat == "REPEAT_ONE") {
+                nowPlaying.repeatSettings = REPEAT_STATUS_REPEAT_ONE;
+            } else if (repeat == "REPEAT_ALL") {
+                nowPlaying.repeatSettings = REPEAT_STATUS_REPEAT_ALL;
+            }
+        } else if(xml.name() == "streamType") {
+            QString streamType = xml.readElementText().toUpper();
+            //qDebug(dcBose) << "Stream Type" << streamType;
+            //Types: TRACK_ONDEMAND, RADIO_STREAMING, RADIO_TRACKS, NO_TRANSPORT_CONTROLS
+            if (streamType == "RADIO_TRACKS") {
+                nowPlaying.streamType = STREAM_STATUS_RADIO_TRACKS;
+            } else if (streamType == "TRACK_ONDEMAND") {
+                nowPlaying.streamType = STREAM_STATUS_TRACK_ONDEMAND;
+            } else if (streamType == "RADIO_STREAMING") {
+                nowPlaying.streamType = STREAM_STATUS_RADIO_STREAMING;
+            } else if (streamType == "NO_TRANSPORT_CONTROLS") {
+                nowPlaying.streamType = STREAM_STATUS_NO_TRANSPORT_CONTROLS;
+            };
+        } else if(xml.name() == "stationLocation") {
+            nowPlaying.stationLocation = xml.readElementText();
+        } else {
+            xml.skipCurrentElement();
+        }
+    }
+    return nowPlaying;
+}
+
+VolumeObject SoundTouch::parseVolume(QXmlStreamReader &xml)
+{
+    VolumeObject volumeObject;
+    if(xml.attributes().hasAttribute("deviceID")) {
+        //qDebug(dcBose) << "Device ID" << xml.attributes().value("deviceID").toString();
+        volumeObject.deviceID = xml.attributes().value("deviceID").toString();
+    }
+    while(xml.readNextStartElement()){
+        if(xml.name() == "targetvolume"){
+            //qDebug(dcBose) << "Target volume" << xml.readElementText();
+            volumeObject.targetVolume = xml.readElementText().toInt();
+        }else if(xml.name() == "actualvolume"){
+            //qDebug(dcBose) << "Actual volume" << xml.readElementText();
+            volumeObject.actualVolume = xml.readElementText().toInt();
+        }else if(xml.name() == "muteenabled"){
+            //qDebug(dcBose) << "Mute enabled" << xml.readElementText();
+            volumeObject.muteEnabled = ( xml.readElementText().toUpper() == "TRUE" ); //TODO convert from "false" to bool
+        }else {
+            xml.skipCurrentElement();
+        }
+    }
+    return volumeObject;
+}
+
+ZoneObject SoundTouch::parseZone(QXmlStreamReader &xml)
+{
+    ZoneObject zone;
+    if(xml.attributes().hasAttribute("master")) {
+        zone.deviceID = xml.attributes().value("master").toString();
+    }
+    while(xml.readNextStartElement()){
+        MemberObject member;
+        if(xml.name() == "member") {
+            if(xml.attributes().hasAttribute("ipaddress")) {
+                member.ipAddress = xml.attributes().value("ipaddress").toString();
+            }
+            member.deviceID = xml.readElementText();
+        } else {
+            xml.skipCurrentElement();
+        }
+        zone.members.append(member);
+    }
+    return zone;
+}
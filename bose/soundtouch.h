@@ -49,6 +49,9 @@ class SoundTouch : public QObject
 public:
     explicit SoundTouch(NetworkAccessManager *networkAccessManager, QString ipAddress, QObject *parent = nullptr);
 
+    // While the websocket is connected the speaker pushes now playing, volume and zone changes
+    bool websocketConnected() const;
+
     QUuid getInfo();             //Get basic information about a product.
     QUuid getVolume();           //Get the current volume and mute status of a product.
     QUuid getNowPlaying();       //Get information about what's playing on a product.
@@ -82,11 +85,18 @@ private:
     QString m_ipAddress;
     int m_port = 8090;
     QWebSocket *m_websocket = nullptr;
+    int m_websocketPort = 8080;
+    QTimer *m_websocketReconnectTimer = nullptr;
     void emitRequestStatus(QUuid requestId, QNetworkReply *reply); //returns the status, -1 in case of error
     void parseData(QUuid requestId, const QByteArray &data);
 
+    NowPlayingObject parseNowPlaying(QXmlStreamReader &xml);
+    VolumeObject parseVolume(QXmlStreamReader &xml);
+    ZoneObject parseZone(QXmlStreamReader &xml);
+
 signals:
     void connectionChanged(bool connected);
+    void websocketConnectedChanged(bool connected);
 
     void infoReceived(QUuid requestId, InfoObject info);
     void nowPlayingReceived(QUuid requestId, NowPlayingObject nowPlaying);
@@ -102,9 +112,11 @@ signals:
     void errorReceived(ErrorObject error);
 
 private slots:
+    void connectWebsocket();
     void onWebsocketConnected();
     void onWebsocketDisconnected();
-    void onWebsocketMessageReceived(QString message);
+    void onWebsocketError(QAbstractSocket::SocketError error);
+    void onWebsocketMessageReceived(const QString &message);
 };
 
 #endif // SOUNDTOUCH_H
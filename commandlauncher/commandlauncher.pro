@@ -3,8 +3,10 @@ include(../plugins.pri)
 TARGET = $$qtLibraryTarget(nymea_integrationplugincommandlauncher)
 
 SOURCES += \
+    commandrunner.cpp \
     integrationplugincommandlauncher.cpp
 
 HEADERS += \
+    commandrunner.h \
     integrationplugincommandlauncher.h
 
@@ -0,0 +1,407 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+*
+* Copyright 2013 - 2020, nymea GmbH
+* Contact: contact@nymea.io
+*
+* This file is part of nymea.
+* This project including source code and documentation is protected by
+* copyright law, and remains the property of nymea GmbH. All rights, including
+* reproduction, publication, editing and translation, are reserved. The use of
+* this project is subject to the terms of a license agreement to be concluded
+* with nymea GmbH in accordance with the terms of use of nymea GmbH, available
+* under https://nymea.io/license
+*
+* GNU Lesser General Public License Usage
+* Alternatively, this project may be redistributed and/or modified under the
+* terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; version 3. This project is distributed in the hope that
+* it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+* warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this project. If not, see <https://www.gnu.org/licenses/>.
+*
+* For any further details and any questions please contact us under
+* contact@nymea.io or see our FAQ/Licensing Information on
+* https://nymea.io/license/faq
+*
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "commandrunner.h"
+#include "extern-plugininfo.h"
+
+#include <QTimer>
+
+// Output beyond this size is dropped, the events would get unusable otherwise
+static const int maxOutputSize = 65536;
+
+static void appendOutput(QByteArray &output, const QByteArray &data)
+{
+    if (output.size() < maxOutputSize) {
+        output.append(data.left(maxOutputSize - output.size()));
+    }
+}
+
+// Moves everything in pending before the marker into output. Returns true and the data
+// following the marker in rest once the marker has been seen. Keeps a possibly incomplete
+// marker at the end of pending until the next chunk arrives.
+static bool consumeOutput(QByteArray &pending, const QByteArray &marker, QByteArray &output, QByteArray *rest)
+{
+    int index = pending.indexOf(marker);
+    if (index < 0) {
+        int keep = qMin(pending.size(), marker.size() - 1);
+        appendOutput(output, pending.left(pending.size() - keep));
+        pending = pending.right(keep);
+        return false;
+    }
+
+    appendOutput(output, pending.left(index));
+    *rest = pending.mid(index + marker.size());
+    pending.clear();
+    return true;
+}
+
+static QString shellQuote(const QString &text)
+{
+    QString quoted = text;
+    quoted.replace("'", "'\\''");
+    return "'" + quoted + "'";
+}
+
+CommandRunner::CommandRunner(bool persistentShell, int maxCommands, const Limits &limits, QObject *parent) :
+    QObject(parent),
+    m_persistentShell(persistentShell),
+    m_maxCommands(qMax(1, maxCommands)),
+    m_limits(limits)
+{
+    m_token = "NYMEA_COMMAND_DONE_" + QUuid::createUuid().toRfc4122().toHex();
+}
+
+CommandRunner::~CommandRunner()
+{
+    // Don't call back into a half destroyed runner while the processes are going down
+    foreach (QProcess *process, m_processes.keys()) {
+        disconnect(process, nullptr, this, nullptr);
+        process->kill();
+        process->waitForFinished(1000);
+    }
+
+    if (m_shell) {
+        disconnect(m_shell, nullptr, this, nullptr);
+        QProcess::startDetached("pkill", QStringList() << "-KILL" << "-P" << QString::number(m_shell->processId()));
+        m_shell->kill();
+        m_shell->waitForFinished(1000);
+    }
+}
+
+bool CommandRunner::persistentShell() const
+{
+    return m_persistentShell;
+}
+
+bool CommandRunner::running() const
+{
+    return m_running;
+}
+
+QUuid CommandRunner::run(const QString &command)
+{
+    if (commandCount() >= m_maxCommands) {
+        qCDebug(dcCommandLauncher()) << "Not running" << command << "because" << commandCount() << "commands are already running or waiting.";
+        return QUuid();
+    }
+
+    Command queuedCommand;
+    queuedCommand.id = QUuid::createUuid();
+    queuedCommand.command = command;
+    queuedCommand.timer.start();
+    m_queue.append(queuedCommand);
+    updateRunning();
+
+    // Give the caller the chance to connect to commandStarted before anything happens
+    QTimer::singleShot(0, this, &CommandRunner::processQueue);
+    return queuedCommand.id;
+}
+
+void CommandRunner::killAll()
+{
+    QList<Command> queue = m_queue;
+    m_queue.clear();
+    foreach (const Command &command, queue) {
+        finishCommand(command, false, -1);
+    }
+
+    foreach (QProcess *process, m_processes.keys()) {
+        process->kill();
+    }
+
+    if (m_shell) {
+        // The shell forks a subshell per command, take its children down as well
+        qCDebug(dcCommandLauncher()) << "Killing worker shell" << m_shell->processId();
+        QProcess::startDetached("pkill", QStringList() << "-KILL" << "-P" << QString::number(m_shell->processId()));
+        m_shell->kill();
+    }
+
+    updateRunning();
+}
+
+int CommandRunner::commandCount() const
+{
+    int count = m_queue.count() + m_processes.count();
+    if (!m_current.id.isNull()) {
+        count++;
+    }
+    return count;
+}
+
+QString CommandRunner::cgroupPrefix() const
+{
+    if (m_limits.cgroup.isEmpty()) {
+        return QString();
+    }
+    return QString("echo $$ > %1 || exit 125; ").arg(shellQuote(m_limits.cgroup + "/cgroup.procs"));
+}
+
+QString CommandRunner::resourceLimitsPrefix() const
+{
+    // Resource limits are per process, the CPU time limit has to be set in the process running
+    // the command. Set on the worker shell it would count the CPU time of all commands.
+    QStringList commands;
+    if (m_limits.memoryLimit > 0) {
+        commands << QString("ulimit -v %1 || exit 125").arg(m_limits.memoryLimit * 1024);
+    }
+    if (m_limits.cpuTimeLimit > 0) {
+        commands << QString("ulimit -t %1 || exit 125").arg(m_limits.cpuTimeLimit);
+    }
+
+    if (commands.isEmpty()) {
+        return QString();
+    }
+    return commands.join("; ") + "; ";
+}
+
+void CommandRunner::updateRunning()
+{
+    bool running = commandCount() > 0;
+    if (m_running != running) {
+        m_running = running;
+        emit runningChanged(m_running);
+    }
+}
+
+void CommandRunner::processQueue()
+{
+    if (!m_persistentShell) {
+        while (!m_queue.isEmpty()) {
+            startProcess(m_queue.takeFirst());
+        }
+        return;
+    }
+
+    // The worker shell runs one command after the other
+    if (m_queue.isEmpty() || !m_current.id.isNull()) {
+        return;
+    }
+
+    if (!m_shell) {
+        startShell();
+        if (!m_shell) {
+            // Failed right away
+            Command command = m_queue.takeFirst();
+            finishCommand(command, false, -1);
+            if (!m_queue.isEmpty()) {
+                QTimer::singleShot(0, this, &CommandRunner::processQueue);
+            }
+            return;
+        }
+    }
+
+    m_current = m_queue.takeFirst();
+    m_current.queueTime = m_current.timer.restart();
+    m_stdoutPending.clear();
+    m_stderrPending.clear();
+    m_exitCodePending = false;
+    m_stdoutDone = false;
+    m_stderrDone = false;
+    m_exitCode = -1;
+
+    qCDebug(dcCommandLauncher()) << "Running in worker shell:" << m_current.command;
+    writeCommand(m_current.command);
+    emit commandStarted(m_current.id);
+}
+
+void CommandRunner::startProcess(Command command)
+{
+    QProcess *process = new QProcess(this);
+    m_processes.insert(process, command);
+
+    connect(process, &QProcess::started, this, [this, process](){
+        Command &command = m_processes[process];
+        command.queueTime = command.timer.restart();
+        emit commandStarted(command.id);
+    });
+    connect(process, &QProcess::readyReadStandardOutput, this, [this, process](){
+        appendOutput(m_processes[process].standardOutput, process->readAllStandardOutput());
+    });
+    connect(process, &QProcess::readyReadStandardError, this, [this, process](){
+        appendOutput(m_processes[process].standardError, process->readAllStandardError());
+    });
+    connect(process, &QProcess::errorOccurred, this, [this, process](QProcess::ProcessError error){
+        if (error != QProcess::FailedToStart) {
+            return; // finished() will follow
+        }
+        qCWarning(dcCommandLauncher()) << "Failed to start process:" << process->errorString();
+        Command command = m_processes.take(process);
+        process->deleteLater();
+        finishCommand(command, false, -1);
+    });
+
+    typedef void (QProcess:: *finishedSignal)(int exitCode, QProcess::ExitStatus exitStatus);
+    connect(process, static_cast<finishedSignal>(&QProcess::finished), this, [this, process](int exitCode, QProcess::ExitStatus exitStatus){
+        Command command = m_processes.take(process);
+        appendOutput(command.standardOutput, process->readAllStandardOutput());
+        appendOutput(command.standardError, process->readAllStandardError());
+        process->deleteLater();
+        finishCommand(command, true, exitStatus == QProcess::NormalExit ? exitCode : -1);
+    });
+
+    process->start("/bin/bash", QStringList() << "-c" << cgroupPrefix() + resourceLimitsPrefix() + command.command);
+}
+
+void CommandRunner::startShell()
+{
+    m_shell = new QProcess(this);
+    connect(m_shell, &QProcess::readyReadStandardOutput, this, &CommandRunner::onShellStandardOutput);
+    connect(m_shell, &QProcess::readyReadStandardError, this, &CommandRunner::onShellStandardError);
+    connect(m_shell, &QProcess::errorOccurred, this, [this](QProcess::ProcessError error){
+        if (error == QProcess::FailedToStart) {
+            qCWarning(dcCommandLauncher()) << "Failed to start worker shell:" << m_shell->errorString();
+            onShellFinished();
+        }
+    });
+    typedef void (QProcess:: *finishedSignal)(int exitCode, QProcess::ExitStatus exitStatus);
+    connect(m_shell, static_cast<finishedSignal>(&QProcess::finished), this, [this](int exitCode, QProcess::ExitStatus exitStatus){
+        qCDebug(dcCommandLauncher()) << "Worker shell exited. Exit code:" << exitCode << "Exit status:" << exitStatus;
+        onShellFinished();
+    });
+
+    qCDebug(dcCommandLauncher()) << "Starting worker shell";
+    m_shell->start("/bin/bash", QStringList() << "--noprofile" << "--norc" << "-s");
+
+    // The cgroup is inherited by every command the shell runs
+    QString prefix = cgroupPrefix();
+    if (!prefix.isEmpty()) {
+        m_shell->write(prefix.toUtf8() + "\n");
+    }
+}
+
+void CommandRunner::writeCommand(const QString &command)
+{
+    // Run each command in a subshell with its own stdin so it can neither change the state
+    // of the worker nor eat the following commands. eval turns syntax errors into an exit
+    // code instead of terminating the worker. Once done, the exit code and a token mark the
+    // end of the output on stdout and on stderr.
+    QByteArray line;
+    line.append("( " + resourceLimitsPrefix().toUtf8() + "eval " + shellQuote(command).toUtf8() + "\n) </dev/null; ");
+    line.append("printf '\\n%s %d\\n' " + m_token + " $?; ");
+    line.append("printf '\\n%s\\n' " + m_token + " >&2\n");
+    m_shell->write(line);
+}
+
+void CommandRunner::onShellStandardOutput()
+{
+    QByteArray data = m_shell->readAllStandardOutput();
+    if (m_current.id.isNull() || m_stdoutDone) {
+        return; // Leftovers of something a command has sent to the background
+    }
+
+    m_stdoutPending.append(data);
+    if (!m_exitCodePending) {
+        QByteArray rest;
+        if (!consumeOutput(m_stdoutPending, "\n" + m_token + " ", m_current.standardOutput, &rest)) {
+            return;
+        }
+        m_exitCodePending = true;
+        m_stdoutPending = rest;
+    }
+
+    int index = m_stdoutPending.indexOf('\n');
+    if (index < 0) {
+        return;
+    }
+
+    m_exitCode = m_stdoutPending.left(index).toInt();
+    m_stdoutPending.clear();
+    m_stdoutDone = true;
+    if (m_stderrDone) {
+        finishCurrent(true);
+    }
+}
+
+void CommandRunner::onShellStandardError()
+{
+    QByteArray data = m_shell->readAllStandardError();
+    if (m_current.id.isNull() || m_stderrDone) {
+        return;
+    }
+
+    m_stderrPending.append(data);
+    QByteArray rest;
+    if (!consumeOutput(m_stderrPending, "\n" + m_token + "\n", m_current.standardError, &rest)) {
+        return;
+    }
+
+    m_stderrDone = true;
+    if (m_stdoutDone) {
+        finishCurrent(true);
+    }
+}
+
+void CommandRunner::onShellFinished()
+{
+    if (m_shell->exitStatus() == QProcess::NormalExit && m_shell->exitCode() == 125) {
+        qCWarning(dcCommandLauncher()) << "Could not move the worker shell into the cgroup:" << m_shell->readAllStandardError();
+    }
+
+    m_shell->deleteLater();
+    m_shell = nullptr;
+
+    if (!m_current.id.isNull()) {
+        m_exitCode = -1;
+        finishCurrent(true);
+    } else {
+        updateRunning();
+    }
+}
+
+void CommandRunner::finishCurrent(bool started)
+{
+    Command command = m_current;
+    m_current = Command();
+    finishCommand(command, started, m_exitCode);
+
+    if (!m_queue.isEmpty()) {
+        QTimer::singleShot(0, this, &CommandRunner::processQueue);
+    }
+}
+
+void CommandRunner::finishCommand(const Command &command, bool started, int exitCode)
+{
+    Result result;
+    result.commandId = command.id;
+    result.started = started;
+    result.exitCode = exitCode;
+    result.standardOutput = QString::fromUtf8(command.standardOutput);
+    result.standardError = QString::fromUtf8(command.standardError);
+    if (started) {
+        result.queueTime = command.queueTime;
+        result.duration = command.timer.elapsed();
+    } else {
+        result.queueTime = command.timer.elapsed();
+    }
+
+    qCDebug(dcCommandLauncher()) << "Command" << command.command << "finished with exit code" << exitCode << "after" << result.duration << "ms, waited" << result.queueTime << "ms";
+    emit commandFinished(result);
+    updateRunning();
+}
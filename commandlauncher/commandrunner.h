@@ -0,0 +1,124 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+*
+* Copyright 2013 - 2020, nymea GmbH
+* Contact: contact@nymea.io
+*
+* This file is part of nymea.
+* This project including source code and documentation is protected by
+* copyright law, and remains the property of nymea GmbH. All rights, including
+* reproduction, publication, editing and translation, are reserved. The use of
+* this project is subject to the terms of a license agreement to be concluded
+* with nymea GmbH in accordance with the terms of use of nymea GmbH, available
+* under https://nymea.io/license
+*
+* GNU Lesser General Public License Usage
+* Alternatively, this project may be redistributed and/or modified under the
+* terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; version 3. This project is distributed in the hope that
+* it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+* warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this project. If not, see <https://www.gnu.org/licenses/>.
+*
+* For any further details and any questions please contact us under
+* contact@nymea.io or see our FAQ/Licensing Information on
+* https://nymea.io/license/faq
+*
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef COMMANDRUNNER_H
+#define COMMANDRUNNER_H
+
+#include <QObject>
+#include <QProcess>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QUuid>
+
+class CommandRunner : public QObject
+{
+    Q_OBJECT
+public:
+    struct Limits {
+        int memoryLimit = 0;    // MB of virtual memory, 0 means unlimited
+        int cpuTimeLimit = 0;   // Seconds of CPU time per process, 0 means unlimited
+        QString cgroup;         // Path of an existing cgroup v2 directory to run in
+    };
+
+    struct Result {
+        QUuid commandId;
+        bool started = false;
+        int exitCode = -1;
+        QString standardOutput;
+        QString standardError;
+        qint64 queueTime = 0;   // ms between run() and the start of the command
+        qint64 duration = 0;    // ms between the start and the end of the command
+    };
+
+    explicit CommandRunner(bool persistentShell, int maxCommands, const Limits &limits, QObject *parent = nullptr);
+    ~CommandRunner();
+
+    bool persistentShell() const;
+    bool running() const;
+
+    // Returns a null uuid if maxCommands are already running or waiting
+    QUuid run(const QString &command);
+    void killAll();
+
+signals:
+    void commandStarted(const QUuid &commandId);
+    void commandFinished(const CommandRunner::Result &result);
+    void runningChanged(bool running);
+
+private:
+    struct Command {
+        QUuid id;
+        QString command;
+        QElapsedTimer timer;
+        qint64 queueTime = 0;
+        QByteArray standardOutput;
+        QByteArray standardError;
+    };
+
+    bool m_persistentShell = false;
+    int m_maxCommands = 1;
+    Limits m_limits;
+    bool m_running = false;
+
+    QList<Command> m_queue;
+
+    // One process per command
+    QHash<QProcess *, Command> m_processes;
+
+    // Persistent worker shell
+    QProcess *m_shell = nullptr;
+    QByteArray m_token;
+    Command m_current;
+    QByteArray m_stdoutPending;
+    QByteArray m_stderrPending;
+    bool m_exitCodePending = false;
+    bool m_stdoutDone = false;
+    bool m_stderrDone = false;
+    int m_exitCode = -1;
+
+    int commandCount() const;
+    QString cgroupPrefix() const;
+    QString resourceLimitsPrefix() const;
+    void updateRunning();
+
+    void startProcess(Command command);
+    void startShell();
+    void writeCommand(const QString &command);
+    void finishCurrent(bool started);
+    void finishCommand(const Command &command, bool started, int exitCode);
+
+private slots:
+    void processQueue();
+    void onShellStandardOutput();
+    void onShellStandardError();
+    void onShellFinished();
+};
+
+#endif // COMMANDRUNNER_H
@@ -42,15 +42,33 @@ IntegrattionPluginCommandLauncher::IntegrattionPluginCommandLauncher()
 
 void IntegrattionPluginCommandLauncher::setupThing(ThingSetupInfo *info)
 {
+    Thing *thing = info->thing();
+
     // Application
-    if(info->thing()->thingClassId() == applicationThingClassId) {
+    if(thing->thingClassId() == applicationThingClassId) {
+        CommandRunner::Limits limits;
+        limits.memoryLimit = thing->paramValue(applicationThingMemoryLimitParamTypeId).toInt();
+        limits.cpuTimeLimit = thing->paramValue(applicationThingCpuTimeLimitParamTypeId).toInt();
+        limits.cgroup = thing->paramValue(applicationThingCgroupParamTypeId).toString();
+
+        CommandRunner *runner = new CommandRunner(thing->paramValue(applicationThingPersistentShellParamTypeId).toBool(),
+                                                  thing->paramValue(applicationThingMaxCommandsParamTypeId).toInt(),
+                                                  limits, this);
+        connect(runner, &CommandRunner::runningChanged, thing, [thing](bool running){
+            thing->setStateValue(applicationRunningStateTypeId, running);
+        });
+        connect(runner, &CommandRunner::commandFinished, thing, [this, thing](const CommandRunner::Result &result){
+            emitFinishedEvent(thing, result);
+        });
+        m_runners.insert(thing, runner);
+
         info->finish(Thing::ThingErrorNoError);
         return;
     }
 
     // Script
-    if(info->thing()->thingClassId() == scriptThingClassId){
-        QStringList scriptArguments = info->thing()->paramValue(scriptThingScriptParamTypeId).toString().split(QRegExp("[ \r\n][ \r\n]*"));
+    if(thing->thingClassId() == scriptThingClassId){
+        QStringList scriptArguments = thing->paramValue(scriptThingScriptParamTypeId).toString().split(QRegExp("[ \r\n][ \r\n]*"));
         // check if script exists and if it is executable
         QFileInfo fileInfo(scriptArguments.first());
         if (!fileInfo.exists()) {
@@ -72,6 +90,21 @@ void IntegrattionPluginCommandLauncher::setupThing(ThingSetupInfo *info)
             return;
         }
 
+        CommandRunner::Limits limits;
+        limits.memoryLimit = thing->paramValue(scriptThingMemoryLimitParamTypeId).toInt();
+        limits.cpuTimeLimit = thing->paramValue(scriptThingCpuTimeLimitParamTypeId).toInt();
+        limits.cgroup = thing->paramValue(scriptThingCgroupParamTypeId).toString();
+
+        // Scripts are started by a fresh bash anyways, a worker shell would not save anything
+        CommandRunner *runner = new CommandRunner(false, thing->paramValue(scriptThingMaxCommandsParamTypeId).toInt(), limits, this);
+        connect(runner, &CommandRunner::runningChanged, thing, [thing](bool running){
+            thing->setStateValue(scriptRunningStateTypeId, running);
+        });
+        connect(runner, &CommandRunner::commandFinished, thing, [this, thing](const CommandRunner::Result &result){
+            emitFinishedEvent(thing, result);
+        });
+        m_runners.insert(thing, runner);
+
         info->finish(Thing::ThingErrorNoError);
         return;
     }
@@ -87,155 +120,28 @@ void IntegrattionPluginCommandLauncher::executeAction(ThingActionInfo *info)
     if (thing->thingClassId() == applicationThingClassId ) {
         // execute application...
         if (info->action().actionTypeId() == applicationTriggerActionTypeId) {
-            // check if we already have started the application
-            if (m_applications.values().contains(thing)) {
-                if (m_applications.key(thing)->state() == QProcess::Running) {
-                    //: Error running the application
-                    info->finish(Thing::ThingErrorThingInUse, QT_TR_NOOP("This application is already running."));
-                    return;
-                }
-            }
-            QProcess *process = new QProcess(this);
-            connect(process, &QProcess::stateChanged, info, [info](QProcess::ProcessState newState){
-                switch (newState) {
-                case QProcess::Starting:
-                    qCDebug(dcCommandLauncher()) << "Application starting...";
-                    return;
-                case QProcess::Running:
-                    qCDebug(dcCommandLauncher()) << "Application started.";
-                    info->finish(Thing::ThingErrorNoError);
-                    return;
-                case QProcess::NotRunning:
-                    qCDebug(dcCommandLauncher()) << "Application failed to start.";
-                    //: Error running the application
-                    info->finish(Thing::ThingErrorHardwareFailure, QT_TR_NOOP("The application failed to start."));
-                    return;
-                }
-            });
-            connect(process, &QProcess::stateChanged, thing, [this, process, thing](QProcess::ProcessState newState){
-                switch (newState) {
-                case QProcess::Starting:
-                    return; // Nothing to do here
-                case QProcess::Running:
-                    thing->setStateValue(applicationRunningStateTypeId, true);
-                    return;
-                case QProcess::NotRunning:
-                    thing->setStateValue(applicationRunningStateTypeId, false);
-                    m_applications.remove(process);
-                    process->deleteLater();
-                    return;
-                }
-            });
-
-            m_applications.insert(process, thing);
-            process->start("/bin/bash", QStringList() << "-c" << thing->paramValue(applicationThingCommandParamTypeId).toString());
+            runCommand(info, thing->paramValue(applicationThingCommandParamTypeId).toString());
             return;
         }
         // kill application...
         if (info->action().actionTypeId() == applicationKillActionTypeId) {
-            // check if the application is running...
-            QProcess *process = m_applications.key(info->thing());
-
-            if (!process || process->state() == QProcess::NotRunning) {
-                info->finish(Thing::ThingErrorNoError);
-                return;
-            }
-
-            connect(process, &QProcess::stateChanged, info, [info](QProcess::ProcessState newState){
-                switch (newState) {
-                case QProcess::Starting:
-                case QProcess::Running:
-                    qCWarning(dcCommandLauncher()) << "The applicaton has started while it should be stopping.";
-                    //: Error stopping the application
-                    info->finish(Thing::ThingErrorHardwareFailure, QT_TR_NOOP("An unexpected error happened."));
-                    return;
-                case QProcess::NotRunning:
-                    qCDebug(dcCommandLauncher()) << "Application stopped.";
-                    info->finish(Thing::ThingErrorNoError);
-                    return;
-                }
-            });
-
-            process->kill();
+            killCommands(info);
             return;
         }
         info->finish(Thing::ThingErrorActionTypeNotFound);
+        return;
     }
 
     // Script
-    if (info->thing()->thingClassId() == scriptThingClassId ) {
+    if (thing->thingClassId() == scriptThingClassId ) {
         // execute script...
         if (info->action().actionTypeId() == scriptTriggerActionTypeId) {
-            // check if we already have started the script
-            if (m_scripts.values().contains(info->thing())) {
-                if (m_scripts.key(info->thing())->state() == QProcess::Running) {
-                    //: Error running the script
-                    info->finish(Thing::ThingErrorThingInUse, QT_TR_NOOP("This script is already running."));
-                    return;
-                }
-            }
-            QProcess *process = new QProcess(this);
-
-            connect(process, &QProcess::stateChanged, info, [info](QProcess::ProcessState newState){
-                switch (newState) {
-                case QProcess::Starting:
-                    qCDebug(dcCommandLauncher()) << "Script starting...";
-                    return;
-                case QProcess::Running:
-                    qCDebug(dcCommandLauncher()) << "Script started.";
-                    info->finish(Thing::ThingErrorNoError);
-                    return;
-                case QProcess::NotRunning:
-                    qCDebug(dcCommandLauncher()) << "Script failed to start.";
-                    //: Error running the script
-                    info->finish(Thing::ThingErrorHardwareFailure, QT_TR_NOOP("The script failed to start."));
-                    return;
-                }
-            });
-            connect(process, &QProcess::stateChanged, thing, [this, process, thing](QProcess::ProcessState newState){
-                switch (newState) {
-                case QProcess::Starting:
-                    return; // Nothing to do here
-                case QProcess::Running:
-                    thing->setStateValue(applicationRunningStateTypeId, true);
-                    return;
-                case QProcess::NotRunning:
-                    thing->setStateValue(applicationRunningStateTypeId, false);
-                    m_scripts.remove(process);
-                    process->deleteLater();
-                    return;
-                }
-            });
-
-            m_scripts.insert(process, info->thing());
-            process->start("/bin/bash", QStringList() << info->thing()->paramValue(scriptThingScriptParamTypeId).toString());
+            runCommand(info, "/bin/bash " + thing->paramValue(scriptThingScriptParamTypeId).toString());
             return;
         }
         // kill script...
         if (info->action().actionTypeId() == scriptKillActionTypeId) {
-            // check if the script is running...
-            QProcess *process = m_scripts.key(info->thing());
-            if (!process || process->state() == QProcess::NotRunning) {
-                info->finish(Thing::ThingErrorNoError);
-                return;
-            }
-
-            connect(process, &QProcess::stateChanged, info, [info](QProcess::ProcessState newState){
-                switch (newState) {
-                case QProcess::Starting:
-                case QProcess::Running:
-                    qCWarning(dcCommandLauncher()) << "The script has started while it should be stopping.";
-                    //: Error stopping the script
-                    info->finish(Thing::ThingErrorHardwareFailure, QT_TR_NOOP("An unexpected error happened."));
-                    return;
-                case QProcess::NotRunning:
-                    qCDebug(dcCommandLauncher()) << "Script stopped.";
-                    info->finish(Thing::ThingErrorNoError);
-                    return;
-                }
-            });
-
-            process->kill();
+            killCommands(info);
             return;
         }
 
@@ -247,20 +153,92 @@ void IntegrattionPluginCommandLauncher::executeAction(ThingActionInfo *info)
 
 void IntegrattionPluginCommandLauncher::thingRemoved(Thing *thing)
 {
-    if (m_applications.values().contains(thing)) {
-        QProcess * process = m_applications.key(thing);
-        if (process->state() != QProcess::NotRunning) {
-            process->kill();
+    if (m_runners.contains(thing)) {
+        CommandRunner *runner = m_runners.take(thing);
+        runner->killAll();
+        runner->deleteLater();
+    }
+}
+
+void IntegrattionPluginCommandLauncher::runCommand(ThingActionInfo *info, const QString &command)
+{
+    Thing *thing = info->thing();
+    CommandRunner *runner = m_runners.value(thing);
+    bool application = thing->thingClassId() == applicationThingClassId;
+
+    QUuid commandId = runner->run(command);
+    if (commandId.isNull()) {
+        if (application) {
+            //: Error running the application
+            info->finish(Thing::ThingErrorThingInUse, QT_TR_NOOP("This application is already running."));
+        } else {
+            //: Error running the script
+            info->finish(Thing::ThingErrorThingInUse, QT_TR_NOOP("This script is already running."));
+        }
+        return;
+    }
+
+    connect(runner, &CommandRunner::commandStarted, info, [info, commandId, application](const QUuid &startedCommandId){
+        if (startedCommandId != commandId) {
+            return;
+        }
+        qCDebug(dcCommandLauncher()) << (application ? "Application started." : "Script started.");
+        info->finish(Thing::ThingErrorNoError);
+    });
+    connect(runner, &CommandRunner::commandFinished, info, [info, commandId, application](const CommandRunner::Result &result){
+        if (result.commandId != commandId || result.started) {
+            return;
+        }
+        if (application) {
+            qCDebug(dcCommandLauncher()) << "Application failed to start.";
+            //: Error running the application
+            info->finish(Thing::ThingErrorHardwareFailure, QT_TR_NOOP("The application failed to start."));
+        } else {
+            qCDebug(dcCommandLauncher()) << "Script failed to start.";
+            //: Error running the script
+            info->finish(Thing::ThingErrorHardwareFailure, QT_TR_NOOP("The script failed to start."));
         }
-        m_applications.remove(process);
-        process->deleteLater();
+    });
+}
+
+void IntegrattionPluginCommandLauncher::killCommands(ThingActionInfo *info)
+{
+    CommandRunner *runner = m_runners.value(info->thing());
+    if (!runner->running()) {
+        info->finish(Thing::ThingErrorNoError);
+        return;
     }
-    if (m_scripts.values().contains(thing)) {
-        QProcess * process = m_scripts.key(thing);
-        if (process->state() != QProcess::NotRunning) {
-            process->kill();
+
+    connect(runner, &CommandRunner::runningChanged, info, [info](bool running){
+        if (!running) {
+            qCDebug(dcCommandLauncher()) << "Stopped" << info->thing()->name();
+            info->finish(Thing::ThingErrorNoError);
         }
-        m_scripts.remove(process);
-        process->deleteLater();
+    });
+
+    runner->killAll();
+}
+
+void IntegrattionPluginCommandLauncher::emitFinishedEvent(Thing *thing, const CommandRunner::Result &result)
+{
+    if (!result.started) {
+        return;
+    }
+
+    ParamList params;
+    if (thing->thingClassId() == applicationThingClassId) {
+        params << Param(applicationFinishedEventExitCodeParamTypeId, result.exitCode);
+        params << Param(applicationFinishedEventStandardOutputParamTypeId, result.standardOutput);
+        params << Param(applicationFinishedEventStandardErrorParamTypeId, result.standardError);
+        params << Param(applicationFinishedEventDurationParamTypeId, result.duration);
+        params << Param(applicationFinishedEventQueueTimeParamTypeId, result.queueTime);
+        emitEvent(Event(applicationFinishedEventTypeId, thing->id(), params));
+    } else {
+        params << Param(scriptFinishedEventExitCodeParamTypeId, result.exitCode);
+        params << Param(scriptFinishedEventStandardOutputParamTypeId, result.standardOutput);
+        params << Param(scriptFinishedEventStandardErrorParamTypeId, result.standardError);
+        params << Param(scriptFinishedEventDurationParamTypeId, result.duration);
+        params << Param(scriptFinishedEventQueueTimeParamTypeId, result.queueTime);
+        emitEvent(Event(scriptFinishedEventTypeId, thing->id(), params));
     }
 }
@@ -33,7 +33,8 @@
 
 #include "integrations/integrationplugin.h"
 
-#include <QProcess>
+#include "commandrunner.h"
+
 #include <QFileInfo>
 
 class IntegrattionPluginCommandLauncher : public IntegrationPlugin
@@ -52,8 +53,11 @@ public:
     void thingRemoved(Thing *thing) override;
 
 private:
-    QHash<QProcess*,Thing*> m_scripts;
-    QHash<QProcess*,Thing*> m_applications;
+    QHash<Thing *, CommandRunner *> m_runners;
+
+    void runCommand(ThingActionInfo *info, const QString &command);
+    void killCommands(ThingActionInfo *info);
+    void emitFinishedEvent(Thing *thing, const CommandRunner::Result &result);
 };
 
 #endif // INTEGRATIONPLUGINCOMMANDLAUNCHER_H
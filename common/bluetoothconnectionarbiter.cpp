@@ -0,0 +1,472 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+*
+* Copyright 2013 - 2020, nymea GmbH
+* Contact: contact@nymea.io
+*
+* This file is part of nymea.
+* This project including source code and documentation is protected by
+* copyright law, and remains the property of nymea GmbH. All rights, including
+* reproduction, publication, editing and translation, are reserved. The use of
+* this project is subject to the terms of a license agreement to be concluded
+* with nymea GmbH in accordance with the terms of use of nymea GmbH, available
+* under https://nymea.io/license
+*
+* GNU Lesser General Public License Usage
+* Alternatively, this project may be redistributed and/or modified under the
+* terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; version 3. This project is distributed in the hope that
+* it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+* warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this project. If not, see <https://www.gnu.org/licenses/>.
+*
+* For any further details and any questions please contact us under
+* contact@nymea.io or see our FAQ/Licensing Information on
+* https://nymea.io/license/faq
+*
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "bluetoothconnectionarbiter.h"
+
+#include <QCoreApplication>
+#include <QDynamicPropertyChangeEvent>
+#include <QLoggingCategory>
+
+namespace {
+Q_LOGGING_CATEGORY(dcBluetoothConnectionArbiter, "BluetoothConnectionArbiter")
+}
+
+// The plugins are separate libraries, so the lock shared between them is a plain
+// QObject on the application which is only accessed through dynamic properties.
+static const char *lockObjectName = "BluetoothConnectionArbiterLock";
+static const char *ownerProperty = "owner";
+static const char *connectionsProperty = "connections";
+static const char *budgetProperty = "budget";
+static const char *evictionProperty = "evictionRequester";
+
+static const int defaultConnectionBudget = 5;
+static const int connectTimeout = 20000;
+
+BluetoothConnectionArbiter::BluetoothConnectionArbiter(QObject *parent) :
+    QObject(parent)
+{
+    m_clock.start();
+
+    m_connectTimeout.setSingleShot(true);
+    m_connectTimeout.setInterval(connectTimeout);
+    connect(&m_connectTimeout, &QTimer::timeout, this, &BluetoothConnectionArbiter::onConnectTimeout);
+
+    m_idleTimer.setSingleShot(true);
+    connect(&m_idleTimer, &QTimer::timeout, this, &BluetoothConnectionArbiter::checkIdleDevices);
+
+    QObject *application = QCoreApplication::instance();
+    if (application) {
+        m_lock = application->findChild<QObject *>(lockObjectName, Qt::FindDirectChildrenOnly);
+    }
+
+    if (!m_lock) {
+        m_lock = new QObject(application ? application : this);
+        m_lock->setObjectName(lockObjectName);
+        m_lock->setProperty(connectionsProperty, 0);
+        m_lock->setProperty(budgetProperty, defaultConnectionBudget);
+    }
+
+    m_lock->installEventFilter(this);
+}
+
+BluetoothConnectionArbiter::~BluetoothConnectionArbiter()
+{
+    if (!m_lock)
+        return;
+
+    m_lock->removeEventFilter(this);
+    if (m_lock->property(evictionProperty).value<QObject *>() == this) {
+        m_lock->setProperty(evictionProperty, QVariant::fromValue<QObject *>(nullptr));
+    }
+
+    int counted = 0;
+    foreach (const DeviceEntry &entry, m_devices) {
+        if (entry.counted) {
+            counted++;
+        }
+    }
+
+    // Make sure other plugins are not blocked by a lock or connections of this arbiter
+    if (m_connectingDevice) {
+        releaseLock();
+    }
+    if (counted > 0) {
+        changeGlobalConnections(-counted);
+    }
+}
+
+void BluetoothConnectionArbiter::registerDevice(BluetoothLowEnergyDevice *device, bool keepConnected)
+{
+    if (m_devices.contains(device))
+        return;
+
+    DeviceEntry entry;
+    entry.keepConnected = keepConnected;
+    entry.counted = !keepConnected && device->connected();
+    if (entry.counted) {
+        changeGlobalConnections(1);
+    }
+    m_devices.insert(device, entry);
+
+    connect(device, &BluetoothLowEnergyDevice::connectedChanged, this, &BluetoothConnectionArbiter::onConnectedChanged);
+}
+
+void BluetoothConnectionArbiter::unregisterDevice(BluetoothLowEnergyDevice *device)
+{
+    if (!m_devices.contains(device))
+        return;
+
+    disconnect(device, &BluetoothLowEnergyDevice::connectedChanged, this, &BluetoothConnectionArbiter::onConnectedChanged);
+    DeviceEntry entry = m_devices.take(device);
+    if (entry.counted) {
+        changeGlobalConnections(-1);
+    }
+
+    if (m_connectingDevice == device) {
+        m_connectTimeout.stop();
+        m_connectingDevice = nullptr;
+        releaseLock();
+    }
+
+    scheduleProcessQueue();
+}
+
+void BluetoothConnectionArbiter::requestConnection(BluetoothLowEnergyDevice *device, Priority priority)
+{
+    if (!m_devices.contains(device)) {
+        qCWarning(dcBluetoothConnectionArbiter()) << "Connection requested for unregistered device" << device->address().toString();
+        return;
+    }
+
+    DeviceEntry &entry = m_devices[device];
+    entry.inUse = true;
+    entry.lastUsed = m_clock.elapsed();
+
+    if (device->connected() || m_connectingDevice == device)
+        return;
+
+    if (entry.pendingPriority < 0) {
+        entry.requestTime = m_clock.elapsed();
+    }
+    entry.pendingPriority = qMax(entry.pendingPriority, static_cast<int>(priority));
+    scheduleProcessQueue();
+}
+
+void BluetoothConnectionArbiter::releaseConnection(BluetoothLowEnergyDevice *device)
+{
+    if (!m_devices.contains(device))
+        return;
+
+    DeviceEntry &entry = m_devices[device];
+    entry.inUse = false;
+    entry.pendingPriority = -1;
+    entry.lastUsed = m_clock.elapsed();
+
+    if (entry.keepConnected || !device->connected())
+        return;
+
+    if (m_idleTimeout <= 0) {
+        device->disconnectDevice();
+        return;
+    }
+
+    if (!m_idleTimer.isActive()) {
+        m_idleTimer.start(m_idleTimeout);
+    }
+}
+
+int BluetoothConnectionArbiter::connectionBudget() const
+{
+    return m_lock ? m_lock->property(budgetProperty).toInt() : defaultConnectionBudget;
+}
+
+void BluetoothConnectionArbiter::setConnectionBudget(int connectionBudget)
+{
+    Q_ASSERT_X(connectionBudget > 0, "value out of range", "The connection budget must be bigger than 0");
+    if (m_lock) {
+        m_lock->setProperty(budgetProperty, connectionBudget);
+    }
+}
+
+int BluetoothConnectionArbiter::idleTimeout() const
+{
+    return m_idleTimeout;
+}
+
+void BluetoothConnectionArbiter::setIdleTimeout(int idleTimeout)
+{
+    m_idleTimeout = idleTimeout;
+}
+
+int BluetoothConnectionArbiter::connectionAttempts(BluetoothLowEnergyDevice *device) const
+{
+    return m_devices.value(device).attempts;
+}
+
+int BluetoothConnectionArbiter::connectionFailures(BluetoothLowEnergyDevice *device) const
+{
+    return m_devices.value(device).failures;
+}
+
+int BluetoothConnectionArbiter::lastConnectionLatency(BluetoothLowEnergyDevice *device) const
+{
+    return m_devices.value(device).lastLatency;
+}
+
+int BluetoothConnectionArbiter::averageConnectionLatency(BluetoothLowEnergyDevice *device) const
+{
+    DeviceEntry entry = m_devices.value(device);
+    if (entry.successes == 0)
+        return -1;
+
+    return static_cast<int>(entry.totalLatency / entry.successes);
+}
+
+bool BluetoothConnectionArbiter::eventFilter(QObject *watched, QEvent *event)
+{
+    if (watched == m_lock && event->type() == QEvent::DynamicPropertyChange) {
+        QByteArray propertyName = static_cast<QDynamicPropertyChangeEvent *>(event)->propertyName();
+        if (propertyName == ownerProperty || propertyName == connectionsProperty || propertyName == budgetProperty) {
+            scheduleProcessQueue();
+        } else if (propertyName == evictionProperty) {
+            // Another plugin is waiting for a connection, the first arbiter able to free one up takes the request
+            QObject *requester = m_lock->property(evictionProperty).value<QObject *>();
+            if (requester && requester != this && evictIdleDevice()) {
+                m_lock->setProperty(evictionProperty, QVariant::fromValue<QObject *>(nullptr));
+            }
+        }
+    }
+    return QObject::eventFilter(watched, event);
+}
+
+void BluetoothConnectionArbiter::onConnectedChanged(bool connected)
+{
+    BluetoothLowEnergyDevice *device = static_cast<BluetoothLowEnergyDevice *>(sender());
+    if (!m_devices.contains(device))
+        return;
+
+    // Permanent connections are not part of the budget, they could never be freed up
+    DeviceEntry &entry = m_devices[device];
+    bool counted = connected && !entry.keepConnected;
+    if (counted != entry.counted) {
+        entry.counted = counted;
+        changeGlobalConnections(counted ? 1 : -1);
+    }
+
+    if (connected) {
+        entry.lastUsed = m_clock.elapsed();
+        entry.pendingPriority = -1;
+    }
+
+    if (device == m_connectingDevice) {
+        finishAttempt(connected);
+    }
+
+    // Devices which are not used any more and got connected by someone else are treated as idle
+    if (connected && !entry.inUse && !entry.keepConnected && !m_idleTimer.isActive()) {
+        m_idleTimer.start(qMax(m_idleTimeout, 0));
+    }
+}
+
+void BluetoothConnectionArbiter::onConnectTimeout()
+{
+    if (!m_connectingDevice)
+        return;
+
+    BluetoothLowEnergyDevice *device = m_connectingDevice;
+    qCDebug(dcBluetoothConnectionArbiter()) << "Connecting to" << device->address().toString() << "timed out";
+    finishAttempt(false);
+    device->disconnectDevice();
+}
+
+void BluetoothConnectionArbiter::checkIdleDevices()
+{
+    qint64 now = m_clock.elapsed();
+    qint64 nextCheck = -1;
+
+    foreach (BluetoothLowEnergyDevice *device, m_devices.keys()) {
+        const DeviceEntry &entry = m_devices[device];
+        if (entry.keepConnected || entry.inUse || !device->connected())
+            continue;
+
+        qint64 idleTime = now - entry.lastUsed;
+        if (idleTime >= m_idleTimeout) {
+            qCDebug(dcBluetoothConnectionArbiter()) << "Disconnecting idle device" << device->address().toString();
+            device->disconnectDevice();
+        } else if (nextCheck < 0 || m_idleTimeout - idleTime < nextCheck) {
+            nextCheck = m_idleTimeout - idleTime;
+        }
+    }
+
+    if (nextCheck >= 0) {
+        m_idleTimer.start(static_cast<int>(nextCheck));
+    }
+}
+
+void BluetoothConnectionArbiter::processQueue()
+{
+    m_processScheduled = false;
+
+    if (m_connectingDevice)
+        return;
+
+    // Highest priority first, oldest request first within the same priority
+    BluetoothLowEnergyDevice *nextDevice = nullptr;
+    foreach (BluetoothLowEnergyDevice *device, m_devices.keys()) {
+        const DeviceEntry &entry = m_devices[device];
+        if (entry.pendingPriority < 0)
+            continue;
+
+        if (!nextDevice) {
+            nextDevice = device;
+            continue;
+        }
+
+        const DeviceEntry &nextEntry = m_devices[nextDevice];
+        if (entry.pendingPriority > nextEntry.pendingPriority || (entry.pendingPriority == nextEntry.pendingPriority && entry.requestTime < nextEntry.requestTime)) {
+            nextDevice = device;
+        }
+    }
+
+    if (!nextDevice)
+        return;
+
+    if (globalConnections() >= connectionBudget()) {
+        // A disconnected idle device changes the connection count which triggers the queue again
+        if (!evictIdleDevice()) {
+            requestEviction();
+            qCDebug(dcBluetoothConnectionArbiter()) << "Connection budget of" << connectionBudget() << "exhausted. Waiting before connecting to" << nextDevice->address().toString();
+        }
+        return;
+    }
+
+    // Another device is connecting right now, the lock release triggers the queue again
+    if (!acquireLock())
+        return;
+
+    DeviceEntry &entry = m_devices[nextDevice];
+    entry.pendingPriority = -1;
+    entry.attempts++;
+
+    m_connectingDevice = nextDevice;
+    m_connectStarted = m_clock.elapsed();
+    m_connectTimeout.start();
+
+    qCDebug(dcBluetoothConnectionArbiter()) << "Connecting to" << nextDevice->address().toString();
+    nextDevice->connectDevice();
+}
+
+bool BluetoothConnectionArbiter::acquireLock()
+{
+    if (!m_lock)
+        return false;
+
+    QObject *owner = m_lock->property(ownerProperty).value<QObject *>();
+    if (owner && owner != this)
+        return false;
+
+    m_lock->setProperty(ownerProperty, QVariant::fromValue<QObject *>(this));
+    return true;
+}
+
+void BluetoothConnectionArbiter::releaseLock()
+{
+    if (!m_lock || m_lock->property(ownerProperty).value<QObject *>() != this)
+        return;
+
+    m_lock->setProperty(ownerProperty, QVariant::fromValue<QObject *>(nullptr));
+}
+
+int BluetoothConnectionArbiter::globalConnections() const
+{
+    return m_lock ? m_lock->property(connectionsProperty).toInt() : 0;
+}
+
+void BluetoothConnectionArbiter::changeGlobalConnections(int delta)
+{
+    if (m_lock) {
+        m_lock->setProperty(connectionsProperty, qMax(0, globalConnections() + delta));
+    }
+}
+
+void BluetoothConnectionArbiter::scheduleProcessQueue()
+{
+    if (m_processScheduled)
+        return;
+
+    m_processScheduled = true;
+
+    // Arbiters with pending user actions get the chance to take the lock before those with polls only
+    bool userActionPending = false;
+    foreach (const DeviceEntry &entry, m_devices) {
+        if (entry.pendingPriority == PriorityUserAction) {
+            userActionPending = true;
+            break;
+        }
+    }
+    QTimer::singleShot(userActionPending ? 0 : 100, this, &BluetoothConnectionArbiter::processQueue);
+}
+
+bool BluetoothConnectionArbiter::evictIdleDevice()
+{
+    // Disconnect the least recently used device nobody needs right now
+    BluetoothLowEnergyDevice *idleDevice = nullptr;
+    foreach (BluetoothLowEnergyDevice *device, m_devices.keys()) {
+        const DeviceEntry &entry = m_devices[device];
+        if (entry.keepConnected || entry.inUse || !device->connected())
+            continue;
+
+        if (!idleDevice || entry.lastUsed < m_devices[idleDevice].lastUsed) {
+            idleDevice = device;
+        }
+    }
+
+    if (!idleDevice)
+        return false;
+
+    qCDebug(dcBluetoothConnectionArbiter()) << "Disconnecting idle device" << idleDevice->address().toString() << "to stay within the connection budget";
+    idleDevice->disconnectDevice();
+    return true;
+}
+
+void BluetoothConnectionArbiter::requestEviction()
+{
+    // The budget is shared, so the idle devices of other plugins count as well
+    if (!m_lock)
+        return;
+
+    // Repeat a request nobody could serve before, devices may have become idle since then
+    if (m_lock->property(evictionProperty).value<QObject *>() == this) {
+        m_lock->setProperty(evictionProperty, QVariant::fromValue<QObject *>(nullptr));
+    }
+    m_lock->setProperty(evictionProperty, QVariant::fromValue<QObject *>(this));
+}
+
+void BluetoothConnectionArbiter::finishAttempt(bool success)
+{
+    BluetoothLowEnergyDevice *device = m_connectingDevice;
+    m_connectingDevice = nullptr;
+    m_connectTimeout.stop();
+
+    DeviceEntry &entry = m_devices[device];
+    if (success) {
+        entry.lastLatency = static_cast<int>(m_clock.elapsed() - m_connectStarted);
+        entry.totalLatency += entry.lastLatency;
+        entry.successes++;
+        qCDebug(dcBluetoothConnectionArbiter()) << "Connected to" << device->address().toString() << "in" << entry.lastLatency << "ms" << "Attempts:" << entry.attempts << "Failures:" << entry.failures;
+    } else {
+        entry.failures++;
+        qCDebug(dcBluetoothConnectionArbiter()) << "Failed to connect to" << device->address().toString() << "Attempts:" << entry.attempts << "Failures:" << entry.failures;
+    }
+
+    releaseLock();
+    emit connectionStatisticsChanged(device);
+    scheduleProcessQueue();
+}
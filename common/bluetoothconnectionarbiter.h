@@ -0,0 +1,134 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+*
+* Copyright 2013 - 2020, nymea GmbH
+* Contact: contact@nymea.io
+*
+* This file is part of nymea.
+* This project including source code and documentation is protected by
+* copyright law, and remains the property of nymea GmbH. All rights, including
+* reproduction, publication, editing and translation, are reserved. The use of
+* this project is subject to the terms of a license agreement to be concluded
+* with nymea GmbH in accordance with the terms of use of nymea GmbH, available
+* under https://nymea.io/license
+*
+* GNU Lesser General Public License Usage
+* Alternatively, this project may be redistributed and/or modified under the
+* terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; version 3. This project is distributed in the hope that
+* it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+* warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this project. If not, see <https://www.gnu.org/licenses/>.
+*
+* For any further details and any questions please contact us under
+* contact@nymea.io or see our FAQ/Licensing Information on
+* https://nymea.io/license/faq
+*
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef BLUETOOTHCONNECTIONARBITER_H
+#define BLUETOOTHCONNECTIONARBITER_H
+
+#include <QObject>
+#include <QHash>
+#include <QTimer>
+#include <QPointer>
+#include <QElapsedTimer>
+
+#include "hardware/bluetoothlowenergy/bluetoothlowenergydevice.h"
+
+// Serializes connection attempts to Bluetooth LE devices. The arbiters of all plugins
+// within the process share one lock and one connection budget, so only one device is
+// connecting on the adapter at any time and user actions are served before polls.
+// Only connections are arbitrated, reads and writes are not queued here. Plugins send
+// the commands waiting in their own queue once the requested connection is up.
+class BluetoothConnectionArbiter : public QObject
+{
+    Q_OBJECT
+public:
+    enum Priority {
+        PriorityPoll,
+        PriorityNormal,
+        PriorityUserAction
+    };
+    Q_ENUM(Priority)
+
+    explicit BluetoothConnectionArbiter(QObject *parent = nullptr);
+    ~BluetoothConnectionArbiter() override;
+
+    // Devices which keep their connection are never disconnected by the arbiter and
+    // don't count against the connection budget
+    void registerDevice(BluetoothLowEnergyDevice *device, bool keepConnected = false);
+    void unregisterDevice(BluetoothLowEnergyDevice *device);
+
+    // Requests for a device which is connected or connecting are served by the same connection
+    void requestConnection(BluetoothLowEnergyDevice *device, Priority priority = PriorityNormal);
+    void releaseConnection(BluetoothLowEnergyDevice *device);
+
+    // Maximum number of simultaneous on demand connections of all plugins, the last value set wins
+    int connectionBudget() const;
+    void setConnectionBudget(int connectionBudget);
+
+    // Released devices stay connected for this time [ms] in case they are needed again
+    int idleTimeout() const;
+    void setIdleTimeout(int idleTimeout);
+
+    // Statistics
+    int connectionAttempts(BluetoothLowEnergyDevice *device) const;
+    int connectionFailures(BluetoothLowEnergyDevice *device) const;
+    int lastConnectionLatency(BluetoothLowEnergyDevice *device) const;
+    int averageConnectionLatency(BluetoothLowEnergyDevice *device) const;
+
+signals:
+    void connectionStatisticsChanged(BluetoothLowEnergyDevice *device);
+
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) override;
+
+private slots:
+    void onConnectedChanged(bool connected);
+    void onConnectTimeout();
+    void checkIdleDevices();
+    void processQueue();
+
+private:
+    struct DeviceEntry {
+        bool keepConnected = false;
+        bool inUse = false;
+        int pendingPriority = -1;
+        qint64 requestTime = 0;
+        qint64 lastUsed = 0;
+        bool counted = false;
+
+        int attempts = 0;
+        int failures = 0;
+        int successes = 0;
+        int lastLatency = -1;
+        qint64 totalLatency = 0;
+    };
+
+    QHash<BluetoothLowEnergyDevice *, DeviceEntry> m_devices;
+    BluetoothLowEnergyDevice *m_connectingDevice = nullptr;
+    QElapsedTimer m_clock;
+    qint64 m_connectStarted = 0;
+    QTimer m_connectTimeout;
+    QTimer m_idleTimer;
+    int m_idleTimeout = 30000;
+    bool m_processScheduled = false;
+
+    QPointer<QObject> m_lock;
+
+    bool acquireLock();
+    void releaseLock();
+    int globalConnections() const;
+    void changeGlobalConnections(int delta);
+
+    void scheduleProcessQueue();
+    bool evictIdleDevice();
+    void requestEviction();
+    void finishAttempt(bool success);
+};
+
+#endif // BLUETOOTHCONNECTIONARBITER_H
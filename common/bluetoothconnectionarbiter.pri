@@ -0,0 +1,9 @@
+# Shared GATT connection scheduling for Bluetooth LE plugins
+
+INCLUDEPATH += $$PWD
+
+SOURCES += \
+    $$PWD/bluetoothconnectionarbiter.cpp
+
+HEADERS += \
+    $$PWD/bluetoothconnectionarbiter.h
@@ -0,0 +1,270 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+*
+* Copyright 2013 - 2020, nymea GmbH
+* Contact: contact@nymea.io
+*
+* This file is part of nymea.
+* This project including source code and documentation is protected by
+* copyright law, and remains the property of nymea GmbH. All rights, including
+* reproduction, publication, editing and translation, are reserved. The use of
+* this project is subject to the terms of a license agreement to be concluded
+* with nymea GmbH in accordance with the terms of use of nymea GmbH, available
+* under https://nymea.io/license
+*
+* GNU Lesser General Public License Usage
+* Alternatively, this project may be redistributed and/or modified under the
+* terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; version 3. This project is distributed in the hope that
+* it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+* warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this project. If not, see <https://www.gnu.org/licenses/>.
+*
+* For any further details and any questions please contact us under
+* contact@nymea.io or see our FAQ/Licensing Information on
+* https://nymea.io/license/faq
+*
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "httprequestparser.h"
+
+#include <QLoggingCategory>
+
+Q_LOGGING_CATEGORY(dcHttpRequestParser, "HttpRequestParser")
+
+#define MAX_HEADER_SIZE 16384
+#define MAX_BODY_SIZE 1048576
+
+bool HttpRequest::keepAlive() const
+{
+    QByteArray connection = headers.value("connection").toLower();
+    if (version == "HTTP/1.0") {
+        return connection == "keep-alive";
+    }
+    return connection != "close";
+}
+
+HttpRequestParser::HttpRequestParser()
+{
+
+}
+
+void HttpRequestParser::addData(const QByteArray &data)
+{
+    if (m_state == StateError) {
+        return;
+    }
+
+    m_buffer.append(data);
+
+    bool progress = true;
+    while (progress && m_state != StateError) {
+        progress = false;
+        QByteArray line;
+        switch (m_state) {
+        case StateRequestLine:
+            if (takeLine(&line)) {
+                progress = true;
+                // Ignore empty lines between pipelined requests (RFC 7230 3.5)
+                if (!line.isEmpty() && parseRequestLine(line)) {
+                    m_state = StateHeaders;
+                }
+            }
+            break;
+        case StateHeaders:
+            if (takeLine(&line)) {
+                progress = true;
+                if (line.isEmpty()) {
+                    headersComplete();
+                } else {
+                    parseHeaderLine(line);
+                }
+            }
+            break;
+        case StateBody:
+        case StateChunkData: {
+            int available = qMin<qint64>(m_buffer.size() - m_position, m_remaining);
+            if (available > 0) {
+                m_request.body.append(m_buffer.constData() + m_position, available);
+                m_position += available;
+                m_remaining -= available;
+                progress = true;
+            }
+            if (m_remaining == 0) {
+                progress = true;
+                if (m_state == StateBody) {
+                    requestComplete();
+                } else {
+                    m_state = StateChunkDataEnd;
+                }
+            }
+            break;
+        }
+        case StateChunkSize:
+            if (takeLine(&line)) {
+                progress = true;
+                // Drop chunk extensions
+                int extension = line.indexOf(';');
+                if (extension >= 0) {
+                    line.truncate(extension);
+                }
+                bool ok = false;
+                m_remaining = line.trimmed().toLongLong(&ok, 16);
+                if (!ok || m_remaining < 0) {
+                    setError(ErrorBadRequest);
+                } else if (m_request.body.size() + m_remaining > MAX_BODY_SIZE) {
+                    setError(ErrorBodyTooLarge);
+                } else {
+                    m_state = m_remaining == 0 ? StateChunkTrailer : StateChunkData;
+                }
+            }
+            break;
+        case StateChunkDataEnd:
+            if (takeLine(&line)) {
+                progress = true;
+                if (!line.isEmpty()) {
+                    setError(ErrorBadRequest);
+                } else {
+                    m_state = StateChunkSize;
+                }
+            }
+            break;
+        case StateChunkTrailer:
+            // Trailer fields are not of interest, just wait for the final empty line
+            if (takeLine(&line)) {
+                progress = true;
+                if (line.isEmpty()) {
+                    requestComplete();
+                }
+            }
+            break;
+        case StateError:
+            break;
+        }
+    }
+
+    // Drop consumed data
+    if (m_position > 0) {
+        m_buffer.remove(0, m_position);
+        m_position = 0;
+    }
+
+    if (m_state == StateRequestLine || m_state == StateHeaders) {
+        if (m_headerSize + m_buffer.size() > MAX_HEADER_SIZE) {
+            setError(ErrorHeaderTooLarge);
+        }
+    }
+}
+
+bool HttpRequestParser::hasRequest() const
+{
+    return !m_requests.isEmpty();
+}
+
+HttpRequest HttpRequestParser::takeRequest()
+{
+    return m_requests.takeFirst();
+}
+
+HttpRequestParser::Error HttpRequestParser::error() const
+{
+    return m_error;
+}
+
+bool HttpRequestParser::takeLine(QByteArray *line)
+{
+    int end = m_buffer.indexOf('\n', m_position);
+    if (end < 0) {
+        return false;
+    }
+    int length = end - m_position;
+    if (length > 0 && m_buffer.at(end - 1) == '\r') {
+        length--;
+    }
+    *line = m_buffer.mid(m_position, length);
+    if (m_state == StateRequestLine || m_state == StateHeaders) {
+        m_headerSize += end + 1 - m_position;
+    }
+    m_position = end + 1;
+    return true;
+}
+
+bool HttpRequestParser::parseRequestLine(const QByteArray &line)
+{
+    QList<QByteArray> tokens = line.split(' ');
+    if (tokens.count() != 3 || !tokens.at(2).startsWith("HTTP/")) {
+        qCDebug(dcHttpRequestParser()) << "Invalid HTTP request line" << line;
+        setError(ErrorBadRequest);
+        return false;
+    }
+    m_request = HttpRequest();
+    m_request.method = tokens.at(0);
+    m_request.path = tokens.at(1);
+    m_request.version = tokens.at(2);
+    return true;
+}
+
+bool HttpRequestParser::parseHeaderLine(const QByteArray &line)
+{
+    int separator = line.indexOf(':');
+    if (separator <= 0) {
+        qCDebug(dcHttpRequestParser()) << "Invalid HTTP header line" << line;
+        setError(ErrorBadRequest);
+        return false;
+    }
+    QByteArray name = line.left(separator).trimmed().toLower();
+    QByteArray value = line.mid(separator + 1).trimmed();
+    if (m_request.headers.contains(name)) {
+        // Combine repeated fields (RFC 7230 3.2.2)
+        value = m_request.headers.value(name) + ", " + value;
+    }
+    m_request.headers.insert(name, value);
+    return true;
+}
+
+void HttpRequestParser::headersComplete()
+{
+    m_headerSize = 0;
+
+    if (m_request.headers.value("transfer-encoding").toLower().contains("chunked")) {
+        m_state = StateChunkSize;
+        return;
+    }
+
+    if (m_request.headers.contains("content-length")) {
+        bool ok = false;
+        m_remaining = m_request.headers.value("content-length").toLongLong(&ok);
+        if (!ok || m_remaining < 0) {
+            setError(ErrorBadRequest);
+            return;
+        }
+        if (m_remaining > MAX_BODY_SIZE) {
+            setError(ErrorBodyTooLarge);
+            return;
+        }
+        m_request.body.reserve(m_remaining);
+        m_state = StateBody;
+        return;
+    }
+
+    // No body
+    requestComplete();
+}
+
+void HttpRequestParser::requestComplete()
+{
+    m_requests.append(m_request);
+    m_request = HttpRequest();
+    m_remaining = 0;
+    m_state = StateRequestLine;
+}
+
+void HttpRequestParser::setError(Error error)
+{
+    m_error = error;
+    m_state = StateError;
+    m_buffer.clear();
+    m_position = 0;
+}
@@ -0,0 +1,101 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+*
+* Copyright 2013 - 2020, nymea GmbH
+* Contact: contact@nymea.io
+*
+* This file is part of nymea.
+* This project including source code and documentation is protected by
+* copyright law, and remains the property of nymea GmbH. All rights, including
+* reproduction, publication, editing and translation, are reserved. The use of
+* this project is subject to the terms of a license agreement to be concluded
+* with nymea GmbH in accordance with the terms of use of nymea GmbH, available
+* under https://nymea.io/license
+*
+* GNU Lesser General Public License Usage
+* Alternatively, this project may be redistributed and/or modified under the
+* terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; version 3. This project is distributed in the hope that
+* it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+* warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this project. If not, see <https://www.gnu.org/licenses/>.
+*
+* For any further details and any questions please contact us under
+* contact@nymea.io or see our FAQ/Licensing Information on
+* https://nymea.io/license/faq
+*
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef HTTPREQUESTPARSER_H
+#define HTTPREQUESTPARSER_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+
+class HttpRequest
+{
+public:
+    QByteArray method;
+    QByteArray path;
+    QByteArray version;
+    // Header names are stored in lower case
+    QHash<QByteArray, QByteArray> headers;
+    QByteArray body;
+
+    bool keepAlive() const;
+};
+
+// Incremental HTTP/1.1 request parser. Data can be fed in arbitrary chunks
+// as it arrives on the socket, complete requests are queued in order.
+class HttpRequestParser
+{
+public:
+    enum Error {
+        ErrorNone,
+        ErrorBadRequest,
+        ErrorHeaderTooLarge,
+        ErrorBodyTooLarge
+    };
+
+    HttpRequestParser();
+
+    void addData(const QByteArray &data);
+
+    bool hasRequest() const;
+    HttpRequest takeRequest();
+
+    Error error() const;
+
+private:
+    enum State {
+        StateRequestLine,
+        StateHeaders,
+        StateBody,
+        StateChunkSize,
+        StateChunkData,
+        StateChunkDataEnd,
+        StateChunkTrailer,
+        StateError
+    };
+
+    bool takeLine(QByteArray *line);
+    bool parseRequestLine(const QByteArray &line);
+    bool parseHeaderLine(const QByteArray &line);
+    void headersComplete();
+    void requestComplete();
+    void setError(Error error);
+
+    State m_state = StateRequestLine;
+    Error m_error = ErrorNone;
+    QByteArray m_buffer;
+    int m_position = 0;
+    int m_headerSize = 0;
+    qint64 m_remaining = 0;
+    HttpRequest m_request;
+    QList<HttpRequest> m_requests;
+};
+
+#endif // HTTPREQUESTPARSER_H
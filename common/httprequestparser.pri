@@ -0,0 +1,9 @@
+# Incremental HTTP/1.1 request parser for plugins running a small HTTP server
+
+INCLUDEPATH += $$PWD
+
+SOURCES += \
+    $$PWD/httprequestparser.cpp
+
+HEADERS += \
+    $$PWD/httprequestparser.h
@@ -0,0 +1,125 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+*
+* Copyright 2013 - 2020, nymea GmbH
+* Contact: contact@nymea.io
+*
+* This file is part of nymea.
+* This project including source code and documentation is protected by
+* copyright law, and remains the property of nymea GmbH. All rights, including
+* reproduction, publication, editing and translation, are reserved. The use of
+* this project is subject to the terms of a license agreement to be concluded
+* with nymea GmbH in accordance with the terms of use of nymea GmbH, available
+* under https://nymea.io/license
+*
+* GNU Lesser General Public License Usage
+* Alternatively, this project may be redistributed and/or modified under the
+* terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; version 3. This project is distributed in the hope that
+* it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+* warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this project. If not, see <https://www.gnu.org/licenses/>.
+*
+* For any further details and any questions please contact us under
+* contact@nymea.io or see our FAQ/Licensing Information on
+* https://nymea.io/license/faq
+*
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+#include "upnpeventserver.h"
+
+#include <QLoggingCategory>
+#include <QNetworkInterface>
+
+Q_LOGGING_CATEGORY(dcUpnpEventServer, "UpnpEventServer")
+
+UpnpEventServer::UpnpEventServer(QObject *parent) :
+    QTcpServer(parent)
+{
+    // Any free port, it is announced to the devices with each subscription
+    if (!listen(QHostAddress::AnyIPv4, 0)) {
+        qCWarning(dcUpnpEventServer()) << "Could not start the event callback server:" << errorString();
+        return;
+    }
+    qCDebug(dcUpnpEventServer()) << "Event callback server listening on port" << serverPort();
+}
+
+UpnpEventServer::~UpnpEventServer()
+{
+    close();
+}
+
+QHostAddress UpnpEventServer::callbackAddress(const QHostAddress &deviceAddress) const
+{
+    // The address of the interface in the same network as the device
+    foreach (const QNetworkInterface &networkInterface, QNetworkInterface::allInterfaces()) {
+        if (!networkInterface.flags().testFlag(QNetworkInterface::IsUp) || networkInterface.flags().testFlag(QNetworkInterface::IsLoopBack))
+            continue;
+
+        foreach (const QNetworkAddressEntry &entry, networkInterface.addressEntries()) {
+            if (entry.ip().protocol() != QAbstractSocket::IPv4Protocol)
+                continue;
+
+            if (deviceAddress.isInSubnet(entry.ip(), entry.prefixLength())) {
+                return entry.ip();
+            }
+        }
+    }
+    return QHostAddress();
+}
+
+void UpnpEventServer::incomingConnection(qintptr socketDescriptor)
+{
+    QTcpSocket *socket = new QTcpSocket(this);
+    connect(socket, &QTcpSocket::readyRead, this, &UpnpEventServer::readClient);
+    connect(socket, &QTcpSocket::disconnected, this, &UpnpEventServer::discardClient);
+    socket->setSocketDescriptor(socketDescriptor);
+    m_clients.insert(socket, HttpRequestParser());
+}
+
+void UpnpEventServer::readClient()
+{
+    QTcpSocket *socket = static_cast<QTcpSocket *>(sender());
+    if (!m_clients.contains(socket))
+        return;
+
+    HttpRequestParser &parser = m_clients[socket];
+    parser.addData(socket->readAll());
+
+    while (parser.hasRequest()) {
+        HttpRequest request = parser.takeRequest();
+        if (request.method != "NOTIFY") {
+            socket->write(generateResponse(405, "Method Not Allowed"));
+            continue;
+        }
+
+        QByteArray sid = request.headers.value("sid");
+        if (sid.isEmpty() || request.headers.value("nts") != "upnp:propchange") {
+            socket->write(generateResponse(412, "Precondition Failed"));
+            continue;
+        }
+        socket->write(generateResponse(200, "OK"));
+        emit notificationReceived(request.path, sid, request.body);
+    }
+
+    if (parser.error() != HttpRequestParser::ErrorNone) {
+        socket->write(generateResponse(400, "Bad Request"));
+        socket->disconnectFromHost();
+    }
+}
+
+void UpnpEventServer::discardClient()
+{
+    QTcpSocket *socket = static_cast<QTcpSocket *>(sender());
+    m_clients.remove(socket);
+    socket->deleteLater();
+}
+
+QByteArray UpnpEventServer::generateResponse(int statusCode, const QByteArray &reason)
+{
+    QByteArray response = "HTTP/1.1 " + QByteArray::number(statusCode) + " " + reason + "\r\n";
+    response += "Content-Length: 0\r\n";
+    response += "\r\n";
+    return response;
+}
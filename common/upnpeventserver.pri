@@ -0,0 +1,9 @@
+# Callback server for UPnP GENA event subscriptions
+
+include($$PWD/httprequestparser.pri)
+
+SOURCES += \
+    $$PWD/upnpeventserver.cpp
+
+HEADERS += \
+    $$PWD/upnpeventserver.h
@@ -203,19 +203,56 @@ Alarm::TimeType Alarm::timeType() const
     return m_timeType;
 }
 
-QDateTime Alarm::getAlertTime() const
+QDateTime Alarm::nextAlarmTime(const QDateTime &after, const QTimeZone &timeZone) const
 {
-    return QDateTime(QDate::currentDate(), QTime(hours(), minutes())).addSecs(m_offset * 60);
+    QDateTime sunTime;
+    switch (m_timeType) {
+    case TimeTypeTime: {
+        // The offset may move the alarm to the previous or next day, the weekday
+        // always refers to the day the alarm goes off
+        QDate today = after.toTimeZone(timeZone).date();
+        for (int day = -1; day <= 8; day++) {
+            QDateTime alarmTime = QDateTime(today.addDays(day), QTime(hours(), minutes()), timeZone).addSecs(m_offset * 60);
+            if (alarmTime > after && checkDayOfWeek(alarmTime.toTimeZone(timeZone).date())) {
+                return alarmTime;
+            }
+        }
+        return QDateTime();
+    }
+    case TimeTypeDusk:
+        sunTime = m_duskOffset;
+        break;
+    case TimeTypeSunrise:
+        sunTime = m_sunriseOffset;
+        break;
+    case TimeTypeNoon:
+        sunTime = m_noonOffset;
+        break;
+    case TimeTypeSunset:
+        sunTime = m_sunsetOffset;
+        break;
+    case TimeTypeDawn:
+        sunTime = m_dawnOffset;
+        break;
+    }
+
+    if (!sunTime.isValid() || sunTime <= after)
+        return QDateTime();
+
+    return sunTime;
 }
 
 QDateTime Alarm::calculateOffsetTime(const QDateTime &dateTime) const
 {
+    if (!dateTime.isValid())
+        return QDateTime();
+
     return QDateTime(dateTime).addSecs(m_offset * 60);
 }
 
-bool Alarm::checkDayOfWeek(const QDateTime &dateTime)
-{    
-    switch (dateTime.date().dayOfWeek()) {
+bool Alarm::checkDayOfWeek(const QDate &date) const
+{
+    switch (date.dayOfWeek()) {
     case Qt::Monday:
         return monday();
     case Qt::Tuesday:
@@ -235,92 +272,12 @@ bool Alarm::checkDayOfWeek(const QDateTime &dateTime)
     }
 }
 
-bool Alarm::checkHour(const QDateTime &dateTime)
-{
-    if (getAlertTime().time().hour() == dateTime.time().hour()) {
-        return true;
-    }
-    return false;
-}
-
-bool Alarm::checkMinute(const QDateTime &dateTime)
+void Alarm::trigger(const QDateTime &dateTime)
 {
-    if (getAlertTime().time().minute() == dateTime.time().minute()) {
-        return true;
+    if (m_timeType == TimeTypeTime) {
+        qCDebug(dcDateTime) << name() << "time match" << dateTime.time().toString("hh:mm") << QTime(hours(), minutes()).toString("hh:mm") << "with offset" << m_offset;
+    } else {
+        qCDebug(dcDateTime) << name() << "time:" << dateTime.time().toString() << "matches sun time with offset" << m_offset;
     }
-    return false;
-}
-
-bool Alarm::checkTimeTypes(const QDateTime &dateTime)
-{
-    bool checkOk = false;
-    switch (m_timeType) {
-    case TimeTypeTime:
-        qCWarning(dcDateTime) << name() << "wrong time type. This should never happen!";
-        checkOk = false;
-        break;
-    case TimeTypeDusk:
-        if (m_duskOffset == dateTime) {
-            qCDebug(dcDateTime) << name() << "time:" << dateTime.time().toString() << "matches dusk time" << m_duskOffset.time().toString() << "with offset" << m_offset;
-            checkOk = true;
-        }
-        break;
-    case TimeTypeSunrise:
-        if (m_sunriseOffset == dateTime) {
-            qCDebug(dcDateTime) << name() << "time:" << dateTime.time().toString() << "matches sunrise time" << m_sunriseOffset.time().toString() << "with offset" << m_offset;
-            checkOk = true;
-        }
-        break;
-    case TimeTypeNoon:
-        if (m_noonOffset == dateTime) {
-            qCDebug(dcDateTime) << name() << "time:" << dateTime.time().toString() << "matches noon time" << m_noonOffset.time().toString() << "with offset" << m_offset;
-            checkOk = true;
-        }
-        break;
-    case TimeTypeSunset:
-        if (m_sunsetOffset == dateTime) {
-            qCDebug(dcDateTime) << name() << "time:" << dateTime.time().toString() << "matches sunset time" << m_sunsetOffset.time().toString() << "with offset" << m_offset;
-            checkOk = true;
-        }
-        break;
-    case TimeTypeDawn:
-        if (m_dawnOffset == dateTime) {
-            qCDebug(dcDateTime) << name() << "time:" << dateTime.time().toString() << "matches dawn time" << m_dawnOffset.time().toString() << "with offset" << m_offset;
-            checkOk = true;
-        }
-        break;
-    default:
-        checkOk = false;
-    }
-    return checkOk;
-}
-
-void Alarm::validate(const QDateTime &dateTime)
-{
-    if (m_timeType != TimeTypeTime)
-        return;
-
-    if (!checkDayOfWeek(dateTime))
-        return;
-
-    // check if should use the given time
-    if (!checkHour(dateTime))
-        return;
-
-    if (!checkMinute(dateTime))
-        return;
-
-    qCDebug(dcDateTime) << name() << "time match" << dateTime.time().toString("hh:mm") << QTime(hours(), minutes()).toString("hh:mm") << "with offset" << m_offset;
-    emit alarm();
-}
-
-void Alarm::validateTimes(const QDateTime &dateTime)
-{
-    if (m_timeType == TimeTypeTime)
-        return;
-
-    if (!checkTimeTypes(dateTime))
-        return;
-
     emit alarm();
 }
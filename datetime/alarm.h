@@ -33,6 +33,7 @@
 
 #include <QObject>
 #include <QDateTime>
+#include <QTimeZone>
 
 class Alarm : public QObject
 {
@@ -92,6 +93,10 @@ public:
     void setTimeType(const QString &timeType);
     TimeType timeType() const;
 
+    // The next time after the given time this alarm goes off. Sun based alarms only
+    // know the times of the current day, an invalid time is returned once they passed.
+    QDateTime nextAlarmTime(const QDateTime &after, const QTimeZone &timeZone) const;
+
 private:
     QString m_name;
     bool m_monday;
@@ -113,21 +118,15 @@ private:
     QDateTime m_sunsetOffset;
     QDateTime m_dawnOffset;
 
-    QDateTime getAlertTime() const;
     QDateTime calculateOffsetTime(const QDateTime &dateTime) const;
 
-    bool checkDayOfWeek(const QDateTime &dateTime);
-    bool checkHour(const QDateTime &dateTime);
-    bool checkMinute(const QDateTime &dateTime);
-
-    bool checkTimeTypes(const QDateTime &dateTime);
+    bool checkDayOfWeek(const QDate &date) const;
 
 signals:
     void alarm();
 
 public slots:
-    void validate(const QDateTime &dateTime);
-    void validateTimes(const QDateTime &dateTime);
+    void trigger(const QDateTime &dateTime);
 
 };
 
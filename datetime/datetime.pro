@@ -7,10 +7,12 @@ TARGET = $$qtLibraryTarget(nymea_integrationplugindatetime)
 SOURCES += \
     integrationplugindatetime.cpp \
     alarm.cpp \
-    countdown.cpp
+    countdown.cpp \
+    solarephemeris.cpp
 
 HEADERS += \
     integrationplugindatetime.h \
     alarm.h \
-    countdown.h
+    countdown.h \
+    solarephemeris.h
 
@@ -36,7 +36,9 @@
 #include "network/networkaccessmanager.h"
 
 #include <QJsonDocument>
-#include <QUrlQuery>
+
+#include <algorithm>
+#include <functional>
 
 IntegrationPluginDateTime::IntegrationPluginDateTime() :
     m_timer(nullptr),
@@ -49,11 +51,12 @@ IntegrationPluginDateTime::IntegrationPluginDateTime() :
     m_dawn(QDateTime())
 {
     m_timer = new QTimer(this);
-    m_timer->setInterval(1000);
+    m_timer->setSingleShot(true);
+    m_timer->setTimerType(Qt::PreciseTimer);
 
     m_currentDateTime = QDateTime(QDate::currentDate(), QTime::currentTime(), m_timeZone);
 
-    connect(m_timer, &QTimer::timeout, this, &IntegrationPluginDateTime::onSecondChanged);
+    connect(m_timer, &QTimer::timeout, this, &IntegrationPluginDateTime::onTimerTimeout);
 }
 
 void IntegrationPluginDateTime::setupThing(ThingSetupInfo *info)
@@ -76,6 +79,12 @@ void IntegrationPluginDateTime::setupThing(ThingSetupInfo *info)
         }
         m_todayDevice = thing;
         qCDebug(dcDateTime) << "Create today thing: current time" << m_currentDateTime.currentDateTime().toString();
+
+        connect(thing, &Thing::settingChanged, this, [this](const ParamTypeId &paramTypeId){
+            if (paramTypeId == todaySettingsLatitudeParamTypeId || paramTypeId == todaySettingsLongitudeParamTypeId) {
+                loadLocation();
+            }
+        });
     }
 
     // alarm
@@ -118,7 +127,7 @@ void IntegrationPluginDateTime::setupThing(ThingSetupInfo *info)
         m_countdowns.insert(thing, countdown);
     }
 
-    m_timer->start();
+    requestReschedule();
 
     info->finish(Thing::ThingErrorNoError);
 }
@@ -127,20 +136,14 @@ void IntegrationPluginDateTime::postSetupThing(Thing *thing)
 {
     if (thing->thingClassId() == todayThingClassId) {
         QDateTime zoneTime = QDateTime::currentDateTime().toTimeZone(m_timeZone);
-        updateTimes();
-        onMinuteChanged(zoneTime);
-        onHourChanged(zoneTime);
+        // Requests the geo location if required
+        loadLocation();
         onDayChanged(zoneTime);
     }
 }
 
 void IntegrationPluginDateTime::thingRemoved(Thing *thing)
 {
-    // check if we still need the timer
-    if (myThings().count() == 0) {
-        m_timer->stop();
-    }
-
     // date
     if (thing->thingClassId() == todayThingClassId) {
         m_todayDevice = nullptr;
@@ -158,6 +161,8 @@ void IntegrationPluginDateTime::thingRemoved(Thing *thing)
         countdown->deleteLater();
     }
 
+    requestReschedule();
+
     //startMonitoringAutoThings();
 }
 
@@ -192,6 +197,37 @@ void IntegrationPluginDateTime::startMonitoringAutoThings()
 //    emit autoThingsAppeared(todayThingClassId, QList<ThingDescriptor>() << dateDescriptor);
 }
 
+void IntegrationPluginDateTime::loadLocation()
+{
+    if (!m_todayDevice)
+        return;
+
+    double latitude = m_todayDevice->setting(todaySettingsLatitudeParamTypeId).toDouble();
+    double longitude = m_todayDevice->setting(todaySettingsLongitudeParamTypeId).toDouble();
+    if (!qFuzzyIsNull(latitude) || !qFuzzyIsNull(longitude)) {
+        qCDebug(dcDateTime()) << "Using configured location" << latitude << longitude;
+    } else {
+        // Fall back to the last autodetected location, so we don't depend on the network after a restart
+        pluginStorage()->beginGroup("geolocation");
+        bool cached = pluginStorage()->contains("latitude") && pluginStorage()->contains("longitude");
+        latitude = pluginStorage()->value("latitude").toDouble();
+        longitude = pluginStorage()->value("longitude").toDouble();
+        pluginStorage()->endGroup();
+
+        if (!cached) {
+            m_locationValid = false;
+            searchGeoLocation();
+            return;
+        }
+        qCDebug(dcDateTime()) << "Using autodetected location" << latitude << longitude;
+    }
+
+    m_locationValid = true;
+    m_latitude = latitude;
+    m_longitude = longitude;
+    calculateSunTimes(QDateTime::currentDateTime().toTimeZone(m_timeZone).date());
+}
+
 void IntegrationPluginDateTime::searchGeoLocation()
 {
     if (!m_todayDevice)
@@ -224,10 +260,14 @@ void IntegrationPluginDateTime::processGeoLocationData(const QByteArray &data)
         return;
     }
 
+    if (!m_todayDevice)
+        return;
+
     //qCDebug(dcDateTime) << "geo location data received:" << jsonDoc.toJson();
     QVariantMap response = jsonDoc.toVariant().toMap();
     if (response.value("status") != "success") {
         qCWarning(dcDateTime) << "failed to request geo location:" << response.value("status");
+        return;
     }
 
     // check timezone
@@ -247,71 +287,45 @@ void IntegrationPluginDateTime::processGeoLocationData(const QByteArray &data)
     qCDebug(dcDateTime) << " lat      :" << response.value("lat").toByteArray();
     qCDebug(dcDateTime) << "---------------------------------------------";
 
-    getTimes(response.value("lat").toString(), response.value("lon").toString());
-}
-
-void IntegrationPluginDateTime::getTimes(const QString &latitude, const QString &longitude)
-{
-    QUrlQuery urlQuery;
-    urlQuery.addQueryItem("lat", latitude);
-    urlQuery.addQueryItem("lng", longitude);
-    urlQuery.addQueryItem("date", "today");
-
-    QUrl url = QUrl("https://api.sunrise-sunset.org/json");
-    url.setQuery(urlQuery.toString());
-
-    QNetworkRequest request;
-    request.setUrl(url);
-
-    QNetworkReply *reply = hardwareManager()->networkManager()->get(request);
-    connect(reply, &QNetworkReply::finished, this, [reply, this](){
-        reply->deleteLater();
+    pluginStorage()->beginGroup("geolocation");
+    pluginStorage()->setValue("latitude", response.value("lat").toDouble());
+    pluginStorage()->setValue("longitude", response.value("lon").toDouble());
+    pluginStorage()->endGroup();
 
-        if (reply->error() != QNetworkReply::NoError) {
-            qCWarning(dcDateTime) << "Http error status for time request:" << reply->error();
-            return;
-        }
-        processTimesData(reply->readAll());
-    });
+    loadLocation();
 }
 
-void IntegrationPluginDateTime::processTimesData(const QByteArray &data)
+void IntegrationPluginDateTime::calculateSunTimes(const QDate &date)
 {
-    QJsonParseError error;
-    QJsonDocument jsonDoc = QJsonDocument::fromJson(data, &error);
-
-    if(error.error != QJsonParseError::NoError) {
-        qCWarning(dcDateTime) << "failed to parse time JSON data:" << error.errorString() << ":" << data ;
+    if (!m_locationValid)
         return;
-    }
 
-    qCDebug(dcDateTime()) << "Raw data:" << qUtf8Printable(jsonDoc.toJson(QJsonDocument::Indented));
-    QVariantMap response = jsonDoc.toVariant().toMap();
-    if (response.value("status") != "OK") {
-        qCWarning(dcDateTime) << "failed to request time data:" << response.value("status");
+    // The times only change once a day, reuse them as long as date and location are the same
+    if (m_ephemeris.isValid() && m_ephemeris.date() == date && m_ephemeris.latitude() == m_latitude && m_ephemeris.longitude() == m_longitude)
         return;
-    }
 
-    // given time is always in UTC
-    QVariantMap result = response.value("results").toMap();
-    QString dawnString = result.value("civil_twilight_begin").toString();
-    QString sunriseString = result.value("sunrise").toString();
-    QString noonString = result.value("solar_noon").toString();
-    QString sunsetString = result.value("sunset").toString();
-    QString duskString = result.value("civil_twilight_end").toString();
-
-    // calculate the times in each alarm
-    m_dawn = QDateTime(QDate::currentDate(), QTime::fromString(dawnString, "h:mm:ss AP"), Qt::UTC).toTimeZone(m_timeZone);
-    m_sunrise = QDateTime(QDate::currentDate(), QTime::fromString(sunriseString, "h:mm:ss AP"), Qt::UTC).toTimeZone(m_timeZone);
-    m_noon = QDateTime(QDate::currentDate(), QTime::fromString(noonString, "h:mm:ss AP"), Qt::UTC).toTimeZone(m_timeZone);
-    m_sunset = QDateTime(QDate::currentDate(), QTime::fromString(sunsetString, "h:mm:ss AP"), Qt::UTC).toTimeZone(m_timeZone);
-    m_dusk = QDateTime(QDate::currentDate(), QTime::fromString(duskString, "h:mm:ss AP"), Qt::UTC).toTimeZone(m_timeZone);
-
-    qCDebug(dcDateTime) << " dawn     :" << m_dawn.toString() << dawnString;
-    qCDebug(dcDateTime) << " sunrise  :" << m_sunrise.toString() << sunriseString;
-    qCDebug(dcDateTime) << " noon     :" << m_noon.toString() << noonString;
-    qCDebug(dcDateTime) << " sunset   :" << m_sunset.toString() << sunsetString;
-    qCDebug(dcDateTime) << " dusk     :" << m_dusk.toString() << duskString;
+    m_ephemeris = SolarEphemeris(date, m_latitude, m_longitude);
+
+    // Same second resolution as the time validation
+    auto toZoneTime = [this](const QDateTime &dateTime) {
+        if (!dateTime.isValid())
+            return QDateTime();
+        QDateTime zoneTime = dateTime.toTimeZone(m_timeZone);
+        return QDateTime(zoneTime.date(), QTime(zoneTime.time().hour(), zoneTime.time().minute(), zoneTime.time().second()), m_timeZone);
+    };
+
+    m_dawn = toZoneTime(m_ephemeris.civilDawn());
+    m_sunrise = toZoneTime(m_ephemeris.sunrise());
+    m_noon = toZoneTime(m_ephemeris.noon());
+    m_sunset = toZoneTime(m_ephemeris.sunset());
+    m_dusk = toZoneTime(m_ephemeris.civilDusk());
+
+    qCDebug(dcDateTime) << "Sun times for" << date.toString() << "at" << m_latitude << m_longitude;
+    qCDebug(dcDateTime) << " dawn     :" << m_dawn.toString();
+    qCDebug(dcDateTime) << " sunrise  :" << m_sunrise.toString();
+    qCDebug(dcDateTime) << " noon     :" << m_noon.toString();
+    qCDebug(dcDateTime) << " sunset   :" << m_sunset.toString();
+    qCDebug(dcDateTime) << " dusk     :" << m_dusk.toString();
     qCDebug(dcDateTime) << "---------------------------------------------";
 
     updateTimes();
@@ -341,43 +355,163 @@ void IntegrationPluginDateTime::onCountdownRunningChanged(const bool &running)
     thing->setStateValue(countdownRunningStateTypeId, running);
 }
 
-void IntegrationPluginDateTime::onSecondChanged()
+void IntegrationPluginDateTime::onTimerTimeout()
 {
-    QDateTime currentTime = QDateTime::currentDateTime().toTimeZone(m_timeZone);
-    // make shore that ms are 0
-    QDateTime zoneTime = QDateTime(QDate(currentTime.date()), QTime(currentTime.time().hour(), currentTime.time().minute(), currentTime.time().second(), 0));
+    QDateTime now = QDateTime::currentDateTime().toTimeZone(m_timeZone);
+    qint64 nowMs = now.toMSecsSinceEpoch();
+    m_currentDateTime = now;
+
+    while (!m_schedule.isEmpty() && m_schedule.first().time <= nowMs) {
+        std::pop_heap(m_schedule.begin(), m_schedule.end(), std::greater<ScheduleEntry>());
+        ScheduleEntry entry = m_schedule.takeLast();
+        QDateTime entryTime = QDateTime::fromMSecsSinceEpoch(entry.time).toTimeZone(m_timeZone);
+
+        // Entries overdue for more than a minute have been skipped by a change of the system time
+        bool overdue = nowMs - entry.time > 60000;
+        if (overdue) {
+            qCDebug(dcDateTime()) << "Skipping overdue schedule entry for" << entryTime.toString();
+        }
 
-    validateTimeTypes(zoneTime);
+        switch (entry.type) {
+        case ScheduleEntry::TypeAlarm: {
+            Alarm *alarm = m_alarms.value(entry.thing);
+            if (!alarm)
+                break;
+            if (!overdue)
+                alarm->trigger(entryTime);
+            scheduleAlarm(entry.thing, now);
+            break;
+        }
+        case ScheduleEntry::TypeSunEvent:
+            if (!m_todayDevice || overdue)
+                break;
+            emit emitEvent(Event(entry.eventTypeId, m_todayDevice->id()));
+            if (entry.eventTypeId == todaySunriseEventTypeId || entry.eventTypeId == todaySunsetEventTypeId) {
+                m_todayDevice->setStateValue(todayDaylightStateTypeId, m_sunrise <= now && now < m_sunset);
+            }
+            break;
+        case ScheduleEntry::TypeDayChange:
+            // Recalculates the sun times, which reschedules everything
+            onDayChanged(now);
+            requestReschedule();
+            break;
+        case ScheduleEntry::TypeHourChange: {
+            onHourChanged(now);
+            ScheduleEntry hourEntry;
+            hourEntry.time = QDateTime(now.date(), QTime(now.time().hour(), 0), m_timeZone).addSecs(3600).toMSecsSinceEpoch();
+            hourEntry.type = ScheduleEntry::TypeHourChange;
+            scheduleEntry(hourEntry);
+            break;
+        }
+        }
+    }
 
-    if (zoneTime.date() != m_currentDateTime.date())
-        onDayChanged(zoneTime);
+    armTimer();
+}
+
+void IntegrationPluginDateTime::requestReschedule()
+{
+    // Coalesce the rescheduling while many things are set up or removed at once
+    if (m_reschedulePending)
+        return;
+
+    m_reschedulePending = true;
+    QMetaObject::invokeMethod(this, "reschedule", Qt::QueuedConnection);
+}
+
+void IntegrationPluginDateTime::reschedule()
+{
+    m_reschedulePending = false;
+    m_schedule.clear();
+
+    if (myThings().isEmpty()) {
+        m_timer->stop();
+        return;
+    }
 
-    if (zoneTime.time().hour() != m_currentDateTime.time().hour())
-        onHourChanged(zoneTime);
+    QDateTime now = QDateTime::currentDateTime().toTimeZone(m_timeZone);
+    m_currentDateTime = now;
 
-    if (zoneTime.time().minute() != m_currentDateTime.time().minute())
-        onMinuteChanged(zoneTime);
+    foreach (Thing *thing, m_alarms.keys()) {
+        scheduleAlarm(thing, now);
+    }
+
+    if (m_todayDevice) {
+        scheduleSunEvent(todayDawnEventTypeId, m_dawn, now);
+        scheduleSunEvent(todaySunriseEventTypeId, m_sunrise, now);
+        scheduleSunEvent(todayNoonEventTypeId, m_noon, now);
+        scheduleSunEvent(todaySunsetEventTypeId, m_sunset, now);
+        scheduleSunEvent(todayDuskEventTypeId, m_dusk, now);
+
+        ScheduleEntry hourEntry;
+        hourEntry.time = QDateTime(now.date(), QTime(now.time().hour(), 0), m_timeZone).addSecs(3600).toMSecsSinceEpoch();
+        hourEntry.type = ScheduleEntry::TypeHourChange;
+        scheduleEntry(hourEntry);
+    }
 
-    // just store for compairing
-    m_currentDateTime = zoneTime;
+    // Sun based alarms only know the current day, so the day change is always needed
+    ScheduleEntry dayEntry;
+    dayEntry.time = QDateTime(now.date().addDays(1), QTime(0, 0), m_timeZone).toMSecsSinceEpoch();
+    dayEntry.type = ScheduleEntry::TypeDayChange;
+    scheduleEntry(dayEntry);
+
+    qCDebug(dcDateTime()) << "Scheduled" << m_schedule.count() << "alarms and events";
+    armTimer();
 }
 
-void IntegrationPluginDateTime::onMinuteChanged(const QDateTime &dateTime)
+void IntegrationPluginDateTime::scheduleEntry(const ScheduleEntry &entry)
 {
-    //qCDebug(dcDateTime) << "minute changed" << dateTime.toString();
+    m_schedule.append(entry);
+    std::push_heap(m_schedule.begin(), m_schedule.end(), std::greater<ScheduleEntry>());
+}
 
-    // validate alerts
-    foreach (Alarm *alarm, m_alarms.values()) {
-        alarm->validate(dateTime);
+void IntegrationPluginDateTime::scheduleAlarm(Thing *thing, const QDateTime &after)
+{
+    Alarm *alarm = m_alarms.value(thing);
+    QDateTime alarmTime = alarm->nextAlarmTime(after, m_timeZone);
+    if (!alarmTime.isValid())
+        return;
+
+    ScheduleEntry entry;
+    entry.time = alarmTime.toMSecsSinceEpoch();
+    entry.type = ScheduleEntry::TypeAlarm;
+    entry.thing = thing;
+    scheduleEntry(entry);
+}
+
+void IntegrationPluginDateTime::scheduleSunEvent(const EventTypeId &eventTypeId, const QDateTime &time, const QDateTime &after)
+{
+    if (!time.isValid() || time <= after)
+        return;
+
+    ScheduleEntry entry;
+    entry.time = time.toMSecsSinceEpoch();
+    entry.type = ScheduleEntry::TypeSunEvent;
+    entry.eventTypeId = eventTypeId;
+    scheduleEntry(entry);
+}
+
+void IntegrationPluginDateTime::armTimer()
+{
+    if (m_schedule.isEmpty()) {
+        m_timer->stop();
+        return;
     }
+
+    // The timer runs on the monotonic clock, wake up at least once per hour
+    // to follow changes of the system time.
+    qint64 interval = m_schedule.first().time - QDateTime::currentMSecsSinceEpoch();
+    m_timer->start(static_cast<int>(qBound<qint64>(0, interval, 3600000)));
 }
 
 void IntegrationPluginDateTime::onHourChanged(const QDateTime &dateTime)
 {
     Q_UNUSED(dateTime)
     //qCDebug(dcDateTime) << "hour changed" <<  dateTime.toString();
-    // check every hour in case we are offline in the wrong moment
-    searchGeoLocation();
+    // retry every hour in case we were offline in the wrong moment
+    if (m_todayDevice && !m_locationValid) {
+        searchGeoLocation();
+    }
 }
 
 void IntegrationPluginDateTime::onDayChanged(const QDateTime &dateTime)
@@ -387,6 +521,8 @@ void IntegrationPluginDateTime::onDayChanged(const QDateTime &dateTime)
     if (!m_todayDevice)
         return;
 
+    calculateSunTimes(dateTime.date());
+
     m_todayDevice->setStateValue(todayDayStateTypeId, dateTime.date().day());
     m_todayDevice->setStateValue(todayMonthStateTypeId, dateTime.date().month());
     m_todayDevice->setStateValue(todayYearStateTypeId, dateTime.date().year());
@@ -412,8 +548,10 @@ void IntegrationPluginDateTime::updateTimes()
     }
 
     // date
-    if (!m_todayDevice)
+    if (!m_todayDevice) {
+        requestReschedule();
         return;
+    }
 
     if (m_dusk.isValid()) {
         m_todayDevice->setStateValue(todayDuskTimeStateTypeId, m_dusk.toTime_t());
@@ -429,37 +567,25 @@ void IntegrationPluginDateTime::updateTimes()
         m_todayDevice->setStateValue(todaySunsetTimeStateTypeId, 0);
         m_todayDevice->setStateValue(todayDaylightStateTypeId, false);
     }
-    if (m_dusk.isValid()) {
+    if (m_noon.isValid()) {
         m_todayDevice->setStateValue(todayNoonTimeStateTypeId, m_noon.toTime_t());
     } else {
         m_todayDevice->setStateValue(todayNoonTimeStateTypeId, 0);
     }
-    if (m_dusk.isValid()) {
+    if (m_dawn.isValid()) {
         m_todayDevice->setStateValue(todayDawnTimeStateTypeId, m_dawn.toTime_t());
     } else {
         m_todayDevice->setStateValue(todayDawnTimeStateTypeId, 0);
     }
-}
 
+    QDateTime nauticalDawn = m_ephemeris.nauticalDawn();
+    QDateTime nauticalDusk = m_ephemeris.nauticalDusk();
+    QDateTime astronomicalDawn = m_ephemeris.astronomicalDawn();
+    QDateTime astronomicalDusk = m_ephemeris.astronomicalDusk();
+    m_todayDevice->setStateValue(todayNauticalDawnTimeStateTypeId, nauticalDawn.isValid() ? nauticalDawn.toTime_t() : 0);
+    m_todayDevice->setStateValue(todayNauticalDuskTimeStateTypeId, nauticalDusk.isValid() ? nauticalDusk.toTime_t() : 0);
+    m_todayDevice->setStateValue(todayAstronomicalDawnTimeStateTypeId, astronomicalDawn.isValid() ? astronomicalDawn.toTime_t() : 0);
+    m_todayDevice->setStateValue(todayAstronomicalDuskTimeStateTypeId, astronomicalDusk.isValid() ? astronomicalDusk.toTime_t() : 0);
 
-void IntegrationPluginDateTime::validateTimeTypes(const QDateTime &dateTime)
-{
-    if (!m_todayDevice)
-        return;
-
-    if (dateTime == m_dusk) {
-        emit emitEvent(Event(todayDuskEventTypeId, m_todayDevice->id()));
-    } else if (dateTime == m_sunrise) {
-        emit emitEvent(Event(todaySunriseEventTypeId, m_todayDevice->id()));
-    } else if (dateTime == m_noon) {
-        emit emitEvent(Event(todayNoonEventTypeId, m_todayDevice->id()));
-    } else if (dateTime == m_dawn) {
-        emit emitEvent(Event(todayDawnEventTypeId, m_todayDevice->id()));
-    } else if (dateTime == m_sunset) {
-        emit emitEvent(Event(todaySunsetEventTypeId, m_todayDevice->id()));
-    }
-
-    foreach (Alarm *alarm, m_alarms.values()) {
-        alarm->validateTimes(dateTime);
-    }
+    requestReschedule();
 }
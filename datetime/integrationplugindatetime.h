@@ -34,11 +34,13 @@
 #include "integrations/integrationplugin.h"
 #include "alarm.h"
 #include "countdown.h"
+#include "solarephemeris.h"
 
 #include <QDateTime>
 #include <QTimeZone>
 #include <QTime>
 #include <QTimer>
+#include <QVector>
 #include <QNetworkReply>
 
 class IntegrationPluginDateTime : public IntegrationPlugin
@@ -60,6 +62,22 @@ public:
     void startMonitoringAutoThings() override;
 
 private:
+    // An entry of the schedule, ordered by time
+    struct ScheduleEntry {
+        enum Type {
+            TypeAlarm,
+            TypeSunEvent,
+            TypeDayChange,
+            TypeHourChange
+        };
+        qint64 time = 0;
+        Type type = TypeAlarm;
+        Thing *thing = nullptr;
+        EventTypeId eventTypeId;
+
+        bool operator>(const ScheduleEntry &other) const { return time > other.time; }
+    };
+
     QTimer *m_timer;
     Thing *m_todayDevice;
     QTimeZone m_timeZone;
@@ -74,11 +92,27 @@ private:
     QDateTime m_sunset;
     QDateTime m_dawn;
 
+    // Location used for the sun times, either configured or autodetected
+    bool m_locationValid = false;
+    double m_latitude = 0;
+    double m_longitude = 0;
+    SolarEphemeris m_ephemeris;
+
+    void loadLocation();
     void searchGeoLocation();
     void processGeoLocationData(const QByteArray &data);
 
-    void getTimes(const QString &latitude, const QString &longitude);
-    void processTimesData(const QByteArray &data);
+    void calculateSunTimes(const QDate &date);
+
+    // Min-heap of upcoming alarms and events, the timer is armed for the earliest one
+    QVector<ScheduleEntry> m_schedule;
+    bool m_reschedulePending = false;
+
+    void requestReschedule();
+    void scheduleEntry(const ScheduleEntry &entry);
+    void scheduleAlarm(Thing *thing, const QDateTime &after);
+    void scheduleSunEvent(const EventTypeId &eventTypeId, const QDateTime &time, const QDateTime &after);
+    void armTimer();
 
 signals:
     void dusk();
@@ -91,15 +125,13 @@ private slots:
     void onAlarm();
     void onCountdownTimeout();
     void onCountdownRunningChanged(const bool &running);
-    void onSecondChanged();
-    void onMinuteChanged(const QDateTime &dateTime);
+    void onTimerTimeout();
+    void reschedule();
     void onHourChanged(const QDateTime &dateTime);
     void onDayChanged(const QDateTime &dateTime);
 
     void updateTimes();
 
-    void validateTimeTypes(const QDateTime &dateTime);
-
 };
 
 #endif // INTEGRATIONPLUGINDATETIME_H
@@ -0,0 +1,253 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+*
+* Copyright 2013 - 2020, nymea GmbH
+* Contact: contact@nymea.io
+*
+* This file is part of nymea.
+* This project including source code and documentation is protected by
+* copyright law, and remains the property of nymea GmbH. All rights, including
+* reproduction, publication, editing and translation, are reserved. The use of
+* this project is subject to the terms of a license agreement to be concluded
+* with nymea GmbH in accordance with the terms of use of nymea GmbH, available
+* under https://nymea.io/license
+*
+* GNU Lesser General Public License Usage
+* Alternatively, this project may be redistributed and/or modified under the
+* terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; version 3. This project is distributed in the hope that
+* it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+* warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this project. If not, see <https://www.gnu.org/licenses/>.
+*
+* For any further details and any questions please contact us under
+* contact@nymea.io or see our FAQ/Licensing Information on
+* https://nymea.io/license/faq
+*
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "solarephemeris.h"
+
+#include <QtMath>
+
+// Zenith angles in degrees, the sunrise/sunset zenith includes refraction and the sun's radius
+#define ZENITH_SUNRISE      90.833
+#define ZENITH_CIVIL        96.0
+#define ZENITH_NAUTICAL    102.0
+#define ZENITH_ASTRONOMICAL 108.0
+
+namespace {
+
+double julianCentury(double julianDay)
+{
+    return (julianDay - 2451545.0) / 36525.0;
+}
+
+double geomMeanLongSun(double t)
+{
+    double l0 = 280.46646 + t * (36000.76983 + t * 0.0003032);
+    l0 = std::fmod(l0, 360.0);
+    return l0 < 0 ? l0 + 360 : l0;
+}
+
+double geomMeanAnomalySun(double t)
+{
+    return 357.52911 + t * (35999.05029 - 0.0001537 * t);
+}
+
+double eccentricityEarthOrbit(double t)
+{
+    return 0.016708634 - t * (0.000042037 + 0.0000001267 * t);
+}
+
+double sunEquationOfCenter(double t)
+{
+    double m = qDegreesToRadians(geomMeanAnomalySun(t));
+    return qSin(m) * (1.914602 - t * (0.004817 + 0.000014 * t))
+            + qSin(2 * m) * (0.019993 - 0.000101 * t)
+            + qSin(3 * m) * 0.000289;
+}
+
+double sunApparentLongitude(double t)
+{
+    double trueLongitude = geomMeanLongSun(t) + sunEquationOfCenter(t);
+    double omega = 125.04 - 1934.136 * t;
+    return trueLongitude - 0.00569 - 0.00478 * qSin(qDegreesToRadians(omega));
+}
+
+double obliquityCorrection(double t)
+{
+    double seconds = 21.448 - t * (46.8150 + t * (0.00059 - t * 0.001813));
+    double meanObliquity = 23.0 + (26.0 + seconds / 60.0) / 60.0;
+    double omega = 125.04 - 1934.136 * t;
+    return meanObliquity + 0.00256 * qCos(qDegreesToRadians(omega));
+}
+
+double sunDeclination(double t)
+{
+    double e = qDegreesToRadians(obliquityCorrection(t));
+    double lambda = qDegreesToRadians(sunApparentLongitude(t));
+    return qRadiansToDegrees(qAsin(qSin(e) * qSin(lambda)));
+}
+
+// In minutes
+double equationOfTime(double t)
+{
+    double epsilon = qDegreesToRadians(obliquityCorrection(t));
+    double l0 = qDegreesToRadians(geomMeanLongSun(t));
+    double e = eccentricityEarthOrbit(t);
+    double m = qDegreesToRadians(geomMeanAnomalySun(t));
+
+    double y = qTan(epsilon / 2.0);
+    y *= y;
+
+    double eTime = y * qSin(2.0 * l0)
+            - 2.0 * e * qSin(m)
+            + 4.0 * e * y * qSin(m) * qCos(2.0 * l0)
+            - 0.5 * y * y * qSin(4.0 * l0)
+            - 1.25 * e * e * qSin(2.0 * m);
+    return qRadiansToDegrees(eTime) * 4.0;
+}
+
+// Returns NaN if the sun does not reach the given zenith
+double hourAngle(double latitude, double declination, double zenith)
+{
+    double latitudeRad = qDegreesToRadians(latitude);
+    double declinationRad = qDegreesToRadians(declination);
+    double cosHourAngle = qCos(qDegreesToRadians(zenith)) / (qCos(latitudeRad) * qCos(declinationRad)) - qTan(latitudeRad) * qTan(declinationRad);
+    if (cosHourAngle < -1.0 || cosHourAngle > 1.0) {
+        return qQNaN();
+    }
+    return qRadiansToDegrees(qAcos(cosHourAngle));
+}
+
+}
+
+SolarEphemeris::SolarEphemeris()
+{
+
+}
+
+SolarEphemeris::SolarEphemeris(const QDate &date, double latitude, double longitude):
+    m_date(date),
+    m_latitude(latitude),
+    m_longitude(longitude)
+{
+    if (!date.isValid()) {
+        return;
+    }
+
+    m_noon = toDateTime(solarNoonMinutes(date.toJulianDay() - 0.5));
+    m_astronomicalDawn = toDateTime(eventMinutes(ZENITH_ASTRONOMICAL, true));
+    m_nauticalDawn = toDateTime(eventMinutes(ZENITH_NAUTICAL, true));
+    m_civilDawn = toDateTime(eventMinutes(ZENITH_CIVIL, true));
+    m_sunrise = toDateTime(eventMinutes(ZENITH_SUNRISE, true));
+    m_sunset = toDateTime(eventMinutes(ZENITH_SUNRISE, false));
+    m_civilDusk = toDateTime(eventMinutes(ZENITH_CIVIL, false));
+    m_nauticalDusk = toDateTime(eventMinutes(ZENITH_NAUTICAL, false));
+    m_astronomicalDusk = toDateTime(eventMinutes(ZENITH_ASTRONOMICAL, false));
+}
+
+bool SolarEphemeris::isValid() const
+{
+    return m_date.isValid();
+}
+
+QDate SolarEphemeris::date() const
+{
+    return m_date;
+}
+
+double SolarEphemeris::latitude() const
+{
+    return m_latitude;
+}
+
+double SolarEphemeris::longitude() const
+{
+    return m_longitude;
+}
+
+QDateTime SolarEphemeris::astronomicalDawn() const
+{
+    return m_astronomicalDawn;
+}
+
+QDateTime SolarEphemeris::nauticalDawn() const
+{
+    return m_nauticalDawn;
+}
+
+QDateTime SolarEphemeris::civilDawn() const
+{
+    return m_civilDawn;
+}
+
+QDateTime SolarEphemeris::sunrise() const
+{
+    return m_sunrise;
+}
+
+QDateTime SolarEphemeris::noon() const
+{
+    return m_noon;
+}
+
+QDateTime SolarEphemeris::sunset() const
+{
+    return m_sunset;
+}
+
+QDateTime SolarEphemeris::civilDusk() const
+{
+    return m_civilDusk;
+}
+
+QDateTime SolarEphemeris::nauticalDusk() const
+{
+    return m_nauticalDusk;
+}
+
+QDateTime SolarEphemeris::astronomicalDusk() const
+{
+    return m_astronomicalDusk;
+}
+
+QDateTime SolarEphemeris::toDateTime(double minutes) const
+{
+    if (qIsNaN(minutes)) {
+        return QDateTime();
+    }
+    // Minutes since midnight UTC, may be negative or exceed one day depending on the longitude
+    return QDateTime(m_date, QTime(0, 0), Qt::UTC).addSecs(qRound64(minutes * 60));
+}
+
+double SolarEphemeris::solarNoonMinutes(double julianDay) const
+{
+    // Two passes, the second one evaluated at the approximate noon of the first one
+    double t = julianCentury(julianDay - m_longitude / 360.0 + 0.5);
+    double noon = 720 - 4 * m_longitude - equationOfTime(t);
+    t = julianCentury(julianDay + noon / 1440.0);
+    return 720 - 4 * m_longitude - equationOfTime(t);
+}
+
+double SolarEphemeris::eventMinutes(double zenith, bool rising) const
+{
+    double julianDay = m_date.toJulianDay() - 0.5;
+    double noon = solarNoonMinutes(julianDay);
+
+    // Start with the sun position at noon, then refine at the estimated event time
+    double minutes = noon;
+    for (int i = 0; i < 2; i++) {
+        double t = julianCentury(julianDay + minutes / 1440.0);
+        double angle = hourAngle(m_latitude, sunDeclination(t), zenith);
+        if (qIsNaN(angle)) {
+            return qQNaN();
+        }
+        double delta = 4 * angle;
+        minutes = 720 - 4 * m_longitude - equationOfTime(t) + (rising ? -delta : delta);
+    }
+    return minutes;
+}
@@ -0,0 +1,82 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+*
+* Copyright 2013 - 2020, nymea GmbH
+* Contact: contact@nymea.io
+*
+* This file is part of nymea.
+* This project including source code and documentation is protected by
+* copyright law, and remains the property of nymea GmbH. All rights, including
+* reproduction, publication, editing and translation, are reserved. The use of
+* this project is subject to the terms of a license agreement to be concluded
+* with nymea GmbH in accordance with the terms of use of nymea GmbH, available
+* under https://nymea.io/license
+*
+* GNU Lesser General Public License Usage
+* Alternatively, this project may be redistributed and/or modified under the
+* terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; version 3. This project is distributed in the hope that
+* it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+* warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this project. If not, see <https://www.gnu.org/licenses/>.
+*
+* For any further details and any questions please contact us under
+* contact@nymea.io or see our FAQ/Licensing Information on
+* https://nymea.io/license/faq
+*
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef SOLAREPHEMERIS_H
+#define SOLAREPHEMERIS_H
+
+#include <QDate>
+#include <QDateTime>
+
+// Sun times of a day, calculated locally using the NOAA solar calculator
+// equations. All times are in UTC. Events which don't happen on the given
+// day (e.g. during polar day or night) are invalid.
+class SolarEphemeris
+{
+public:
+    SolarEphemeris();
+    SolarEphemeris(const QDate &date, double latitude, double longitude);
+
+    bool isValid() const;
+
+    QDate date() const;
+    double latitude() const;
+    double longitude() const;
+
+    QDateTime astronomicalDawn() const;
+    QDateTime nauticalDawn() const;
+    QDateTime civilDawn() const;
+    QDateTime sunrise() const;
+    QDateTime noon() const;
+    QDateTime sunset() const;
+    QDateTime civilDusk() const;
+    QDateTime nauticalDusk() const;
+    QDateTime astronomicalDusk() const;
+
+private:
+    QDate m_date;
+    double m_latitude = 0;
+    double m_longitude = 0;
+
+    QDateTime m_astronomicalDawn;
+    QDateTime m_nauticalDawn;
+    QDateTime m_civilDawn;
+    QDateTime m_sunrise;
+    QDateTime m_noon;
+    QDateTime m_sunset;
+    QDateTime m_civilDusk;
+    QDateTime m_nauticalDusk;
+    QDateTime m_astronomicalDusk;
+
+    QDateTime toDateTime(double minutes) const;
+    double solarNoonMinutes(double julianDay) const;
+    double eventMinutes(double zenith, bool rising) const;
+};
+
+#endif // SOLAREPHEMERIS_H
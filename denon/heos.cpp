@@ -58,6 +58,18 @@ Heos::Heos(const QHostAddress &hostAddress, QObject *parent) :
         qCDebug(dcDenon()) << "Heos: Reconnect timer timeout, trying to connect to" << m_hostAddress.toString();
         connectDevice();
     });
+
+    // Gives up on requests the device never answered, otherwise they would block the queue
+    m_requestTimeoutTimer = new QTimer(this);
+    m_requestTimeoutTimer->setSingleShot(true);
+    m_requestTimeoutTimer->setInterval(10000);
+    connect(m_requestTimeoutTimer, &QTimer::timeout, this, [this]{
+        qCWarning(dcDenon()) << "Heos: Request timeout," << m_requestsInFlight.count() << "requests without response";
+        m_requestsInFlight.clear();
+        while (!m_requestQueue.isEmpty() && m_requestsInFlight.count() < m_maxRequestsInFlight) {
+            writeRequest(m_requestQueue.dequeue());
+        }
+    });
 }
 
 Heos::~Heos()
@@ -101,61 +113,49 @@ void Heos::disconnectDevice()
 
 
 /********************************
- *        PLAYER COMMANDS
+ *        SYSTEM COMMANDS
  ********************************/
 void Heos::registerForChangeEvents(bool state)
 {
-    QByteArray query;
-
-    if (state) {
-        query = "?enable=on";
-    } else {
-        query = "?enable=off";
-    }
-    QByteArray cmd = "heos://system/register_for_change_events" + query + "\r\n";
-    qCDebug(dcDenon) << "Register for change events:" << cmd;
-    m_socket->write(cmd);
+    QUrlQuery query;
+    query.addQueryItem("enable", state ? "on" : "off");
+    qCDebug(dcDenon) << "Register for change events:" << query.toString();
+    sendCommand("system/register_for_change_events", query);
 }
 
 void Heos::sendHeartbeat()
 {
-    QByteArray cmd = "heos://system/heart_beat\r\n";
-    m_socket->write(cmd);
+    sendCommand("system/heart_beat");
 }
 
 void Heos::getUserAccount()
 {
-    QByteArray cmd = "heos://system/check_account\r\n";
-    m_socket->write(cmd);
+    sendCommand("system/check_account");
 }
 
 void Heos::setUserAccount(QString userName, QString password)
 {
-    QByteArray cmd = "heos://system/sign_in?un=" + userName.toLocal8Bit() + "&pw=" + password.toLocal8Bit() + "\r\n";
-    m_socket->write(cmd);
+    QUrlQuery query;
+    query.addQueryItem("un", userName);
+    query.addQueryItem("pw", password);
+    sendCommand("system/sign_in", query);
 }
 
 void Heos::logoutUserAccount()
 {
-    QByteArray cmd = "heos://system/sign_out\r\n";
-    m_socket->write(cmd);
+    sendCommand("system/sign_out");
 }
 
 void Heos::rebootSpeaker()
 {
-    QByteArray cmd = "heos://system/reboot\r\n";
-    m_socket->write(cmd);
+    sendCommand("system/reboot");
 }
 
 void Heos::prettifyJsonResponse(bool enable)
 {
-    QByteArray cmd = "heos://system/prettify_json_response?enable=";
-    if (enable) {
-        cmd.append("on=\r\n");
-    } else {
-        cmd.append("off=\r\n");
-    }
-    m_socket->write(cmd);
+    QUrlQuery query;
+    query.addQueryItem("enable", enable ? "on" : "off");
+    sendCommand("system/prettify_json_response", query);
 }
 
 /********************************
@@ -163,167 +163,140 @@ void Heos::prettifyJsonResponse(bool enable)
  ********************************/
 void Heos::playNext(int playerId)
 {
-    QByteArray cmd = "heos://player/play_next?pid=" + QVariant(playerId).toByteArray() + "\r\n";
-    qCDebug(dcDenon) << "Play next:" << cmd;
-    m_socket->write(cmd);
+    qCDebug(dcDenon) << "Play next:" << playerId;
+    sendCommand("player/play_next", playerQuery(playerId));
 }
 
 void Heos::playPrevious(int playerId)
 {
-    QByteArray cmd = "heos://player/play_previous?pid=" + QVariant(playerId).toByteArray() + "\r\n";
-    qCDebug(dcDenon) << "Play previous:" << cmd;
-    m_socket->write(cmd);
+    qCDebug(dcDenon) << "Play previous:" << playerId;
+    sendCommand("player/play_previous", playerQuery(playerId));
 }
 
 void Heos::volumeUp(int playerId, int step)
 {
-    QByteArray cmd = "heos://player/volume_up?pid=" + QVariant(playerId).toByteArray() + "&step=" + QVariant(step).toByteArray() + "\r\n";
-    qCDebug(dcDenon) << "Volume up:" << cmd;
-    m_socket->write(cmd);
+    QUrlQuery query = playerQuery(playerId);
+    query.addQueryItem("step", QString::number(step));
+    qCDebug(dcDenon) << "Volume up:" << query.toString();
+    sendCommand("player/volume_up", query);
 }
 
 void Heos::volumeDown(int playerId, int step)
 {
-    QByteArray cmd = "heos://player/volume_down?pid=" + QVariant(playerId).toByteArray() + "&step=" + QVariant(step).toByteArray() + "\r\n";
-    qCDebug(dcDenon) << "Volume down:" << cmd;
-    m_socket->write(cmd);
+    QUrlQuery query = playerQuery(playerId);
+    query.addQueryItem("step", QString::number(step));
+    qCDebug(dcDenon) << "Volume down:" << query.toString();
+    sendCommand("player/volume_down", query);
 }
 
 void Heos::clearQueue(int playerId)
 {
-    QByteArray cmd = "heos://player/clear_queue?pid=" + QVariant(playerId).toByteArray() + "\r\n";
-    qCDebug(dcDenon) << "clear queue:" << cmd;
-    m_socket->write(cmd);
+    qCDebug(dcDenon) << "clear queue:" << playerId;
+    sendCommand("player/clear_queue", playerQuery(playerId));
 }
 
 void Heos::moveQueue(int playerId, int sourcQueueId, int destinationQueueId)
 {
-    QByteArray cmd("heos://player/move_queue_item?");
-    QUrlQuery queryParams;
-    queryParams.addQueryItem("pid", QString::number(playerId));
-    queryParams.addQueryItem("sqid", QString::number(sourcQueueId));
-    queryParams.addQueryItem("dqid", QString::number(destinationQueueId));
-    cmd.append(queryParams.toString());
-    cmd.append("\r\n");
-    qCDebug(dcDenon) << "moving queue:" << cmd;
-    m_socket->write(cmd);
+    QUrlQuery query = playerQuery(playerId);
+    query.addQueryItem("sqid", QString::number(sourcQueueId));
+    query.addQueryItem("dqid", QString::number(destinationQueueId));
+    qCDebug(dcDenon) << "moving queue:" << query.toString();
+    sendCommand("player/move_queue_item", query);
 }
 
 void Heos::checkForFirmwareUpdate(int playerId)
 {
-    QByteArray cmd = "heos://player/check_update?pid=" + QVariant(playerId).toByteArray() + "\r\n";
-    qCDebug(dcDenon) << "Check firmware update:" << cmd;
-    m_socket->write(cmd);
+    qCDebug(dcDenon) << "Check firmware update:" << playerId;
+    sendCommand("player/check_update", playerQuery(playerId));
 }
+
 void Heos::getNowPlayingMedia(int playerId)
 {
-    QByteArray cmd = "heos://player/get_now_playing_media?pid=" + QVariant(playerId).toByteArray() + "\r\n";
-    m_socket->write(cmd);
+    sendCommand("player/get_now_playing_media", playerQuery(playerId));
 }
 
 void Heos::getPlayers()
 {
-    QByteArray cmd = "heos://player/get_players\r\n";
-    m_socket->write(cmd);
+    sendCommand("player/get_players");
 }
 
 void Heos::getPlayerInfo(int playerId)
 {
-    QByteArray cmd = "heos://player/get_player_info?pid=" + QVariant(playerId).toByteArray() + "\r\n";
-    qCDebug(dcDenon) << "Get player info:" << cmd;
-    m_socket->write(cmd);
+    qCDebug(dcDenon) << "Get player info:" << playerId;
+    sendCommand("player/get_player_info", playerQuery(playerId));
 }
 
 void Heos::getVolume(int playerId)
 {
-    QByteArray cmd = "heos://player/get_volume?pid=" + QVariant(playerId).toByteArray() + "\r\n";
-    m_socket->write(cmd);
+    sendCommand("player/get_volume", playerQuery(playerId));
 }
 
 void Heos::setVolume(int playerId, int volume)
 {
-    QByteArray cmd = "heos://player/set_volume?pid=" + QVariant(playerId).toByteArray() + "&level=" + QVariant(volume).toByteArray() + "\r\n";
-    qCDebug(dcDenon) << "Set volume:" << cmd;
-    m_socket->write(cmd);
+    QUrlQuery query = playerQuery(playerId);
+    query.addQueryItem("level", QString::number(volume));
+    qCDebug(dcDenon) << "Set volume:" << query.toString();
+    sendCommand("player/set_volume", query);
 }
 
 void Heos::getMute(int playerId)
 {
-    QByteArray cmd = "heos://player/get_mute?pid=" + QVariant(playerId).toByteArray() + "\r\n";
-    m_socket->write(cmd);
+    sendCommand("player/get_mute", playerQuery(playerId));
 }
 
 void Heos::setMute(int playerId, bool state)
 {
-    QByteArray stateQuery;
-    if(state) {
-        stateQuery = "&state=on";
-    } else {
-        stateQuery = "&state=off";
-    }
-    QByteArray cmd = "heos://player/set_mute?pid=" + QVariant(playerId).toByteArray() + stateQuery + "\r\n";
-    qCDebug(dcDenon) << "Set mute:" << cmd;
-    m_socket->write(cmd);
+    QUrlQuery query = playerQuery(playerId);
+    query.addQueryItem("state", state ? "on" : "off");
+    qCDebug(dcDenon) << "Set mute:" << query.toString();
+    sendCommand("player/set_mute", query);
 }
 
 void Heos::setPlayerState(int playerId, PLAYER_STATE state)
 {
-    QByteArray playerStateQuery;
-
+    QUrlQuery query = playerQuery(playerId);
     if (state == PLAYER_STATE_PLAY){
-        playerStateQuery = "&state=play";
+        query.addQueryItem("state", "play");
     } else if (state == PLAYER_STATE_PAUSE){
-        playerStateQuery = "&state=pause";
+        query.addQueryItem("state", "pause");
     } else if (state == PLAYER_STATE_STOP){
-        playerStateQuery = "&state=stop";
+        query.addQueryItem("state", "stop");
     }
 
-    QByteArray cmd = "heos://player/set_play_state?pid=" + QVariant(playerId).toByteArray() + playerStateQuery + "\r\n";
-    qCDebug(dcDenon) << "Set play mode:" << cmd;
-    m_socket->write(cmd);
+    qCDebug(dcDenon) << "Set play mode:" << query.toString();
+    sendCommand("player/set_play_state", query);
 }
 
 void Heos::getPlayerState(int playerId)
 {
-    QByteArray cmd = "heos://player/get_play_state?pid=" + QVariant(playerId).toByteArray() + "\r\n";
-    m_socket->write(cmd);
+    sendCommand("player/get_play_state", playerQuery(playerId));
 }
 
 
 void Heos::setPlayMode(int playerId, REPEAT_MODE repeatMode, bool shuffle)
 {
-    QByteArray repeatModeQuery;
-
+    QUrlQuery query = playerQuery(playerId);
     if (repeatMode == REPEAT_MODE_OFF) {
-        repeatModeQuery = "&repeat=off";
+        query.addQueryItem("repeat", "off");
     } else if (repeatMode == REPEAT_MODE_ONE) {
-        repeatModeQuery = "&repeat=on_one";
+        query.addQueryItem("repeat", "on_one");
     } else if (repeatMode == REPEAT_MODE_ALL) {
-        repeatModeQuery = "&repeat=on_all";
-    }
-
-    QByteArray shuffleQuery;
-    if (shuffle) {
-        shuffleQuery = "&shuffle=on";
-    } else {
-        shuffleQuery = "&shuffle=off";
+        query.addQueryItem("repeat", "on_all");
     }
+    query.addQueryItem("shuffle", shuffle ? "on" : "off");
 
-    QByteArray cmd = "heos://player/set_play_mode?pid=" + QVariant(playerId).toByteArray() + repeatModeQuery + shuffleQuery + "\r\n";
-    qCDebug(dcDenon) << "Set play mode:" << cmd;
-    m_socket->write(cmd);
+    qCDebug(dcDenon) << "Set play mode:" << query.toString();
+    sendCommand("player/set_play_mode", query);
 }
 
 void Heos::getPlayMode(int playerId)
 {
-    QByteArray cmd = "heos://player/get_play_mode?pid=" + QVariant(playerId).toByteArray() + "\r\n";
-    m_socket->write(cmd);
+    sendCommand("player/get_play_mode", playerQuery(playerId));
 }
 
 void Heos::getQueue(int playerId)
 {
-    QByteArray cmd = "heos://player/get_queue?pid=" + QVariant(playerId).toByteArray() + "\r\n";
-    m_socket->write(cmd);
+    sendCommand("player/get_queue", playerQuery(playerId));
 }
 
 /********************************
@@ -331,79 +304,72 @@ void Heos::getQueue(int playerId)
  ********************************/
 void Heos::getGroups()
 {
-    QByteArray cmd = "heos://group/get_groups\r\n";
-    m_socket->write(cmd);
+    sendCommand("group/get_groups");
 }
 
 void Heos::getGroupInfo(int groupId)
 {
-    QByteArray cmd = "heos://group/get_group_info?gid=" + QVariant(groupId).toByteArray() + "\r\n";
-    m_socket->write(cmd);
+    sendCommand("group/get_group_info", groupQuery(groupId));
 }
 
 void Heos::getGroupVolume(int groupId)
 {
-    QByteArray cmd = "heos://group/get_volume?gid=" + QVariant(groupId).toByteArray() + "\r\n";
-    m_socket->write(cmd);
+    sendCommand("group/get_volume", groupQuery(groupId));
 }
 
 void Heos::getGroupMute(int groupId)
 {
-    QByteArray cmd = "heos://group/get_mute?gid=" + QVariant(groupId).toByteArray() + "\r\n";
-    m_socket->write(cmd);
+    sendCommand("group/get_mute", groupQuery(groupId));
 }
 
 
 void Heos::setGroupVolume(int groupId, bool volume)
 {
-    QByteArray cmd = "heos://group/set_volume?gid=" + QVariant(groupId).toByteArray() + "&level=" + QVariant(volume).toByteArray() + "\r\n";
-    qCDebug(dcDenon) << "Volume up:" << cmd;
-    m_socket->write(cmd);
+    QUrlQuery query = groupQuery(groupId);
+    query.addQueryItem("level", QString::number(volume));
+    qCDebug(dcDenon) << "Volume up:" << query.toString();
+    sendCommand("group/set_volume", query);
 }
 
 void Heos::setGroupMute(int groupId, bool mute)
 {
-    QByteArray cmd = "heos://group/set_mute?gid=" + QVariant(groupId).toByteArray() + "&state=";
-    if (mute) {
-        cmd.append("on\r\n");
-    } else {
-        cmd.append("off\r\n");
-    }
-    m_socket->write(cmd);
+    QUrlQuery query = groupQuery(groupId);
+    query.addQueryItem("state", mute ? "on" : "off");
+    sendCommand("group/set_mute", query);
 }
 
 void Heos::setGroup(QList<int> playerIds)
 {
-    QByteArray cmd = "heos://group/set_group?pid=";
+    QStringList playerIdList;
     foreach(int playerId, playerIds) {
-        cmd.append(QVariant(playerId).toByteArray());
-        cmd.append(',');
+        playerIdList.append(QString::number(playerId));
     }
-    cmd.resize(cmd.size()-1); //remove last ','
-    cmd.append("\r\n");
-    qCDebug(dcDenon) << "Set group:" << cmd;
-    m_socket->write(cmd);
+    QUrlQuery query;
+    query.addQueryItem("pid", playerIdList.join(','));
+    qCDebug(dcDenon) << "Set group:" << query.toString();
+    sendCommand("group/set_group", query);
 }
 
 void Heos::toggleGroupMute(int groupId)
 {
-    QByteArray cmd = "heos://group/toggle_mute?gid=" + QVariant(groupId).toByteArray() + "\r\n";
-    qCDebug(dcDenon) << "Volume up:" << cmd;
-    m_socket->write(cmd);
+    qCDebug(dcDenon) << "Toggle group mute:" << groupId;
+    sendCommand("group/toggle_mute", groupQuery(groupId));
 }
 
 void Heos::groupVolumeUp(int groupId, int step)
 {
-    QByteArray cmd = "heos://group/volume_up?pid=" + QVariant(groupId).toByteArray() + "&step=" + QVariant(step).toByteArray() + "\r\n";
-    qCDebug(dcDenon) << "Group volume up:" << cmd;
-    m_socket->write(cmd);
+    QUrlQuery query = groupQuery(groupId);
+    query.addQueryItem("step", QString::number(step));
+    qCDebug(dcDenon) << "Group volume up:" << query.toString();
+    sendCommand("group/volume_up", query);
 }
 
 void Heos::groupVolumeDown(int groupId, int step)
 {
-    QByteArray cmd = "heos://group/volume_down?pid=" + QVariant(groupId).toByteArray() + "&step=" + QVariant(step).toByteArray() + "\r\n";
-    qCDebug(dcDenon) << "Group volume up:" << cmd;
-    m_socket->write(cmd);
+    QUrlQuery query = groupQuery(groupId);
+    query.addQueryItem("step", QString::number(step));
+    qCDebug(dcDenon) << "Group volume down:" << query.toString();
+    sendCommand("group/volume_down", query);
 }
 
 
@@ -412,142 +378,94 @@ void Heos::groupVolumeDown(int groupId, int step)
  ********************************/
 quint32 Heos::getMusicSources()
 {
-    quint32 sequence = createRandomNumber();
-    QByteArray cmd = "heos://browse/get_music_sources?";
-    QUrlQuery queryParams;
-    queryParams.addQueryItem("SEQUENCE", QString::number(sequence));
-    cmd.append(queryParams.toString());
-    cmd.append("\r\n");
-    qCDebug(dcDenon) << "Get music sources:" << cmd;
-    m_socket->write(cmd);
-    return sequence;
+    qCDebug(dcDenon) << "Get music sources";
+    return sendCommand("browse/get_music_sources");
 }
 
 quint32 Heos::getSourceInfo(const QString &sourceId)
 {
-    quint32 sequence = createRandomNumber();
-    QByteArray cmd = "heos://browse/get_source_info?";
-    QUrlQuery queryParams;
-    queryParams.addQueryItem("sid", sourceId);
-    queryParams.addQueryItem("SEQUENCE", QString::number(sequence));
-    cmd.append(queryParams.toString());
-    cmd.append("\r\n");
-    qCDebug(dcDenon) << "Get source info:" << cmd;
-    m_socket->write(cmd);
-    return sequence;
+    QUrlQuery query;
+    query.addQueryItem("sid", sourceId);
+    qCDebug(dcDenon) << "Get source info:" << query.toString();
+    return sendCommand("browse/get_source_info", query);
 }
 
 quint32 Heos::getSearchCriteria(const QString &sourceId)
 {
-    quint32 sequence = createRandomNumber();;
-    QByteArray cmd = "heos://browse/get_search_criteria?";
-    QUrlQuery queryParams;
-    queryParams.addQueryItem("sid", sourceId);
-    cmd.append(queryParams.toString());
-    cmd.append("\r\n");
-    qCDebug(dcDenon) << "Get search criteria:" << cmd;
-    m_socket->write(cmd);
-    return sequence;
+    QUrlQuery query;
+    query.addQueryItem("sid", sourceId);
+    qCDebug(dcDenon) << "Get search criteria:" << query.toString();
+    return sendCommand("browse/get_search_criteria", query);
 }
 
 quint32 Heos::browseSource(const QString &sourceId)
 {
-    quint32 sequence = createRandomNumber();
-    QByteArray cmd = "heos://browse/browse?";
-    QUrlQuery queryParams;
-    queryParams.addQueryItem("sid", sourceId);
-    queryParams.addQueryItem("SEQUENCE", QString::number(sequence));
-    cmd.append(queryParams.toString());
-    cmd.append("\r\n");
-    qCDebug(dcDenon) << "Browse source:" << cmd;
-    m_socket->write(cmd);
-    return sequence;
+    QUrlQuery query;
+    query.addQueryItem("sid", sourceId);
+    qCDebug(dcDenon) << "Browse source:" << query.toString();
+    return sendCommand("browse/browse", query);
 }
 
 quint32 Heos::browseSourceContainers(const QString &sourceId, const QString &containerId)
 {
-    quint32 sequence = createRandomNumber();;
-    QByteArray cmd = "heos://browse/browse?";
-    QUrlQuery queryParams;
-    queryParams.addQueryItem("sid", sourceId);
-    queryParams.addQueryItem("cid", containerId);
-    queryParams.addQueryItem("SEQUENCE", QString::number(sequence));
-    cmd.append(queryParams.toString());
-    cmd.append("\r\n");
-    qCDebug(dcDenon) << "Browsing container:" << cmd;
-    m_socket->write(cmd);
-    return sequence;
+    QUrlQuery query;
+    query.addQueryItem("sid", sourceId);
+    query.addQueryItem("cid", containerId);
+    qCDebug(dcDenon) << "Browsing container:" << query.toString();
+    return sendCommand("browse/browse", query);
 }
 
 quint32 Heos::playStation(int playerId, const QString &sourceId, const QString &containerId, const QString &mediaId, const QString &stationName)
 {
-    quint32 sequence = createRandomNumber();;
-    QByteArray cmd("heos://browse/play_stream?");
-    QUrlQuery queryParams;
-    queryParams.addQueryItem("pid", QString::number(playerId));
+    QUrlQuery query = playerQuery(playerId);
     if (!sourceId.isEmpty()) {
-        queryParams.addQueryItem("sid", sourceId);
+        query.addQueryItem("sid", sourceId);
     }
     if (!containerId.isEmpty()) {
-        queryParams.addQueryItem("cid", containerId);
+        query.addQueryItem("cid", containerId);
     }
     if (!mediaId.isEmpty()) {
-        queryParams.addQueryItem("mid", mediaId);
+        query.addQueryItem("mid", mediaId);
     }
     if (!stationName.isEmpty()) {
-        queryParams.addQueryItem("name", stationName);
+        query.addQueryItem("name", stationName);
     }
-    queryParams.addQueryItem("SEQUENCE", QString::number(sequence));
-    cmd.append(queryParams.toString());
-    cmd.append("\r\n");
-    qCDebug(dcDenon) << "playing station:" << cmd;
-    m_socket->write(cmd);
-    return sequence;
+    qCDebug(dcDenon) << "playing station:" << query.toString();
+    return sendCommand("browse/play_stream", query);
 }
 
 quint32 Heos::playPresetStation(int playerId, int presetNumber)
 {
-    quint32 sequence = createRandomNumber();
-    QByteArray cmd("heos://browse/play_preset?");
-    QUrlQuery queryParams;
-    queryParams.addQueryItem("pid", QString::number(playerId));
-    queryParams.addQueryItem("preset", QString::number(presetNumber));
-    queryParams.addQueryItem("SEQUENCE", QString::number(sequence));
-    cmd.append(queryParams.toString());
-    cmd.append("\r\n");
-    qCDebug(dcDenon) << "playing preset station:" << cmd;
-    m_socket->write(cmd);
-    return sequence;
+    QUrlQuery query = playerQuery(playerId);
+    query.addQueryItem("preset", QString::number(presetNumber));
+    qCDebug(dcDenon) << "playing preset station:" << query.toString();
+    return sendCommand("browse/play_preset", query);
 }
 
 quint32 Heos::playInputSource(int playerId, const QString &inputName)
 {
-    quint32 sequence = createRandomNumber();
-    QByteArray cmd("heos://browse/play_input?");
-    QUrlQuery queryParams;
-    queryParams.addQueryItem("pid", QString::number(playerId));
-    queryParams.addQueryItem("input", inputName);
-    queryParams.addQueryItem("SEQUENCE", QString::number(sequence));
-    cmd.append(queryParams.toString());
-    cmd.append("\r\n");
-    qCDebug(dcDenon) << "playing input source:" << cmd;
-    m_socket->write(cmd);
-    return sequence;
+    QUrlQuery query = playerQuery(playerId);
+    query.addQueryItem("input", inputName);
+    qCDebug(dcDenon) << "playing input source:" << query.toString();
+    return sendCommand("browse/play_input", query);
 }
 
 quint32 Heos::playUrl(int playerId, const QUrl &mediaUrl)
 {
-    quint32 sequence = createRandomNumber();
-    QByteArray cmd("heos://browse/play_stream?");
-    QUrlQuery queryParams;
-    queryParams.addQueryItem("pid", QString::number(playerId));
-    queryParams.addQueryItem("url", mediaUrl.toString());
-    queryParams.addQueryItem("SEQUENCE", QString::number(sequence));
-    cmd.append(queryParams.toString());
-    cmd.append("\r\n");
-    qCDebug(dcDenon) << "playing url:" << cmd;
-    m_socket->write(cmd);
-    return sequence;
+    QUrlQuery query = playerQuery(playerId);
+    query.addQueryItem("url", mediaUrl.toString());
+    qCDebug(dcDenon) << "playing url:" << query.toString();
+    return sendCommand("browse/play_stream", query);
+}
+
+quint32 Heos::addContainerToQueue(int playerId, const QString &sourceId, const QString &containerId, ADD_CRITERIA addCriteria)
+{
+    QUrlQuery query = playerQuery(playerId);
+    query.addQueryItem("sid", sourceId);
+    query.addQueryItem("cid", containerId);
+    query.addQueryItem("aid", QString::number(addCriteria));
+    qCDebug(dcDenon) << "Adding to queue:" << query.toString();
+    return sendCommand("browse/add_to_queue", query);
 }
 
 void Heos::onConnected()
@@ -559,28 +477,16 @@ void Heos::onConnected()
 
 void Heos::onDisconnected()
 {
+    // Requests and responses of the old connection can't be matched any more
+    m_requestsInFlight.clear();
+    m_requestQueue.clear();
+    m_requestTimeoutTimer->stop();
+
     m_reconnectTimer->start();
     qCDebug(dcDenon()) << "Heos: Disconnected from" << m_hostAddress.toString() << "try reconnecting in 5 seconds";
     emit connectionStatusChanged(false);
 }
 
-quint32 Heos::addContainerToQueue(int playerId, const QString &sourceId, const QString &containerId, ADD_CRITERIA addCriteria)
-{
-    quint32 sequence = createRandomNumber();
-    QByteArray cmd("heos://browse/add_to_queue?");
-    QUrlQuery queryParams;
-    queryParams.addQueryItem("pid", QString::number(playerId));
-    queryParams.addQueryItem("sid", sourceId);
-    queryParams.addQueryItem("cid", containerId);
-    queryParams.addQueryItem("aid", QString::number(addCriteria));
-    queryParams.addQueryItem("SEQUENCE", QString::number(sequence));
-    cmd.append(queryParams.toString());
-    cmd.append("\r\n");
-    qCDebug(dcDenon) << "Adding to queue:" << cmd;
-    m_socket->write(cmd);
-    return sequence;
-}
-
 void Heos::onError(QAbstractSocket::SocketError socketError)
 {
     qCWarning(dcDenon) << "Heos: Socket error:" << socketError << m_socket->errorString();
@@ -588,602 +494,593 @@ void Heos::onError(QAbstractSocket::SocketError socketError)
 
 void Heos::readData()
 {
-    QByteArray data;
-    QJsonParseError error;
-
     while (m_socket->canReadLine()) {
-        data = m_socket->readLine();
+        QByteArray data = m_socket->readLine();
+        QJsonParseError error;
         QJsonDocument jsonDoc = QJsonDocument::fromJson(data, &error);
         if (error.error != QJsonParseError::NoError) {
             qCWarning(dcDenon) << "failed to parse json :" << error.errorString();
-            return;
+            continue;
         }
+
         QVariantMap dataMap = jsonDoc.toVariant().toMap();
-        if (dataMap.contains("heos")) {
-            QString command = dataMap.value("heos").toMap().value("command").toString();
-            QUrlQuery message(dataMap.value("heos").toMap().value("message").toString());
-            bool success = false;
-            if(dataMap.value("heos").toMap().contains("result")) {
-                //If the message doesn't contain result it is an event message
-                success = dataMap.value("heos").toMap().value("result").toString().contains("success");
-                if (!success) {
-                    qCWarning(dcDenon()) << "Command:" << command << "was not successfull. Message:" << message.toString();
-                    if (command == "system/sign_in") {
-                        emit userChanged(false, "");
-                    }
+        if (!dataMap.contains("heos"))
+            continue;
+
+        QVariantMap heosMap = dataMap.value("heos").toMap();
+        HeosResponse response;
+        response.command = heosMap.value("command").toString().trimmed();
+        response.message = QUrlQuery(heosMap.value("message").toString());
+        response.payload = dataMap.value("payload");
+        response.sequence = response.message.queryItemValue("SEQUENCE").toUInt();
+
+        //If the message doesn't contain result it is an event message
+        if (heosMap.contains("result")) {
+            response.success = heosMap.value("result").toString().contains("success");
+
+            // The final response of the request follows later
+            if (!response.message.hasQueryItem("command under process"))
+                finishRequest(response.command, response.sequence);
+
+            if (!response.success) {
+                qCWarning(dcDenon()) << "Command:" << response.command << "was not successfull. Message:" << response.message.toString();
+                if (response.command == "system/sign_in") {
+                    emit userChanged(false, "");
                 }
             }
-            /*
-             * 4.1 System Commands
-             *  4.1.1 Register for Change Events
-             *  4.1.2 HEOS Account Check
-             *  4.1.3 HEOS Account Sign In
-             *  4.1.4 HEOS Account Sign Out
-             *  4.1.5 HEOS System Heart Beat
-             *  4.1.6 HEOS Speaker Reboot
-             *  4.1.7 Prettify JSON response
-            */
-            if (command.startsWith("system")) {
-                if (command.contains("register_for_change_events")) {
-                    QString enabled = message.queryItemValue("enabled");
-                    if (enabled.contains("off")) {
-                        qDebug(dcDenon) << "Events are disabled";
-                        m_eventRegistered = false;
-                        emit systemEventsEnabled(false);
-                    } else {
-                        qDebug(dcDenon) << "Events are enabled";
-                        m_eventRegistered = true;
-                        emit systemEventsEnabled(true);
-                    }
-
-                } else if (command.contains("check_account")) {
-
-                    qDebug(dcDenon()) << "System command check_account:" << message.toString();
-                    bool signedIn;
-                    QString username = "";
-                    if (message.hasQueryItem("signed_in")){
-                        signedIn = true;
-                        username = message.queryItemValue("un");
-                    } else {
-                        signedIn = false;
-                    }
-                    emit userChanged(signedIn, username);
-
-                } else if (command.contains("sign_in")) {
-
-                    qDebug(dcDenon()) << "System command sign_in:" << message.toString();
-
-                    if (message.hasQueryItem("signed_in")) {
-                        QString username = message.queryItemValue("un");
-                        emit userChanged(true, username);
-
-                    } // otherwise it will be command under process and we will wait for the event
-                } else if (command.contains("sign_out")) {
-
-                    qDebug(dcDenon()) << "System command sign_out:" << message.toString();
-                    emit userChanged(false, "");
+        } else {
+            response.success = true;
+        }
 
-                } else if (command.contains("heart_beat")) {
+        ResponseHandler handler = responseHandlers().value(response.command);
+        if (!handler) {
+            qCDebug(dcDenon) << "Unhandled Heos command" << response.command;
+            continue;
+        }
+        (this->*handler)(response);
+    }
+}
 
-                } else if (command.contains("reboot")) {
+quint32 Heos::sendCommand(const QString &command, QUrlQuery query)
+{
+    // Every request gets a sequence number, the HEOS device returns it in the message of the response
+    quint32 sequence = createRandomNumber();
+    query.addQueryItem("SEQUENCE", QString::number(sequence));
 
-                } else if (command.contains("prettify_json_response")) {
+    QByteArray data = "heos://" + command.toUtf8() + "?" + query.toString().toUtf8() + "\r\n";
 
-                }  else {
-                    qDebug(dcDenon) << "Unhandled Heos system command" << command;
-                }
-                /* 4.2 Player Commands
-             *  4.2.1 Get Players
-             *  4.2.2 Get Player Info
-             *  4.2.3 Get Play State
-             *  4.2.4 Set Play State
-             *  4.2.5 Get Now Playing Media
-             *  4.2.6 Get Volume
-             *  4.2.7 Set Volume
-             *  4.2.8 Volume Up
-             *  4.2.9 Volume Down
-             *  4.2.10 Get Mute
-             *  4.2.11 Set Mute
-             *  4.2.12 Toggle Mute
-             *  4.2.13 Get Play Mode
-             *  4.2.14 Set Play Mode
-             *  4.2.15 Get Queue
-             *  4.2.16 Play Queue Item
-             *  4.2.17 Remove Item(s) from Queue
-             *  4.2.18 Save Queue as Playlist
-             *  4.2.19 Clear Queue
-             *  4.2.20 Move Queue
-             *  4.2.21 Play Next
-             *  4.2.22 Play Previous
-             *  4.2.23 Set QuickSelect [LS AVR Only]
-             *  4.2.24 Play QuickSelect [LS AVR Only]
-             *  4.2.25 Get QuickSelects [LS AVR Only]
-             *  4.2.26 Check for Firmware Update
-             */
-            } else if (command.startsWith("player")) {
-                int playerId = 0;
-                if (message.hasQueryItem("pid")) {
-                    playerId = message.queryItemValue("pid").toInt();
-                }
+    PendingRequest request;
+    request.sequence = sequence;
+    request.command = command;
+    request.data = data;
 
-                if (command.contains("get_players")) {
-                    QVariantList payloadVariantList = jsonDoc.toVariant().toMap().value("payload").toList();
-                    QList<HeosPlayer *> players;
-                    foreach (const QVariant &payloadEntryVariant, payloadVariantList) {
-                        HeosPlayer *player = new HeosPlayer(payloadEntryVariant.toMap().value("pid").toInt());
-                        player->setSerialNumber(payloadEntryVariant.toMap().value("serial").toString());
-                        player->setName(payloadEntryVariant.toMap().value("name").toString());
-                        getPlayerInfo(player->playerId());
-                        players.append(player);
-                    }
-                    emit playersRecieved(players);
-
-                } else if (command.contains("get_player_info")) {
-                    //update heos player info
-                    int pid = dataMap.value("payload").toMap().value("pid").toInt();
-                    HeosPlayer *player = new HeosPlayer(pid);
-                    player->setName(dataMap.value("payload").toMap().value("name").toString());
-                    if (dataMap.value("payload").toMap().contains("gid")) {
-                        player->setGroupId(dataMap.value("payload").toMap().value("gid").toInt());
-                    } else {
-                        player->setGroupId(-1); //no group assigned
-                    }
-                    player->setPlayerModel(dataMap.value("payload").toMap().value("model").toString());
-                    player->setPlayerVersion(dataMap.value("payload").toMap().value("version").toString());
-                    player->setLineOut(dataMap.value("payload").toMap().value("lineout").toString());
-                    player->setControl(dataMap.value("payload").toMap().value("control").toString());
-                    player->setSerialNumber(dataMap.value("payload").toMap().value("serial").toString());
-                    player->setNetwork(dataMap.value("payload").toMap().value("network").toString());
-                    emit playerInfoRecieved(player);
-
-                } else if (command.contains("get_now_playing_media")) {
-
-                    QString artist = dataMap.value("payload").toMap().value("artist").toString();
-                    QString song = dataMap.value("payload").toMap().value("song").toString();
-                    QString artwork = dataMap.value("payload").toMap().value("image_url").toString();
-                    QString album = dataMap.value("payload").toMap().value("album").toString();
-                    QString sourceId = dataMap.value("payload").toMap().value("sid").toString();
-                    qDebug(dcDenon) << "Now playing" << playerId << sourceId << artist << album << song;
-                    emit nowPlayingMediaStatusReceived(playerId, sourceId, artist, album, song, artwork);
-
-                } else if (command.contains("get_play_state") || command.contains("set_play_state")) {
-                    if (message.hasQueryItem("state")) {
-                        PLAYER_STATE playState =  PLAYER_STATE_STOP;
-                        if (message.queryItemValue("state").contains("play")) {
-                            playState =  PLAYER_STATE_PLAY;
-                        } else if (message.queryItemValue("state").contains("pause")) {
-                            playState = PLAYER_STATE_PAUSE;
-                        } else if (message.queryItemValue("state").contains("stop")) {
-                            playState =  PLAYER_STATE_STOP;
-                        }
-                        emit playerPlayStateReceived(playerId, playState);
-                    }
-                } else if (command.contains("get_volume") || command.contains("set_volume")) {
-                    if (message.hasQueryItem("level")) {
-                        int volume = message.queryItemValue("level").toInt();
-                        emit playerVolumeReceived(playerId, volume);
-                    }
-                } else if (command.contains("get_mute") || command.contains("set_mute")) {
-                    if (message.hasQueryItem("state")) {
-                        QString state = message.queryItemValue("state");
-                        if (state.contains("on")) {
-                            emit playerMuteStatusReceived(playerId, true);
-                        } else {
-                            emit playerMuteStatusReceived(playerId, false);
-                        }
-                    }
-                } else if (command.contains("get_play_mode") || command.contains("set_play_mode")) {
-                    if (message.hasQueryItem("shuffle") && message.hasQueryItem("repeat")) {
-                        bool shuffle;
-                        if (message.queryItemValue("shuffle").contains("on")){
-                            shuffle = true;
-                        } else {
-                            shuffle = false;
-                        }
-                        emit playerShuffleModeReceived(playerId, shuffle);
-
-                        REPEAT_MODE repeatMode = REPEAT_MODE_OFF;
-                        if (message.queryItemValue("repeat").contains("on_all")){
-                            repeatMode = REPEAT_MODE_ALL;
-                        } else if (message.queryItemValue("repeat").contains("on_one")){
-                            repeatMode = REPEAT_MODE_ONE;
-                        } else  if (message.queryItemValue("repeat").contains("off")){
-                            repeatMode = REPEAT_MODE_OFF;
-                        }
-                        emit playerRepeatModeReceived(playerId, repeatMode);
-                    }
-                } else if (command.contains("check_update")) {
-                    QVariantMap payloadVariantMap = jsonDoc.toVariant().toMap().value("payload").toMap();
-                    bool updateExist = payloadVariantMap.value("update").toString().contains("exist");
-                    emit playerUpdateAvailable(playerId, updateExist);
-                } else {
-                    qDebug(dcDenon) << "Unhandled Heos group command" << command;
-                }
-                /*
-             * 4.3 Group Commands
-             *  4.3.1 Get Groups
-             *  4.3.2 Get Group Info
-             *  4.3.3 Set Group
-             *  4.3.4 Get Group Volume
-             *  4.3.5 Set Group Volume
-             *  4.2.6 Group Volume Up
-             *  4.2.7 Group Volume Down
-             *  4.3.8 Get Group Mute
-             *  4.3.9 Set Group Mute
-             *  4.3.10 Toggle Group Mute
-             */
-            } else if (command.startsWith("group")) {
-                int groupId = 0;
-                if (message.hasQueryItem("gid")) {
-                    qDebug(dcDenon) << "Group id" << message.queryItemValue("gid");
-                    groupId = message.queryItemValue("gid").toInt();
-                }
-                if (command.contains("get_groups")) {
-                    QVariantList payloadVariantList = jsonDoc.toVariant().toMap().value("payload").toList();
-                    QList<GroupObject> groups;
-                    foreach (const QVariant &payloadEntryVariant, payloadVariantList) {
-                        GroupObject group;
-                        group.groupId = payloadEntryVariant.toMap().value("gid").toInt();
-                        group.name = payloadEntryVariant.toMap().value("name").toString();
-                        if (!payloadEntryVariant.toMap().value("players").toList().isEmpty()) {
-                            QVariantList playerlist = payloadEntryVariant.toMap().value("players").toList();
-                            foreach (const QVariant &playerVariant, playerlist) {
-                                PlayerObject player;
-                                player.name = playerVariant.toMap().value("name").toString();
-                                player.playerId = playerVariant.toMap().value("pid").toInt();
-                                group.players.append(player);
-                            }
-                        }
-                        groups.append(group);
-                    }
-                    emit groupsReceived(groups);
-                } else if (command.contains("get_group_info")) {
-                    QVariantMap payloadVariantMap = jsonDoc.toVariant().toMap().value("payload").toMap();
-                    GroupObject group;
-                    group.groupId = payloadVariantMap.value("gid").toInt();
-                    group.name = payloadVariantMap.value("name").toString();
-                    if (!payloadVariantMap.value("players").toList().isEmpty()) {
-                        QVariantList playerlist = payloadVariantMap.value("players").toList();
-                        foreach (const QVariant &playerVariant, playerlist) {
-                            PlayerObject player;
-                            player.name = playerVariant.toMap().value("name").toString();
-                            player.playerId = playerVariant.toMap().value("pid").toInt();
-                            group.players.append(player);
-                        }
-                    }
-                    emit groupInfoReceived(group);
-
-                } else if (command.contains("set_group")) {
-                    if (message.hasQueryItem("gid")) {
-
-                        int groupId = message.queryItemValue("gid").toInt();
-                        QString groupName = message.queryItemValue("name");
-                        emit setGroupReceived(groupId, groupName);
-                    } else {
-                        //No group Id so it must have been an ungoup request
-                        int playerId = message.queryItemValue("pid").toInt();
-                        emit deleteGroupReceived(playerId);
-                    }
-
-                } else if (command.contains("get_volume") || command.contains("set_volume")) {
-
-                    if (message.hasQueryItem("level")) {
-                        int volume = message.queryItemValue("level").toInt();
-                        emit groupVolumeReceived(groupId, volume);
-                    }
-
-                } else if (command.contains("volume_up") || command.contains("volume_down")) {
-
-                } else if (command.contains("get_mute") || command.contains("set_mute")) {
-
-                    if (message.hasQueryItem("state")) {
-                        QString state = message.queryItemValue("state");
-                        if (state.contains("on")) {
-                            emit playerMuteStatusReceived(groupId, true);
-                        } else {
-                            emit playerMuteStatusReceived(groupId, false);
-                        }
-                    }
-                } else if (command.contains("toggle_mute")) {
-
-                } else {
-                    qDebug(dcDenon) << "Unhandled Heos group command" << command;
-                }
+    if (m_requestsInFlight.count() >= m_maxRequestsInFlight) {
+        m_requestQueue.enqueue(request);
+        if (m_requestQueue.count() > 100)
+            qCWarning(dcDenon()) << "Heos: Request queue is growing," << m_requestQueue.count() << "requests waiting";
 
+        return sequence;
+    }
 
-                /* 4.4 Browse Commands
-                                                  *  4.4.1 Get Music Sources                         - "command": "browse/get_music_sources"
-                                                  *  4.4.2 Get Source Info                           - "command": "browse/get_source_info"
-                                                  *  4.4.3 Browse Source                             - "command": "browse/browse",
-                                                  *  4.4.4 Browse Source Containers                  - "command": "browse/browse",
-                                                  *  4.4.5 Get Source Search Criteria                - "command": "browse/get_search_criteria"
-                                                  *  4.4.6 Search                                    - "command": "browse/search"
-                                                  *  4.4.7 Play Station                              - "command": "browse/play_stream"
-                                                  *  4.4.8 Play Preset Station                       - "command": "browse/play_preset"
-                                                  *  4.4.9 Play Input source                         - "command": "browse/play_input"
-                                                  *  4.4.10 Play URL                                 - "command": "browse/play_stream "
-                                                  *  4.4.11 Add Container to Queue with Options      - "command": "browse/add_to_queue"
-                                                  *  4.4.12 Add Track to Queue with Options          - "command": "browse/add_to_queue"
-                                                  *  4.4.14 Rename HEOS Playlist                     - "command": "browse/rename_playlist"
-                                                  *  4.4.15 Delete HEOS Playlist                     - "command": "browse/delete_playlist "
-                                                  *  4.4.17 Retrieve Album Metadata                  - "command": "browse/retrieve_metadata",
-                                                 */
-            } else if (command.startsWith("browse") || command.startsWith(" browse")) {
-
-                quint32 sequenceNumber = 0;
-                if (message.hasQueryItem("SEQUENCE")) {
-                    qDebug(dcDenon) << "Sequence number" << message.queryItemValue("SEQUENCE");
-                    sequenceNumber = message.queryItemValue("SEQUENCE").toUInt();
-                }
+    writeRequest(request);
+    return sequence;
+}
 
-                if (command.contains("get_music_sources") || command.contains("get_source_info")) {
-                    qDebug(dcDenon()) << "Get music source request response received" << command;
-                    QVariantList payloadVariantList = jsonDoc.toVariant().toMap().value("payload").toList();
-                    QList<MusicSourceObject> musicSources;
-                    if (success) {
-                        foreach (const QVariant &payloadEntryVariant, payloadVariantList) {
-                            MusicSourceObject source;
-                            source.name = payloadEntryVariant.toMap().value("name").toString();
-                            source.image_url = payloadEntryVariant.toMap().value("image_url").toString();
-                            source.type = payloadEntryVariant.toMap().value("type").toString();
-                            source.sourceId = payloadEntryVariant.toMap().value("sid").toInt();
-                            source.available = payloadEntryVariant.toMap().value("available").toString().contains("true");
-                            source.serviceUsername = payloadEntryVariant.toMap().value("service_username").toString();
-                            musicSources.append(source);
-                        }
-                        emit musicSourcesReceived(sequenceNumber, musicSources);
-                    }
-
-                } else if (command.contains("browse/browse")) {
-                    qDebug(dcDenon()) << "Browse response:"  << jsonDoc.toVariant().toMap().value("payload");
-                    QVariantList payloadVariantList = jsonDoc.toVariant().toMap().value("payload").toList();
-                    QString sourceId;
-                    QString containerId;
-                    if (message.hasQueryItem("sid")) {
-                        sourceId = message.queryItemValue("sid");
-                    }
-                    if (message.hasQueryItem("cid")) {
-                        containerId = message.queryItemValue("cid");
-                    }
-
-                    if (message.toString().contains("command under process")){
-                        qDebug(dcDenon()) << "Browse command is beeing processed";
-                        return;
-                    }
-                    if (success) {
-                        QList<MusicSourceObject> musicSources;
-                        QList<MediaObject> mediaItems;
-                        foreach (const QVariant &payloadEntryVariant, payloadVariantList) {
-                            QString type = payloadEntryVariant.toMap().value("type").toString();
-                            if (type == "source") {
-                                MusicSourceObject source;
-                                source.name = payloadEntryVariant.toMap().value("name").toString();
-                                source.image_url = payloadEntryVariant.toMap().value("image_url").toString();
-                                source.type = payloadEntryVariant.toMap().value("type").toString();
-                                source.sourceId = payloadEntryVariant.toMap().value("sid").toInt();
-                                qDebug(dcDenon()) << "Source" << source.name << source.type << source.sourceId << payloadEntryVariant.toMap().value("sid");
-                                //source.available = payloadEntryVariant.toMap().value("available").toString().contains("true");
-                                //source.serviceUsername = payloadEntryVariant.toMap().value("service_username").toString();
-                                musicSources.append(source);
-                            } else {
-                                MediaObject media;
-                                qDebug(dcDenon()) << "Media Item" << payloadEntryVariant.toMap().value("mid").toString() << payloadEntryVariant.toMap().value("cid").toString();
-                                media.name = payloadEntryVariant.toMap().value("name").toString();
-                                if (payloadEntryVariant.toMap().contains("cid")) {
-                                    media.containerId = payloadEntryVariant.toMap().value("cid").toString();
-                                } else {
-                                    media.containerId = message.queryItemValue("cid");
-                                }
-                                media.mediaId = payloadEntryVariant.toMap().value("mid").toString();
-                                media.imageUrl = payloadEntryVariant.toMap().value("image_url").toString();
-                                media.isPlayable = payloadEntryVariant.toMap().value("playable").toString().contains("yes");
-                                media.isContainer = payloadEntryVariant.toMap().value("container").toString().contains("yes");
-                                media.sourceId = sourceId;
-                                if (type == "artist") {
-                                    media.mediaType = MEDIA_TYPE_ARTIST;
-                                } else if (type == "song") {
-                                    media.mediaType = MEDIA_TYPE_SONG;
-                                } else if (type == "genre") {
-                                    media.mediaType = MEDIA_TYPE_GENRE;
-                                } else if (type == "station") {
-                                    media.mediaType = MEDIA_TYPE_STATION;
-                                } else if (type == "album") {
-                                    media.mediaType = MEDIA_TYPE_ALBUM;
-                                } else if (type == "container") {
-                                    media.mediaType = MEDIA_TYPE_CONTAINER;
-                                }
-                                mediaItems.append(media);
-                            }
-                        }
-                        emit browseRequestReceived(sequenceNumber, sourceId, containerId, musicSources, mediaItems);
-                    }
-                    else {
-                        int errorId = message.queryItemValue("eid").toInt();
-                        QString text = message.queryItemValue("text");
-                        emit browseErrorReceived(sourceId, containerId, errorId, text);
-                    }
-                } else if (command.contains("play_preset")) {
-
-                } else if (command.contains("play_input")) {
-                    qCDebug(dcDenon()) << "Command play input";
-
-                } else if (command.contains("add_to_queue")) {
-
-                } else if (command.contains("rename_playlist")) {
-
-                } else if (command.contains("delete_playlist")) {
-
-                } else if (command.contains("retrieve_metadata")) {
-
-                } else {
-                    qDebug(dcDenon) << "Unhandled Heos browse command" << command;
-                }
+void Heos::writeRequest(const PendingRequest &request)
+{
+    m_requestsInFlight.append(request);
+    m_socket->write(request.data);
+    if (!m_requestTimeoutTimer->isActive())
+        m_requestTimeoutTimer->start();
+}
 
+void Heos::finishRequest(const QString &command, quint32 sequence)
+{
+    // Match by sequence number, fall back to the oldest request of the same command
+    int index = -1;
+    for (int i = 0; i < m_requestsInFlight.count(); i++) {
+        if (sequence != 0 && m_requestsInFlight.at(i).sequence == sequence) {
+            index = i;
+            break;
+        }
+        if (index < 0 && m_requestsInFlight.at(i).command == command) {
+            index = i;
+        }
+    }
+    if (index < 0)
+        return;
 
-                /*
-             * 5. Change Events (Unsolicited Responses) 5.1 Sources Changed
-             * 5.2 Players Changed
-             * 5.3 Group Changed
-             * 5.4 Player State Changed
-             * 5.5 Player Now Playing Changed
-             * 5.6 Player Now Playing Progress
-             * 5.7 Player Playback Error
-             * 5.8 Player Queue Changed
-             * 5.9 Player Volume Changed
-             * 5.10 Player Repeat Mode Changed
-             * 5.11 Player Shuffle Mode Changed
-             * 5.12 Group Volume Changed
-             * 5.13 User Changed
-             */
-            } else if (command.startsWith("event")) {
-                if (command.contains("sources_changed")) {
-                    emit sourcesChanged();
-
-                } else if (command.contains("players_changed")) {
-                    emit playersChanged();
-
-                } else if (command.contains("groups_changed")) {
-                    emit groupsChanged();
-
-                } else if (command.contains("player_state_changed")) {
-                    qDebug(dcDenon()) << "Player state changed";
-                    if (message.hasQueryItem("pid")) {
-                        int playerId = message.queryItemValue("pid").toInt();
-                        if (message.hasQueryItem("state")) {
-                            PLAYER_STATE playState = PLAYER_STATE_STOP;
-                            if (message.queryItemValue("state").contains("play")) {
-                                playState = PLAYER_STATE_PLAY;
-                            } else if (message.queryItemValue("state").contains("pause")) {
-                                playState = PLAYER_STATE_PAUSE;
-                            } else if (message.queryItemValue("state").contains("stop")) {
-                                playState = PLAYER_STATE_STOP;
-                            }
-                            emit playerPlayStateReceived(playerId, playState);
-                        }
-                    }
-                } else if (command.contains("player_now_playing_changed")) {
-                    qDebug(dcDenon()) << "Player now playing changed, player id:" << message.queryItemValue("pid").toInt();
-                    if (message.hasQueryItem("pid")) {
-                        int playerId = message.queryItemValue("pid").toInt();
-                        emit playerNowPlayingChanged(playerId);
-                    }
-                } else if (command.contains("player_now_playing_progress")) {
-                    //qDebug(dcDenon()) << "Player now playing progress";
-                    if (message.hasQueryItem("pid")) {
-                        int playerId = message.queryItemValue("pid").toInt();
-                        int currentPossition = message.queryItemValue("cur_pos").toInt();
-                        int duration = message.queryItemValue("duration").toInt();
-                        emit playerNowPlayingProgressReceived(playerId, currentPossition, duration);
-                    }
-                } else if (command.contains("player_playback_error")) {
-                    qDebug(dcDenon) << "Player playback error";
-                    int playerId = 0;
-                    if (message.hasQueryItem("pid")) {
-                        playerId = message.queryItemValue("pid").toInt();
-                        QString errorMessage = message.queryItemValue("error");
-                        emit playerPlaybackErrorReceived(playerId, errorMessage);
-                    }
-                } else if (command.contains("player_queue_changed")) {
-                    qDebug(dcDenon()) << "Player queue Changed";
-                    int playerId = 0;
-                    if (message.hasQueryItem("pid")) {
-                        playerId = message.queryItemValue("pid").toInt();
-                        emit playerQueueChanged(playerId);
-                    }
-                } else if (command.contains("player_volume_changed")) {
-                    qDebug(dcDenon()) << "Event player volume Changed";
-                    int playerId = 0;
-                    if (message.hasQueryItem("pid")) {
-                        playerId = message.queryItemValue("pid").toInt();
-
-                        if (message.hasQueryItem("level")) {
-                            int volume = message.queryItemValue("level").toInt();
-                            emit playerVolumeReceived(playerId, volume);
-                        }
-                        if (message.hasQueryItem("mute")) {
-                            bool mute;
-                            if (message.queryItemValue("mute").contains("on")) {
-                                mute = true;
-                            } else {
-                                mute = false;
-                            }
-                            emit playerMuteStatusReceived(playerId, mute);
-                        }
-                    }
-                } else if (command.contains("repeat_mode_changed")) {
-                    qDebug(dcDenon()) << "Repeat mode Changed";
-                    int playerId = 0;
-                    if (message.hasQueryItem("pid")) {
-                        playerId = message.queryItemValue("pid").toInt();
-
-                        if (message.hasQueryItem("repeat")) {
-                            REPEAT_MODE repeatMode = REPEAT_MODE_OFF;
-                            if (message.queryItemValue("repeat").contains("on_all")){
-                                repeatMode = REPEAT_MODE_ALL;
-                            } else if (message.queryItemValue("repeat").contains("on_one")){
-                                repeatMode = REPEAT_MODE_ONE;
-                            } else  if (message.queryItemValue("repeat").contains("off")){
-                                repeatMode = REPEAT_MODE_OFF;
-                            }
-                            emit playerRepeatModeReceived(playerId, repeatMode);
-                        }
-                    }
-                } else if (command.contains("shuffle_mode_changed")) {
-                    qDebug(dcDenon()) << "Shuffle mode Changed";
-                    int playerId = 0;
-                    if (message.hasQueryItem("pid")) {
-                        playerId = message.queryItemValue("pid").toInt();
-
-                        if (message.hasQueryItem("shuffle")) {
-                            bool shuffle;
-                            if (message.queryItemValue("shuffle").contains("on")){
-                                shuffle = true;
-                            } else {
-                                shuffle = false;
-                            }
-                            emit playerShuffleModeReceived(playerId, shuffle);
-                        }
-                    }
-                } else if (command.contains("group_volume_changed")) {
-                    qDebug(dcDenon()) << "Event group volume Changed";
-                    int playerId = 0;
-                    if (message.hasQueryItem("gid")) {
-                        playerId = message.queryItemValue("gid").toInt();
-
-                        if (message.hasQueryItem("level")) {
-                            int volume = message.queryItemValue("level").toInt();
-                            emit groupVolumeReceived(playerId, volume);
-                        }
-                        if (message.hasQueryItem("mute")) {
-                            bool mute;
-                            if (message.queryItemValue("mute").contains("on")) {
-                                mute = true;
-                            } else {
-                                mute = false;
-                            }
-                            emit groupMuteStatusReceived(playerId, mute);
-                        }
-                    }
-                } else if (command.contains("user_changed")) {
-
-                    qDebug(dcDenon()) << "Event user changed" << message.toString();
-                    bool signedIn;
-                    QString username;
-                    if (message.hasQueryItem("signed_out")){
-                        signedIn = false;
-                    } else {
-                        signedIn = true;
-                        username = message.queryItemValue("un");
-                    }
-                    emit userChanged(signedIn, username);
-                } else {
-                    qDebug(dcDenon) << "Unhandled Heos event";
-                }
+    m_requestsInFlight.removeAt(index);
+    if (m_requestsInFlight.isEmpty()) {
+        m_requestTimeoutTimer->stop();
+    } else {
+        m_requestTimeoutTimer->start();
+    }
+
+    while (!m_requestQueue.isEmpty() && m_requestsInFlight.count() < m_maxRequestsInFlight) {
+        writeRequest(m_requestQueue.dequeue());
+    }
+}
+
+QUrlQuery Heos::playerQuery(int playerId)
+{
+    QUrlQuery query;
+    query.addQueryItem("pid", QString::number(playerId));
+    return query;
+}
+
+QUrlQuery Heos::groupQuery(int groupId)
+{
+    QUrlQuery query;
+    query.addQueryItem("gid", QString::number(groupId));
+    return query;
+}
+
+PLAYER_STATE Heos::parsePlayerState(const QString &state)
+{
+    if (state.contains("play")) {
+        return PLAYER_STATE_PLAY;
+    } else if (state.contains("pause")) {
+        return PLAYER_STATE_PAUSE;
+    }
+    return PLAYER_STATE_STOP;
+}
+
+REPEAT_MODE Heos::parseRepeatMode(const QString &repeatMode)
+{
+    if (repeatMode.contains("on_all")){
+        return REPEAT_MODE_ALL;
+    } else if (repeatMode.contains("on_one")){
+        return REPEAT_MODE_ONE;
+    }
+    return REPEAT_MODE_OFF;
+}
+
+const QHash<QString, Heos::ResponseHandler> &Heos::responseHandlers()
+{
+    static const QHash<QString, ResponseHandler> handlers = {
+        /* 4.1 System Commands */
+        { "system/register_for_change_events", &Heos::processRegisterForChangeEvents },
+        { "system/check_account", &Heos::processCheckAccount },
+        { "system/sign_in", &Heos::processSignIn },
+        { "system/sign_out", &Heos::processSignOut },
+        { "system/heart_beat", &Heos::processIgnored },
+        { "system/reboot", &Heos::processIgnored },
+        { "system/prettify_json_response", &Heos::processIgnored },
+
+        /* 4.2 Player Commands */
+        { "player/get_players", &Heos::processGetPlayers },
+        { "player/get_player_info", &Heos::processGetPlayerInfo },
+        { "player/get_now_playing_media", &Heos::processGetNowPlayingMedia },
+        { "player/get_play_state", &Heos::processPlayState },
+        { "player/set_play_state", &Heos::processPlayState },
+        { "player/get_volume", &Heos::processPlayerVolume },
+        { "player/set_volume", &Heos::processPlayerVolume },
+        { "player/volume_up", &Heos::processIgnored },
+        { "player/volume_down", &Heos::processIgnored },
+        { "player/get_mute", &Heos::processPlayerMute },
+        { "player/set_mute", &Heos::processPlayerMute },
+        { "player/get_play_mode", &Heos::processPlayMode },
+        { "player/set_play_mode", &Heos::processPlayMode },
+        { "player/get_queue", &Heos::processIgnored },
+        { "player/clear_queue", &Heos::processIgnored },
+        { "player/move_queue_item", &Heos::processIgnored },
+        { "player/play_next", &Heos::processIgnored },
+        { "player/play_previous", &Heos::processIgnored },
+        { "player/check_update", &Heos::processCheckUpdate },
+
+        /* 4.3 Group Commands */
+        { "group/get_groups", &Heos::processGetGroups },
+        { "group/get_group_info", &Heos::processGetGroupInfo },
+        { "group/set_group", &Heos::processSetGroup },
+        { "group/get_volume", &Heos::processGroupVolume },
+        { "group/set_volume", &Heos::processGroupVolume },
+        { "group/volume_up", &Heos::processIgnored },
+        { "group/volume_down", &Heos::processIgnored },
+        { "group/get_mute", &Heos::processGroupMute },
+        { "group/set_mute", &Heos::processGroupMute },
+        { "group/toggle_mute", &Heos::processIgnored },
+
+        /* 4.4 Browse Commands */
+        { "browse/get_music_sources", &Heos::processMusicSources },
+        { "browse/get_source_info", &Heos::processMusicSources },
+        { "browse/browse", &Heos::processBrowse },
+        { "browse/get_search_criteria", &Heos::processIgnored },
+        { "browse/play_stream", &Heos::processIgnored },
+        { "browse/play_preset", &Heos::processIgnored },
+        { "browse/play_input", &Heos::processIgnored },
+        { "browse/add_to_queue", &Heos::processIgnored },
+        { "browse/rename_playlist", &Heos::processIgnored },
+        { "browse/delete_playlist", &Heos::processIgnored },
+        { "browse/retrieve_metadata", &Heos::processIgnored },
+
+        /* 5. Change Events (Unsolicited Responses) */
+        { "event/sources_changed", &Heos::processSourcesChangedEvent },
+        { "event/players_changed", &Heos::processPlayersChangedEvent },
+        { "event/groups_changed", &Heos::processGroupsChangedEvent },
+        { "event/player_state_changed", &Heos::processPlayState },
+        { "event/player_now_playing_changed", &Heos::processNowPlayingChangedEvent },
+        { "event/player_now_playing_progress", &Heos::processNowPlayingProgressEvent },
+        { "event/player_playback_error", &Heos::processPlaybackErrorEvent },
+        { "event/player_queue_changed", &Heos::processQueueChangedEvent },
+        { "event/player_volume_changed", &Heos::processPlayerVolumeChangedEvent },
+        { "event/repeat_mode_changed", &Heos::processPlayMode },
+        { "event/shuffle_mode_changed", &Heos::processPlayMode },
+        { "event/group_volume_changed", &Heos::processGroupVolumeChangedEvent },
+        { "event/user_changed", &Heos::processUserChangedEvent }
+    };
+    return handlers;
+}
+
+void Heos::processIgnored(const HeosResponse &response)
+{
+    Q_UNUSED(response)
+}
+
+void Heos::processRegisterForChangeEvents(const HeosResponse &response)
+{
+    QString enabled = response.message.queryItemValue("enabled");
+    if (enabled.contains("off")) {
+        qDebug(dcDenon) << "Events are disabled";
+        m_eventRegistered = false;
+        emit systemEventsEnabled(false);
+    } else {
+        qDebug(dcDenon) << "Events are enabled";
+        m_eventRegistered = true;
+        emit systemEventsEnabled(true);
+    }
+}
+
+void Heos::processCheckAccount(const HeosResponse &response)
+{
+    qDebug(dcDenon()) << "System command check_account:" << response.message.toString();
+    if (response.message.hasQueryItem("signed_in")){
+        emit userChanged(true, response.message.queryItemValue("un"));
+    } else {
+        emit userChanged(false, "");
+    }
+}
+
+void Heos::processSignIn(const HeosResponse &response)
+{
+    qDebug(dcDenon()) << "System command sign_in:" << response.message.toString();
+    // Otherwise it will be command under process and we will wait for the event
+    if (response.message.hasQueryItem("signed_in")) {
+        emit userChanged(true, response.message.queryItemValue("un"));
+    }
+}
+
+void Heos::processSignOut(const HeosResponse &response)
+{
+    qDebug(dcDenon()) << "System command sign_out:" << response.message.toString();
+    emit userChanged(false, "");
+}
+
+void Heos::processGetPlayers(const HeosResponse &response)
+{
+    QList<HeosPlayer *> players;
+    foreach (const QVariant &payloadEntryVariant, response.payload.toList()) {
+        QVariantMap payloadEntry = payloadEntryVariant.toMap();
+        HeosPlayer *player = new HeosPlayer(payloadEntry.value("pid").toInt());
+        player->setSerialNumber(payloadEntry.value("serial").toString());
+        player->setName(payloadEntry.value("name").toString());
+        getPlayerInfo(player->playerId());
+        players.append(player);
+    }
+    emit playersRecieved(players);
+}
+
+void Heos::processGetPlayerInfo(const HeosResponse &response)
+{
+    //update heos player info
+    QVariantMap payload = response.payload.toMap();
+    HeosPlayer *player = new HeosPlayer(payload.value("pid").toInt());
+    player->setName(payload.value("name").toString());
+    if (payload.contains("gid")) {
+        player->setGroupId(payload.value("gid").toInt());
+    } else {
+        player->setGroupId(-1); //no group assigned
+    }
+    player->setPlayerModel(payload.value("model").toString());
+    player->setPlayerVersion(payload.value("version").toString());
+    player->setLineOut(payload.value("lineout").toString());
+    player->setControl(payload.value("control").toString());
+    player->setSerialNumber(payload.value("serial").toString());
+    player->setNetwork(payload.value("network").toString());
+    emit playerInfoRecieved(player);
+}
+
+void Heos::processGetNowPlayingMedia(const HeosResponse &response)
+{
+    int playerId = response.message.queryItemValue("pid").toInt();
+    QVariantMap payload = response.payload.toMap();
+    QString artist = payload.value("artist").toString();
+    QString song = payload.value("song").toString();
+    QString artwork = payload.value("image_url").toString();
+    QString album = payload.value("album").toString();
+    QString sourceId = payload.value("sid").toString();
+    qDebug(dcDenon) << "Now playing" << playerId << sourceId << artist << album << song;
+    emit nowPlayingMediaStatusReceived(playerId, sourceId, artist, album, song, artwork);
+}
+
+void Heos::processPlayState(const HeosResponse &response)
+{
+    if (response.message.hasQueryItem("pid") && response.message.hasQueryItem("state")) {
+        int playerId = response.message.queryItemValue("pid").toInt();
+        emit playerPlayStateReceived(playerId, parsePlayerState(response.message.queryItemValue("state")));
+    }
+}
+
+void Heos::processPlayerVolume(const HeosResponse &response)
+{
+    if (response.message.hasQueryItem("level")) {
+        int playerId = response.message.queryItemValue("pid").toInt();
+        emit playerVolumeReceived(playerId, response.message.queryItemValue("level").toInt());
+    }
+}
+
+void Heos::processPlayerMute(const HeosResponse &response)
+{
+    if (response.message.hasQueryItem("state")) {
+        int playerId = response.message.queryItemValue("pid").toInt();
+        emit playerMuteStatusReceived(playerId, response.message.queryItemValue("state").contains("on"));
+    }
+}
+
+void Heos::processPlayMode(const HeosResponse &response)
+{
+    // Used for the play mode responses and the repeat/shuffle mode changed events
+    if (!response.message.hasQueryItem("pid"))
+        return;
+
+    int playerId = response.message.queryItemValue("pid").toInt();
+    if (response.message.hasQueryItem("shuffle")) {
+        emit playerShuffleModeReceived(playerId, response.message.queryItemValue("shuffle").contains("on"));
+    }
+    if (response.message.hasQueryItem("repeat")) {
+        emit playerRepeatModeReceived(playerId, parseRepeatMode(response.message.queryItemValue("repeat")));
+    }
+}
+
+void Heos::processCheckUpdate(const HeosResponse &response)
+{
+    int playerId = response.message.queryItemValue("pid").toInt();
+    bool updateExist = response.payload.toMap().value("update").toString().contains("exist");
+    emit playerUpdateAvailable(playerId, updateExist);
+}
+
+void Heos::processGetGroups(const HeosResponse &response)
+{
+    QList<GroupObject> groups;
+    foreach (const QVariant &payloadEntryVariant, response.payload.toList()) {
+        groups.append(parseGroup(payloadEntryVariant.toMap()));
+    }
+    emit groupsReceived(groups);
+}
+
+void Heos::processGetGroupInfo(const HeosResponse &response)
+{
+    emit groupInfoReceived(parseGroup(response.payload.toMap()));
+}
+
+void Heos::processSetGroup(const HeosResponse &response)
+{
+    if (response.message.hasQueryItem("gid")) {
+        int groupId = response.message.queryItemValue("gid").toInt();
+        QString groupName = response.message.queryItemValue("name");
+        emit setGroupReceived(groupId, groupName);
+    } else {
+        //No group Id so it must have been an ungoup request
+        int playerId = response.message.queryItemValue("pid").toInt();
+        emit deleteGroupReceived(playerId);
+    }
+}
+
+void Heos::processGroupVolume(const HeosResponse &response)
+{
+    if (response.message.hasQueryItem("level")) {
+        int groupId = response.message.queryItemValue("gid").toInt();
+        emit groupVolumeReceived(groupId, response.message.queryItemValue("level").toInt());
+    }
+}
+
+void Heos::processGroupMute(const HeosResponse &response)
+{
+    if (response.message.hasQueryItem("state")) {
+        int groupId = response.message.queryItemValue("gid").toInt();
+        emit playerMuteStatusReceived(groupId, response.message.queryItemValue("state").contains("on"));
+    }
+}
+
+void Heos::processMusicSources(const HeosResponse &response)
+{
+    qDebug(dcDenon()) << "Get music source request response received" << response.command << response.sequence;
+    if (!response.success)
+        return;
+
+    QList<MusicSourceObject> musicSources;
+    foreach (const QVariant &payloadEntryVariant, response.payload.toList()) {
+        QVariantMap payloadEntry = payloadEntryVariant.toMap();
+        MusicSourceObject source;
+        source.name = payloadEntry.value("name").toString();
+        source.image_url = payloadEntry.value("image_url").toString();
+        source.type = payloadEntry.value("type").toString();
+        source.sourceId = payloadEntry.value("sid").toInt();
+        source.available = payloadEntry.value("available").toString().contains("true");
+        source.serviceUsername = payloadEntry.value("service_username").toString();
+        musicSources.append(source);
+    }
+    emit musicSourcesReceived(response.sequence, musicSources);
+}
+
+void Heos::processBrowse(const HeosResponse &response)
+{
+    QString sourceId = response.message.queryItemValue("sid");
+    QString containerId = response.message.queryItemValue("cid");
+
+    if (response.message.hasQueryItem("command under process")){
+        qDebug(dcDenon()) << "Browse command is beeing processed" << response.sequence;
+        return;
+    }
+
+    if (!response.success) {
+        int errorId = response.message.queryItemValue("eid").toInt();
+        QString text = response.message.queryItemValue("text");
+        emit browseErrorReceived(sourceId, containerId, errorId, text);
+        return;
+    }
+
+    QList<MusicSourceObject> musicSources;
+    QList<MediaObject> mediaItems;
+    foreach (const QVariant &payloadEntryVariant, response.payload.toList()) {
+        QVariantMap payloadEntry = payloadEntryVariant.toMap();
+        QString type = payloadEntry.value("type").toString();
+        if (type == "source") {
+            MusicSourceObject source;
+            source.name = payloadEntry.value("name").toString();
+            source.image_url = payloadEntry.value("image_url").toString();
+            source.type = type;
+            source.sourceId = payloadEntry.value("sid").toInt();
+            musicSources.append(source);
+        } else {
+            MediaObject media;
+            media.name = payloadEntry.value("name").toString();
+            if (payloadEntry.contains("cid")) {
+                media.containerId = payloadEntry.value("cid").toString();
             } else {
-                qDebug(dcDenon) << "Unhandled Heos category" << command;
+                media.containerId = containerId;
+            }
+            media.mediaId = payloadEntry.value("mid").toString();
+            media.imageUrl = payloadEntry.value("image_url").toString();
+            media.isPlayable = payloadEntry.value("playable").toString().contains("yes");
+            media.isContainer = payloadEntry.value("container").toString().contains("yes");
+            media.sourceId = sourceId;
+            if (type == "artist") {
+                media.mediaType = MEDIA_TYPE_ARTIST;
+            } else if (type == "song") {
+                media.mediaType = MEDIA_TYPE_SONG;
+            } else if (type == "genre") {
+                media.mediaType = MEDIA_TYPE_GENRE;
+            } else if (type == "station") {
+                media.mediaType = MEDIA_TYPE_STATION;
+            } else if (type == "album") {
+                media.mediaType = MEDIA_TYPE_ALBUM;
+            } else if (type == "container") {
+                media.mediaType = MEDIA_TYPE_CONTAINER;
             }
+            mediaItems.append(media);
         }
     }
+    qDebug(dcDenon()) << "Browse response" << response.sequence << "with" << musicSources.count() << "sources and" << mediaItems.count() << "media items";
+    emit browseRequestReceived(response.sequence, sourceId, containerId, musicSources, mediaItems);
+}
+
+void Heos::processSourcesChangedEvent(const HeosResponse &response)
+{
+    Q_UNUSED(response)
+    emit sourcesChanged();
+}
+
+void Heos::processPlayersChangedEvent(const HeosResponse &response)
+{
+    Q_UNUSED(response)
+    emit playersChanged();
+}
+
+void Heos::processGroupsChangedEvent(const HeosResponse &response)
+{
+    Q_UNUSED(response)
+    emit groupsChanged();
+}
+
+void Heos::processNowPlayingChangedEvent(const HeosResponse &response)
+{
+    if (response.message.hasQueryItem("pid")) {
+        int playerId = response.message.queryItemValue("pid").toInt();
+        qDebug(dcDenon()) << "Player now playing changed, player id:" << playerId;
+        emit playerNowPlayingChanged(playerId);
+    }
+}
+
+void Heos::processNowPlayingProgressEvent(const HeosResponse &response)
+{
+    if (response.message.hasQueryItem("pid")) {
+        int playerId = response.message.queryItemValue("pid").toInt();
+        int currentPossition = response.message.queryItemValue("cur_pos").toInt();
+        int duration = response.message.queryItemValue("duration").toInt();
+        emit playerNowPlayingProgressReceived(playerId, currentPossition, duration);
+    }
+}
+
+void Heos::processPlaybackErrorEvent(const HeosResponse &response)
+{
+    qDebug(dcDenon) << "Player playback error";
+    if (response.message.hasQueryItem("pid")) {
+        int playerId = response.message.queryItemValue("pid").toInt();
+        emit playerPlaybackErrorReceived(playerId, response.message.queryItemValue("error"));
+    }
+}
+
+void Heos::processQueueChangedEvent(const HeosResponse &response)
+{
+    qDebug(dcDenon()) << "Player queue Changed";
+    if (response.message.hasQueryItem("pid")) {
+        emit playerQueueChanged(response.message.queryItemValue("pid").toInt());
+    }
+}
+
+void Heos::processPlayerVolumeChangedEvent(const HeosResponse &response)
+{
+    qDebug(dcDenon()) << "Event player volume Changed";
+    if (!response.message.hasQueryItem("pid"))
+        return;
+
+    int playerId = response.message.queryItemValue("pid").toInt();
+    if (response.message.hasQueryItem("level")) {
+        emit playerVolumeReceived(playerId, response.message.queryItemValue("level").toInt());
+    }
+    if (response.message.hasQueryItem("mute")) {
+        emit playerMuteStatusReceived(playerId, response.message.queryItemValue("mute").contains("on"));
+    }
+}
+
+void Heos::processGroupVolumeChangedEvent(const HeosResponse &response)
+{
+    qDebug(dcDenon()) << "Event group volume Changed";
+    if (!response.message.hasQueryItem("gid"))
+        return;
+
+    int groupId = response.message.queryItemValue("gid").toInt();
+    if (response.message.hasQueryItem("level")) {
+        emit groupVolumeReceived(groupId, response.message.queryItemValue("level").toInt());
+    }
+    if (response.message.hasQueryItem("mute")) {
+        emit groupMuteStatusReceived(groupId, response.message.queryItemValue("mute").contains("on"));
+    }
+}
+
+void Heos::processUserChangedEvent(const HeosResponse &response)
+{
+    qDebug(dcDenon()) << "Event user changed" << response.message.toString();
+    if (response.message.hasQueryItem("signed_out")){
+        emit userChanged(false, QString());
+    } else {
+        emit userChanged(true, response.message.queryItemValue("un"));
+    }
+}
+
+GroupObject Heos::parseGroup(const QVariantMap &groupMap)
+{
+    GroupObject group;
+    group.groupId = groupMap.value("gid").toInt();
+    group.name = groupMap.value("name").toString();
+    foreach (const QVariant &playerVariant, groupMap.value("players").toList()) {
+        PlayerObject player;
+        player.name = playerVariant.toMap().value("name").toString();
+        player.playerId = playerVariant.toMap().value("pid").toInt();
+        group.players.append(player);
+    }
+    return group;
 }
 
 quint32 Heos::createRandomNumber()
@@ -1194,5 +1091,3 @@ quint32 Heos::createRandomNumber()
     return qrand();
 #endif
 }
-
-
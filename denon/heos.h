@@ -35,6 +35,9 @@
 #include <QHostAddress>
 #include <QTcpSocket>
 #include <QTimer>
+#include <QHash>
+#include <QQueue>
+#include <QUrlQuery>
 
 #include "heosplayer.h"
 #include "heostypes.h"
@@ -113,7 +116,7 @@ public:
     quint32 browseSource(const QString &sourceId);
     quint32 browseSourceContainers(const QString &sourceId, const QString &containerId);
     quint32 addContainerToQueue(int playerId, const QString &sourceId, const QString &containerId, ADD_CRITERIA addCriteria);
-    // Controllers can add custom argument SEQUENCE=<number> in browse commands to associate command and response.
+    // Every command carries a SEQUENCE=<number> argument, the returned number identifies the response.
 
     //Play commands
     quint32 playStation(int playerId, const QString &sourceId, const QString &containerId, const QString &mediaId, const QString &stationName);
@@ -122,12 +125,78 @@ public:
     quint32 playUrl(int playerId, const QUrl &url);
 
 private:
+    struct HeosResponse {
+        QString command;
+        QUrlQuery message;
+        bool success = false;
+        quint32 sequence = 0;
+        QVariant payload;
+    };
+
+    struct PendingRequest {
+        quint32 sequence = 0;
+        QString command;
+        QByteArray data;
+    };
+
+    typedef void (Heos::*ResponseHandler)(const HeosResponse &response);
+
     bool m_eventRegistered = false;
     QHostAddress m_hostAddress;
     QTcpSocket *m_socket = nullptr;
     QTimer *m_reconnectTimer = nullptr;
     void setConnected(const bool &connected);
 
+    // The CLI processes the commands of one connection sequentially, keep only a few of them on the wire
+    int m_maxRequestsInFlight = 4;
+    QList<PendingRequest> m_requestsInFlight;
+    QQueue<PendingRequest> m_requestQueue;
+    QTimer *m_requestTimeoutTimer = nullptr;
+
+    quint32 sendCommand(const QString &command, QUrlQuery query = QUrlQuery());
+    void writeRequest(const PendingRequest &request);
+    void finishRequest(const QString &command, quint32 sequence);
+
+    QUrlQuery playerQuery(int playerId);
+    QUrlQuery groupQuery(int groupId);
+    PLAYER_STATE parsePlayerState(const QString &state);
+    REPEAT_MODE parseRepeatMode(const QString &repeatMode);
+    GroupObject parseGroup(const QVariantMap &groupMap);
+
+    static const QHash<QString, ResponseHandler> &responseHandlers();
+
+    // Response and event handlers
+    void processIgnored(const HeosResponse &response);
+    void processRegisterForChangeEvents(const HeosResponse &response);
+    void processCheckAccount(const HeosResponse &response);
+    void processSignIn(const HeosResponse &response);
+    void processSignOut(const HeosResponse &response);
+    void processGetPlayers(const HeosResponse &response);
+    void processGetPlayerInfo(const HeosResponse &response);
+    void processGetNowPlayingMedia(const HeosResponse &response);
+    void processPlayState(const HeosResponse &response);
+    void processPlayerVolume(const HeosResponse &response);
+    void processPlayerMute(const HeosResponse &response);
+    void processPlayMode(const HeosResponse &response);
+    void processCheckUpdate(const HeosResponse &response);
+    void processGetGroups(const HeosResponse &response);
+    void processGetGroupInfo(const HeosResponse &response);
+    void processSetGroup(const HeosResponse &response);
+    void processGroupVolume(const HeosResponse &response);
+    void processGroupMute(const HeosResponse &response);
+    void processMusicSources(const HeosResponse &response);
+    void processBrowse(const HeosResponse &response);
+    void processSourcesChangedEvent(const HeosResponse &response);
+    void processPlayersChangedEvent(const HeosResponse &response);
+    void processGroupsChangedEvent(const HeosResponse &response);
+    void processNowPlayingChangedEvent(const HeosResponse &response);
+    void processNowPlayingProgressEvent(const HeosResponse &response);
+    void processPlaybackErrorEvent(const HeosResponse &response);
+    void processQueueChangedEvent(const HeosResponse &response);
+    void processPlayerVolumeChangedEvent(const HeosResponse &response);
+    void processGroupVolumeChangedEvent(const HeosResponse &response);
+    void processUserChangedEvent(const HeosResponse &response);
+
 signals:
     void connectionStatusChanged(bool status);
     void systemEventsEnabled(bool status);
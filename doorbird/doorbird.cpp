@@ -46,6 +46,31 @@ Doorbird::Doorbird(const QHostAddress &address, QObject *parent) :
     m_address(address)
 {
     m_networkAccessManager = new QNetworkAccessManager(this);
+
+    m_eventParser = new MultipartParser("ioboundary", this);
+    m_eventParser->setMaximumPartSize(1024);
+    connect(m_eventParser, &MultipartParser::partReceived, this, [this](const QByteArray &contentType, const QByteArray &body){
+        Q_UNUSED(contentType)
+        processEventMessage(body);
+    });
+
+    // Stops the video stream once the frames after an event have been captured
+    m_captureTimer = new QTimer(this);
+    m_captureTimer->setSingleShot(true);
+    m_captureTimer->setInterval(10000);
+    connect(m_captureTimer, &QTimer::timeout, this, [this](){
+        qCDebug(dcDoorBird()) << "Event capture finished with" << m_eventFrames.count() << "frames," << m_preRollFrames << "of them before the event";
+        QList<VideoFrame> frames = m_eventFrames;
+        m_eventFrames.clear();
+        if (!m_continuousCapture) {
+            stopVideoStream();
+        }
+        if (!frames.isEmpty()) {
+            emit eventCaptured(m_captureEventType, frames, m_preRollFrames);
+        }
+    });
+
+    setFrameBufferSize(25);
 }
 
 QHostAddress Doorbird::address()
@@ -160,10 +185,22 @@ QUuid Doorbird::liveVideoRequest()
 
 QUuid Doorbird::liveImageRequest()
 {
+    QUuid requestId = QUuid::createUuid();
+
+    // Answer from the video buffer if the stream is running, no need to wait for the camera
+    VideoFrame frame = latestFrame();
+    if (videoStreamRunning() && !frame.jpeg.isEmpty() && frame.timestamp.msecsTo(QDateTime::currentDateTime()) < 1000) {
+        QImage image = QImage::fromData(frame.jpeg, "JPG");
+        QTimer::singleShot(0, this, [this, image, requestId](){
+            emit liveImageReceived(image);
+            emit requestSent(requestId, true);
+        });
+        return requestId;
+    }
+
     QNetworkRequest request(QString("http://%1/bha-api/image.cgi").arg(m_address.toString()));
     qCDebug(dcDoorBird) << "Sending request:" << request.url();
     QNetworkReply *reply = m_networkAccessManager->get(request);
-    QUuid requestId = QUuid::createUuid();
     connect(reply, &QNetworkReply::finished, reply, &QNetworkReply::deleteLater);
     connect(reply, &QNetworkReply::finished, this, [this, reply, requestId](){
 
@@ -346,89 +383,21 @@ void Doorbird::connectToEventMonitor()
 
     QNetworkRequest request(QString("http://%1/bha-api/monitor.cgi?ring=doorbell,motionsensor").arg(m_address.toString()));
     QNetworkReply *reply = m_networkAccessManager->get(request);
+    m_eventParser->reset();
 
-    connect(reply, &QNetworkReply::downloadProgress, this, [this, reply](qint64 bytesReceived, qint64 bytesTotal){
-        Q_UNUSED(bytesReceived)
-        Q_UNUSED(bytesTotal);
-
+    connect(reply, &QNetworkReply::readyRead, this, [this, reply](){
         emit deviceConnected(true);
-        m_readBuffer.append(reply->readAll());
-        qCDebug(dcDoorBird) << "Event received" << m_readBuffer;
 
         // Input data looks like:
         // "--ioboundary\r\nContent-Type: text/plain\r\n\r\ndoorbell:H\r\n\r\n"
-
-        while (!m_readBuffer.isEmpty()) {
-            // find next --ioboundary
-            QString boundary = QStringLiteral("--ioboundary");
-            int startIndex = m_readBuffer.indexOf(boundary);
-            if (startIndex == -1) {
-                qCWarning(dcDoorBird) << "No meaningful data in buffer:" << m_readBuffer;
-                if (m_readBuffer.size() > 1024) {
-                    qCWarning(dcDoorBird) << "Buffer size > 1KB and still no meaningful data. Discarding buffer...";
-                    m_readBuffer.clear();
-                }
-                // Assuming we don't have enough data yet...
-                return;
-            }
-
-            QByteArray contentType = QByteArrayLiteral("Content-Type: text/plain");
-            int contentTypeIndex = m_readBuffer.indexOf(contentType);
-            if (contentTypeIndex == -1) {
-                qCWarning(dcDoorBird) << "Cannot find Content-Type in buffer:" << m_readBuffer;
-                if (m_readBuffer.size() > startIndex + 50) {
-                    qCWarning(dcDoorBird) << boundary << "found but unexpected data follows. Skipping this element...";
-                    m_readBuffer.remove(0, startIndex + boundary.length());
-                    continue;
-                }
-                // Assuming we don't have enough data yet...
-                return;
-            }
-
-            // At this point we have the boundary and Content-Type. Remove all of that and take the entire string to either end or next boundary
-            m_readBuffer.remove(0, contentTypeIndex + contentType.length());
-            int nextStartIndex = m_readBuffer.indexOf(boundary);
-            QByteArray data;
-            if (nextStartIndex == -1) {
-                data = m_readBuffer;
-                m_readBuffer.clear();
-            } else {
-                data = m_readBuffer.left(nextStartIndex);
-                m_readBuffer.remove(0, nextStartIndex);
-            }
-
-            QString message = data.trimmed();
-            QStringList parts = message.split(":");
-            if (parts.count() != 2) {
-                qCWarning(dcDoorBird) << "Message has invalid format:" << message << "Expected device:state";
-                continue;
-            }
-            if (parts.first() == "doorbell") {
-                if (parts.at(1) == "H") {
-                    qCDebug(dcDoorBird) << "Doorbell ringing!";
-                    emit eventReveiced(EventType::Doorbell, true);
-                } else {
-                    emit eventReveiced(EventType::Doorbell, false);
-                }
-            } else if (parts.first() == "motionsensor") {
-                if (parts.at(1) == "H") {
-                    qCDebug(dcDoorBird) << "Motion sensor detected a person";
-                    emit eventReveiced(EventType::Motion, true);
-                } else {
-                    emit eventReveiced(EventType::Motion, false);
-                }
-            } else {
-                qCWarning(dcDoorBird) << "Unhandled DoorBird data:" << message;
-            }
-        }
-        qCDebug(dcDoorBird()) << "Event read buffer size" << m_readBuffer.size();
+        m_eventParser->addData(reply->readAll());
     });
 
     connect(reply, &QNetworkReply::finished, reply, &QNetworkReply::deleteLater);
     connect(reply, &QNetworkReply::finished, this, [this, reply]() {
 
         emit deviceConnected(false);
-        m_readBuffer.clear();
+        m_eventParser->reset();
         qCDebug(dcDoorBird) << "Monitor request finished:" << reply->error();
         qCDebug(dcDoorBird) << "    - Trying to reconnect in 5 seconds";
         QTimer::singleShot(2000, this, [this] {
@@ -437,3 +406,182 @@ void Doorbird::connectToEventMonitor()
         });
     });
 }
+
+void Doorbird::startVideoStream()
+{
+    if (m_videoReply)
+        return;
+
+    qCDebug(dcDoorBird()) << "Starting video stream";
+    QNetworkRequest request(QString("http://%1/bha-api/video.cgi").arg(m_address.toString()));
+    m_videoReply = m_networkAccessManager->get(request);
+    QNetworkReply *reply = m_videoReply;
+
+    connect(reply, &QNetworkReply::readyRead, this, [this, reply](){
+        if (!m_videoParser) {
+            QByteArray boundary = MultipartParser::boundaryFromContentType(reply->rawHeader("Content-Type"));
+            if (boundary.isEmpty()) {
+                qCWarning(dcDoorBird()) << "Video stream has no multipart boundary:" << reply->rawHeader("Content-Type");
+                reply->abort();
+                return;
+            }
+            m_videoParser = new MultipartParser(boundary, this);
+            connect(m_videoParser, &MultipartParser::partReceived, this, [this](const QByteArray &contentType, const QByteArray &body){
+                if (contentType.startsWith("image/jpeg"))
+                    addFrame(body);
+            });
+        }
+        m_videoParser->addData(reply->readAll());
+    });
+
+    connect(reply, &QNetworkReply::finished, reply, &QNetworkReply::deleteLater);
+    connect(reply, &QNetworkReply::finished, this, [this, reply](){
+        if (m_videoReply != reply)
+            return;
+
+        m_videoReply = nullptr;
+        if (m_videoParser) {
+            m_videoParser->deleteLater();
+            m_videoParser = nullptr;
+        }
+
+        if (reply->error() != QNetworkReply::NoError && reply->error() != QNetworkReply::OperationCanceledError)
+            qCWarning(dcDoorBird()) << "Video stream finished:" << reply->error() << reply->errorString();
+
+        // Restart if the stream should still be running
+        if (reply->error() != QNetworkReply::OperationCanceledError && (m_continuousCapture || m_captureTimer->isActive())) {
+            QTimer::singleShot(5000, this, [this](){
+                if (m_continuousCapture || m_captureTimer->isActive())
+                    startVideoStream();
+            });
+        }
+    });
+}
+
+void Doorbird::stopVideoStream()
+{
+    if (!m_videoReply)
+        return;
+
+    qCDebug(dcDoorBird()) << "Stopping video stream";
+    m_videoReply->abort();
+}
+
+bool Doorbird::videoStreamRunning() const
+{
+    return m_videoReply != nullptr;
+}
+
+bool Doorbird::continuousCapture() const
+{
+    return m_continuousCapture;
+}
+
+void Doorbird::setContinuousCapture(bool continuousCapture)
+{
+    if (m_continuousCapture == continuousCapture)
+        return;
+
+    m_continuousCapture = continuousCapture;
+    if (m_continuousCapture) {
+        startVideoStream();
+    } else if (!m_captureTimer->isActive()) {
+        stopVideoStream();
+    }
+}
+
+int Doorbird::frameBufferSize() const
+{
+    return m_frames.size();
+}
+
+void Doorbird::setFrameBufferSize(int frameBufferSize)
+{
+    QList<VideoFrame> frames = bufferedFrames();
+    m_frames = QVector<VideoFrame>(qMax(1, frameBufferSize));
+    m_frameHead = 0;
+    m_frameCount = 0;
+
+    // Keep the newest frames
+    for (int i = qMax(0, frames.count() - m_frames.size()); i < frames.count(); i++) {
+        m_frames[m_frameHead] = frames.at(i);
+        m_frameHead = (m_frameHead + 1) % m_frames.size();
+        m_frameCount++;
+    }
+}
+
+QList<Doorbird::VideoFrame> Doorbird::bufferedFrames() const
+{
+    QList<VideoFrame> frames;
+    frames.reserve(m_frameCount);
+    int start = (m_frameHead - m_frameCount + m_frames.size()) % qMax(1, m_frames.size());
+    for (int i = 0; i < m_frameCount; i++) {
+        frames.append(m_frames.at((start + i) % m_frames.size()));
+    }
+    return frames;
+}
+
+Doorbird::VideoFrame Doorbird::latestFrame() const
+{
+    if (m_frameCount == 0)
+        return VideoFrame();
+
+    return m_frames.at((m_frameHead - 1 + m_frames.size()) % m_frames.size());
+}
+
+void Doorbird::processEventMessage(const QByteArray &data)
+{
+    QString message = data.trimmed();
+    QStringList parts = message.split(":");
+    if (parts.count() != 2) {
+        qCWarning(dcDoorBird) << "Message has invalid format:" << message << "Expected device:state";
+        return;
+    }
+    if (parts.first() == "doorbell") {
+        if (parts.at(1) == "H") {
+            qCDebug(dcDoorBird) << "Doorbell ringing!";
+            captureEvent(EventType::Doorbell);
+            emit eventReveiced(EventType::Doorbell, true);
+        } else {
+            emit eventReveiced(EventType::Doorbell, false);
+        }
+    } else if (parts.first() == "motionsensor") {
+        if (parts.at(1) == "H") {
+            qCDebug(dcDoorBird) << "Motion sensor detected a person";
+            captureEvent(EventType::Motion);
+            emit eventReveiced(EventType::Motion, true);
+        } else {
+            emit eventReveiced(EventType::Motion, false);
+        }
+    } else {
+        qCWarning(dcDoorBird) << "Unhandled DoorBird data:" << message;
+    }
+}
+
+void Doorbird::addFrame(const QByteArray &jpeg)
+{
+    // The old frame data gets released by overwriting the slot, no reallocation of the buffer
+    VideoFrame &frame = m_frames[m_frameHead];
+    frame.timestamp = QDateTime::currentDateTime();
+    frame.jpeg = jpeg;
+    m_frameHead = (m_frameHead + 1) % m_frames.size();
+    m_frameCount = qMin(m_frameCount + 1, m_frames.size());
+
+    // Frames after the event, limited to twice the ring buffer size
+    if (m_captureTimer->isActive() && m_eventFrames.count() - m_preRollFrames < 2 * m_frames.size()) {
+        m_eventFrames.append(frame);
+    }
+}
+
+void Doorbird::captureEvent(EventType eventType)
+{
+    // A following event extends the running capture instead of starting a new one
+    if (!m_captureTimer->isActive()) {
+        // In continuous mode the ring buffer holds the frames from before the event
+        m_captureEventType = eventType;
+        m_eventFrames = m_continuousCapture ? bufferedFrames() : QList<VideoFrame>();
+        m_preRollFrames = m_eventFrames.count();
+    }
+    m_captureTimer->start();
+    startVideoStream();
+}
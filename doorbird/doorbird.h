@@ -36,8 +36,12 @@
 #include <QNetworkAccessManager>
 #include <QUuid>
 #include <QImage>
+#include <QVector>
+#include <QDateTime>
+#include <QTimer>
 
 #include "network/networkaccessmanager.h"
+#include "multipartparser.h"
 
 class Doorbird : public QObject
 {
@@ -63,6 +67,11 @@ public:
         int id;
     };
 
+    struct VideoFrame {
+        QDateTime timestamp;
+        QByteArray jpeg;
+    };
+
     QHostAddress address();
     void setAddress(const QHostAddress &address);
     QUuid getSession(const QString &username, const QString &password);
@@ -87,10 +96,41 @@ public:
     QUuid restart();
 
     void connectToEventMonitor();
+
+    // MJPEG video stream, the received frames are kept in a ring buffer
+    void startVideoStream();
+    void stopVideoStream();
+    bool videoStreamRunning() const;
+
+    // Keep the video stream running all the time in order to have frames from before an event
+    bool continuousCapture() const;
+    void setContinuousCapture(bool continuousCapture);
+
+    int frameBufferSize() const;
+    void setFrameBufferSize(int frameBufferSize);
+
+    // Returns the buffered frames, oldest first
+    QList<VideoFrame> bufferedFrames() const;
+    VideoFrame latestFrame() const;
+
 private:
     QHostAddress m_address;
     QNetworkAccessManager *m_networkAccessManager;
-    QByteArray m_readBuffer;
+    MultipartParser *m_eventParser = nullptr;
+
+    QNetworkReply *m_videoReply = nullptr;
+    MultipartParser *m_videoParser = nullptr;
+    bool m_continuousCapture = false;
+    QTimer *m_captureTimer = nullptr;
+
+    QVector<VideoFrame> m_frames;
+    int m_frameHead = 0;
+    int m_frameCount = 0;
+
+    // Frames recorded for the currently captured event, pre-roll first
+    EventType m_captureEventType = Doorbell;
+    QList<VideoFrame> m_eventFrames;
+    int m_preRollFrames = 0;
 
     QList<QNetworkReply *> m_networkRequests;
     QList<QNetworkReply *> m_pendingAuthentications;
@@ -98,6 +138,10 @@ private:
     QString m_username;
     QString m_password;
 
+    void processEventMessage(const QByteArray &data);
+    void addFrame(const QByteArray &jpeg);
+    void captureEvent(EventType eventType);
+
 signals:
     void deviceConnected(bool status);
     void requestSent(QUuid requestId, bool success);
@@ -107,6 +151,7 @@ signals:
 
     void sessionIdReceived(const QString &sessionId);
     void liveImageReceived(QImage image);
+    void eventCaptured(EventType eventType, const QList<Doorbird::VideoFrame> &frames, int preRollFrames);
 
 };
 
@@ -5,7 +5,9 @@ QT += network
 SOURCES += \
     integrationplugindoorbird.cpp \
     doorbird.cpp \
+    multipartparser.cpp \
 
 HEADERS += \
     integrationplugindoorbird.h \
     doorbird.h \
+    multipartparser.h \
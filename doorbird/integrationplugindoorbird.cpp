@@ -33,11 +33,17 @@
 
 #include "platform/platformzeroconfcontroller.h"
 #include "network/zeroconf/zeroconfserviceentry.h"
+#include "nymeasettings.h"
 
 #include <QNetworkAccessManager>
 #include <QNetworkReply>
 #include <QHostAddress>
 #include <QTimer>
+#include <QDir>
+#include <QFile>
+
+// Number of recordings kept per DoorBird, older ones get deleted
+static const int maxRecordings = 20;
 
 IntegrationPluginDoorbird::IntegrationPluginDoorbird()
 {
@@ -170,6 +176,7 @@ void IntegrationPluginDoorbird::setupThing(ThingSetupInfo *info)
         }
         connect(doorbird, &Doorbird::deviceConnected, this, &IntegrationPluginDoorbird::onDoorBirdConnected);
         connect(doorbird, &Doorbird::eventReveiced, this, &IntegrationPluginDoorbird::onDoorBirdEvent);
+        connect(doorbird, &Doorbird::eventCaptured, this, &IntegrationPluginDoorbird::onDoorBirdEventCaptured);
         connect(doorbird, &Doorbird::requestSent, this, &IntegrationPluginDoorbird::onDoorBirdRequestSent);
     } else {
         qCWarning(dcDoorBird()) << "Unhandled Thing class" << info->thing()->thingClass();
@@ -185,6 +192,12 @@ void IntegrationPluginDoorbird::postSetupThing(Thing *thing)
         thing->setStateValue(doorBirdConnectedStateTypeId, true); //since we checked the connection inside ThingSetup
         Doorbird *doorbird =  m_doorbirdConnections.value(thing->id());
         doorbird->connectToEventMonitor();
+        doorbird->setContinuousCapture(thing->setting(doorBirdSettingsContinuousVideoBufferParamTypeId).toBool());
+        connect(thing, &Thing::settingChanged, doorbird, [doorbird](const ParamTypeId &paramTypeId, const QVariant &value){
+            if (paramTypeId == doorBirdSettingsContinuousVideoBufferParamTypeId) {
+                doorbird->setContinuousCapture(value.toBool());
+            }
+        });
         doorbird->infoRequest();
         doorbird->listFavorites();
         doorbird->listSchedules();
@@ -236,9 +249,15 @@ void IntegrationPluginDoorbird::thingRemoved(Thing *thing)
     if (thing->thingClassId() == doorBirdThingClassId) {
         Doorbird *doorbirdConnection = m_doorbirdConnections.take(thing->id());
         doorbirdConnection->deleteLater();
+        QDir(recordingsPath(thing)).removeRecursively();
     }
 }
 
+QString IntegrationPluginDoorbird::recordingsPath(Thing *thing) const
+{
+    return NymeaSettings::storagePath() + "/doorbird/" + thing->id().toString().remove(QRegExp("[{}]"));
+}
+
 void IntegrationPluginDoorbird::onDoorBirdConnected(bool status)
 {
     Doorbird *doorbird = static_cast<Doorbird *>(sender());
@@ -281,6 +300,48 @@ void IntegrationPluginDoorbird::onDoorBirdEvent(Doorbird::EventType eventType, b
     }
 }
 
+void IntegrationPluginDoorbird::onDoorBirdEventCaptured(Doorbird::EventType eventType, const QList<Doorbird::VideoFrame> &frames, int preRollFrames)
+{
+    Doorbird *doorbird = static_cast<Doorbird *>(sender());
+    Thing *thing = myThings().findById(m_doorbirdConnections.key(doorbird));
+    if (!thing) {
+        qCWarning(dcDoorBird()) << "Doorbird event captured, associated thing not found";
+        return;
+    }
+
+    QString trigger = eventType == Doorbird::EventType::Motion ? "Motion" : "Doorbell";
+    QDir recordingsDir(recordingsPath(thing));
+    QString recordingName = frames.first().timestamp.toString("yyyyMMdd-hhmmss-zzz") + "-" + trigger.toLower();
+    if (!recordingsDir.mkpath(recordingName)) {
+        qCWarning(dcDoorBird()) << "Could not create recording directory" << recordingsDir.filePath(recordingName);
+        return;
+    }
+
+    // Frames before the event are prefixed, so the files sort in recording order
+    QDir recordingDir(recordingsDir.filePath(recordingName));
+    for (int i = 0; i < frames.count(); i++) {
+        QString fileName = QString("%1-%2.jpg").arg(i < preRollFrames ? "pre" : "post").arg(i, 4, 10, QChar('0'));
+        QFile file(recordingDir.filePath(fileName));
+        if (!file.open(QIODevice::WriteOnly) || file.write(frames.at(i).jpeg) != frames.at(i).jpeg.size()) {
+            qCWarning(dcDoorBird()) << "Could not write recorded frame" << file.fileName() << file.errorString();
+            recordingDir.removeRecursively();
+            return;
+        }
+    }
+    qCDebug(dcDoorBird()) << "Stored" << frames.count() << "frames," << preRollFrames << "before the event, in" << recordingDir.path();
+
+    QStringList recordings = recordingsDir.entryList(QDir::Dirs | QDir::NoDotAndDotDot, QDir::Name);
+    while (recordings.count() > maxRecordings) {
+        QDir(recordingsDir.filePath(recordings.takeFirst())).removeRecursively();
+    }
+
+    ParamList params;
+    params << Param(doorBirdVideoRecordedEventTriggerParamTypeId, trigger);
+    params << Param(doorBirdVideoRecordedEventDirectoryParamTypeId, recordingDir.path());
+    params << Param(doorBirdVideoRecordedEventFrameCountParamTypeId, frames.count());
+    emit emitEvent(Event(doorBirdVideoRecordedEventTypeId, thing->id(), params));
+}
+
 void IntegrationPluginDoorbird::onDoorBirdRequestSent(QUuid requestId, bool success)
 {
     if (m_asyncActions.contains(requestId)) {
@@ -70,9 +70,12 @@ private:
 
     QHash<QUuid, ThingActionInfo *> m_asyncActions;
 
+    QString recordingsPath(Thing *thing) const;
+
 private slots:
     void onDoorBirdConnected(bool status);
     void onDoorBirdEvent(Doorbird::EventType eventType, bool status);
+    void onDoorBirdEventCaptured(Doorbird::EventType eventType, const QList<Doorbird::VideoFrame> &frames, int preRollFrames);
     void onDoorBirdRequestSent(QUuid requestId, bool success);
 };
 
@@ -0,0 +1,235 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+*
+* Copyright 2013 - 2020, nymea GmbH
+* Contact: contact@nymea.io
+*
+* This file is part of nymea.
+* This project including source code and documentation is protected by
+* copyright law, and remains the property of nymea GmbH. All rights, including
+* reproduction, publication, editing and translation, are reserved. The use of
+* this project is subject to the terms of a license agreement to be concluded
+* with nymea GmbH in accordance with the terms of use of nymea GmbH, available
+* under https://nymea.io/license
+*
+* GNU Lesser General Public License Usage
+* Alternatively, this project may be redistributed and/or modified under the
+* terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; version 3. This project is distributed in the hope that
+* it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+* warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this project. If not, see <https://www.gnu.org/licenses/>.
+*
+* For any further details and any questions please contact us under
+* contact@nymea.io or see our FAQ/Licensing Information on
+* https://nymea.io/license/faq
+*
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "multipartparser.h"
+#include "extern-plugininfo.h"
+
+#include <QList>
+
+static const QByteArray headerTerminator = QByteArrayLiteral("\r\n\r\n");
+
+MultipartParser::MultipartParser(const QByteArray &boundary, QObject *parent) :
+    QObject(parent),
+    m_delimiter("--" + boundary)
+{
+
+}
+
+QByteArray MultipartParser::boundaryFromContentType(const QByteArray &contentType)
+{
+    // Content-Type: multipart/x-mixed-replace; boundary=ioboundary
+    foreach (const QByteArray &parameter, contentType.split(';')) {
+        QByteArray trimmed = parameter.trimmed();
+        if (trimmed.toLower().startsWith("boundary=")) {
+            QByteArray boundary = trimmed.mid(9);
+            if (boundary.startsWith('"') && boundary.endsWith('"') && boundary.length() >= 2)
+                boundary = boundary.mid(1, boundary.length() - 2);
+
+            // Some cameras announce the boundary including the leading dashes
+            if (boundary.startsWith("--"))
+                boundary = boundary.mid(2);
+
+            return boundary;
+        }
+    }
+    return QByteArray();
+}
+
+QByteArray MultipartParser::boundary() const
+{
+    return m_delimiter.mid(2);
+}
+
+int MultipartParser::maximumPartSize() const
+{
+    return m_maximumPartSize;
+}
+
+void MultipartParser::setMaximumPartSize(int maximumPartSize)
+{
+    m_maximumPartSize = maximumPartSize;
+}
+
+void MultipartParser::addData(const QByteArray &data)
+{
+    m_buffer.append(data);
+
+    bool progress = true;
+    while (progress) {
+        switch (m_state) {
+        case StateBoundary:
+            progress = processBoundary();
+            break;
+        case StateHeaders:
+            progress = processHeaders();
+            break;
+        case StateBody:
+            progress = processBody();
+            break;
+        }
+    }
+
+    // Drop consumed data once per chunk, not per part
+    if (m_position > 0) {
+        m_buffer.remove(0, m_position);
+        m_searchPosition -= m_position;
+        m_position = 0;
+    }
+}
+
+void MultipartParser::reset()
+{
+    m_buffer.clear();
+    m_position = 0;
+    m_searchPosition = 0;
+    m_state = StateBoundary;
+    m_contentType.clear();
+    m_contentLength = -1;
+}
+
+bool MultipartParser::processBoundary()
+{
+    int index = m_buffer.indexOf(m_delimiter, m_searchPosition);
+    if (index < 0) {
+        // Everything except a possibly incomplete delimiter at the end is garbage
+        m_position = qMax(m_position, m_buffer.length() - m_delimiter.length() + 1);
+        m_searchPosition = m_position;
+        return false;
+    }
+
+    m_position = index + m_delimiter.length();
+    m_searchPosition = m_position;
+    m_state = StateHeaders;
+    m_contentType.clear();
+    m_contentLength = -1;
+    return true;
+}
+
+bool MultipartParser::processHeaders()
+{
+    int index = m_buffer.indexOf(headerTerminator, m_searchPosition);
+    if (index < 0) {
+        if (m_buffer.length() - m_position > 8 * 1024) {
+            qCWarning(dcDoorBird()) << "Multipart headers exceed 8 kB, skipping part.";
+            m_state = StateBoundary;
+            m_position = m_buffer.length();
+            m_searchPosition = m_position;
+            return false;
+        }
+        m_searchPosition = qMax(m_position, m_buffer.length() - headerTerminator.length() + 1);
+        return false;
+    }
+
+    QList<QByteArray> lines = m_buffer.mid(m_position, index - m_position).split('\n');
+    foreach (const QByteArray &line, lines) {
+        int separator = line.indexOf(':');
+        if (separator < 0)
+            continue;
+
+        QByteArray name = line.left(separator).trimmed().toLower();
+        if (name == "content-type") {
+            m_contentType = line.mid(separator + 1).trimmed();
+        } else if (name == "content-length") {
+            bool ok = false;
+            int contentLength = line.mid(separator + 1).trimmed().toInt(&ok);
+            m_contentLength = ok && contentLength >= 0 ? contentLength : -1;
+        }
+    }
+
+    m_position = index + headerTerminator.length();
+    m_searchPosition = m_position;
+    m_state = StateBody;
+    return true;
+}
+
+bool MultipartParser::processBody()
+{
+    // Fast path, the part announced its size
+    if (m_contentLength >= 0) {
+        if (m_contentLength > m_maximumPartSize) {
+            qCWarning(dcDoorBird()) << "Multipart part of" << m_contentLength << "bytes exceeds the limit, skipping part.";
+            m_contentLength = -1;
+            m_state = StateBoundary;
+            return true;
+        }
+        if (m_buffer.length() - m_position < m_contentLength)
+            return false;
+
+        finishPart(m_position + m_contentLength, m_position + m_contentLength);
+        return true;
+    }
+
+    // Text parts of the event monitor are terminated by an empty line, the next
+    // delimiter is only sent with the next event.
+    if (m_contentType.startsWith("text/")) {
+        int index = m_buffer.indexOf(headerTerminator, m_searchPosition);
+        int delimiterIndex = m_buffer.indexOf(m_delimiter, m_searchPosition);
+        if (delimiterIndex >= 0 && (index < 0 || delimiterIndex < index)) {
+            finishPart(delimiterIndex, delimiterIndex);
+            return true;
+        }
+        if (index >= 0) {
+            finishPart(index, index + headerTerminator.length());
+            return true;
+        }
+    } else {
+        int index = m_buffer.indexOf(m_delimiter, m_searchPosition);
+        if (index >= 0) {
+            finishPart(index, index);
+            return true;
+        }
+    }
+
+    if (m_buffer.length() - m_position > m_maximumPartSize) {
+        qCWarning(dcDoorBird()) << "Multipart part exceeds" << m_maximumPartSize << "bytes without delimiter, skipping part.";
+        m_position = m_buffer.length();
+        m_searchPosition = m_position;
+        m_state = StateBoundary;
+        return false;
+    }
+
+    m_searchPosition = qMax(m_position, m_buffer.length() - m_delimiter.length() + 1);
+    return false;
+}
+
+void MultipartParser::finishPart(int bodyEnd, int nextPosition)
+{
+    // Strip the line break preceding the next delimiter if the part size is not known
+    int end = bodyEnd;
+    if (m_contentLength < 0 && end - m_position >= 2 && m_buffer.at(end - 2) == '\r' && m_buffer.at(end - 1) == '\n')
+        end -= 2;
+
+    QByteArray body = m_buffer.mid(m_position, end - m_position);
+    m_position = nextPosition;
+    m_searchPosition = m_position;
+    m_state = StateBoundary;
+
+    emit partReceived(m_contentType, body);
+}
@@ -0,0 +1,84 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+*
+* Copyright 2013 - 2020, nymea GmbH
+* Contact: contact@nymea.io
+*
+* This file is part of nymea.
+* This project including source code and documentation is protected by
+* copyright law, and remains the property of nymea GmbH. All rights, including
+* reproduction, publication, editing and translation, are reserved. The use of
+* this project is subject to the terms of a license agreement to be concluded
+* with nymea GmbH in accordance with the terms of use of nymea GmbH, available
+* under https://nymea.io/license
+*
+* GNU Lesser General Public License Usage
+* Alternatively, this project may be redistributed and/or modified under the
+* terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; version 3. This project is distributed in the hope that
+* it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+* warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this project. If not, see <https://www.gnu.org/licenses/>.
+*
+* For any further details and any questions please contact us under
+* contact@nymea.io or see our FAQ/Licensing Information on
+* https://nymea.io/license/faq
+*
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef MULTIPARTPARSER_H
+#define MULTIPARTPARSER_H
+
+#include <QObject>
+#include <QByteArray>
+
+// Incremental parser for multipart/x-mixed-replace streams as used by the
+// DoorBird event monitor (monitor.cgi) and the MJPEG video stream (video.cgi).
+// Data can be added in arbitrary chunks, already searched data is never scanned twice.
+class MultipartParser : public QObject
+{
+    Q_OBJECT
+public:
+    explicit MultipartParser(const QByteArray &boundary, QObject *parent = nullptr);
+
+    // Returns the boundary parameter of a multipart Content-Type header or an empty byte array
+    static QByteArray boundaryFromContentType(const QByteArray &contentType);
+
+    QByteArray boundary() const;
+
+    int maximumPartSize() const;
+    void setMaximumPartSize(int maximumPartSize);
+
+    void addData(const QByteArray &data);
+    void reset();
+
+signals:
+    void partReceived(const QByteArray &contentType, const QByteArray &body);
+
+private:
+    enum State {
+        StateBoundary,
+        StateHeaders,
+        StateBody
+    };
+
+    QByteArray m_delimiter;
+    int m_maximumPartSize = 1024 * 1024;
+
+    QByteArray m_buffer;
+    int m_position = 0;
+    int m_searchPosition = 0;
+    State m_state = StateBoundary;
+
+    QByteArray m_contentType;
+    int m_contentLength = -1;
+
+    bool processBoundary();
+    bool processHeaders();
+    bool processBody();
+    void finishPart(int bodyEnd, int nextPosition);
+};
+
+#endif // MULTIPARTPARSER_H
@@ -399,6 +399,8 @@ IntegrationPluginElgato::~IntegrationPluginElgato()
 
 void IntegrationPluginElgato::init()
 {
+    m_connectionArbiter = new BluetoothConnectionArbiter(this);
+
     m_pluginTimer = hardwareManager()->pluginTimerManager()->registerTimer(10);
     connect(m_pluginTimer, &PluginTimer::timeout, this, &IntegrationPluginElgato::onPluginTimer);
 }
@@ -462,6 +464,8 @@ void IntegrationPluginElgato::setupThing(ThingSetupInfo *info)
 
         BluetoothLowEnergyDevice *bluetoothDevice = hardwareManager()->bluetoothLowEnergyManager()->registerDevice(deviceInfo, QLowEnergyController::PublicAddress);
 
+        m_connectionArbiter->registerDevice(bluetoothDevice, true);
+
         AveaBulb *bulb = new AveaBulb(thing, bluetoothDevice, this);
         m_bulbs.insert(thing, bulb);
 
@@ -481,7 +485,7 @@ void IntegrationPluginElgato::postSetupThing(Thing *thing)
     bulb->setGreen(thing->stateValue(aveaGreenStateTypeId).toInt());
     bulb->setBlue(thing->stateValue(aveaBlueStateTypeId).toInt());
 
-    bulb->bluetoothDevice()->connectDevice();
+    m_connectionArbiter->requestConnection(bulb->bluetoothDevice(), BluetoothConnectionArbiter::PriorityNormal);
 }
 
 void IntegrationPluginElgato::executeAction(ThingActionInfo *info)
@@ -577,6 +581,7 @@ void IntegrationPluginElgato::thingRemoved(Thing *thing)
 
     AveaBulb *bulb = m_bulbs.value(thing);
     m_bulbs.remove(thing);
+    m_connectionArbiter->unregisterDevice(bulb->bluetoothDevice());
     hardwareManager()->bluetoothLowEnergyManager()->unregisterDevice(bulb->bluetoothDevice());
     bulb->deleteLater();
 }
@@ -595,7 +600,7 @@ void IntegrationPluginElgato::onPluginTimer()
 {
     foreach (AveaBulb *bulb, m_bulbs.values()) {
         if (!bulb->bluetoothDevice()->connected()) {
-            bulb->bluetoothDevice()->connectDevice();
+            m_connectionArbiter->requestConnection(bulb->bluetoothDevice(), BluetoothConnectionArbiter::PriorityPoll);
         }
     }
 }
@@ -35,6 +35,7 @@
 #include "plugintimer.h"
 #include "integrations/integrationplugin.h"
 #include "hardware/bluetoothlowenergy/bluetoothlowenergydevice.h"
+#include "bluetoothconnectionarbiter.h"
 
 class IntegrationPluginElgato : public IntegrationPlugin
 {
@@ -56,6 +57,7 @@ public:
 
 private:
     PluginTimer *m_pluginTimer = nullptr;
+    BluetoothConnectionArbiter *m_connectionArbiter = nullptr;
     QHash<Thing *, AveaBulb *> m_bulbs;
 
     bool verifyExistingDevices(const QBluetoothDeviceInfo &deviceInfo);
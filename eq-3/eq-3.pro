@@ -1,4 +1,5 @@
 include(../plugins.pri)
+include(../common/bluetoothconnectionarbiter.pri)
 
 QT += network bluetooth
 
@@ -8,6 +9,7 @@ SOURCES += \
     integrationplugineq-3.cpp    \
     maxcubediscovery.cpp    \
     maxcube.cpp             \
+    maxbitreader.cpp        \
     maxdevice.cpp           \
     room.cpp \
     wallthermostat.cpp \
@@ -18,6 +20,7 @@ HEADERS += \
     integrationplugineq-3.h      \
     maxcubediscovery.h      \
     maxcube.h               \
+    maxbitreader.h          \
     maxdevice.h             \
     room.h \
     wallthermostat.h \
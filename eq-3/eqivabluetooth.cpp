@@ -106,16 +106,27 @@ const quint8 setModeAuto =     0x00;
 const quint8 setModeManual =   0x40;
 const quint8 setModeHoliday =  0x40; // Same as manual but with a time limit
 
-EqivaBluetooth::EqivaBluetooth(BluetoothLowEnergyManager *bluetoothManager, const QBluetoothAddress &hostAddress, const QString &name, QObject *parent):
+EqivaBluetooth::EqivaBluetooth(BluetoothLowEnergyManager *bluetoothManager, BluetoothConnectionArbiter *connectionArbiter, const QBluetoothAddress &hostAddress, const QString &name, QObject *parent):
     QObject(parent),
     m_bluetoothManager(bluetoothManager),
+    m_connectionArbiter(connectionArbiter),
     m_name(name)
 {
 
     QBluetoothDeviceInfo deviceInfo = QBluetoothDeviceInfo(hostAddress, QString(), 0);
     m_bluetoothDevice = m_bluetoothManager->registerDevice(deviceInfo, QLowEnergyController::PublicAddress);
     connect(m_bluetoothDevice, &BluetoothLowEnergyDevice::stateChanged, this, &EqivaBluetooth::controllerStateChanged);
-    m_bluetoothDevice->connectDevice();
+    m_connectionArbiter->registerDevice(m_bluetoothDevice, true);
+    m_connectionArbiter->requestConnection(m_bluetoothDevice, BluetoothConnectionArbiter::PriorityNormal);
+    connect(m_connectionArbiter, &BluetoothConnectionArbiter::connectionStatisticsChanged, this, [this](BluetoothLowEnergyDevice *device){
+        if (device != m_bluetoothDevice)
+            return;
+
+        qCDebug(dcEQ3()) << m_name << "Connection attempts:" << m_connectionArbiter->connectionAttempts(device)
+                         << "failures:" << m_connectionArbiter->connectionFailures(device)
+                         << "latency:" << m_connectionArbiter->lastConnectionLatency(device) << "ms"
+                         << "average:" << m_connectionArbiter->averageConnectionLatency(device) << "ms";
+    });
 
     m_refreshTimer.setInterval(5000);
     m_refreshTimer.setSingleShot(true);
@@ -125,7 +136,7 @@ EqivaBluetooth::EqivaBluetooth(BluetoothLowEnergyManager *bluetoothManager, cons
     connect(&m_reconnectTimer, &QTimer::timeout, this, [this](){
         qCDebug(dcEQ3()) << m_name << "Trying to reconnect";
         m_reconnectAttempt++;
-        m_bluetoothDevice->connectDevice();
+        m_connectionArbiter->requestConnection(m_bluetoothDevice, BluetoothConnectionArbiter::PriorityPoll);
     });
 
     m_commandTimeout.setInterval(3000);
@@ -145,6 +156,9 @@ EqivaBluetooth::EqivaBluetooth(BluetoothLowEnergyManager *bluetoothManager, cons
 
 EqivaBluetooth::~EqivaBluetooth()
 {
+    if (m_connectionArbiter) {
+        m_connectionArbiter->unregisterDevice(m_bluetoothDevice);
+    }
     m_bluetoothManager->unregisterDevice(m_bluetoothDevice);
 }
 
@@ -480,15 +494,17 @@ void EqivaBluetooth::sendDate()
     stream << static_cast<quint8>(now.time().second());
 
     // Example: 03130117172315 -> 03YYMMDDHHMMSS
-    enqueue("SetDate", data);
+    // Also used for refreshing the state periodically, so no need to hurry for a connection
+    enqueue("SetDate", data, BluetoothConnectionArbiter::PriorityPoll);
 }
 
-int EqivaBluetooth::enqueue(const QString &name, const QByteArray &data)
+int EqivaBluetooth::enqueue(const QString &name, const QByteArray &data, BluetoothConnectionArbiter::Priority priority)
 {
     Command cmd;
     cmd.name = name;
     cmd.id = m_nextCommandId++;
     cmd.data = data;
+    cmd.priority = priority;
     m_commandQueue.append(cmd);
     processCommandQueue();
     return cmd.id;
@@ -506,8 +522,13 @@ void EqivaBluetooth::processCommandQueue()
     }
 
     if (!m_available) {
+        // The connection is needed as urgently as the most urgent queued command
+        BluetoothConnectionArbiter::Priority priority = BluetoothConnectionArbiter::PriorityPoll;
+        foreach (const Command &command, m_commandQueue) {
+            priority = qMax(priority, command.priority);
+        }
         qCWarning(dcEQ3()) << m_name << "Not connected. Trying to reconnect before sending commands...";
-        m_bluetoothDevice->connectDevice();
+        m_connectionArbiter->requestConnection(m_bluetoothDevice, priority);
         return;
     }
 
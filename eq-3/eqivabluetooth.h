@@ -32,8 +32,10 @@
 #define EQIVABLUETOOTH_H
 
 #include <QObject>
+#include <QPointer>
 
 #include "hardware/bluetoothlowenergy/bluetoothlowenergymanager.h"
+#include "bluetoothconnectionarbiter.h"
 
 
 class EqivaBluetooth : public QObject
@@ -45,7 +47,7 @@ public:
         ModeManual,
         ModeHoliday
     };
-    explicit EqivaBluetooth(BluetoothLowEnergyManager *bluetoothManager, const QBluetoothAddress &hostAddress, const QString &name, QObject *parent = nullptr);
+    explicit EqivaBluetooth(BluetoothLowEnergyManager *bluetoothManager, BluetoothConnectionArbiter *connectionArbiter, const QBluetoothAddress &hostAddress, const QString &name, QObject *parent = nullptr);
     ~EqivaBluetooth();
     void setName(const QString &name);
 
@@ -94,11 +96,12 @@ private slots:
     void sendDate();
 
     // Name parameter used for debugging purposes
-    int enqueue(const QString &name, const QByteArray &data);
+    int enqueue(const QString &name, const QByteArray &data, BluetoothConnectionArbiter::Priority priority = BluetoothConnectionArbiter::PriorityUserAction);
     void processCommandQueue();
 
 private:
     BluetoothLowEnergyManager* m_bluetoothManager = nullptr;
+    QPointer<BluetoothConnectionArbiter> m_connectionArbiter;
     BluetoothLowEnergyDevice* m_bluetoothDevice = nullptr;
     QLowEnergyService *m_eqivaService = nullptr;
     QTimer m_refreshTimer;
@@ -121,6 +124,7 @@ private:
         QString name; // For debug prints
         QByteArray data;
         qint32 id = -1;
+        BluetoothConnectionArbiter::Priority priority = BluetoothConnectionArbiter::PriorityUserAction;
     };
     QList<Command> m_commandQueue;
     Command m_currentCommand;
@@ -54,6 +54,8 @@ void IntegrationPluginEQ3::init()
 
     m_pluginTimer = hardwareManager()->pluginTimerManager()->registerTimer(10);
     connect(m_pluginTimer, &PluginTimer::timeout, this, &IntegrationPluginEQ3::onPluginTimer);
+
+    m_connectionArbiter = new BluetoothConnectionArbiter(this);
 }
 
 void IntegrationPluginEQ3::discoverThings(ThingDiscoveryInfo *info)
@@ -162,7 +164,7 @@ void IntegrationPluginEQ3::setupThing(ThingSetupInfo *info)
     }
 
     if (thing->thingClassId() == eqivaBluetoothThingClassId) {
-        EqivaBluetooth *eqivaDevice = new EqivaBluetooth(hardwareManager()->bluetoothLowEnergyManager(), QBluetoothAddress(thing->paramValue(eqivaBluetoothThingMacAddressParamTypeId).toString()), thing->name(), this);
+        EqivaBluetooth *eqivaDevice = new EqivaBluetooth(hardwareManager()->bluetoothLowEnergyManager(), m_connectionArbiter, QBluetoothAddress(thing->paramValue(eqivaBluetoothThingMacAddressParamTypeId).toString()), thing->name(), this);
         m_eqivaDevices.insert(thing, eqivaDevice);
 
         connect(thing, &Thing::nameChanged, eqivaDevice, [thing, eqivaDevice](){
@@ -64,6 +64,7 @@ private:
     EqivaBluetooth::Mode stringToMode(const QString &string);
 
     PluginTimer *m_pluginTimer = nullptr;
+    BluetoothConnectionArbiter *m_connectionArbiter = nullptr;
     QList<Param> m_config;
     QHash<MaxCube *, Thing *> m_cubes;
 
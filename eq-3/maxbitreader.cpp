@@ -0,0 +1,141 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+*
+* Copyright 2013 - 2020, nymea GmbH
+* Contact: contact@nymea.io
+*
+* This file is part of nymea.
+* This project including source code and documentation is protected by
+* copyright law, and remains the property of nymea GmbH. All rights, including
+* reproduction, publication, editing and translation, are reserved. The use of
+* this project is subject to the terms of a license agreement to be concluded
+* with nymea GmbH in accordance with the terms of use of nymea GmbH, available
+* under https://nymea.io/license
+*
+* GNU Lesser General Public License Usage
+* Alternatively, this project may be redistributed and/or modified under the
+* terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; version 3. This project is distributed in the hope that
+* it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+* warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this project. If not, see <https://www.gnu.org/licenses/>.
+*
+* For any further details and any questions please contact us under
+* contact@nymea.io or see our FAQ/Licensing Information on
+* https://nymea.io/license/faq
+*
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "maxbitreader.h"
+
+MaxBitReader::MaxBitReader(const QByteArray &data) :
+    m_data(data)
+{
+
+}
+
+quint32 MaxBitReader::readBits(int count)
+{
+    Q_ASSERT_X(count > 0 && count <= 32, "value out of range", "Only 1 to 32 bits can be read at once");
+    if (!checkBits(count))
+        return 0;
+
+    quint32 value = 0;
+
+    // Fast path for byte aligned reads
+    if (m_bitPosition % 8 == 0 && count % 8 == 0) {
+        int index = m_bitPosition / 8;
+        for (int i = 0; i < count / 8; i++) {
+            value = (value << 8) | static_cast<quint8>(m_data.at(index + i));
+        }
+        m_bitPosition += count;
+        return value;
+    }
+
+    for (int i = 0; i < count; i++) {
+        quint8 byte = static_cast<quint8>(m_data.at(m_bitPosition / 8));
+        value = (value << 1) | ((byte >> (7 - m_bitPosition % 8)) & 0x01);
+        m_bitPosition++;
+    }
+    return value;
+}
+
+bool MaxBitReader::readBit()
+{
+    return readBits(1) != 0;
+}
+
+quint8 MaxBitReader::readUInt8()
+{
+    return static_cast<quint8>(readBits(8));
+}
+
+quint16 MaxBitReader::readUInt16()
+{
+    return static_cast<quint16>(readBits(16));
+}
+
+quint32 MaxBitReader::readUInt24()
+{
+    return readBits(24);
+}
+
+QByteArray MaxBitReader::readBytes(int count)
+{
+    Q_ASSERT_X(m_bitPosition % 8 == 0, "unaligned read", "Byte arrays can only be read from byte boundaries");
+    if (count < 0 || !checkBits(count * 8))
+        return QByteArray();
+
+    QByteArray bytes = m_data.mid(m_bitPosition / 8, count);
+    m_bitPosition += count * 8;
+    return bytes;
+}
+
+QByteArray MaxBitReader::readHex(int count)
+{
+    return readBytes(count).toHex();
+}
+
+void MaxBitReader::skipBits(int count)
+{
+    if (checkBits(count)) {
+        m_bitPosition += count;
+    }
+}
+
+void MaxBitReader::skipBytes(int count)
+{
+    skipBits(count * 8);
+}
+
+int MaxBitReader::position() const
+{
+    return m_bitPosition / 8;
+}
+
+int MaxBitReader::bytesAvailable() const
+{
+    return (m_data.size() * 8 - m_bitPosition) / 8;
+}
+
+bool MaxBitReader::atEnd() const
+{
+    return m_bitPosition >= m_data.size() * 8;
+}
+
+bool MaxBitReader::isValid() const
+{
+    return m_valid;
+}
+
+bool MaxBitReader::checkBits(int count)
+{
+    if (m_bitPosition + count > m_data.size() * 8) {
+        m_valid = false;
+        m_bitPosition = m_data.size() * 8;
+        return false;
+    }
+    return true;
+}
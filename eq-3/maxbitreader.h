@@ -0,0 +1,68 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+*
+* Copyright 2013 - 2020, nymea GmbH
+* Contact: contact@nymea.io
+*
+* This file is part of nymea.
+* This project including source code and documentation is protected by
+* copyright law, and remains the property of nymea GmbH. All rights, including
+* reproduction, publication, editing and translation, are reserved. The use of
+* this project is subject to the terms of a license agreement to be concluded
+* with nymea GmbH in accordance with the terms of use of nymea GmbH, available
+* under https://nymea.io/license
+*
+* GNU Lesser General Public License Usage
+* Alternatively, this project may be redistributed and/or modified under the
+* terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; version 3. This project is distributed in the hope that
+* it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+* warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this project. If not, see <https://www.gnu.org/licenses/>.
+*
+* For any further details and any questions please contact us under
+* contact@nymea.io or see our FAQ/Licensing Information on
+* https://nymea.io/license/faq
+*
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef MAXBITREADER_H
+#define MAXBITREADER_H
+
+#include <QByteArray>
+
+// Reads MSB first bit fields directly from the raw bytes of a decoded cube message
+class MaxBitReader
+{
+public:
+    explicit MaxBitReader(const QByteArray &data);
+
+    quint32 readBits(int count);
+    bool readBit();
+    quint8 readUInt8();
+    quint16 readUInt16();
+    quint32 readUInt24();
+    QByteArray readBytes(int count);
+    QByteArray readHex(int count);
+
+    void skipBits(int count);
+    void skipBytes(int count);
+
+    int position() const;
+    int bytesAvailable() const;
+    bool atEnd() const;
+
+    // False once a read went past the end of the data
+    bool isValid() const;
+
+private:
+    QByteArray m_data;
+    int m_bitPosition = 0;
+    bool m_valid = true;
+
+    bool checkBits(int count);
+};
+
+#endif // MAXBITREADER_H
@@ -127,6 +127,7 @@ QList<Room *> MaxCube::roomList()
 
 void MaxCube::connectToCube()
 {
+    m_readBuffer.clear();
     connectToHost(m_hostAddress,m_port);
 }
 
@@ -156,9 +157,13 @@ bool MaxCube::isInitialized()
     return m_cubeInitialized;
 }
 
-void MaxCube::decodeHelloMessage(QByteArray data)
+void MaxCube::decodeHelloMessage(const QByteArray &data)
 {
     QList<QByteArray> list = data.split(',');
+    if(list.count() < 11){
+        qCWarning(dcEQ3) << "Invalid hello message" << data;
+        return;
+    }
     m_cubeDateTime = calculateDateTime(list.at(7),list.at(8));
 
     m_rfAddress = list.at(1);
@@ -176,28 +181,38 @@ void MaxCube::decodeHelloMessage(QByteArray data)
     qCDebug(dcEQ3) << "             NTP counter | " << list.at(10);
 }
 
-void MaxCube::decodeMetadataMessage(QByteArray data)
+void MaxCube::decodeMetadataMessage(const QByteArray &data)
 {
-    QList<QByteArray> list = data.left(data.length()-2).split(',');
-    QByteArray dataDecoded = QByteArray::fromBase64(list.at(2));
+    QList<QByteArray> list = data.split(',');
+    if(list.count() < 3){
+        qCWarning(dcEQ3) << "Invalid metadata message" << data;
+        return;
+    }
+
+    MaxBitReader reader(QByteArray::fromBase64(list.at(2)));
     qCDebug(dcEQ3) << "====================================================";
     qCDebug(dcEQ3) << "               METADATA message:";
     qCDebug(dcEQ3) << "====================================================";
 
     // parse room list
-    int roomCount = dataDecoded.toHex().mid(4,2).toInt(0,16);
-
-    QByteArray roomRawData = dataDecoded.toHex();
-    roomRawData = roomRawData.right(roomRawData.length()-6);
+    reader.skipBytes(2);
+    int roomCount = reader.readUInt8();
 
     for(int i = 0; i < roomCount; i++){
+        int roomId = reader.readUInt8();
+        int roomNameLength = reader.readUInt8();
+        QByteArray roomName = reader.readBytes(roomNameLength);
+        QByteArray groupRfAddress = reader.readHex(3);
+        if(!reader.isValid()){
+            qCWarning(dcEQ3) << "Metadata message truncated while reading the room list";
+            return;
+        }
+
         Room *room = new Room(this);
-        room->setRoomId(roomRawData.left(2).toInt(0,16));
-        int roomNameLength = roomRawData.mid(2,2).toInt(0,16);
-        room->setRoomName(QByteArray::fromHex(roomRawData.mid(4,roomNameLength*2)));
-        room->setGroupRfAddress(roomRawData.mid(roomNameLength*2 + 4, 6));
+        room->setRoomId(roomId);
+        room->setRoomName(roomName);
+        room->setGroupRfAddress(groupRfAddress);
         m_roomList.append(room);
-        roomRawData = roomRawData.right(roomRawData.length() - ((roomNameLength*2) + 10));
     }
     qCDebug(dcEQ3) << "-------------------------|-------------------------";
     qCDebug(dcEQ3) << "found " << m_roomList.count() << "rooms";
@@ -211,94 +226,95 @@ void MaxCube::decodeMetadataMessage(QByteArray data)
     }
 
     // parse thing list
-    int deviceCount = roomRawData.left(2).toInt(0,16);
-    QByteArray deviceRawData = roomRawData.right(roomRawData.length() - 2);
+    int deviceCount = reader.readUInt8();
 
     qCDebug(dcEQ3) << "-------------------------|-------------------------";
     qCDebug(dcEQ3) << "found " << deviceCount << "devices";
     qCDebug(dcEQ3) << "-------------------------|-------------------------";
 
     for(int i = 0; i < deviceCount; i++){
-        int deviceType = deviceRawData.left(2).toInt(0,16);
+        int deviceType = reader.readUInt8();
+        QByteArray rfAddress = reader.readHex(3);
+        QByteArray serialNumber = reader.readBytes(10);
+        int deviceNameLenght = reader.readUInt8();
+        QByteArray deviceName = reader.readBytes(deviceNameLenght);
+        int roomId = reader.readUInt8();
+        if(!reader.isValid()){
+            qCWarning(dcEQ3) << "Metadata message truncated while reading the device list";
+            break;
+        }
+
+        MaxDevice *thing = nullptr;
         switch (deviceType) {
         case MaxDevice::DeviceRadiatorThermostat:{
-            RadiatorThermostat* thing = new RadiatorThermostat(this);
-            thing->setDeviceType(deviceType);
-            thing->setRfAddress(deviceRawData.mid(2,6));
-            thing->setSerialNumber(QByteArray::fromHex(deviceRawData.mid(8,20)));
-            int deviceNameLenght = deviceRawData.mid(28,2).toInt(0,16);
-            thing->setDeviceName(QByteArray::fromHex(deviceRawData.mid(30,deviceNameLenght*2)));
-            thing->setRoomId(deviceRawData.mid(30 + deviceNameLenght*2,2).toInt(0,16));
-            deviceRawData = deviceRawData.right(deviceRawData.length() - (32 + deviceNameLenght*2));
-
-            // set room data for each thing
-            foreach (Room * room, m_roomList) {
-                if(thing->roomId() == room->roomId()){
-                    thing->setRoomName(room->roomName());
-                }
-            }
-            m_radiatorThermostatList.append(thing);
-
-            qCDebug(dcEQ3) << "             Device Name | " << thing->deviceName();
-            qCDebug(dcEQ3) << "            Serial Number| " << thing->serialNumber();
-            qCDebug(dcEQ3) << "      Device Type String | " << thing->deviceTypeString();
-            qCDebug(dcEQ3) << "        RF address (hex) | " << thing->rfAddress();
-            qCDebug(dcEQ3) << "                 Room ID | " << thing->roomId();
-            qCDebug(dcEQ3) << "               Room Name | " << thing->roomName();
-            qCDebug(dcEQ3) << "-------------------------|-------------------------";
+            RadiatorThermostat *radiatorThermostat = new RadiatorThermostat(this);
+            m_radiatorThermostatList.append(radiatorThermostat);
+            thing = radiatorThermostat;
             break;
         }
         case MaxDevice::DeviceWallThermostat:{
-            WallThermostat* thing = new WallThermostat(this);
-            thing->setDeviceType(deviceType);
-            thing->setRfAddress(deviceRawData.mid(2,6));
-            thing->setSerialNumber(QByteArray::fromHex(deviceRawData.mid(8,20)));
-            int deviceNameLenght = deviceRawData.mid(28,2).toInt(0,16);
-            thing->setDeviceName(QByteArray::fromHex(deviceRawData.mid(30,deviceNameLenght*2)));
-            thing->setRoomId(deviceRawData.mid(30 + deviceNameLenght*2,2).toInt(0,16));
-            deviceRawData = deviceRawData.right(deviceRawData.length() - (32 + deviceNameLenght*2));
-
-            // set room data for each thing
-            foreach (Room * room, m_roomList) {
-                if(thing->roomId() == room->roomId()){
-                    thing->setRoomName(room->roomName());
-                }
-            }
-            m_wallThermostatList.append(thing);
-
-            qCDebug(dcEQ3) << "             Device Name | " << thing->deviceName();
-            qCDebug(dcEQ3) << "            Serial Number| " << thing->serialNumber();
-            qCDebug(dcEQ3) << "      Device Type String | " << thing->deviceTypeString();
-            qCDebug(dcEQ3) << "        RF address (hex) | " << thing->rfAddress();
-            qCDebug(dcEQ3) << "                 Room ID | " << thing->roomId();
-            qCDebug(dcEQ3) << "               Room Name | " << thing->roomName();
-            qCDebug(dcEQ3) << "-------------------------|-------------------------";
+            WallThermostat *wallThermostat = new WallThermostat(this);
+            m_wallThermostatList.append(wallThermostat);
+            thing = wallThermostat;
             break;
         }
         default:
             break;
         }
+
+        if(!thing){
+            continue;
+        }
+
+        thing->setDeviceType(deviceType);
+        thing->setRfAddress(rfAddress);
+        thing->setSerialNumber(serialNumber);
+        thing->setDeviceName(deviceName);
+        thing->setRoomId(roomId);
+
+        // set room data for each thing
+        foreach (Room * room, m_roomList) {
+            if(thing->roomId() == room->roomId()){
+                thing->setRoomName(room->roomName());
+            }
+        }
+
+        qCDebug(dcEQ3) << "             Device Name | " << thing->deviceName();
+        qCDebug(dcEQ3) << "            Serial Number| " << thing->serialNumber();
+        qCDebug(dcEQ3) << "      Device Type String | " << thing->deviceTypeString();
+        qCDebug(dcEQ3) << "        RF address (hex) | " << thing->rfAddress();
+        qCDebug(dcEQ3) << "                 Room ID | " << thing->roomId();
+        qCDebug(dcEQ3) << "               Room Name | " << thing->roomName();
+        qCDebug(dcEQ3) << "-------------------------|-------------------------";
     }
 
     m_cubeInitialized = true;
 }
 
-void MaxCube::decodeConfigMessage(QByteArray data)
+void MaxCube::decodeConfigMessage(const QByteArray &data)
 {
     QList<QByteArray> list = data.split(',');
     if(list.count() < 2){
         return;
     }
     QByteArray rfAddress = list.at(0);
-    QByteArray dataRaw = QByteArray::fromBase64(list.at(1)).toHex();
-    int lengthData = dataRaw.left(2).toInt(0,16);
-    if(rfAddress != dataRaw.mid(2,6)){
+    QByteArray configData = QByteArray::fromBase64(list.at(1));
+
+    MaxBitReader reader(configData);
+    int lengthData = reader.readUInt8();
+    if(rfAddress != reader.readHex(3)){
         qCWarning(dcEQ3) << "RF addresses not equal!";
     }
-    int deviceType = dataRaw.mid(8,2).toInt(0,16);
-    //QByteArray unknown = dataRaw.mid(12,6);
+    int deviceType = reader.readUInt8();
+    reader.skipBytes(1); // room id
+    int firmware = reader.readUInt8();
+    reader.skipBytes(1); // test result
+    QByteArray serialNumber = reader.readBytes(10);
+    if(!reader.isValid()){
+        qCWarning(dcEQ3) << "Config message too short for" << rfAddress;
+        return;
+    }
 
-    QByteArray serialNumber = QByteArray::fromHex(dataRaw.mid(16,20));
     qCDebug(dcEQ3) << "====================================================";
     qCDebug(dcEQ3) << "               CONFIG message:";
     qCDebug(dcEQ3) << "====================================================";
@@ -311,40 +327,36 @@ void MaxCube::decodeConfigMessage(QByteArray data)
     switch (deviceType) {
     case MaxDevice::DeviceCube:{
 
-        m_portalEnabeld = (bool)dataRaw.mid(36,2).toInt(0,16);
+        m_portalEnabeld = (bool)reader.readUInt8();
 
         qCDebug(dcEQ3) << "          portal enabled | " << m_portalEnabeld;
-        qCDebug(dcEQ3) << "              portal URL | " << QString(QByteArray::fromHex(dataRaw.mid(170,68)));
-        qCDebug(dcEQ3) << "               time zone | " << QString(QByteArray::fromHex(dataRaw.mid(428,6)));
-        qCDebug(dcEQ3) << "      summer/winter time | " << QString(QByteArray::fromHex(dataRaw.mid(452,8)));
+        qCDebug(dcEQ3) << "              portal URL | " << QString(configData.mid(85,34));
+        qCDebug(dcEQ3) << "               time zone | " << QString(configData.mid(214,3));
+        qCDebug(dcEQ3) << "      summer/winter time | " << QString(configData.mid(226,4));
         emit cubeConfigReady();
         break;
     }
     case MaxDevice::DeviceRadiatorThermostat:{
         foreach (RadiatorThermostat* thing, m_radiatorThermostatList) {
             if(thing->rfAddress() == rfAddress){
-
-                //int roomId = dataRaw.mid(10,2).toInt(0,16);
-                int firmware = dataRaw.mid(12,2).toInt(0,16);
-                thing->setComfortTemp((double)dataRaw.mid(36,2).toInt(0,16) / 2.0);
-                thing->setEcoTemp((double)dataRaw.mid(38,2).toInt(0,16) / 2.0);
-                thing->setMaxSetPointTemp((double)dataRaw.mid(40,2).toInt(0,16) / 2.0);
-                thing->setMinSetPointTemp((double)dataRaw.mid(42,2).toInt(0,16) / 2.0);
-                thing->setOffsetTemp((double)(dataRaw.mid(44,2).toInt(0,16) / 2.0 ) - 3.5);
-                thing->setWindowOpenTemp((double)dataRaw.mid(46,2).toInt(0,16)/2.0);
-                thing->setWindowOpenDuration(dataRaw.mid(48,2).toInt(0,16));
-                // boost code
-                QByteArray boostDurationCode = fillBin(QByteArray::number(dataRaw.mid(50,2).toInt(0,16),2),8);
-                thing->setBoostDuration(boostDurationCode.left(3).toInt(0,2) * 5);
-                thing->setBoostValveValue(boostDurationCode.right(5).toInt(0,2) * 5);
-
-                // day of week an time
-                QByteArray dowTime = fillBin(QByteArray::number(dataRaw.mid(52,2).toInt(0,16),2),8);
-                thing->setDiscalcingWeekDay(weekDayString(dowTime.left(3).toInt(0,2)));
-                thing->setDiscalcingTime(QTime(dowTime.right(5).toInt(0,2),0));
-
-                thing->setValveMaximumSettings((double)dataRaw.mid(54,2).toInt(0,16)*(double)100.0/255.0);
-                thing->setValveOffset((double)dataRaw.mid(56,2).toInt(0,16)*100.0/255.0);
+                MaxBitReader deviceReader(reader);
+                thing->setComfortTemp(deviceReader.readUInt8() / 2.0);
+                thing->setEcoTemp(deviceReader.readUInt8() / 2.0);
+                thing->setMaxSetPointTemp(deviceReader.readUInt8() / 2.0);
+                thing->setMinSetPointTemp(deviceReader.readUInt8() / 2.0);
+                thing->setOffsetTemp((deviceReader.readUInt8() / 2.0) - 3.5);
+                thing->setWindowOpenTemp(deviceReader.readUInt8() / 2.0);
+                thing->setWindowOpenDuration(deviceReader.readUInt8());
+                // boost code: 3 bit duration, 5 bit valve value
+                thing->setBoostDuration(deviceReader.readBits(3) * 5);
+                thing->setBoostValveValue(deviceReader.readBits(5) * 5);
+
+                // day of week an time: 3 bit week day, 5 bit hour
+                thing->setDiscalcingWeekDay(weekDayString(deviceReader.readBits(3)));
+                thing->setDiscalcingTime(QTime(deviceReader.readBits(5),0));
+
+                thing->setValveMaximumSettings(deviceReader.readUInt8() * 100.0 / 255.0);
+                thing->setValveOffset(deviceReader.readUInt8() * 100.0 / 255.0);
 
                 qCDebug(dcEQ3) << "                 Room ID | " << thing->roomId();
                 qCDebug(dcEQ3) << "                firmware | " << firmware;
@@ -361,7 +373,7 @@ void MaxCube::decodeConfigMessage(QByteArray data)
                 qCDebug(dcEQ3) << "    disclaiming run time | " << thing->discalcingTime().toString("HH:mm");
                 qCDebug(dcEQ3) << "  Valve Maximum Settings | " << thing->valveMaximumSettings() << "%";
                 qCDebug(dcEQ3) << "            Valve Offset | " << thing->valveOffset() << "%";
-                parseWeeklyProgram(dataRaw.right(dataRaw.length() - 58));
+                parseWeeklyProgram(deviceReader);
                 emit radiatorThermostatFound();
             }
         }
@@ -372,12 +384,11 @@ void MaxCube::decodeConfigMessage(QByteArray data)
     case MaxDevice::DeviceWallThermostat:{
         foreach (WallThermostat* thing, m_wallThermostatList) {
             if(thing->rfAddress() == rfAddress){
-                //int roomId = dataRaw.mid(10,2).toInt(0,16);
-                int firmware = dataRaw.mid(12,2).toInt(0,16);
-                thing->setComfortTemp((double)dataRaw.mid(36,2).toInt(0,16) / 2.0);
-                thing->setEcoTemp((double)dataRaw.mid(38,2).toInt(0,16)/2.0);
-                thing->setMaxSetPointTemp((double)dataRaw.mid(40,2).toInt(0,16)/2.0);
-                thing->setMinSetPointTemp((double)dataRaw.mid(42,2).toInt(0,16)/2.0);
+                MaxBitReader deviceReader(reader);
+                thing->setComfortTemp(deviceReader.readUInt8() / 2.0);
+                thing->setEcoTemp(deviceReader.readUInt8() / 2.0);
+                thing->setMaxSetPointTemp(deviceReader.readUInt8() / 2.0);
+                thing->setMinSetPointTemp(deviceReader.readUInt8() / 2.0);
 
                 qCDebug(dcEQ3) << "                 Room ID | " << thing->roomId();
                 qCDebug(dcEQ3) << "                firmware | " << firmware;
@@ -386,7 +397,7 @@ void MaxCube::decodeConfigMessage(QByteArray data)
                 qCDebug(dcEQ3) << "    Max. Set Point Temp. | " << thing->maxSetPointTemp();
                 qCDebug(dcEQ3) << "    Min. Set Point Temp. | " << thing->minSetPointTemp();
 
-                parseWeeklyProgram(dataRaw.right(dataRaw.length() - 44));
+                parseWeeklyProgram(deviceReader);
                 emit wallThermostatFound();
             }
         }
@@ -402,55 +413,82 @@ void MaxCube::decodeConfigMessage(QByteArray data)
     }
 }
 
-void MaxCube::decodeDevicelistMessage(QByteArray data)
+void MaxCube::decodeDevicelistMessage(const QByteArray &data)
 {
     qCDebug(dcEQ3) << "====================================================";
     qCDebug(dcEQ3) << "               LIVE message:";
     qCDebug(dcEQ3) << "====================================================";
 
-    QByteArray rawDataAll = QByteArray::fromBase64(data).toHex();
-    QList<QByteArray> deviceMessageList = splitMessage(rawDataAll);
-
-    foreach (QByteArray rawData, deviceMessageList) {
+    QByteArray liveData = QByteArray::fromBase64(data);
+    MaxBitReader reader(liveData);
+
+    // Each device block starts with its length byte
+    while(!reader.atEnd()){
+        int length = reader.readUInt8();
+        int start = reader.position();
+        MaxBitReader deviceReader(reader);
+        reader.skipBytes(length);
+        if(!reader.isValid() || length < 6){
+            qCWarning(dcEQ3) << "Invalid device block in live message";
+            return;
+        }
 
-        QByteArray rfAddress = rawData.mid(0,6);
+        QByteArray rfAddress = deviceReader.readHex(3);
         int deviceType = deviceTypeFromRFAddress(rfAddress);
+        deviceReader.skipBytes(1);
+
+        // init/valid code
+        deviceReader.skipBits(3);
+        bool informationValid = deviceReader.readBit();
+        bool errorOccurred = deviceReader.readBit();
+        bool isAnswereToCommand = deviceReader.readBit();
+        bool initialized = deviceReader.readBit();
+        deviceReader.skipBits(1);
+
+        // status code
+        bool batteryLow = deviceReader.readBit();
+        bool linkError = deviceReader.readBit();
+        bool panelLocked = deviceReader.readBit();
+        bool gatewayKnown = deviceReader.readBit();
+        bool dtsActive = deviceReader.readBit();
+        deviceReader.skipBits(1);
+        int deviceMode = deviceReader.readBits(2);
 
         switch (deviceType) {
         case MaxDevice::DeviceWallThermostat:{
+            if(length < 9){
+                qCWarning(dcEQ3) << "Live data of wall thermostat" << rfAddress << "too short";
+                break;
+            }
+
+            // calculate current temperature and setpoint temperature
+            deviceReader.skipBytes(1);
+            bool currentTemperatureHighBit = deviceReader.readBits(2) == 0x02;
+            double setpointTemperature = deviceReader.readBits(6) / 2.0;
+            double currentTemperature = static_cast<quint8>(liveData.at(start + length - 1)) / 10.0;
+            if(currentTemperatureHighBit){
+                currentTemperature += 25.6;
+            }
+
             foreach (WallThermostat *thing, m_wallThermostatList) {
                 if(thing->rfAddress() == rfAddress){
-
-                    // init/valid code
-                    QByteArray initCode = fillBin(QByteArray::number(rawData.mid(8,2).toInt(0,16),2),8);
-                    thing->setInformationValid((bool)initCode.mid(3,1).toInt());
-                    thing->setErrorOccurred((bool)initCode.mid(4,1).toInt());
-                    thing->setIsAnswereToCommand((bool)initCode.mid(5,1).toInt());
-                    thing->setInitialized((bool)initCode.mid(6,1).toInt());
-
-                    // status code
-                    QByteArray statusCode = fillBin(QByteArray::number(rawData.mid(10,2).toInt(0,16),2),8);
-                    thing->setBatteryLow((bool)statusCode.mid(0,1).toInt());
-                    thing->setLinkStatusOK(!(bool)statusCode.mid(1,1).toInt());
-                    thing->setPanelLocked((bool)statusCode.mid(2,1).toInt());
-                    thing->setGatewayKnown((bool)statusCode.mid(3,1).toInt());
-                    thing->setDtsActive((bool)statusCode.mid(4,1).toInt());
-                    thing->setDeviceMode(statusCode.right(2).toInt(0,2));
-
-                    // calculate current temperature and setpoint temperature
-                    QByteArray tempCode = fillBin(QByteArray::number(rawData.mid(14,2).toInt(0,16),2),8);
-                    thing->setSetpointTemperatre((double)tempCode.right(6).toInt(0,2) / 2.0);
-                    if(tempCode.left(2) == "10"){
-                        thing->setCurrentTemperatre(((double)rawData.right(2).toInt(0,16) / 10.0) + 25.6);
-                    }else{
-                        thing->setCurrentTemperatre((double)rawData.right(2).toInt(0,16) / 10.0);
-                    }
-
-                    qCDebug(dcEQ3) << "                raw data | " << rawData;
+                    thing->setInformationValid(informationValid);
+                    thing->setErrorOccurred(errorOccurred);
+                    thing->setIsAnswereToCommand(isAnswereToCommand);
+                    thing->setInitialized(initialized);
+                    thing->setBatteryLow(batteryLow);
+                    thing->setLinkStatusOK(!linkError);
+                    thing->setPanelLocked(panelLocked);
+                    thing->setGatewayKnown(gatewayKnown);
+                    thing->setDtsActive(dtsActive);
+                    thing->setDeviceMode(deviceMode);
+                    thing->setSetpointTemperatre(setpointTemperature);
+                    thing->setCurrentTemperatre(currentTemperature);
+
+                    qCDebug(dcEQ3) << "                raw data | " << liveData.mid(start, length).toHex();
                     qCDebug(dcEQ3) << "             thing type | " << thing->deviceTypeString();
                     qCDebug(dcEQ3) << "             thing name | " << thing->deviceName();
                     qCDebug(dcEQ3) << "        RF address (hex) | " << thing->rfAddress();
-                    qCDebug(dcEQ3) << "                initCode | " << initCode;
                     qCDebug(dcEQ3) << "       information valid | " << thing->informationValid();
                     qCDebug(dcEQ3) << "          error occurred | " << thing->errorOccurred();
                     qCDebug(dcEQ3) << " is answere to a command | " << thing->isAnswereToCommand();
@@ -471,25 +509,28 @@ void MaxCube::decodeDevicelistMessage(QByteArray data)
             break;
         }
         case MaxDevice::DeviceRadiatorThermostat:{
-            foreach (RadiatorThermostat* thing, m_radiatorThermostatList) {
-                if(thing->rfAddress() == rfAddress){
-
-                    QByteArray initCode = fillBin(QByteArray::number(rawData.mid(8,2).toInt(0,16),2),8);
-                    thing->setInformationValid((bool)initCode.mid(3,1).toInt());
-                    thing->setErrorOccurred((bool)initCode.mid(4,1).toInt());
-                    thing->setIsAnswereToCommand((bool)initCode.mid(5,1).toInt());
-                    thing->setInitialized((bool)initCode.mid(6,1).toInt());
+            if(length < 8){
+                qCWarning(dcEQ3) << "Live data of radiator thermostat" << rfAddress << "too short";
+                break;
+            }
 
-                    QByteArray statusCode = fillBin(QByteArray::number(rawData.mid(10,2).toInt(0,16),2),8);
-                    thing->setBatteryLow((bool)statusCode.mid(0,1).toInt());
-                    thing->setLinkStatusOK(!(bool)statusCode.mid(1,1).toInt());
-                    thing->setPanelLocked((bool)statusCode.mid(2,1).toInt());
-                    thing->setGatewayKnown((bool)statusCode.mid(3,1).toInt());
-                    thing->setDtsActive((bool)statusCode.mid(4,1).toInt());
-                    thing->setDeviceMode(statusCode.right(2).toInt(0,2));
+            int valvePosition = deviceReader.readUInt8();
+            double setpointTemperature = deviceReader.readUInt8() / 2.0;
 
-                    thing->setValvePosition((double)rawData.mid(12,2).toInt(0,16));
-                    thing->setSetpointTemperatre((double)rawData.mid(14,2).toInt(0,16)/ 2.0);
+            foreach (RadiatorThermostat* thing, m_radiatorThermostatList) {
+                if(thing->rfAddress() == rfAddress){
+                    thing->setInformationValid(informationValid);
+                    thing->setErrorOccurred(errorOccurred);
+                    thing->setIsAnswereToCommand(isAnswereToCommand);
+                    thing->setInitialized(initialized);
+                    thing->setBatteryLow(batteryLow);
+                    thing->setLinkStatusOK(!linkError);
+                    thing->setPanelLocked(panelLocked);
+                    thing->setGatewayKnown(gatewayKnown);
+                    thing->setDtsActive(dtsActive);
+                    thing->setDeviceMode(deviceMode);
+                    thing->setValvePosition(valvePosition);
+                    thing->setSetpointTemperatre(setpointTemperature);
 
                     qCDebug(dcEQ3) << "             thing type | " << thing->deviceTypeString();
                     qCDebug(dcEQ3) << "             thing name | " << thing->deviceName();
@@ -514,13 +555,11 @@ void MaxCube::decodeDevicelistMessage(QByteArray data)
             break;
         }
         case MaxDevice::DeviceWindowContact:{
-            //QByteArray windowOpenRawData = fillBin(QByteArray::number(rawData.mid(10,2).toInt(0,16),2),8);
-            //bool windowOpen = (bool)windowOpenRawData.mid(5,1).toInt();
+            //bool windowOpen = (deviceReader.readUInt8() & 0x04);
 
-            //            qCDebug(dcEQ3) << "                raw data | " << rawData;
+            //            qCDebug(dcEQ3) << "                raw data | " << liveData.mid(start, length).toHex();
             //            qCDebug(dcEQ3) << "        thing type name | " << "Window Contact";
             //            qCDebug(dcEQ3) << "        RF address (hex) | " << rfAddress;
-            //            qCDebug(dcEQ3) << "        window open code | " << windowOpenRawData;
             //            qCDebug(dcEQ3) << "             window open | " << windowOpen;
             //            qCDebug(dcEQ3) << "-------------------------|-------------------------";
             break;
@@ -535,7 +574,7 @@ void MaxCube::decodeCommandMessage(QByteArray data)
 {
     QList<QByteArray> list = data.split(',');
 
-    if(list.isEmpty()){
+    if(list.count() < 3){
         return;
     }
     bool succeeded = !(bool)list.at(2).toInt(0,10);
@@ -546,23 +585,24 @@ void MaxCube::decodeCommandMessage(QByteArray data)
     processCommandQueue();
 }
 
-void MaxCube::parseWeeklyProgram(QByteArray data)
+void MaxCube::parseWeeklyProgram(MaxBitReader &reader)
 {
-    for(int i=0; i < 7; i++){
-        QByteArray dayData = data.left(52);
-        //qCDebug(dcEQ3) << weekDayString(i);
-        for(int i = 0; i < 52; i+=4){
-            QByteArray element = fillBin(QByteArray::number(dayData.mid(i,4).toInt(0,16),2),16);
-            //int minutes = element.right(9).toInt(0,2) * 5;
+    for(int day = 0; day < 7; day++){
+        //qCDebug(dcEQ3) << weekDayString(day);
+        for(int i = 0; i < 13; i++){
+            // 7 bit temperature and 9 bit end time of each program slot
+            int temperature = reader.readBits(7);
+            int minutes = reader.readBits(9) * 5;
+            Q_UNUSED(temperature)
+            Q_UNUSED(minutes)
             //int hours = (minutes / 60) % 24;
             //minutes = minutes % 60;
             //QTime time = QTime(hours,minutes);
-            //qCDebug(dcEQ3) << (double)element.left(7).toInt(0,2) / 2 << "\t" << "deg. until" << "\t" << time.toString("HH:mm");
+            //qCDebug(dcEQ3) << (double)temperature / 2 << "\t" << "deg. until" << "\t" << time.toString("HH:mm");
         }
-        data = data.right(data.length() - 52);
     }
-    if(!data.isEmpty()){
-        //qCDebug(dcEQ3) << "                       ? | " << data;
+    if(!reader.atEnd()){
+        //qCDebug(dcEQ3) << "                       ? | " << reader.bytesAvailable() << "bytes";
     }
 }
 
@@ -664,18 +704,6 @@ QByteArray MaxCube::fillBin(QByteArray data, int dataLength)
     return data;
 }
 
-QList<QByteArray> MaxCube::splitMessage(QByteArray data)
-{
-    QList<QByteArray> messageList;
-    while(!data.isEmpty()){
-        int length = data.left(2).toInt(0,16)*2;
-        messageList.append(data.mid(2,length));
-        data = data.right(data.length() - (length+2));
-    }
-    //qCDebug(dcEQ3) << messageList;
-    return messageList;
-}
-
 int MaxCube::deviceTypeFromRFAddress(QByteArray rfAddress)
 {
     foreach (WallThermostat* thing, m_wallThermostatList) {
@@ -723,52 +751,60 @@ void MaxCube::error(QAbstractSocket::SocketError error)
 
 void MaxCube::readData()
 {
-    QByteArray message;
-    while(canReadLine()){
-        QByteArray dataLine = readLine();
-        message.append(dataLine);
+    m_readBuffer.append(readAll());
+
+    // Emit each complete line without the line ending, a partial line stays buffered
+    int start = 0;
+    int end = m_readBuffer.indexOf('\n');
+    while(end >= 0){
+        int length = end - start;
+        if(length > 0 && m_readBuffer.at(end - 1) == '\r'){
+            length--;
+        }
+        if(length > 0){
+            emit cubeDataAvailable(m_readBuffer.mid(start, length));
+        }
+        start = end + 1;
+        end = m_readBuffer.indexOf('\n', start);
+    }
+    m_readBuffer.remove(0, start);
+
+    if(m_readBuffer.size() > 65536){
+        qCWarning(dcEQ3) << "Cube" << m_serialNumber << "sent a line exceeding 64 kB. Discarding data.";
+        m_readBuffer.clear();
     }
-    emit cubeDataAvailable(message);
 }
 
 void MaxCube::processCubeData(const QByteArray &data)
 {
     //qCDebug(dcEQ3) << "data" << data;
     if(data.startsWith("H")){
-        decodeHelloMessage(data.right(data.length() -2 ));
+        decodeHelloMessage(data.mid(2));
         return;
     }
     // METADATA message
     if(data.startsWith("M")){
-        decodeMetadataMessage(data.right(data.length() -2 ));
+        decodeMetadataMessage(data.mid(2));
         return;
     }
     // CONFIG message
     if(data.startsWith("C")){
-        QList<QByteArray> dataList = data.split('\r');
-        foreach (QByteArray dataElement, dataList) {
-            if(dataElement.startsWith("C")){
-                decodeConfigMessage(dataElement.right(dataElement.length() -2 ));
-            }
-            if(dataElement.startsWith("\nC")){
-                decodeConfigMessage(dataElement.right(dataElement.length() -3 ));
-            }
-        }
+        decodeConfigMessage(data.mid(2));
         return;
     }
     // LIVE message
     if(data.startsWith("L")){
-        decodeDevicelistMessage(data.right(data.length() -2 ));
+        decodeDevicelistMessage(data.mid(2));
         return;
     }
     // NEWDEVICEFOUND message
     if(data.startsWith("N")){
-        decodeNewDeviceFoundMessage(data.right(data.length() -2));
+        decodeNewDeviceFoundMessage(data.mid(2));
         return;
     }
     // COMMAND answere message
     if(data.startsWith("S")){
-        decodeCommandMessage(data.right(data.length() -2));
+        decodeCommandMessage(data.mid(2));
         return;
     }
     // ACK message
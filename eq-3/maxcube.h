@@ -37,6 +37,7 @@
 #include <QHostAddress>
 
 #include "maxdevice.h"
+#include "maxbitreader.h"
 #include "room.h"
 #include "wallthermostat.h"
 #include "radiatorthermostat.h"
@@ -143,12 +144,14 @@ private:
 
     bool m_cubeInitialized;
 
-    void decodeHelloMessage(QByteArray data);
-    void decodeMetadataMessage(QByteArray data);
-    void decodeConfigMessage(QByteArray data);
-    void decodeDevicelistMessage(QByteArray data);
+    QByteArray m_readBuffer;
+
+    void decodeHelloMessage(const QByteArray &data);
+    void decodeMetadataMessage(const QByteArray &data);
+    void decodeConfigMessage(const QByteArray &data);
+    void decodeDevicelistMessage(const QByteArray &data);
     void decodeCommandMessage(QByteArray data);
-    void parseWeeklyProgram(QByteArray data);
+    void parseWeeklyProgram(MaxBitReader &reader);
     void decodeNewDeviceFoundMessage(QByteArray data);
 
     QDateTime calculateDateTime(QByteArray dateRaw, QByteArray timeRaw);
@@ -156,7 +159,6 @@ private:
     QString weekDayString(int weekDay);
 
     QByteArray fillBin(QByteArray data, int dataLength);
-    QList<QByteArray> splitMessage(QByteArray data);
     int deviceTypeFromRFAddress(QByteArray rfAddress);
 
     struct Command {
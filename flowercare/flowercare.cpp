@@ -34,18 +34,33 @@
 
 #include <QDataStream>
 
-FlowerCare::FlowerCare(BluetoothLowEnergyDevice *thing, QObject *parent):
+FlowerCare::FlowerCare(BluetoothLowEnergyDevice *thing, BluetoothConnectionArbiter *connectionArbiter, QObject *parent):
     QObject(parent),
-    m_bluetoothDevice(thing)
+    m_bluetoothDevice(thing),
+    m_connectionArbiter(connectionArbiter)
 {
     connect(m_bluetoothDevice, &BluetoothLowEnergyDevice::connectedChanged, this, &FlowerCare::onConnectedChanged);
     connect(m_bluetoothDevice, &BluetoothLowEnergyDevice::servicesDiscoveryFinished, this, &FlowerCare::onServiceDiscoveryFinished);
+    connect(m_connectionArbiter, &BluetoothConnectionArbiter::connectionStatisticsChanged, this, [this](BluetoothLowEnergyDevice *device){
+        if (device != m_bluetoothDevice)
+            return;
+
+        qCDebug(dcFlowerCare()) << m_bluetoothDevice->address().toString() << "Connection attempts:" << m_connectionArbiter->connectionAttempts(device)
+                                << "failures:" << m_connectionArbiter->connectionFailures(device)
+                                << "latency:" << m_connectionArbiter->lastConnectionLatency(device) << "ms"
+                                << "average:" << m_connectionArbiter->averageConnectionLatency(device) << "ms";
+    });
 }
 
 void FlowerCare::refreshData()
 {
-    qCDebug(dcFlowerCare()) << "Connecting to device";
-    m_bluetoothDevice->connectDevice();
+    if (m_bluetoothDevice->connected()) {
+        qCDebug(dcFlowerCare()) << "Device already connected. Waiting for sensor data.";
+        return;
+    }
+
+    qCDebug(dcFlowerCare()) << "Requesting connection to device";
+    m_connectionArbiter->requestConnection(m_bluetoothDevice, BluetoothConnectionArbiter::PriorityPoll);
 }
 
 BluetoothLowEnergyDevice *FlowerCare::btDevice() const
@@ -84,6 +99,7 @@ void FlowerCare::onSensorServiceStateChanged(const QLowEnergyService::ServiceSta
     QLowEnergyCharacteristic batteryFirmwareCharacteristic = m_sensorService->characteristic(batteryFirmwareCharacteristicUuid);
     if (!batteryFirmwareCharacteristic.isValid()) {
         qCWarning(dcFlowerCare()) << "Invalid battery/firmware characteristic.";
+        m_connectionArbiter->releaseConnection(m_bluetoothDevice);
         emit failed();
         return;
     }
@@ -167,6 +183,6 @@ void FlowerCare::processSensorData(const QByteArray &data)
 
     qCDebug(dcFlowerCare()) << "Temperature:" << temp << "Lux:" << lux << "moisture:" << moisture << "fertility" << fertility;
 
-    m_bluetoothDevice->disconnectDevice();
+    m_connectionArbiter->releaseConnection(m_bluetoothDevice);
     emit finished(m_batteryLevel, 1.0 * temp / 10, lux, moisture, fertility);
 }
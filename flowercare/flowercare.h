@@ -32,8 +32,10 @@
 #define FLOWERCARE_H
 
 #include <QObject>
+#include <QPointer>
 
 #include "hardware/bluetoothlowenergy/bluetoothlowenergydevice.h"
+#include "bluetoothconnectionarbiter.h"
 
 static QBluetoothUuid sensorServiceUuid                      = QBluetoothUuid(QUuid("00001204-0000-1000-8000-00805f9b34fb"));
 
@@ -51,7 +53,7 @@ class FlowerCare : public QObject
 {
     Q_OBJECT
 public:
-    explicit FlowerCare(BluetoothLowEnergyDevice* thing, QObject *parent = nullptr);
+    explicit FlowerCare(BluetoothLowEnergyDevice* thing, BluetoothConnectionArbiter *connectionArbiter, QObject *parent = nullptr);
 
     void refreshData();
 
@@ -75,6 +77,7 @@ private:
     void processSensorData(const QByteArray &data);
 
     BluetoothLowEnergyDevice *m_bluetoothDevice;
+    QPointer<BluetoothConnectionArbiter> m_connectionArbiter;
 
     // Services
     QLowEnergyService *m_sensorService = nullptr;
@@ -1,13 +1,16 @@
 include(../plugins.pri)
+include(../common/bluetoothconnectionarbiter.pri)
 
-QT += bluetooth
+QT += bluetooth dbus
 
 TARGET = $$qtLibraryTarget(nymea_integrationpluginflowercare)
 
 SOURCES += \
     integrationpluginflowercare.cpp \
-    flowercare.cpp
+    flowercare.cpp \
+    mibeaconscanner.cpp
 
 HEADERS += \
     integrationpluginflowercare.h \
-    flowercare.h
+    flowercare.h \
+    mibeaconscanner.h
@@ -56,6 +56,19 @@ IntegrationPluginFlowercare::~IntegrationPluginFlowercare()
 
 void IntegrationPluginFlowercare::init()
 {
+    // Sensors are polled rarely, so connections are closed as soon as the data has been read
+    m_connectionArbiter = new BluetoothConnectionArbiter(this);
+    m_connectionArbiter->setIdleTimeout(0);
+    m_connectionArbiter->setConnectionBudget(configValue(flowerCarePluginConnectionBudgetParamTypeId).toInt());
+    connect(this, &IntegrationPluginFlowercare::configValueChanged, this, [this](const ParamTypeId &paramTypeId, const QVariant &value){
+        if (paramTypeId == flowerCarePluginConnectionBudgetParamTypeId) {
+            qCDebug(dcFlowerCare()) << "Bluetooth connection budget changed to" << value.toInt();
+            m_connectionArbiter->setConnectionBudget(value.toInt());
+        }
+    });
+
+    m_beaconScanner = new MiBeaconScanner(this);
+    connect(m_beaconScanner, &MiBeaconScanner::measurementReceived, this, &IntegrationPluginFlowercare::onMeasurementReceived);
 }
 
 void IntegrationPluginFlowercare::discoverThings(ThingDiscoveryInfo *info)
@@ -111,7 +124,8 @@ void IntegrationPluginFlowercare::setupThing(ThingSetupInfo *info)
     QBluetoothDeviceInfo deviceInfo = QBluetoothDeviceInfo(address, thing->name(), 0);
 
     BluetoothLowEnergyDevice *bluetoothDevice = hardwareManager()->bluetoothLowEnergyManager()->registerDevice(deviceInfo, QLowEnergyController::PublicAddress);
-    FlowerCare *flowerCare = new FlowerCare(bluetoothDevice, this);
+    m_connectionArbiter->registerDevice(bluetoothDevice);
+    FlowerCare *flowerCare = new FlowerCare(bluetoothDevice, m_connectionArbiter, this);
     connect(flowerCare, &FlowerCare::finished, this, &IntegrationPluginFlowercare::onSensorDataReceived);
     m_list.insert(thing, flowerCare);
 
@@ -125,7 +139,7 @@ void IntegrationPluginFlowercare::setupThing(ThingSetupInfo *info)
     // Update refresh schedule when the refresh rate setting is changed
     connect(thing, &Thing::settingChanged, flowerCare, [this, thing] {
         FlowerCare *flowerCare = m_list.value(thing);
-        int refreshInterval = thing->setting(flowerCareSettingsRefreshRateParamTypeId).toInt();
+        int refreshInterval = connectionInterval(thing);
         if (m_refreshMinutes[flowerCare] > refreshInterval) {
             m_refreshMinutes[flowerCare] = refreshInterval;
         }
@@ -147,7 +161,10 @@ void IntegrationPluginFlowercare::thingRemoved(Thing *thing)
         return;
     }
 
+    m_connectionArbiter->unregisterDevice(flowerCare->btDevice());
     hardwareManager()->bluetoothLowEnergyManager()->unregisterDevice(flowerCare->btDevice());
+    m_refreshMinutes.remove(flowerCare);
+    m_lastSeen.remove(flowerCare);
     flowerCare->deleteLater();
 
     if (m_list.isEmpty() && m_reconnectTimer) {
@@ -156,10 +173,65 @@ void IntegrationPluginFlowercare::thingRemoved(Thing *thing)
     }
 }
 
+bool IntegrationPluginFlowercare::passiveScanningEnabled(Thing *thing) const
+{
+    return m_beaconScanner->available() && thing->setting(flowerCareSettingsPassiveScanningParamTypeId).toBool();
+}
+
+int IntegrationPluginFlowercare::connectionInterval(Thing *thing) const
+{
+    // With passive scanning the sensor values arrive with the advertisements,
+    // connections are only needed for reading the battery level
+    if (passiveScanningEnabled(thing)) {
+        return thing->setting(flowerCareSettingsBatteryRefreshRateParamTypeId).toInt() * 60;
+    }
+    return thing->setting(flowerCareSettingsRefreshRateParamTypeId).toInt();
+}
+
+void IntegrationPluginFlowercare::startPassiveScan()
+{
+    if (m_scanRunning || !hardwareManager()->bluetoothLowEnergyManager()->enabled())
+        return;
+
+    qCDebug(dcFlowerCare()) << "Starting passive scan for advertisements";
+    m_scanRunning = true;
+    BluetoothDiscoveryReply *reply = hardwareManager()->bluetoothLowEnergyManager()->discoverDevices();
+    connect(reply, &BluetoothDiscoveryReply::finished, this, [this, reply](){
+        reply->deleteLater();
+        m_scanRunning = false;
+        if (reply->error() != BluetoothDiscoveryReply::BluetoothDiscoveryReplyErrorNoError) {
+            qCDebug(dcFlowerCare()) << "Passive scan finished with error:" << reply->error();
+        }
+    });
+}
+
 void IntegrationPluginFlowercare::onPluginTimer()
 {
+    bool scanRequired = false;
+    QDateTime now = QDateTime::currentDateTime();
 
     foreach (FlowerCare *flowerCare, m_list) {
+        Thing *thing = m_list.key(flowerCare);
+        int refreshInterval = thing->setting(flowerCareSettingsRefreshRateParamTypeId).toInt();
+        bool recentlySeen = m_lastSeen.value(flowerCare).isValid() && m_lastSeen.value(flowerCare).secsTo(now) <= refreshInterval * 60;
+
+        if (passiveScanningEnabled(thing)) {
+            scanRequired = true;
+
+            // Fall back to connecting if no advertisement arrived within the refresh interval
+            if (!recentlySeen && m_refreshMinutes[flowerCare] > 0) {
+                qCDebug(dcFlowerCare()) << "No advertisement from" << flowerCare->btDevice()->address() << "within" << refreshInterval << "minutes. Connecting instead.";
+                m_refreshMinutes[flowerCare] = 0;
+            }
+
+            // Don't keep retrying the battery read every minute while advertisements keep the sensor reachable
+            if (recentlySeen && m_refreshMinutes[flowerCare] < -2) {
+                qCDebug(dcFlowerCare()) << "Failed to read battery level from" << flowerCare->btDevice()->address() << "Retrying in" << refreshInterval << "minutes";
+                m_refreshMinutes[flowerCare] = refreshInterval;
+                continue;
+            }
+        }
+
         if (--m_refreshMinutes[flowerCare] <= 0) {
             qCDebug(dcFlowerCare()) << "Refreshing" << flowerCare->btDevice()->address();
             flowerCare->refreshData();
@@ -168,11 +240,15 @@ void IntegrationPluginFlowercare::onPluginTimer()
         }
 
         // If we had 2 or more failed connection attempts, mark it as disconnected
-        if (m_refreshMinutes[flowerCare] < -2) {
+        if (m_refreshMinutes[flowerCare] < -2 && !recentlySeen) {
             qCDebug(dcFlowerCare()) << "Failed to refresh for"<< (m_refreshMinutes[flowerCare] * -1) << "minutes. Marking as unreachable";
-            m_list.key(flowerCare)->setStateValue(flowerCareConnectedStateTypeId, false);
+            thing->setStateValue(flowerCareConnectedStateTypeId, false);
         }
     }
+
+    if (scanRequired) {
+        startPassiveScan();
+    }
 }
 
 void IntegrationPluginFlowercare::onSensorDataReceived(quint8 batteryLevel, double degreeCelsius, double lux, double moisture, double fertility)
@@ -187,5 +263,47 @@ void IntegrationPluginFlowercare::onSensorDataReceived(quint8 batteryLevel, doub
     thing->setStateValue(flowerCareMoistureStateTypeId, moisture);
     thing->setStateValue(flowerCareConductivityStateTypeId, fertility);
 
-    m_refreshMinutes[flowerCare] = thing->setting(flowerCareSettingsRefreshRateParamTypeId).toInt();
+    m_lastSeen[flowerCare] = QDateTime::currentDateTime();
+    m_refreshMinutes[flowerCare] = connectionInterval(thing);
+}
+
+void IntegrationPluginFlowercare::onMeasurementReceived(const QBluetoothAddress &address, MiBeaconScanner::Measurement measurement, double value)
+{
+    FlowerCare *flowerCare = nullptr;
+    foreach (FlowerCare *candidate, m_list) {
+        if (candidate->btDevice()->address() == address) {
+            flowerCare = candidate;
+            break;
+        }
+    }
+
+    if (!flowerCare)
+        return;
+
+    Thing *thing = m_list.key(flowerCare);
+    if (!passiveScanningEnabled(thing))
+        return;
+
+    qCDebug(dcFlowerCare()) << "Advertisement from" << thing->name() << measurement << value;
+    m_lastSeen[flowerCare] = QDateTime::currentDateTime();
+    thing->setStateValue(flowerCareConnectedStateTypeId, true);
+
+    switch (measurement) {
+    case MiBeaconScanner::MeasurementTemperature:
+        thing->setStateValue(flowerCareTemperatureStateTypeId, value);
+        break;
+    case MiBeaconScanner::MeasurementMoisture:
+        thing->setStateValue(flowerCareMoistureStateTypeId, value);
+        break;
+    case MiBeaconScanner::MeasurementLightIntensity:
+        thing->setStateValue(flowerCareLightIntensityStateTypeId, value);
+        break;
+    case MiBeaconScanner::MeasurementConductivity:
+        thing->setStateValue(flowerCareConductivityStateTypeId, value);
+        break;
+    case MiBeaconScanner::MeasurementBatteryLevel:
+        thing->setStateValue(flowerCareBatteryLevelStateTypeId, value);
+        thing->setStateValue(flowerCareBatteryCriticalStateTypeId, value <= 10);
+        break;
+    }
 }
@@ -34,10 +34,14 @@
 
 #include <QPointer>
 #include <QHash>
+#include <QDateTime>
 #include "integrations/integrationplugin.h"
 #include "plugintimer.h"
 #include "hardware/bluetoothlowenergy/bluetoothlowenergydevice.h"
 
+#include "mibeaconscanner.h"
+#include "bluetoothconnectionarbiter.h"
+
 class FlowerCare;
 
 class IntegrationPluginFlowercare : public IntegrationPlugin
@@ -60,10 +64,20 @@ private:
     PluginTimer *m_reconnectTimer = nullptr;
     QHash<Thing*, FlowerCare*> m_list;
     QHash<FlowerCare*, int> m_refreshMinutes;
+    QHash<FlowerCare*, QDateTime> m_lastSeen;
+
+    MiBeaconScanner *m_beaconScanner = nullptr;
+    BluetoothConnectionArbiter *m_connectionArbiter = nullptr;
+    bool m_scanRunning = false;
+
+    bool passiveScanningEnabled(Thing *thing) const;
+    int connectionInterval(Thing *thing) const;
+    void startPassiveScan();
 
 private slots:
     void onPluginTimer();
     void onSensorDataReceived(quint8 batteryLevel, double degreeCelsius, double lux, double moisture, double fertility);
+    void onMeasurementReceived(const QBluetoothAddress &address, MiBeaconScanner::Measurement measurement, double value);
 
 };
 
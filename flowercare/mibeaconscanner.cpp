@@ -0,0 +1,192 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+*
+* Copyright 2013 - 2020, nymea GmbH
+* Contact: contact@nymea.io
+*
+* This file is part of nymea.
+* This project including source code and documentation is protected by
+* copyright law, and remains the property of nymea GmbH. All rights, including
+* reproduction, publication, editing and translation, are reserved. The use of
+* this project is subject to the terms of a license agreement to be concluded
+* with nymea GmbH in accordance with the terms of use of nymea GmbH, available
+* under https://nymea.io/license
+*
+* GNU Lesser General Public License Usage
+* Alternatively, this project may be redistributed and/or modified under the
+* terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; version 3. This project is distributed in the hope that
+* it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+* warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this project. If not, see <https://www.gnu.org/licenses/>.
+*
+* For any further details and any questions please contact us under
+* contact@nymea.io or see our FAQ/Licensing Information on
+* https://nymea.io/license/faq
+*
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "mibeaconscanner.h"
+#include "extern-plugininfo.h"
+
+#include <QDBusConnection>
+#include <QDBusArgument>
+#include <QDBusObjectPath>
+#include <QBluetoothUuid>
+
+static QBluetoothUuid miBeaconServiceUuid = QBluetoothUuid(static_cast<quint16>(0xfe95));
+
+MiBeaconScanner::MiBeaconScanner(QObject *parent) :
+    QObject(parent)
+{
+    QDBusConnection systemBus = QDBusConnection::systemBus();
+    if (!systemBus.isConnected()) {
+        qCWarning(dcFlowerCare()) << "System DBus not available. Passive scanning is not available.";
+        return;
+    }
+
+    // Known devices report new service data as property change
+    bool propertiesConnected = systemBus.connect("org.bluez", QString(), "org.freedesktop.DBus.Properties", "PropertiesChanged", this, SLOT(onPropertiesChanged(QDBusMessage)));
+
+    // Devices seen for the first time come with their service data in the initial properties
+    bool interfacesConnected = systemBus.connect("org.bluez", "/", "org.freedesktop.DBus.ObjectManager", "InterfacesAdded", this, SLOT(onInterfacesAdded(QDBusMessage)));
+
+    m_available = propertiesConnected && interfacesConnected;
+    if (!m_available) {
+        qCWarning(dcFlowerCare()) << "Could not connect to bluez signals. Passive scanning is not available.";
+    }
+}
+
+bool MiBeaconScanner::available() const
+{
+    return m_available;
+}
+
+void MiBeaconScanner::onPropertiesChanged(const QDBusMessage &message)
+{
+    if (message.arguments().count() < 2 || message.arguments().at(0).toString() != "org.bluez.Device1")
+        return;
+
+    QVariantMap changedProperties = qdbus_cast<QVariantMap>(message.arguments().at(1));
+    if (!changedProperties.contains("ServiceData"))
+        return;
+
+    // The object path ends with dev_XX_XX_XX_XX_XX_XX
+    QString deviceName = message.path().section('/', -1);
+    if (!deviceName.startsWith("dev_"))
+        return;
+
+    QBluetoothAddress address(deviceName.mid(4).replace('_', ':'));
+    processServiceData(address, changedProperties.value("ServiceData"));
+}
+
+void MiBeaconScanner::onInterfacesAdded(const QDBusMessage &message)
+{
+    if (message.arguments().count() < 2)
+        return;
+
+    const QDBusArgument interfacesArgument = message.arguments().at(1).value<QDBusArgument>();
+    interfacesArgument.beginMap();
+    while (!interfacesArgument.atEnd()) {
+        QString interface;
+        QVariantMap properties;
+        interfacesArgument.beginMapEntry();
+        interfacesArgument >> interface >> properties;
+        interfacesArgument.endMapEntry();
+
+        if (interface == "org.bluez.Device1" && properties.contains("ServiceData")) {
+            QBluetoothAddress address(properties.value("Address").toString());
+            processServiceData(address, properties.value("ServiceData"));
+        }
+    }
+    interfacesArgument.endMap();
+}
+
+void MiBeaconScanner::processServiceData(const QBluetoothAddress &address, const QVariant &serviceDataVariant)
+{
+    if (address.isNull())
+        return;
+
+    QVariantMap serviceData = qdbus_cast<QVariantMap>(serviceDataVariant);
+    foreach (const QString &uuidString, serviceData.keys()) {
+        if (QBluetoothUuid(QUuid(uuidString)) != miBeaconServiceUuid)
+            continue;
+
+        processMiBeacon(address, serviceData.value(uuidString).toByteArray());
+    }
+}
+
+void MiBeaconScanner::processMiBeacon(const QBluetoothAddress &address, const QByteArray &data)
+{
+    // Frame control (2), product id (2), frame counter (1)
+    if (data.size() < 5)
+        return;
+
+    const uchar *bytes = reinterpret_cast<const uchar *>(data.constData());
+    quint16 frameControl = static_cast<quint16>(bytes[0] | (bytes[1] << 8));
+    quint16 productId = static_cast<quint16>(bytes[2] | (bytes[3] << 8));
+    quint8 frameCounter = bytes[4];
+
+    // Encrypted beacons need the bind key, the Flower Care sends them unencrypted
+    if (frameControl & 0x0008) {
+        qCDebug(dcFlowerCare()) << "Ignoring encrypted MiBeacon from" << address.toString();
+        return;
+    }
+
+    if (!(frameControl & 0x0040))
+        return;
+
+    quint64 addressKey = address.toUInt64();
+    if (m_frameCounters.contains(addressKey) && m_frameCounters.value(addressKey) == frameCounter)
+        return;
+
+    m_frameCounters.insert(addressKey, frameCounter);
+
+    int offset = 5;
+    if (frameControl & 0x0010)
+        offset += 6; // MAC address
+
+    if (frameControl & 0x0020)
+        offset += 1; // Capability
+
+    // Object id (2), length (1), value
+    while (offset + 3 <= data.size()) {
+        quint16 objectId = static_cast<quint16>(bytes[offset] | (bytes[offset + 1] << 8));
+        int length = bytes[offset + 2];
+        offset += 3;
+        if (offset + length > data.size()) {
+            qCDebug(dcFlowerCare()) << "Truncated MiBeacon object from" << address.toString() << data.toHex();
+            return;
+        }
+
+        const uchar *value = bytes + offset;
+        switch (objectId) {
+        case 0x1004:
+            if (length >= 2)
+                emit measurementReceived(address, MeasurementTemperature, static_cast<qint16>(value[0] | (value[1] << 8)) / 10.0);
+            break;
+        case 0x1007:
+            if (length >= 3)
+                emit measurementReceived(address, MeasurementLightIntensity, value[0] | (value[1] << 8) | (value[2] << 16));
+            break;
+        case 0x1008:
+            if (length >= 1)
+                emit measurementReceived(address, MeasurementMoisture, value[0]);
+            break;
+        case 0x1009:
+            if (length >= 2)
+                emit measurementReceived(address, MeasurementConductivity, value[0] | (value[1] << 8));
+            break;
+        case 0x100a:
+            if (length >= 1)
+                emit measurementReceived(address, MeasurementBatteryLevel, value[0]);
+            break;
+        default:
+            qCDebug(dcFlowerCare()) << "Unhandled MiBeacon object" << QString::number(objectId, 16) << "from" << address.toString() << "product" << QString::number(productId, 16);
+            break;
+        }
+        offset += length;
+    }
+}
@@ -0,0 +1,74 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+*
+* Copyright 2013 - 2020, nymea GmbH
+* Contact: contact@nymea.io
+*
+* This file is part of nymea.
+* This project including source code and documentation is protected by
+* copyright law, and remains the property of nymea GmbH. All rights, including
+* reproduction, publication, editing and translation, are reserved. The use of
+* this project is subject to the terms of a license agreement to be concluded
+* with nymea GmbH in accordance with the terms of use of nymea GmbH, available
+* under https://nymea.io/license
+*
+* GNU Lesser General Public License Usage
+* Alternatively, this project may be redistributed and/or modified under the
+* terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; version 3. This project is distributed in the hope that
+* it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+* warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this project. If not, see <https://www.gnu.org/licenses/>.
+*
+* For any further details and any questions please contact us under
+* contact@nymea.io or see our FAQ/Licensing Information on
+* https://nymea.io/license/faq
+*
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef MIBEACONSCANNER_H
+#define MIBEACONSCANNER_H
+
+#include <QObject>
+#include <QHash>
+#include <QDBusMessage>
+#include <QBluetoothAddress>
+
+// Decodes Xiaomi MiBeacon service data advertisements reported by BlueZ while a discovery is running
+class MiBeaconScanner : public QObject
+{
+    Q_OBJECT
+public:
+    enum Measurement {
+        MeasurementTemperature,
+        MeasurementMoisture,
+        MeasurementLightIntensity,
+        MeasurementConductivity,
+        MeasurementBatteryLevel
+    };
+    Q_ENUM(Measurement)
+
+    explicit MiBeaconScanner(QObject *parent = nullptr);
+
+    bool available() const;
+
+signals:
+    void measurementReceived(const QBluetoothAddress &address, MiBeaconScanner::Measurement measurement, double value);
+
+private slots:
+    void onPropertiesChanged(const QDBusMessage &message);
+    void onInterfacesAdded(const QDBusMessage &message);
+
+private:
+    bool m_available = false;
+
+    // Last frame counter per device, advertisements are repeated several times
+    QHash<quint64, quint8> m_frameCounters;
+
+    void processServiceData(const QBluetoothAddress &address, const QVariant &serviceDataVariant);
+    void processMiBeacon(const QBluetoothAddress &address, const QByteArray &data);
+};
+
+#endif // MIBEACONSCANNER_H
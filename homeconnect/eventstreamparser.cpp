@@ -0,0 +1,175 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+*
+* Copyright 2013 - 2020, nymea GmbH
+* Contact: contact@nymea.io
+*
+* This file is part of nymea.
+* This project including source code and documentation is protected by
+* copyright law, and remains the property of nymea GmbH. All rights, including
+* reproduction, publication, editing and translation, are reserved. The use of
+* this project is subject to the terms of a license agreement to be concluded
+* with nymea GmbH in accordance with the terms of use of nymea GmbH, available
+* under https://nymea.io/license
+*
+* GNU Lesser General Public License Usage
+* Alternatively, this project may be redistributed and/or modified under the
+* terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; version 3. This project is distributed in the hope that
+* it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+* warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this project. If not, see <https://www.gnu.org/licenses/>.
+*
+* For any further details and any questions please contact us under
+* contact@nymea.io or see our FAQ/Licensing Information on
+* https://nymea.io/license/faq
+*
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+#include "eventstreamparser.h"
+#include "extern-plugininfo.h"
+
+static const QByteArray byteOrderMark = QByteArrayLiteral("\xEF\xBB\xBF");
+
+EventStreamParser::EventStreamParser(QObject *parent) :
+    QObject(parent)
+{
+
+}
+
+QByteArray EventStreamParser::lastEventId() const
+{
+    return m_lastEventId;
+}
+
+void EventStreamParser::setLastEventId(const QByteArray &lastEventId)
+{
+    m_lastEventId = lastEventId;
+}
+
+int EventStreamParser::maximumEventSize() const
+{
+    return m_maximumEventSize;
+}
+
+void EventStreamParser::setMaximumEventSize(int maximumEventSize)
+{
+    m_maximumEventSize = maximumEventSize;
+}
+
+void EventStreamParser::addData(const QByteArray &data)
+{
+    m_buffer.append(data);
+
+    int lineStart = 0;
+    int position = m_searchPosition;
+    while (position < m_buffer.size()) {
+        char character = m_buffer.at(position);
+
+        // A CR line ending can be followed by a LF in the next chunk
+        if (m_skipLineFeed) {
+            m_skipLineFeed = false;
+            if (character == '\n' && position == lineStart) {
+                lineStart = ++position;
+                continue;
+            }
+        }
+
+        if (character == '\r' || character == '\n') {
+            processLine(m_buffer.mid(lineStart, position - lineStart));
+            m_skipLineFeed = (character == '\r');
+            lineStart = ++position;
+            continue;
+        }
+        position++;
+    }
+
+    m_buffer.remove(0, lineStart);
+    m_searchPosition = m_buffer.size();
+
+    if (m_buffer.size() + m_data.size() > m_maximumEventSize) {
+        qCWarning(dcHomeConnect()) << "Event stream: Event exceeds" << m_maximumEventSize << "bytes, discarding it";
+        m_buffer.clear();
+        m_searchPosition = 0;
+        m_eventType.clear();
+        m_data.clear();
+    }
+}
+
+void EventStreamParser::reset()
+{
+    m_buffer.clear();
+    m_searchPosition = 0;
+    m_streamStart = true;
+    m_skipLineFeed = false;
+    m_eventType.clear();
+    m_data.clear();
+}
+
+void EventStreamParser::processLine(const QByteArray &line)
+{
+    QByteArray currentLine = line;
+    if (m_streamStart) {
+        m_streamStart = false;
+        if (currentLine.startsWith(byteOrderMark))
+            currentLine.remove(0, byteOrderMark.size());
+    }
+
+    if (currentLine.isEmpty()) {
+        dispatchEvent();
+        return;
+    }
+
+    // Comment line, usually used as keep alive
+    if (currentLine.startsWith(':'))
+        return;
+
+    QByteArray field;
+    QByteArray value;
+    int colonIndex = currentLine.indexOf(':');
+    if (colonIndex < 0) {
+        field = currentLine;
+    } else {
+        field = currentLine.left(colonIndex);
+        value = currentLine.mid(colonIndex + 1);
+        if (value.startsWith(' '))
+            value.remove(0, 1);
+    }
+
+    if (field == "event") {
+        m_eventType = value;
+    } else if (field == "data") {
+        m_data.append(value);
+        m_data.append('\n');
+    } else if (field == "id") {
+        if (!value.contains('\0'))
+            m_lastEventId = value;
+    } else if (field == "retry") {
+        bool valid = false;
+        int retryInterval = value.toInt(&valid);
+        if (valid && retryInterval >= 0) {
+            emit retryReceived(retryInterval);
+        }
+    } else {
+        qCDebug(dcHomeConnect()) << "Event stream: Ignoring unknown field" << field;
+    }
+}
+
+void EventStreamParser::dispatchEvent()
+{
+    if (m_data.isEmpty()) {
+        m_eventType.clear();
+        return;
+    }
+
+    ServerSentEvent event;
+    event.type = m_eventType.isEmpty() ? QByteArray("message") : m_eventType;
+    event.data = m_data;
+    event.data.chop(1);
+    event.id = m_lastEventId;
+
+    m_eventType.clear();
+    m_data.clear();
+    emit eventReceived(event);
+}
@@ -0,0 +1,80 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+*
+* Copyright 2013 - 2020, nymea GmbH
+* Contact: contact@nymea.io
+*
+* This file is part of nymea.
+* This project including source code and documentation is protected by
+* copyright law, and remains the property of nymea GmbH. All rights, including
+* reproduction, publication, editing and translation, are reserved. The use of
+* this project is subject to the terms of a license agreement to be concluded
+* with nymea GmbH in accordance with the terms of use of nymea GmbH, available
+* under https://nymea.io/license
+*
+* GNU Lesser General Public License Usage
+* Alternatively, this project may be redistributed and/or modified under the
+* terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; version 3. This project is distributed in the hope that
+* it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+* warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this project. If not, see <https://www.gnu.org/licenses/>.
+*
+* For any further details and any questions please contact us under
+* contact@nymea.io or see our FAQ/Licensing Information on
+* https://nymea.io/license/faq
+*
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+#ifndef EVENTSTREAMPARSER_H
+#define EVENTSTREAMPARSER_H
+
+#include <QObject>
+#include <QByteArray>
+
+// Incremental parser for text/event-stream (Server-Sent Events) responses.
+// Data can be added in arbitrary chunks, events are emitted once the terminating
+// blank line has been received. Lines may end with CRLF, LF or CR.
+class EventStreamParser : public QObject
+{
+    Q_OBJECT
+public:
+    struct ServerSentEvent {
+        QByteArray type;
+        QByteArray data;
+        QByteArray id;
+    };
+
+    explicit EventStreamParser(QObject *parent = nullptr);
+
+    QByteArray lastEventId() const;
+    void setLastEventId(const QByteArray &lastEventId);
+
+    int maximumEventSize() const;
+    void setMaximumEventSize(int maximumEventSize);
+
+    void addData(const QByteArray &data);
+    void reset();
+
+signals:
+    void eventReceived(const EventStreamParser::ServerSentEvent &event);
+    void retryReceived(int retryInterval);
+
+private:
+    int m_maximumEventSize = 1024 * 1024;
+
+    QByteArray m_buffer;
+    int m_searchPosition = 0;
+    bool m_streamStart = true;
+    bool m_skipLineFeed = false;
+
+    QByteArray m_eventType;
+    QByteArray m_data;
+    QByteArray m_lastEventId;
+
+    void processLine(const QByteArray &line);
+    void dispatchEvent();
+};
+
+#endif // EVENTSTREAMPARSER_H
@@ -753,9 +753,16 @@ void HomeConnect::connectEventStream()
     request.setRawHeader("accept", "text/event-stream");
 
     QNetworkReply *reply = m_networkManager->get(request);
+    EventStreamParser *parser = new EventStreamParser(reply);
+    connect(parser, &EventStreamParser::eventReceived, this, &HomeConnect::processServerSentEvent);
+    connect(parser, &EventStreamParser::retryReceived, this, [this](int retryInterval) {
+        qCDebug(dcHomeConnect()) << "Event stream reconnect interval set to" << retryInterval << "ms";
+        m_eventStreamReconnectInterval = retryInterval;
+    });
+
     connect(reply, &QNetworkReply::finished, reply, &QNetworkReply::deleteLater);
     connect(reply, &QNetworkReply::finished, [reply, this] {
-        int reconnectTime = 5000; // Usual reconnect in 5 s
+        int reconnectTime = m_eventStreamReconnectInterval;
         if (reply->error() != QNetworkReply::NetworkError::NoError) {
             qCDebug(dcHomeConnect()) << "Event stream error" << reply->errorString() << reply->readAll();
         }
@@ -770,84 +777,73 @@ void HomeConnect::connectEventStream()
             connectEventStream();
         });
     });
-    connect(reply, &QNetworkReply::readyRead, this, [this, reply]{
-
+    connect(reply, &QNetworkReply::readyRead, this, [reply, parser]{
         int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
         if (status == 200) {
-            while (reply->canReadLine()) {
-                QJsonDocument data;
-                QString haId;
-                EventType eventType;
-
-                QByteArray eventTypeLine = reply->readLine();
-                if (eventTypeLine == "\n")
-                    continue;
-                if (eventTypeLine.startsWith("event")) {
-                    QString eventString = eventTypeLine.split(':').last().trimmed();
-                    if (eventString == "KEEP-ALIVE") {
-                        eventType = EventTypeKeepAlive;
-                    } else if (eventString == "STATUS") {
-                        eventType = EventTypeStatus;
-                    } else if (eventString == "EVENT") {
-                        eventType = EventTypeEvent;
-                    } else if (eventString == "NOTIFY") {
-                        eventType = EventTypeNotify;
-                    } else if (eventString == "DISCONNECTED") {
-                        eventType = EventTypeDisconnected;
-                    } else if (eventString == "CONNECTED") {
-                        eventType = EventTypeConnected;
-                    } else if (eventString == "PAIRED") {
-                        eventType = EventTypePaired;
-                    } else if (eventString == "DEPAIRED") {
-                        eventType = EventTypeDepaired;
-                    } else {
-                        qCWarning(dcHomeConnect()) << "Unhandled event type" << eventString;
-                        return;
-                    }
-                    QByteArray dataLine = reply->readLine();
-                    if (dataLine.startsWith("data")) {
-                        data = QJsonDocument::fromJson(dataLine.remove(0,6));
-
-                        QByteArray idLine = reply->readLine();
-                        if (idLine.startsWith("id")) {
-                            haId = idLine.split(':').last().trimmed();
-                        } else {
-                            qCWarning(dcHomeConnect()) << "Id line: Unexpected line" << eventTypeLine;
-                            continue;
-                        }
-                    } else {
-                        qCWarning(dcHomeConnect()) << "Data Line: Unexpected line" << eventTypeLine;
-                        continue;
-                    }
-                } else {
-                    qCWarning(dcHomeConnect()) << "Event type: Unexpected line" << eventTypeLine;
-                    continue;
-                }
-
-                if (data.toVariant().toMap().contains("items")) {
-                    QList<Event> events;
-                    QVariantList itemsList = data.toVariant().toMap().value("items").toList();
-                    Q_FOREACH(QVariant item, itemsList) {
-                        QVariantMap map = item.toMap();
-                        Event event;
-                        event.key = map["key"].toString();
-                        event.uri = map["uri"].toString();
-                        event.name = map["uri"].toString();
-                        event.value  = map["value"];
-                        event.unit = map["unit"].toString();
-                        event.timestamp  = map["timestamp"].toInt();
-                        events.append(event);
-                    }
-                    if (!events.isEmpty())
-                        emit receivedEvents(eventType, haId, events);
-                } else if (data.toVariant().toMap().contains("error")) {
-                    qCWarning(dcHomeConnect()) << "Event stream error" << data.toVariant().toMap().value("error");
-                }
-            }
+            // Events may be split across several reads, the parser buffers incomplete events
+            parser->addData(reply->readAll());
         }
     });
 }
 
+void HomeConnect::processServerSentEvent(const EventStreamParser::ServerSentEvent &serverSentEvent)
+{
+    EventType eventType;
+    if (serverSentEvent.type == "KEEP-ALIVE") {
+        return;
+    } else if (serverSentEvent.type == "STATUS") {
+        eventType = EventTypeStatus;
+    } else if (serverSentEvent.type == "EVENT") {
+        eventType = EventTypeEvent;
+    } else if (serverSentEvent.type == "NOTIFY") {
+        eventType = EventTypeNotify;
+    } else if (serverSentEvent.type == "DISCONNECTED") {
+        eventType = EventTypeDisconnected;
+    } else if (serverSentEvent.type == "CONNECTED") {
+        eventType = EventTypeConnected;
+    } else if (serverSentEvent.type == "PAIRED") {
+        eventType = EventTypePaired;
+    } else if (serverSentEvent.type == "DEPAIRED") {
+        eventType = EventTypeDepaired;
+    } else {
+        qCWarning(dcHomeConnect()) << "Unhandled event type" << serverSentEvent.type;
+        return;
+    }
+
+    if (serverSentEvent.data.isEmpty())
+        return;
+
+    // The id field of Home Connect events carries the home appliance id
+    QString haId = QString::fromUtf8(serverSentEvent.id).trimmed();
+
+    QJsonParseError error;
+    QVariantMap dataMap = QJsonDocument::fromJson(serverSentEvent.data, &error).toVariant().toMap();
+    if (error.error != QJsonParseError::NoError) {
+        qCWarning(dcHomeConnect()) << "Could not parse event data" << error.errorString() << serverSentEvent.data;
+        return;
+    }
+
+    if (dataMap.contains("items")) {
+        QList<Event> events;
+        QVariantList itemsList = dataMap.value("items").toList();
+        Q_FOREACH(QVariant item, itemsList) {
+            QVariantMap map = item.toMap();
+            Event event;
+            event.key = map["key"].toString();
+            event.uri = map["uri"].toString();
+            event.name = map["uri"].toString();
+            event.value  = map["value"];
+            event.unit = map["unit"].toString();
+            event.timestamp  = map["timestamp"].toInt();
+            events.append(event);
+        }
+        if (!events.isEmpty())
+            emit receivedEvents(eventType, haId, events);
+    } else if (dataMap.contains("error")) {
+        qCWarning(dcHomeConnect()) << "Event stream error" << dataMap.value("error");
+    }
+}
+
 QUuid HomeConnect::sendCommand(const QString &haid, const QString &command)
 {
     QUuid commandId = QUuid::createUuid();
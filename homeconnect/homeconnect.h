@@ -36,6 +36,7 @@
 #include <QUuid>
 
 #include "network/networkaccessmanager.h"
+#include "eventstreamparser.h"
 
 class HomeConnect : public QObject
 {
@@ -158,6 +159,7 @@ private:
 
     NetworkAccessManager *m_networkManager = nullptr;
     QTimer *m_tokenRefreshTimer = nullptr;
+    int m_eventStreamReconnectInterval = 5000; // Can be changed by the server with the retry field
 
     void setAuthenticated(bool state);
     void setConnected(bool state);
@@ -169,6 +171,7 @@ private:
 
 private slots:
     void onRefreshTimeout();
+    void processServerSentEvent(const EventStreamParser::ServerSentEvent &serverSentEvent);
 
 signals:
     void connectionChanged(bool connected);
@@ -5,7 +5,9 @@ QT += network
 SOURCES += \
     integrationpluginhomeconnect.cpp \
     homeconnect.cpp \
+    eventstreamparser.cpp \
 
 HEADERS += \
     integrationpluginhomeconnect.h \
     homeconnect.h \
+    eventstreamparser.h \
@@ -1,4 +1,5 @@
 include(../plugins.pri)
+include(../common/httprequestparser.pri)
 
 QT += network
 
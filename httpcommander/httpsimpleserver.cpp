@@ -37,8 +37,9 @@
 #include <QDebug>
 #include <QDateTime>
 #include <QUrlQuery>
-#include <QRegExp>
-#include <QStringList>
+#include <QTimer>
+
+#define KEEP_ALIVE_TIMEOUT 30000
 
 HttpSimpleServer::HttpSimpleServer(quint16 port, QObject *parent):
     QTcpServer(parent)
@@ -61,51 +62,88 @@ void HttpSimpleServer::incomingConnection(qintptr socket)
     connect(tcpSocket, SIGNAL(readyRead()), this, SLOT(readClient()));
     connect(tcpSocket, SIGNAL(disconnected()), this, SLOT(discardClient()));
     tcpSocket->setSocketDescriptor(socket);
+    m_clients.insert(tcpSocket, HttpRequestParser());
 
+    // Close persistent connections which have been idle for too long
+    QTimer *idleTimer = new QTimer(tcpSocket);
+    idleTimer->setObjectName("idleTimer");
+    idleTimer->setSingleShot(true);
+    idleTimer->setInterval(KEEP_ALIVE_TIMEOUT);
+    connect(idleTimer, &QTimer::timeout, tcpSocket, &QTcpSocket::disconnectFromHost);
+    idleTimer->start();
 }
 
 void HttpSimpleServer::readClient()
 {
-    // This slot is called when the client sent data to the server. The
-    // server looks if it was a get request and sends a very simple HTML
-    // document back.
+    // This slot is called when the client sent data to the server. Data
+    // is fed to the parser of this connection, which may hold any number
+    // of complete requests afterwards, or none if more data is required.
     QTcpSocket* tcpSocket = static_cast<QTcpSocket*>(sender());
-    if (tcpSocket->canReadLine()) {
+    if (!m_clients.contains(tcpSocket)) {
+        return;
+    }
 
-        QByteArray data = tcpSocket->readAll();
-        QStringList tokens = QString(data).split(QRegExp("[ \r\n][ \r\n]*"));
-        qCDebug(dcHttpCommander()) << "Http Request, type" << tokens[0] << "path" << tokens[1] << "body" << tokens.last();
+    HttpRequestParser &parser = m_clients[tcpSocket];
+    parser.addData(tcpSocket->readAll());
 
-        if ((tokens[0] == "GET")      ||
-                (tokens[0] == "PUT")  ||
-                (tokens[0] == "POST") ||
-                (tokens[0] == "DELETE")) {
+    QTimer *idleTimer = tcpSocket->findChild<QTimer *>("idleTimer");
+    if (idleTimer) {
+        idleTimer->start();
+    }
 
-            QTextStream os(tcpSocket);
-            os.setAutoDetectUnicode(true);
-            os << generateHeader();
-            tcpSocket->close();
+    while (parser.hasRequest()) {
+        HttpRequest request = parser.takeRequest();
+        qCDebug(dcHttpCommander()) << "Http Request, type" << request.method << "path" << request.path << "body" << request.body;
 
-            if (tcpSocket->state() == QTcpSocket::UnconnectedState)
-                delete tcpSocket;
+        bool keepAlive = request.keepAlive();
+        if ((request.method == "GET")      ||
+                (request.method == "PUT")  ||
+                (request.method == "POST") ||
+                (request.method == "DELETE")) {
+            tcpSocket->write(generateResponse(200, "Ok", keepAlive));
+            emit requestReceived(QString::fromUtf8(request.method), QString::fromUtf8(request.path), QString::fromUtf8(request.body));
+        } else {
+            tcpSocket->write(generateResponse(405, "Method Not Allowed", keepAlive));
+        }
 
-            emit requestReceived(tokens[0], tokens[1], tokens.last());
+        if (!keepAlive) {
+            // Remaining pipelined requests are dropped along with the connection
+            tcpSocket->disconnectFromHost();
+            return;
         }
     }
+
+    switch (parser.error()) {
+    case HttpRequestParser::ErrorNone:
+        break;
+    case HttpRequestParser::ErrorHeaderTooLarge:
+        tcpSocket->write(generateResponse(431, "Request Header Fields Too Large", false));
+        tcpSocket->disconnectFromHost();
+        break;
+    case HttpRequestParser::ErrorBodyTooLarge:
+        tcpSocket->write(generateResponse(413, "Payload Too Large", false));
+        tcpSocket->disconnectFromHost();
+        break;
+    case HttpRequestParser::ErrorBadRequest:
+        tcpSocket->write(generateResponse(400, "Bad Request", false));
+        tcpSocket->disconnectFromHost();
+        break;
+    }
 }
 
 void HttpSimpleServer::discardClient()
 {
     QTcpSocket* socket = static_cast<QTcpSocket*>(sender());
+    m_clients.remove(socket);
     socket->deleteLater();
 }
 
-QString HttpSimpleServer::generateHeader()
+QByteArray HttpSimpleServer::generateResponse(int statusCode, const QByteArray &reason, bool keepAlive)
 {
-    QString contentHeader(
-                "HTTP/1.0 200 Ok\r\n"
-                "Content-Type: text/html; charset=\"utf-8\"\r\n"
-                "\r\n"
-                );
-    return contentHeader;
+    QByteArray response = "HTTP/1.1 " + QByteArray::number(statusCode) + " " + reason + "\r\n";
+    response += "Content-Type: text/html; charset=\"utf-8\"\r\n";
+    response += "Content-Length: 0\r\n";
+    response += keepAlive ? "Connection: keep-alive\r\n" : "Connection: close\r\n";
+    response += "\r\n";
+    return response;
 }
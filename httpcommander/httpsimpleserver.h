@@ -32,8 +32,11 @@
 #define HTTPSIMPLESERVER1_H
 
 #include "typeutils.h"
+#include "httprequestparser.h"
 
 #include <QTcpServer>
+#include <QTcpSocket>
+#include <QHash>
 #include <QUuid>
 #include <QDateTime>
 #include <QUrl>
@@ -62,7 +65,9 @@ private slots:
     void discardClient();
 
 private:
-    QString generateHeader();
+    QByteArray generateResponse(int statusCode, const QByteArray &reason, bool keepAlive);
+
+    QHash<QTcpSocket *, HttpRequestParser> m_clients;
 
 };
 
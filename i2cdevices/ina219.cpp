@@ -45,13 +45,60 @@
 #define INA219_CONFIG_BIT_MODE2  1
 #define INA219_CONFIG_BIT_MODE1  0
 
+#define MAX_BUFFERED_SAMPLES 65536
+
 
 Ina219::Ina219(const QString &portName, int address, double shuntOhms, VoltageRange voltageRange, QObject *parent):
     I2CDevice(portName, address, parent),
     m_shuntOhms(shuntOhms),
     m_voltageRange(voltageRange)
 {
+    m_samples.resize(1);
+}
+
+void Ina219::setAveragingSamples(int samples)
+{
+    switch (samples) {
+    case 128:
+        m_busADC = ADCSamples128;
+        break;
+    case 64:
+        m_busADC = ADCSamples64;
+        break;
+    case 32:
+        m_busADC = ADCSamples32;
+        break;
+    case 16:
+        m_busADC = ADCSamples16;
+        break;
+    case 8:
+        m_busADC = ADCSamples8;
+        break;
+    case 4:
+        m_busADC = ADCSamples4;
+        break;
+    case 2:
+        m_busADC = ADCSamples2;
+        break;
+    default:
+        m_busADC = ADCBits12;
+        break;
+    }
+    m_shuntADC = m_busADC;
+}
+
+void Ina219::setSampling(int sampleInterval, int reportingInterval)
+{
+    m_reportingInterval = qMax(0, reportingInterval);
 
+    // Leave some headroom for timer jitter, the buffer is reset on every report
+    int capacity = 1;
+    if (sampleInterval > 0 && m_reportingInterval > 0) {
+        capacity = qBound(1, m_reportingInterval / sampleInterval * 2, MAX_BUFFERED_SAMPLES);
+    }
+    m_samples.resize(capacity);
+    m_sampleHead = 0;
+    m_sampleCount = 0;
 }
 
 bool Ina219::writeData(int fileDescriptor, const QByteArray &data)
@@ -113,75 +160,141 @@ bool Ina219::writeData(int fileDescriptor, const QByteArray &data)
 
 QByteArray Ina219::readData(int fileDescriptor)
 {
-    char buf[2] = {0};
+    if (!m_clock.isValid()) {
+        m_clock.start();
+    }
 
-    buf[0] = INA219_REGISTER_SHUNT_VOLTAGE;
-    int ret = write(fileDescriptor, buf, 1);
-    if (ret != 1) {
-        qCWarning(dcI2cDevices()) << "Failed to select shunt voltage register on INA219";
+    Sample sample;
+    if (!readSample(fileDescriptor, &sample)) {
         return QByteArray();
     }
-    ret = read(fileDescriptor, buf, 2);
-    if (ret != 2) {
-        qCWarning(dcI2cDevices()) << "Failed to read shunt voltage register on INA219";
+    appendSample(sample);
+
+    if (m_clock.elapsed() - m_lastReport < m_reportingInterval) {
         return QByteArray();
     }
-    int shuntVoltageRaw = ((buf[0] << 8) | buf[1]);
-    double shuntVoltage = shuntVoltageRaw * SHUNT_MILLIVOLTS_LSB / 1000;
-
+    m_lastReport = m_clock.elapsed();
+    return takeReport();
+}
 
-    buf[0] = INA219_REGISTER_BUS_VOLTAGE;
-    ret = write(fileDescriptor, buf, 1);
+bool Ina219::readRegister(int fileDescriptor, quint8 reg, quint16 *value)
+{
+    quint8 buf[2] = {reg, 0};
+    int ret = write(fileDescriptor, buf, 1);
     if (ret != 1) {
-        qCWarning(dcI2cDevices()) << "Failed to select bus voltage register on INA219";
-        return QByteArray();
+        qCWarning(dcI2cDevices()) << "Failed to select register" << reg << "on INA219";
+        return false;
     }
     ret = read(fileDescriptor, buf, 2);
     if (ret != 2) {
-        qCWarning(dcI2cDevices()) << "Failed to read bus voltage register on INA219";
-        return QByteArray();
+        qCWarning(dcI2cDevices()) << "Failed to read register" << reg << "on INA219";
+        return false;
     }
-    int busVoltageRaw = ((buf[0] << 8) | buf[1]);
-    bool overflow = (busVoltageRaw & OVERFLOW_VALUE) == 1;
-    busVoltageRaw = busVoltageRaw >> 3; // Registers are not right_aligned
-    double busVoltage = 1.0 * busVoltageRaw * BUS_MILLIVOLTS_LSB / 1000;
+    *value = static_cast<quint16>((buf[0] << 8) | buf[1]);
+    return true;
+}
 
-    buf[0] = INA219_REGISTER_POWER;
-    ret = write(fileDescriptor, buf, 1);
-    if (ret != 1) {
-        qCWarning(dcI2cDevices()) << "Failed to select power register on INA219";
-        return QByteArray();
-    }
-    ret = read(fileDescriptor, buf, 2);
-    if (ret != 2) {
-        qCWarning(dcI2cDevices()) << "Failed to read power register on INA219";
-        return QByteArray();
+bool Ina219::readSample(int fileDescriptor, Sample *sample)
+{
+    quint16 shuntVoltageRaw, busVoltageRaw, powerRaw, currentRaw;
+    if (!readRegister(fileDescriptor, INA219_REGISTER_SHUNT_VOLTAGE, &shuntVoltageRaw)
+            || !readRegister(fileDescriptor, INA219_REGISTER_BUS_VOLTAGE, &busVoltageRaw)
+            || !readRegister(fileDescriptor, INA219_REGISTER_POWER, &powerRaw)
+            || !readRegister(fileDescriptor, INA219_REGISTER_CURRENT, &currentRaw)) {
+        return false;
     }
-    int powerRaw = ((buf[0] << 8) | buf[1]);
+
+    sample->timestamp = m_clock.elapsed();
+    // Shunt voltage and current are two's complement
+    sample->shuntVoltage = static_cast<qint16>(shuntVoltageRaw) * SHUNT_MILLIVOLTS_LSB / 1000;
+    sample->overflow = (busVoltageRaw & OVERFLOW_VALUE) == 1;
+    sample->busVoltage = 1.0 * (busVoltageRaw >> 3) * BUS_MILLIVOLTS_LSB / 1000; // Registers are not right_aligned
     double powerLSB = m_currentLSB * 20;
-    double power = powerRaw * powerLSB;
+    sample->power = powerRaw * powerLSB;
+    sample->current = 1.0 * static_cast<qint16>(currentRaw) * m_currentLSB;
+    // The power register holds the absolute value, use the current for the direction
+    if (sample->current < 0) {
+        sample->power = -sample->power;
+    }
+    return true;
+}
 
-    buf[0] = INA219_REGISTER_CURRENT;
-    ret = write(fileDescriptor, buf, 1);
-    if (ret != 1) {
-        qCWarning(dcI2cDevices()) << "Failed to select current register on INA219";
-        return QByteArray();
+void Ina219::appendSample(const Sample &sample)
+{
+    int capacity = m_samples.count();
+    int index = (m_sampleHead + m_sampleCount) % capacity;
+    m_samples[index] = sample;
+    if (m_sampleCount < capacity) {
+        m_sampleCount++;
+    } else {
+        // Buffer is full, overwrite the oldest sample
+        m_sampleHead = (m_sampleHead + 1) % capacity;
+        m_droppedSamples++;
     }
-    ret = read(fileDescriptor, buf, 2);
-    if (ret != 2) {
-        qCWarning(dcI2cDevices()) << "Failed to read current register on INA219";
+}
+
+QByteArray Ina219::takeReport()
+{
+    if (m_sampleCount == 0) {
         return QByteArray();
     }
-    int currentRaw = ((buf[0] << 8) | buf[1]);
-    double current = 1.0 * currentRaw * m_currentLSB;
 
-    qCDebug(dcI2cDevices()).nospace().noquote() << "INA219 Shunt voltage: " << shuntVoltage << "mV, Bus voltage: " << busVoltage << "V, Power: " << power << "W, Current: " << current << "A, Overflow: " << overflow;
+    double shuntVoltageSum = 0, busVoltageSum = 0, powerSum = 0, currentSum = 0;
+    double powerMin = 0, powerMax = 0, currentMin = 0, currentMax = 0;
+    double energyConsumed = 0, energyProduced = 0;
+    bool overflow = false;
+
+    for (int i = 0; i < m_sampleCount; i++) {
+        const Sample &sample = m_samples.at((m_sampleHead + i) % m_samples.count());
+        shuntVoltageSum += sample.shuntVoltage;
+        busVoltageSum += sample.busVoltage;
+        powerSum += sample.power;
+        currentSum += sample.current;
+        overflow |= sample.overflow;
+        if (i == 0) {
+            powerMin = powerMax = sample.power;
+            currentMin = currentMax = sample.current;
+        } else {
+            powerMin = qMin(powerMin, sample.power);
+            powerMax = qMax(powerMax, sample.power);
+            currentMin = qMin(currentMin, sample.current);
+            currentMax = qMax(currentMax, sample.current);
+        }
+
+        // Trapezoidal integration, continuing from the last sample of the previous interval
+        if (m_lastSampleValid) {
+            double hours = (sample.timestamp - m_lastSample.timestamp) / 1000.0 / 60 / 60;
+            double energy = (sample.power + m_lastSample.power) / 2 * hours;
+            if (energy >= 0) {
+                energyConsumed += energy;
+            } else {
+                energyProduced -= energy;
+            }
+        }
+        m_lastSample = sample;
+        m_lastSampleValid = true;
+    }
+
+    qCDebug(dcI2cDevices()).nospace().noquote() << "INA219 " << m_sampleCount << " samples, Power: " << powerSum / m_sampleCount << "W (" << powerMin << "W - " << powerMax << "W), Energy: " << energyConsumed << "Wh/" << energyProduced << "Wh, Overflow: " << overflow << ", Dropped: " << m_droppedSamples;
 
     QVariantMap readings;
-    readings.insert("shuntVoltage", shuntVoltage);
-    readings.insert("busVoltage", busVoltage);
-    readings.insert("power", power);
-    readings.insert("current", current);
+    readings.insert("shuntVoltage", shuntVoltageSum / m_sampleCount);
+    readings.insert("busVoltage", busVoltageSum / m_sampleCount);
+    readings.insert("power", powerSum / m_sampleCount);
+    readings.insert("powerMin", powerMin);
+    readings.insert("powerMax", powerMax);
+    readings.insert("current", currentSum / m_sampleCount);
+    readings.insert("currentMin", currentMin);
+    readings.insert("currentMax", currentMax);
+    readings.insert("energyConsumed", energyConsumed);
+    readings.insert("energyProduced", energyProduced);
     readings.insert("overflow", overflow);
+    readings.insert("samples", m_sampleCount);
+    readings.insert("droppedSamples", m_droppedSamples);
+
+    m_sampleHead = 0;
+    m_sampleCount = 0;
+    m_droppedSamples = 0;
+
     return QJsonDocument::fromVariant(readings).toJson(QJsonDocument::Compact);
 }
@@ -2,6 +2,9 @@
 #define INA219_H
 
 #include <QObject>
+#include <QVector>
+#include <QElapsedTimer>
+
 #include <hardware/i2c/i2cdevice.h>
 
 class Ina219 : public I2CDevice
@@ -26,7 +29,15 @@ public:
         ADCBits9 = 0,
         ADCBits10 = 1,
         ADCBits11 = 2,
-        ADCBits12 = 3
+        ADCBits12 = 3,
+        // 12 bit conversions, averaged on the chip
+        ADCSamples2 = 9,
+        ADCSamples4 = 10,
+        ADCSamples8 = 11,
+        ADCSamples16 = 12,
+        ADCSamples32 = 13,
+        ADCSamples64 = 14,
+        ADCSamples128 = 15
     };
     Q_ENUM(ADCBits)
 
@@ -44,6 +55,12 @@ public:
 
     explicit Ina219(const QString &portName, int address, double shuntOhms, VoltageRange voltageRange, QObject *parent = nullptr);
 
+    // Must be called before the device is opened
+    void setAveragingSamples(int samples);
+    // Samples read within the reporting interval are buffered and reported as one aggregated reading.
+    // A reporting interval of 0 reports every single sample.
+    void setSampling(int sampleInterval, int reportingInterval);
+
     bool writeData(int fileDescriptor, const QByteArray &data) override;
     QByteArray readData(int fileDescriptor) override;
 
@@ -51,6 +68,20 @@ signals:
     void measurementAvailable();
 
 private:
+    struct Sample {
+        qint64 timestamp = 0;
+        double shuntVoltage = 0;
+        double busVoltage = 0;
+        double power = 0;
+        double current = 0;
+        bool overflow = false;
+    };
+
+    bool readRegister(int fileDescriptor, quint8 reg, quint16 *value);
+    bool readSample(int fileDescriptor, Sample *sample);
+    void appendSample(const Sample &sample);
+    QByteArray takeReport();
+
     double m_shuntOhms = 0.1;
     VoltageRange m_voltageRange = VoltageRange32;
     GainVolts m_gainVolts = GainVolts004;
@@ -59,6 +90,17 @@ private:
     OperationMode m_operationMode = OperationModeShuntAndBusContinuous;
 
     double m_currentLSB = 0;
+
+    // Accessed from the I2C reading thread only
+    QVector<Sample> m_samples;
+    int m_sampleHead = 0;
+    int m_sampleCount = 0;
+    int m_droppedSamples = 0;
+    int m_reportingInterval = 0;
+    Sample m_lastSample;
+    bool m_lastSampleValid = false;
+    QElapsedTimer m_clock;
+    qint64 m_lastReport = 0;
 };
 
 #endif // INA219_H
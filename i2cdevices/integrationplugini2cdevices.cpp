@@ -221,7 +221,21 @@ void IntegrationPluginI2CDevices::setupThing(ThingSetupInfo *info)
         double shuntOhms = info->thing()->paramValue(ina219ThingShuntOhmsParamTypeId).toDouble();
         Ina219::VoltageRange voltageRange = info->thing()->paramValue(ina219ThingVoltageRangeParamTypeId).toUInt() == 16 ? Ina219::VoltageRange16 : Ina219::VoltageRange32;
 
+        int averaging = info->thing()->paramValue(ina219ThingAveragingParamTypeId).toInt();
+        bool highRateMode = info->thing()->paramValue(ina219ThingHighRateModeParamTypeId).toBool();
+        int sampleInterval = info->thing()->paramValue(ina219ThingSampleIntervalParamTypeId).toInt();
+        int reportingInterval = info->thing()->paramValue(ina219ThingReportingIntervalParamTypeId).toInt() * 1000;
+
         Ina219 *ina219 = new Ina219(i2cPortName, i2cAddress, shuntOhms, voltageRange, this);
+        ina219->setAveragingSamples(averaging);
+        if (highRateMode) {
+            // Samples are buffered on the I2C thread and reported aggregated once per reporting interval
+            ina219->setSampling(sampleInterval, reportingInterval);
+        } else {
+            sampleInterval = 5000;
+            ina219->setSampling(sampleInterval, 0);
+        }
+
         if (!hardwareManager()->i2cManager()->open(ina219)) {
             delete ina219;
             info->finish(Thing::ThingErrorHardwareFailure, QT_TR_NOOP("Failed to open I2C port."));
@@ -230,37 +244,40 @@ void IntegrationPluginI2CDevices::setupThing(ThingSetupInfo *info)
 
         Thing *thing = info->thing();
         connect(ina219, &Ina219::readingAvailable, thing, [thing](const QByteArray &data){
+            if (data.isEmpty()) {
+                // Still buffering samples for the current reporting interval
+                return;
+            }
             QJsonParseError error;
             QVariantMap values = QJsonDocument::fromJson(data, &error).toVariant().toMap();
             if (error.error != QJsonParseError::NoError) {
                 qCWarning(dcI2cDevices()) << thing->name() << "Failed to read data from INA219";
                 return;
             }
-            double currentPower = values.value("power").toDouble();
-            thing->setStateValue(ina219CurrentPowerStateTypeId, currentPower);
+            thing->setStateValue(ina219CurrentPowerStateTypeId, values.value("power").toDouble());
             thing->setStateValue(ina219VoltagePhaseAStateTypeId, values.value("busVoltage").toDouble());
             thing->setStateValue(ina219CurrentPhaseAStateTypeId, values.value("current").toDouble());
             thing->setStateValue(ina219OverflowStateTypeId, values.value("overflow").toBool());
+            thing->setStateValue(ina219PowerMinStateTypeId, values.value("powerMin").toDouble());
+            thing->setStateValue(ina219PowerMaxStateTypeId, values.value("powerMax").toDouble());
+            thing->setStateValue(ina219CurrentMinStateTypeId, values.value("currentMin").toDouble());
+            thing->setStateValue(ina219CurrentMaxStateTypeId, values.value("currentMax").toDouble());
 
-            // Calculate an estimate of totalEnergyConsumed
-            QDateTime lastUpdate = thing->property("lastUpdate").toDateTime();
-            if (lastUpdate.isNull()) {
-                lastUpdate = QDateTime::currentDateTime();
-            }
-            double hoursPassed = lastUpdate.msecsTo(QDateTime::currentDateTime()) / 1000 / 60 / 60;
-            if (currentPower >= 0) {
-                double totalEnergyConsumed = thing->stateValue(ina219TotalEnergyConsumedStateTypeId).toDouble();
-                totalEnergyConsumed += currentPower / 1000 * hoursPassed;
-                thing->setStateValue(ina219TotalEnergyConsumedStateTypeId, totalEnergyConsumed);
-            } else {
-                double totalEnergyReturned = thing->stateValue(ina219TotalEnergyProducedStateTypeId).toDouble();
-                totalEnergyReturned += -currentPower / 1000 * hoursPassed;
-                thing->setStateValue(ina219TotalEnergyProducedStateTypeId, totalEnergyReturned);
+            if (values.value("droppedSamples").toInt() > 0) {
+                qCDebug(dcI2cDevices()) << thing->name() << "dropped" << values.value("droppedSamples").toInt() << "samples in the last interval";
             }
+
+            // The energy is integrated over all samples by the device, in Wh
+            double energyConsumed = values.value("energyConsumed").toDouble() / 1000;
+            double energyProduced = values.value("energyProduced").toDouble() / 1000;
+            thing->setStateValue(ina219IntervalEnergyStateTypeId, energyConsumed - energyProduced);
+            thing->setStateValue(ina219TotalEnergyConsumedStateTypeId, thing->stateValue(ina219TotalEnergyConsumedStateTypeId).toDouble() + energyConsumed);
+            thing->setStateValue(ina219TotalEnergyProducedStateTypeId, thing->stateValue(ina219TotalEnergyProducedStateTypeId).toDouble() + energyProduced);
         });
 
         hardwareManager()->i2cManager()->writeData(ina219, "init");
-        hardwareManager()->i2cManager()->startReading(ina219, 5000);
+        hardwareManager()->i2cManager()->startReading(ina219, sampleInterval);
+        m_i2cDevices.insert(ina219, thing);
 
         info->finish(Thing::ThingErrorNoError);
     }
@@ -47,6 +47,9 @@ Kodi::Kodi(const QHostAddress &hostAddress, int port, int httpPort, QObject *par
     connect(m_jsonHandler, &KodiJsonHandler::notificationReceived, this, &Kodi::processNotification);
     connect(m_jsonHandler, &KodiJsonHandler::replyReceived, this, &Kodi::processResponse);
 
+    // Keep up to 5000 library items in the browse cache
+    m_browseCache.setMaxCost(5000);
+
 
     // Init FS
     m_virtualFs = new VirtualFsNode(BrowserItem());
@@ -189,6 +192,7 @@ QHostAddress Kodi::hostAddress() const
 void Kodi::setHostAddress(const QHostAddress &address)
 {
     m_connection->setHostAddress(address);
+    m_thumbnailBaseUrl.clear();
 }
 
 uint Kodi::port() const
@@ -209,6 +213,7 @@ uint Kodi::httpPort() const
 void Kodi::setHttpPort(uint httpPort)
 {
     m_httpPort = httpPort;
+    m_thumbnailBaseUrl.clear();
 }
 
 bool Kodi::connected() const
@@ -336,8 +341,27 @@ void Kodi::disconnectKodi()
 
 void Kodi::browse(BrowseResult *result)
 {
-//    m_jsonHandler->sendData()
-    VirtualFsNode *node = m_virtualFs->findNode(result->itemId());
+    // Cached results are served without asking Kodi again
+    BrowseCacheEntry *cacheEntry = m_browseCache.object(result->itemId());
+    if (cacheEntry) {
+        qCDebug(dcKodi()) << "Browse result for" << result->itemId() << "served from cache";
+        foreach (const BrowserItem &item, cacheEntry->items) {
+            result->addItem(item);
+        }
+        result->finish(Thing::ThingErrorNoError);
+        return;
+    }
+
+    // Large lists are fetched in pages, following pages are addressed as "page:<start>:<itemId>"
+    QString itemId = result->itemId();
+    int start = 0;
+    if (itemId.startsWith("page:")) {
+        int separator = itemId.indexOf(':', 5);
+        start = itemId.mid(5, separator - 5).toInt();
+        itemId = itemId.mid(separator + 1);
+    }
+
+    VirtualFsNode *node = m_virtualFs->findNode(itemId);
 
     if (node) {
         if (node->getMethod.isEmpty()) {
@@ -349,8 +373,7 @@ void Kodi::browse(BrowseResult *result)
         }
 
         qCDebug(dcKodi()) << "Sending:" << node->getMethod << node->getParams;
-        int id = m_jsonHandler->sendData(node->getMethod, node->getParams);
-        m_pendingBrowseRequests.insert(id, result);
+        sendBrowseRequest(result, node->getMethod, node->getParams, start);
         return;
     }
 
@@ -360,8 +383,8 @@ void Kodi::browse(BrowseResult *result)
     QVariantList properties;
     properties.append("thumbnail");
 
-    if (result->itemId().startsWith("artist:")) {
-        QString idString = result->itemId();
+    if (itemId.startsWith("artist:")) {
+        QString idString = itemId;
         idString.remove(QRegExp("^artist:"));
         QVariantMap filter;
         filter.insert("artistid", idString.toInt());
@@ -371,13 +394,12 @@ void Kodi::browse(BrowseResult *result)
         albumProperties.append("artist");
         albumProperties.append("year");
         params.insert("properties", albumProperties);
-        int id = m_jsonHandler->sendData("AudioLibrary.GetAlbums", params);
-        m_pendingBrowseRequests.insert(id, result);
+        sendBrowseRequest(result, "AudioLibrary.GetAlbums", params, start);
         return;
     }
 
-    if (result->itemId().startsWith("album:")) {
-        QString idString = result->itemId();
+    if (itemId.startsWith("album:")) {
+        QString idString = itemId;
         idString.remove(QRegExp("^album:"));
         QVariantMap filter;
         filter.insert("albumid", idString.toInt());
@@ -389,13 +411,12 @@ void Kodi::browse(BrowseResult *result)
         songProperties.append("album");
         songProperties.append("year");
         params.insert("properties", songProperties);
-        int id = m_jsonHandler->sendData("AudioLibrary.GetSongs", params);
-        m_pendingBrowseRequests.insert(id, result);
+        sendBrowseRequest(result, "AudioLibrary.GetSongs", params, start);
         return;
     }
 
-    if (result->itemId().startsWith("tvshow:")) {
-        QString idString = result->itemId();
+    if (itemId.startsWith("tvshow:")) {
+        QString idString = itemId;
         idString.remove(QRegExp("^tvshow:"));
         QVariantMap params;
         params.insert("tvshowid", idString.toInt());
@@ -405,13 +426,12 @@ void Kodi::browse(BrowseResult *result)
         properties.append("thumbnail");
         properties.append("showtitle");
         params.insert("properties", properties);
-        int id = m_jsonHandler->sendData("VideoLibrary.GetSeasons", params);
-        m_pendingBrowseRequests.insert(id, result);
+        sendBrowseRequest(result, "VideoLibrary.GetSeasons", params, start);
         return;
     }
 
-    if (result->itemId().startsWith("season:")) {
-        QString idString = result->itemId();
+    if (itemId.startsWith("season:")) {
+        QString idString = itemId;
         idString.remove(QRegExp("^season:"));
         int seasonId = idString.left(idString.indexOf(",")).toInt();
         idString.remove(QRegExp("^[0-9]*,tvshow:"));
@@ -425,13 +445,12 @@ void Kodi::browse(BrowseResult *result)
         properties.append("season");
         params.insert("properties", properties);
         qCDebug(dcKodi()) << "getting episodes:" << params;
-        int id = m_jsonHandler->sendData("VideoLibrary.GetEpisodes", params);
-        m_pendingBrowseRequests.insert(id, result);
+        sendBrowseRequest(result, "VideoLibrary.GetEpisodes", params, start);
         return;
     }
 
-    if (result->itemId().startsWith("addon:")) {
-        QString idString = result->itemId();
+    if (itemId.startsWith("addon:")) {
+        QString idString = itemId;
         idString.remove(QRegExp("^addon:"));
         QVariantMap params;
         params.insert("directory", "plugin://" + idString);
@@ -440,20 +459,18 @@ void Kodi::browse(BrowseResult *result)
 //        properties.append("season");
 //        params.insert("properties", properties);
         qCDebug(dcKodi()) << "Sending" << params;
-        int id = m_jsonHandler->sendData("Files.GetDirectory", params);
-        m_pendingBrowseRequests.insert(id, result);
+        sendBrowseRequest(result, "Files.GetDirectory", params, start);
         return;
     }
 
-    if (result->itemId().startsWith("file:")) {
-        QString idString = result->itemId();
+    if (itemId.startsWith("file:")) {
+        QString idString = itemId;
         idString.remove(QRegExp("^file:"));
         QVariantMap params;
         params.insert("directory", idString);
         params.insert("properties", properties);
         qCDebug(dcKodi()) << "Sending" << params;
-        int id = m_jsonHandler->sendData("Files.GetDirectory", params);
-        m_pendingBrowseRequests.insert(id, result);
+        sendBrowseRequest(result, "Files.GetDirectory", params, start);
         return;
     }
 
@@ -567,6 +584,9 @@ int Kodi::executeBrowserItemAction(const QString &itemId, const ActionTypeId &ac
 
 void Kodi::onConnectionStatusChanged()
 {
+    // The library may have changed while we were not listening
+    m_browseCache.clear();
+
     if (m_connection->connected()) {
         checkVersion();
     } else {
@@ -681,6 +701,12 @@ void Kodi::processNotification(const QString &method, const QVariantMap &params)
         return;
     }
 
+    if (method.startsWith("AudioLibrary.On") || method.startsWith("VideoLibrary.On")) {
+        // OnUpdate, OnRemove, OnScanFinished, OnCleanFinished...
+        invalidateBrowseCache(method.section('.', 0, 0));
+        return;
+    }
+
     if (method == "Player.OnPlay" ||
             method == "Player.OnResume" ||
             method == "Player.OnPause" ||
@@ -753,6 +779,7 @@ void Kodi::processResponse(int id, const QString &method, const QVariantMap &res
 
     if (method == "AudioLibrary.GetArtists") {
         BrowseResult *result = m_pendingBrowseRequests.take(id);
+        QList<BrowserItem> items;
         foreach (const QVariant &artistVariant, response.value("result").toMap().value("artists").toList()) {
             QVariantMap artist = artistVariant.toMap();
             qCDebug(dcKodi()) << "Entry:" << artist;
@@ -769,14 +796,15 @@ void Kodi::processResponse(int id, const QString &method, const QVariantMap &res
             }
             item.setDescription(description.join(" - "));
             qCDebug(dcKodi()) << "Thumbnail" << item.thumbnail();
-            result->addItem(item);
+            items.append(item);
         }
-        result->finish(Thing::ThingErrorNoError);
+        finishBrowseRequest(result, method, items, response);
         return;
     }
 
     if (method == "AudioLibrary.GetAlbums") {
         BrowseResult *result = m_pendingBrowseRequests.take(id);
+        QList<BrowserItem> items;
         foreach (const QVariant &albumVariant, response.value("result").toMap().value("albums").toList()) {
             QVariantMap album = albumVariant.toMap();
             BrowserItem item("album:" + album.value("albumid").toString(), album.value("label").toString());
@@ -791,15 +819,17 @@ void Kodi::processResponse(int id, const QString &method, const QVariantMap &res
                 description.append(album.value("year").toString());
             }
             item.setDescription(description.join(" - "));
-            result->addItem(item);
+            items.append(item);
         }
-        result->finish(Thing::ThingErrorNoError);
+        finishBrowseRequest(result, method, items, response);
         return;
     }
 
     if (method == "AudioLibrary.GetSongs") {
         BrowseResult *result = m_pendingBrowseRequests.take(id);
-        int i = 0;
+        QList<BrowserItem> items;
+        // Note: album songs are addressed by their index within the album
+        int i = response.value("result").toMap().value("limits").toMap().value("start").toInt();
         foreach (const QVariant &songVariant, response.value("result").toMap().value("songs").toList()) {
             QVariantMap song = songVariant.toMap();
             qCDebug(dcKodi()) << "Entry:" << song;
@@ -824,16 +854,17 @@ void Kodi::processResponse(int id, const QString &method, const QVariantMap &res
                 description.append(song.value("year").toString());
             }
             item.setDescription(description.join(" - "));
-            result->addItem(item);
+            items.append(item);
             i++;
         }
-        result->finish(Thing::ThingErrorNoError);
+        finishBrowseRequest(result, method, items, response);
         return;
     }
 
 
     if (method == "VideoLibrary.GetMovies") {
         BrowseResult *result = m_pendingBrowseRequests.take(id);
+        QList<BrowserItem> items;
         foreach (const QVariant &movieVariant, response.value("result").toMap().value("movies").toList()) {
             QVariantMap movie = movieVariant.toMap();
             qCDebug(dcKodi()) << "Entry:" << movie;
@@ -856,14 +887,15 @@ void Kodi::processResponse(int id, const QString &method, const QVariantMap &res
             QString duration;
             duration = QString("%1:%2").arg(hours).arg(minutes, 2, 10, QChar('0'));
             item.setDescription(movie.value("year").toString() + " - " + duration + " - " + rating);
-            result->addItem(item);
+            items.append(item);
         }
-        result->finish(Thing::ThingErrorNoError);
+        finishBrowseRequest(result, method, items, response);
         return;
     }
 
     if (method == "VideoLibrary.GetTVShows") {
         BrowseResult *result = m_pendingBrowseRequests.take(id);
+        QList<BrowserItem> items;
         foreach (const QVariant &tvShowVariant, response.value("result").toMap().value("tvshows").toList()) {
             QVariantMap tvShow = tvShowVariant.toMap();
             qCDebug(dcKodi()) << "Entry:" << tvShow;
@@ -880,14 +912,15 @@ void Kodi::processResponse(int id, const QString &method, const QVariantMap &res
                 }
             }
             item.setDescription(tvShow.value("year").toString() + " - " + tr("%1 seasons").arg(tvShow.value("season").toInt()) + " - " + rating);
-            result->addItem(item);
+            items.append(item);
         }
-        result->finish(Thing::ThingErrorNoError);
+        finishBrowseRequest(result, method, items, response);
         return;
     }
 
     if (method == "VideoLibrary.GetSeasons") {
         BrowseResult *result = m_pendingBrowseRequests.take(id);
+        QList<BrowserItem> items;
         foreach (const QVariant &seasonVariant, response.value("result").toMap().value("seasons").toList()) {
             QVariantMap season = seasonVariant.toMap();
             qCDebug(dcKodi()) << "Entry:" << season;
@@ -896,14 +929,15 @@ void Kodi::processResponse(int id, const QString &method, const QVariantMap &res
             item.setIcon(BrowserItem::BrowserIconFolder);
             item.setThumbnail(prepareThumbnail(season.value("thumbnail").toString()));
             item.setDescription(season.value("showtitle").toString());
-            result->addItem(item);
+            items.append(item);
         }
-        result->finish(Thing::ThingErrorNoError);
+        finishBrowseRequest(result, method, items, response);
         return;
     }
 
     if (method == "VideoLibrary.GetEpisodes") {
         BrowseResult *result = m_pendingBrowseRequests.take(id);
+        QList<BrowserItem> items;
         foreach (const QVariant &episodeVariant, response.value("result").toMap().value("episodes").toList()) {
             QVariantMap episode = episodeVariant.toMap();
             qCDebug(dcKodi()) << "Entry:" << episode;
@@ -916,14 +950,15 @@ void Kodi::processResponse(int id, const QString &method, const QVariantMap &res
             } else {
                 item.setDescription(episode.value("showtitle").toString());
             }
-            result->addItem(item);
+            items.append(item);
         }
-        result->finish(Thing::ThingErrorNoError);
+        finishBrowseRequest(result, method, items, response);
         return;
     }
 
     if (method == "VideoLibrary.GetMusicVideos") {
         BrowseResult *result = m_pendingBrowseRequests.take(id);
+        QList<BrowserItem> items;
         foreach (const QVariant &musicVideoVariant, response.value("result").toMap().value("musicvideos").toList()) {
             QVariantMap musicVideo = musicVideoVariant.toMap();
             qCDebug(dcKodi()) << "Entry:" << musicVideo;
@@ -931,14 +966,15 @@ void Kodi::processResponse(int id, const QString &method, const QVariantMap &res
             item.setExecutable(true);
             item.setIcon(BrowserItem::BrowserIconVideo);
             item.setThumbnail(prepareThumbnail(musicVideo.value("thumbnail").toString()));
-            result->addItem(item);
+            items.append(item);
         }
-        result->finish(Thing::ThingErrorNoError);
+        finishBrowseRequest(result, method, items, response);
         return;
     }
 
     if (method == "Addons.GetAddons") {
         BrowseResult *result = m_pendingBrowseRequests.take(id);
+        QList<BrowserItem> items;
         foreach (const QVariant &addonVariant, response.value("result").toMap().value("addons").toList()) {
             QVariantMap addon = addonVariant.toMap();
             qCDebug(dcKodi()) << "Entry:" << addon;
@@ -946,14 +982,15 @@ void Kodi::processResponse(int id, const QString &method, const QVariantMap &res
             item.setBrowsable(true);
             item.setIcon(BrowserItem::BrowserIconApplication);
             item.setThumbnail(prepareThumbnail(addon.value("thumbnail").toString()));
-            result->addItem(item);
+            items.append(item);
         }
-        result->finish(Thing::ThingErrorNoError);
+        finishBrowseRequest(result, method, items, response);
         return;
     }
 
     if (method == "Files.GetDirectory") {
         BrowseResult *result = m_pendingBrowseRequests.take(id);
+        QList<BrowserItem> items;
         foreach (const QVariant &fileVariant, response.value("result").toMap().value("files").toList()) {
             QVariantMap file = fileVariant.toMap();
             qCDebug(dcKodi()) << "Entry:" << file;
@@ -969,9 +1006,9 @@ void Kodi::processResponse(int id, const QString &method, const QVariantMap &res
                 item.setIcon(BrowserItem::BrowserIconMusic);
             }
             item.setThumbnail(prepareThumbnail(file.value("thumbnail").toString()));
-            result->addItem(item);
+            items.append(item);
         }
-        result->finish(Thing::ThingErrorNoError);
+        finishBrowseRequest(result, method, items, response);
         return;
     }
 
@@ -1051,12 +1088,74 @@ QString Kodi::prepareThumbnail(const QString &thumbnail)
         return QString();
     }
 
-    QString addr = m_connection->hostAddress().toString();
-    if (m_connection->hostAddress().protocol() == QAbstractSocket::IPv6Protocol) {
-        addr = '[' + addr + ']';
+    // The base url is resolved once, not for every item of a browse result
+    if (m_thumbnailBaseUrl.isEmpty()) {
+        QString addr = m_connection->hostAddress().toString();
+        if (m_connection->hostAddress().protocol() == QAbstractSocket::IPv6Protocol) {
+            addr = '[' + addr + ']';
+        }
+        m_thumbnailBaseUrl = QString("http://%1:%2/image/").arg(addr).arg(m_httpPort);
+    }
+    return m_thumbnailBaseUrl + QString::fromLatin1(thumbnail.toUtf8().toPercentEncoding());
+}
+
+void Kodi::sendBrowseRequest(BrowseResult *result, const QString &method, QVariantMap params, int start)
+{
+    QVariantMap limits;
+    limits.insert("start", start);
+    limits.insert("end", start + m_browsePageSize);
+    params.insert("limits", limits);
+
+    int id = m_jsonHandler->sendData(method, params);
+    m_pendingBrowseRequests.insert(id, result);
+    connect(result, &BrowseResult::destroyed, this, [this, id](){
+        m_pendingBrowseRequests.remove(id);
+    });
+}
+
+void Kodi::finishBrowseRequest(BrowseResult *result, const QString &method, QList<BrowserItem> items, const QVariantMap &response)
+{
+    if (!result) {
+        qCWarning(dcKodi()) << "Received browse response for" << method << "but the request is gone.";
+        return;
+    }
+
+    // Add an entry for the next page if Kodi has more items
+    QVariantMap limits = response.value("result").toMap().value("limits").toMap();
+    int end = limits.value("end").toInt();
+    int total = limits.value("total").toInt();
+    if (end > 0 && end < total) {
+        QString itemId = result->itemId();
+        if (itemId.startsWith("page:"))
+            itemId = itemId.mid(itemId.indexOf(':', 5) + 1);
+
+        BrowserItem item(QString("page:%1:%2").arg(end).arg(itemId), tr("More..."), true);
+        item.setIcon(BrowserItem::BrowserIconFolder);
+        item.setDescription(tr("%1 - %2 of %3").arg(end + 1).arg(qMin(end + m_browsePageSize, total)).arg(total));
+        items.append(item);
+    }
+
+    // Only library content can be cached, Kodi notifies about changes of the libraries
+    if (method.startsWith("AudioLibrary.") || method.startsWith("VideoLibrary.")) {
+        BrowseCacheEntry *cacheEntry = new BrowseCacheEntry();
+        cacheEntry->library = method.section('.', 0, 0);
+        cacheEntry->items = items;
+        m_browseCache.insert(result->itemId(), cacheEntry, items.count() + 1);
+    }
+
+    foreach (const BrowserItem &item, items) {
+        result->addItem(item);
+    }
+    result->finish(Thing::ThingErrorNoError);
+}
+
+void Kodi::invalidateBrowseCache(const QString &library)
+{
+    foreach (const QString &itemId, m_browseCache.keys()) {
+        BrowseCacheEntry *cacheEntry = m_browseCache.object(itemId);
+        if (cacheEntry && cacheEntry->library == library) {
+            m_browseCache.remove(itemId);
+        }
     }
-    return QString("http://%1:%2/image/%3")
-                .arg(addr)
-                .arg(m_httpPort)
-                .arg(QString(thumbnail.toUtf8().toPercentEncoding()));
+    qCDebug(dcKodi()) << "Browse cache invalidated for" << library;
 }
@@ -32,6 +32,7 @@
 #define KODI_H
 
 #include <QObject>
+#include <QCache>
 #include <QHostAddress>
 
 #include "kodiconnection.h"
@@ -119,6 +120,10 @@ private slots:
 private:
     QString prepareThumbnail(const QString &thumbnail);
 
+    void sendBrowseRequest(BrowseResult *result, const QString &method, QVariantMap params, int start);
+    void finishBrowseRequest(BrowseResult *result, const QString &method, QList<BrowserItem> items, const QVariantMap &response);
+    void invalidateBrowseCache(const QString &library);
+
 private:
     KodiConnection *m_connection;
     int m_httpPort;
@@ -149,6 +154,15 @@ private:
     VirtualFsNode* m_virtualFs = nullptr;
 
     QHash<int, BrowseResult*> m_pendingBrowseRequests;
+
+    // Browse results of the libraries, the cost of an entry is its item count
+    struct BrowseCacheEntry {
+        QString library;
+        QList<BrowserItem> items;
+    };
+    QCache<QString, BrowseCacheEntry> m_browseCache;
+    int m_browsePageSize = 200;
+    QString m_thumbnailBaseUrl;
     QHash<int, BrowserItemResult*> m_pendingBrowserItemRequests;
 
 };
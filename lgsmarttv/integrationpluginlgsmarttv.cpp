@@ -37,6 +37,8 @@
 #include "hardwaremanager.h"
 
 #include <QDebug>
+#include <QSharedPointer>
+#include <QTimer>
 
 IntegrationPluginLgSmartTv::IntegrationPluginLgSmartTv()
 {
@@ -55,45 +57,108 @@ void IntegrationPluginLgSmartTv::init()
 void IntegrationPluginLgSmartTv::discoverThings(ThingDiscoveryInfo *info)
 {
     qCDebug(dcLgSmartTv()) << "Start discovering";
-    UpnpDiscoveryReply *reply = hardwareManager()->upnpDiscovery()->discoverDevices("udap:rootservice","UDAP/2.0");
+    // NetCast TVs answer to the UDAP search, webOS TVs announce the second screen service
+    UpnpDiscoveryReply *udapReply = hardwareManager()->upnpDiscovery()->discoverDevices("udap:rootservice","UDAP/2.0");
+    UpnpDiscoveryReply *webOsReply = hardwareManager()->upnpDiscovery()->discoverDevices("urn:lge-com:service:webos-second-screen:1");
 
     // Clean up in any case when the reply finishes
-    connect(reply, &UpnpDiscoveryReply::finished, reply, &UpnpDiscoveryReply::deleteLater);
-
-    // Connect reply to discovery info for rsults.
-    connect(reply, &UpnpDiscoveryReply::finished, info, [this, info, reply](){
-
-        if (reply->error() != UpnpDiscoveryReply::UpnpDiscoveryReplyErrorNoError) {
-            qCWarning(dcLgSmartTv()) << "Upnp discovery error" << reply->error();
-            return info->finish(Thing::ThingErrorHardwareFailure, QT_TR_NOOP("Error discovering devices. Please check your network connection."));
-        }
+    connect(udapReply, &UpnpDiscoveryReply::finished, udapReply, &UpnpDiscoveryReply::deleteLater);
+    connect(webOsReply, &UpnpDiscoveryReply::finished, webOsReply, &UpnpDiscoveryReply::deleteLater);
+
+    QSharedPointer<int> pendingReplies(new int(2));
+    QSharedPointer<QStringList> discoveredUuids(new QStringList());
+    foreach (UpnpDiscoveryReply *reply, QList<UpnpDiscoveryReply *>() << udapReply << webOsReply) {
+        // Connect reply to discovery info for rsults.
+        bool udap = (reply == udapReply);
+        connect(reply, &UpnpDiscoveryReply::finished, info, [this, info, reply, udap, pendingReplies, discoveredUuids](){
+            (*pendingReplies)--;
+
+            if (reply->error() != UpnpDiscoveryReply::UpnpDiscoveryReplyErrorNoError) {
+                qCWarning(dcLgSmartTv()) << "Upnp discovery error" << reply->error();
+                if (*pendingReplies == 0 && info->thingDescriptors().isEmpty()) {
+                    info->finish(Thing::ThingErrorHardwareFailure, QT_TR_NOOP("Error discovering devices. Please check your network connection."));
+                } else if (*pendingReplies == 0) {
+                    info->finish(Thing::ThingErrorNoError);
+                }
+                return;
+            }
 
-        foreach (UpnpDeviceDescriptor upnpDeviceDescriptor, reply->deviceDescriptors()) {
-            if (!upnpDeviceDescriptor.friendlyName().contains("LG") || !upnpDeviceDescriptor.deviceType().contains("TV"))
-                continue;
-            qCDebug(dcLgSmartTv) << upnpDeviceDescriptor;
-            ThingDescriptor descriptor(lgSmartTvThingClassId, "Lg Smart Tv", upnpDeviceDescriptor.modelName());
-            ParamList params;
-            params << Param(lgSmartTvThingNameParamTypeId, upnpDeviceDescriptor.friendlyName());
-            params << Param(lgSmartTvThingUuidParamTypeId, upnpDeviceDescriptor.uuid());
-            params << Param(lgSmartTvThingModelParamTypeId, upnpDeviceDescriptor.modelName());
-            params << Param(lgSmartTvThingHostAddressParamTypeId, upnpDeviceDescriptor.hostAddress().toString());
-            params << Param(lgSmartTvThingPortParamTypeId, upnpDeviceDescriptor.port());
-            descriptor.setParams(params);
-
-            foreach (Thing *existingThing, myThings()) {
-                if (existingThing->paramValue(lgSmartTvThingUuidParamTypeId).toString() == upnpDeviceDescriptor.uuid()) {
-                    descriptor.setThingId(existingThing->id());
-                    break;
+            foreach (UpnpDeviceDescriptor upnpDeviceDescriptor, reply->deviceDescriptors()) {
+                if (!upnpDeviceDescriptor.friendlyName().contains("LG") && !upnpDeviceDescriptor.modelName().contains("webOS"))
+                    continue;
+                if (udap && !upnpDeviceDescriptor.deviceType().contains("TV"))
+                    continue;
+                if (discoveredUuids->contains(upnpDeviceDescriptor.uuid()))
+                    continue;
+
+                discoveredUuids->append(upnpDeviceDescriptor.uuid());
+                qCDebug(dcLgSmartTv) << upnpDeviceDescriptor;
+                ThingDescriptor descriptor(lgSmartTvThingClassId, "Lg Smart Tv", upnpDeviceDescriptor.modelName());
+                ParamList params;
+                params << Param(lgSmartTvThingNameParamTypeId, upnpDeviceDescriptor.friendlyName());
+                params << Param(lgSmartTvThingUuidParamTypeId, upnpDeviceDescriptor.uuid());
+                params << Param(lgSmartTvThingModelParamTypeId, upnpDeviceDescriptor.modelName());
+                params << Param(lgSmartTvThingHostAddressParamTypeId, upnpDeviceDescriptor.hostAddress().toString());
+                params << Param(lgSmartTvThingPortParamTypeId, upnpDeviceDescriptor.port());
+                descriptor.setParams(params);
+
+                foreach (Thing *existingThing, myThings()) {
+                    if (existingThing->paramValue(lgSmartTvThingUuidParamTypeId).toString() == upnpDeviceDescriptor.uuid()) {
+                        descriptor.setThingId(existingThing->id());
+                        break;
+                    }
                 }
+                info->addThingDescriptor(descriptor);
             }
-            info->addThingDescriptor(descriptor);
-        }
-        info->finish(Thing::ThingErrorNoError);
-    });
+
+            if (*pendingReplies == 0)
+                info->finish(Thing::ThingErrorNoError);
+        });
+    }
 }
 
 void IntegrationPluginLgSmartTv::startPairing(ThingPairingInfo *info)
+{
+    // Try the webOS pairing first, the TV shows the PIN when it accepts the registration.
+    // NetCast TVs don't have the SSAP websocket, they get paired using UDAP.
+    QHostAddress host = QHostAddress(info->params().paramValue(lgSmartTvThingHostAddressParamTypeId).toString());
+    PairingTransactionId transactionId = info->transactionId();
+    WebOsClient *client = new WebOsClient(host, this);
+    m_pairingClients.insert(transactionId, client);
+
+    connect(client, &WebOsClient::pinRequested, info, [info](){
+        info->finish(Thing::ThingErrorNoError, QT_TR_NOOP("Please enter the key displayed on the TV."));
+    });
+    connect(client, &WebOsClient::registrationFailed, info, [this, info, transactionId](){
+        WebOsClient *client = m_pairingClients.take(transactionId);
+        if (client)
+            client->deleteLater();
+
+        info->finish(Thing::ThingErrorAuthenticationFailure, QT_TR_NOOP("The TV rejected the pairing request."));
+    });
+
+    QTimer::singleShot(8000, info, [this, info, transactionId](){
+        WebOsClient *client = m_pairingClients.value(transactionId);
+        if (!client || client->connected())
+            return;
+
+        qCDebug(dcLgSmartTv()) << "No webOS TV found at" << client->address().toString() << "trying UDAP pairing";
+        m_pairingClients.remove(transactionId);
+        client->deleteLater();
+        startUdapPairing(info);
+    });
+
+    // Clean up if the pairing never gets confirmed
+    QTimer::singleShot(300000, client, [this, transactionId](){
+        WebOsClient *client = m_pairingClients.take(transactionId);
+        if (client)
+            client->deleteLater();
+    });
+
+    client->connectToTv();
+}
+
+void IntegrationPluginLgSmartTv::startUdapPairing(ThingPairingInfo *info)
 {
     QHostAddress host = QHostAddress(info->params().paramValue(lgSmartTvThingHostAddressParamTypeId).toString());
     int port = info->params().paramValue(lgSmartTvThingPortParamTypeId).toInt();
@@ -118,6 +183,45 @@ void IntegrationPluginLgSmartTv::confirmPairing(ThingPairingInfo *info, const QS
 {
     Q_UNUSED(username)
 
+    WebOsClient *client = m_pairingClients.take(info->transactionId());
+    if (client) {
+        confirmWebOsPairing(info, client, secret);
+        return;
+    }
+
+    confirmUdapPairing(info, secret);
+}
+
+void IntegrationPluginLgSmartTv::confirmWebOsPairing(ThingPairingInfo *info, WebOsClient *client, const QString &secret)
+{
+    connect(info, &ThingPairingInfo::destroyed, client, &WebOsClient::deleteLater);
+
+    connect(client, &WebOsClient::registeredChanged, info, [this, info, client](bool registered){
+        if (!registered)
+            return;
+
+        pluginStorage()->beginGroup(info->thingId().toString());
+        pluginStorage()->remove("key");
+        pluginStorage()->setValue("webosClientKey", client->clientKey());
+        pluginStorage()->endGroup();
+
+        info->finish(Thing::ThingErrorNoError);
+    });
+    connect(client, &WebOsClient::registrationFailed, info, [info](){
+        info->finish(Thing::ThingErrorAuthenticationFailure, QT_TR_NOOP("Error pairing TV. Please try again."));
+    });
+
+    WebOsReply *reply = client->setPin(secret);
+    connect(reply, &WebOsReply::finished, info, [info](bool success){
+        if (!success) {
+            qCWarning(dcLgSmartTv()) << "Setting the webOS pairing PIN failed";
+            info->finish(Thing::ThingErrorAuthenticationFailure, QT_TR_NOOP("Error pairing TV. Please try again."));
+        }
+    });
+}
+
+void IntegrationPluginLgSmartTv::confirmUdapPairing(ThingPairingInfo *info, const QString &secret)
+{
     QHostAddress host = QHostAddress(info->params().paramValue(lgSmartTvThingHostAddressParamTypeId).toString());
     int port = info->params().paramValue(lgSmartTvThingPortParamTypeId).toInt();
     QPair<QNetworkRequest, QByteArray> request = TvDevice::createPairingRequest(host, port, secret);
@@ -146,6 +250,7 @@ void IntegrationPluginLgSmartTv::confirmPairing(ThingPairingInfo *info, const QS
             }
 
             pluginStorage()->beginGroup(info->thingId().toString());
+            pluginStorage()->remove("webosClientKey");
             pluginStorage()->setValue("key", secret);
             pluginStorage()->endGroup();
 
@@ -160,13 +265,40 @@ void IntegrationPluginLgSmartTv::setupThing(ThingSetupInfo *info)
 
     qCDebug(dcLgSmartTv()) << "Setup LG smart TV" << thing->name() << thing->params();
     QHostAddress address = QHostAddress(thing->paramValue(lgSmartTvThingHostAddressParamTypeId).toString());
-    TvDevice *tvDevice = new TvDevice(address, thing->paramValue(lgSmartTvThingPortParamTypeId).toInt(), this);
-    tvDevice->setUuid(thing->paramValue(lgSmartTvThingUuidParamTypeId).toString());
 
     pluginStorage()->beginGroup(thing->id().toString());
     QString key = pluginStorage()->value("key").toString();
+    QString webOsClientKey = pluginStorage()->value("webosClientKey").toString();
     pluginStorage()->endGroup();
 
+    if (!webOsClientKey.isEmpty()) {
+        TvDevice *tvDevice = new TvDevice(address, thing->paramValue(lgSmartTvThingPortParamTypeId).toInt(), TvDevice::ProtocolWebOs, this);
+        tvDevice->setUuid(thing->paramValue(lgSmartTvThingUuidParamTypeId).toString());
+        tvDevice->setKey(webOsClientKey);
+        connect(tvDevice, &TvDevice::stateChanged, this, &IntegrationPluginLgSmartTv::stateChanged);
+        connect(tvDevice->webOsClient(), &WebOsClient::registeredChanged, thing, [this, thing, tvDevice](bool registered){
+            if (!registered || tvDevice->webOsClient()->clientKey() == tvDevice->key())
+                return;
+
+            // The TV handed out a new client key
+            tvDevice->setKey(tvDevice->webOsClient()->clientKey());
+            pluginStorage()->beginGroup(thing->id().toString());
+            pluginStorage()->setValue("webosClientKey", tvDevice->key());
+            pluginStorage()->endGroup();
+        });
+        connect(tvDevice->webOsClient(), &WebOsClient::registrationFailed, thing, [thing](const QString &error){
+            qCWarning(dcLgSmartTv()) << thing->name() << "rejected the stored client key:" << error << "Please pair the TV again.";
+        });
+        m_tvList.insert(tvDevice, thing);
+
+        // No polling needed, the TV pushes its state changes
+        tvDevice->webOsClient()->connectToTv();
+        info->finish(Thing::ThingErrorNoError);
+        return;
+    }
+
+    TvDevice *tvDevice = new TvDevice(address, thing->paramValue(lgSmartTvThingPortParamTypeId).toInt(), TvDevice::ProtocolUdap, this);
+    tvDevice->setUuid(thing->paramValue(lgSmartTvThingUuidParamTypeId).toString());
     tvDevice->setKey(key);
 
     connect(tvDevice, &TvDevice::stateChanged, this, &IntegrationPluginLgSmartTv::stateChanged);
@@ -188,7 +320,9 @@ void IntegrationPluginLgSmartTv::thingRemoved(Thing *thing)
 
     TvDevice *tvDevice= m_tvList.key(thing);
     qCDebug(dcLgSmartTv) << "Removing device" << thing->name();
-    unpairTvDevice(thing);
+    if (tvDevice->protocol() == TvDevice::ProtocolUdap)
+        unpairTvDevice(thing);
+
     m_tvList.remove(tvDevice);
     delete tvDevice;
 
@@ -200,7 +334,9 @@ void IntegrationPluginLgSmartTv::thingRemoved(Thing *thing)
 
 void IntegrationPluginLgSmartTv::postSetupThing(Thing *thing)
 {
-    pairTvDevice(thing);
+    TvDevice *tvDevice = m_tvList.key(thing);
+    if (tvDevice->protocol() == TvDevice::ProtocolUdap)
+        pairTvDevice(thing);
 }
 
 void IntegrationPluginLgSmartTv::executeAction(ThingActionInfo *info)
@@ -215,6 +351,11 @@ void IntegrationPluginLgSmartTv::executeAction(ThingActionInfo *info)
         return info->finish(Thing::ThingErrorHardwareNotAvailable);
     }
 
+    if (tvDevice->protocol() == TvDevice::ProtocolWebOs) {
+        executeWebOsAction(info, tvDevice);
+        return;
+    }
+
     QNetworkReply *reply = nullptr;
 
     if (action.actionTypeId() == lgSmartTvCommandVolumeUpActionTypeId) {
@@ -293,6 +434,67 @@ void IntegrationPluginLgSmartTv::executeAction(ThingActionInfo *info)
     });
 }
 
+void IntegrationPluginLgSmartTv::executeWebOsAction(ThingActionInfo *info, TvDevice *tvDevice)
+{
+    ActionTypeId actionTypeId = info->action().actionTypeId();
+    WebOsClient *client = tvDevice->webOsClient();
+
+    // Navigation keys go through the pointer input socket
+    QHash<ActionTypeId, QString> buttons;
+    buttons.insert(lgSmartTvCommandArrowUpActionTypeId, "UP");
+    buttons.insert(lgSmartTvCommandArrowDownActionTypeId, "DOWN");
+    buttons.insert(lgSmartTvCommandArrowLeftActionTypeId, "LEFT");
+    buttons.insert(lgSmartTvCommandArrowRightActionTypeId, "RIGHT");
+    buttons.insert(lgSmartTvCommandOkActionTypeId, "ENTER");
+    buttons.insert(lgSmartTvCommandBackActionTypeId, "BACK");
+    buttons.insert(lgSmartTvCommandHomeActionTypeId, "HOME");
+    buttons.insert(lgSmartTvCommandExitActionTypeId, "EXIT");
+    buttons.insert(lgSmartTvCommandInfoActionTypeId, "INFO");
+    buttons.insert(lgSmartTvCommandMyAppsActionTypeId, "MYAPPS");
+    buttons.insert(lgSmartTvCommandProgramListActionTypeId, "LIST");
+    if (buttons.contains(actionTypeId)) {
+        if (!client->sendButton(buttons.value(actionTypeId))) {
+            info->finish(Thing::ThingErrorHardwareNotAvailable);
+            return;
+        }
+        info->finish(Thing::ThingErrorNoError);
+        return;
+    }
+
+    WebOsReply *reply = nullptr;
+    if (actionTypeId == lgSmartTvCommandVolumeUpActionTypeId) {
+        reply = client->sendRequest("ssap://audio/volumeUp");
+    } else if (actionTypeId == lgSmartTvCommandVolumeDownActionTypeId) {
+        reply = client->sendRequest("ssap://audio/volumeDown");
+    } else if (actionTypeId == lgSmartTvCommandMuteActionTypeId) {
+        QVariantMap payload;
+        payload.insert("mute", true);
+        reply = client->sendRequest("ssap://audio/setMute", payload);
+    } else if (actionTypeId == lgSmartTvCommandUnmuteActionTypeId) {
+        QVariantMap payload;
+        payload.insert("mute", false);
+        reply = client->sendRequest("ssap://audio/setMute", payload);
+    } else if (actionTypeId == lgSmartTvCommandChannelUpActionTypeId) {
+        reply = client->sendRequest("ssap://tv/channelUp");
+    } else if (actionTypeId == lgSmartTvCommandChannelDownActionTypeId) {
+        reply = client->sendRequest("ssap://tv/channelDown");
+    } else if (actionTypeId == lgSmartTvCommandPowerOffActionTypeId) {
+        reply = client->sendRequest("ssap://system/turnOff");
+    } else if (actionTypeId == lgSmartTvCommandInputSourceActionTypeId) {
+        QVariantMap payload;
+        payload.insert("id", "com.webos.app.inputpicker");
+        reply = client->sendRequest("ssap://system.launcher/launch", payload);
+    }
+
+    if (!reply) {
+        info->finish(Thing::ThingErrorActionTypeNotFound);
+        return;
+    }
+
+    connect(reply, &WebOsReply::finished, info, [info](bool success){
+        info->finish(success ? Thing::ThingErrorNoError : Thing::ThingErrorHardwareFailure);
+    });
+}
 
 void IntegrationPluginLgSmartTv::pairTvDevice(Thing *thing)
 {
@@ -357,6 +559,9 @@ void IntegrationPluginLgSmartTv::onPluginTimer()
 {
     foreach (Thing *thing, m_tvList.values()) {
         TvDevice *tv = m_tvList.key(thing);
+        if (tv->protocol() == TvDevice::ProtocolWebOs)
+            continue;
+
         if (tv->paired()) {
             refreshTv(thing);
         } else {
@@ -64,11 +64,17 @@ private:
     PluginTimer *m_pluginTimer = nullptr;
     QHash<TvDevice *, Thing *> m_tvList;
     QHash<QString, QString> m_tvKeys;
+    QHash<PairingTransactionId, WebOsClient *> m_pairingClients;
 
     // update requests
     QHash<QNetworkReply *, Thing *> m_volumeInfoRequests;
     QHash<QNetworkReply *, Thing *> m_channelInfoRequests;
 
+    void startUdapPairing(ThingPairingInfo *info);
+    void confirmUdapPairing(ThingPairingInfo *info, const QString &secret);
+    void confirmWebOsPairing(ThingPairingInfo *info, WebOsClient *client, const QString &secret);
+    void executeWebOsAction(ThingActionInfo *info, TvDevice *tvDevice);
+
     void pairTvDevice(Thing *thing);
     void unpairTvDevice(Thing *thing);
     void refreshTv(Thing *thing);
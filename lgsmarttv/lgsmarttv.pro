@@ -2,16 +2,18 @@ include(../plugins.pri)
 
 TARGET = $$qtLibraryTarget(nymea_integrationpluginlgsmarttv)
 
-QT+= network xml
+QT+= network xml websockets
 
 SOURCES += \
     integrationpluginlgsmarttv.cpp \
     tvdevice.cpp \
-    tveventhandler.cpp
+    tveventhandler.cpp \
+    webosclient.cpp
 
 HEADERS += \
     integrationpluginlgsmarttv.h \
     tvdevice.h \
-    tveventhandler.h
+    tveventhandler.h \
+    webosclient.h
 
 
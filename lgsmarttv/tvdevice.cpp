@@ -31,8 +31,9 @@
 #include "tvdevice.h"
 #include "extern-plugininfo.h"
 
-TvDevice::TvDevice(const QHostAddress &hostAddress, const int &port, QObject *parent) :
+TvDevice::TvDevice(const QHostAddress &hostAddress, const int &port, Protocol protocol, QObject *parent) :
     QObject(parent),
+    m_protocol(protocol),
     m_hostAddress(hostAddress),
     m_port(port),
     m_paired(false),
@@ -43,13 +44,61 @@ TvDevice::TvDevice(const QHostAddress &hostAddress, const int &port, QObject *pa
     m_inputSourceIndex(-1),
     m_channelNumber(-1)
 {
-    m_eventHandler = new TvEventHandler(hostAddress, port, this);
-    connect(m_eventHandler, &TvEventHandler::eventOccured, this, &TvDevice::eventOccured);
+    if (m_protocol == ProtocolUdap) {
+        m_eventHandler = new TvEventHandler(hostAddress, port, this);
+        connect(m_eventHandler, &TvEventHandler::eventOccured, this, &TvDevice::eventOccured);
+        return;
+    }
+
+    m_webOsClient = new WebOsClient(hostAddress, this);
+    connect(m_webOsClient, &WebOsClient::registeredChanged, this, [this](bool registered){
+        if (!registered)
+            m_powerActive = true;
+
+        setPaired(registered);
+        updateWebOsReachable();
+    });
+    connect(m_webOsClient, &WebOsClient::powerStateChanged, this, [this](bool active){
+        m_powerActive = active;
+        updateWebOsReachable();
+    });
+    connect(m_webOsClient, &WebOsClient::volumeChanged, this, [this](int volume, bool muted){
+        m_volumeLevel = volume;
+        m_mute = muted;
+        emit stateChanged();
+    });
+    connect(m_webOsClient, &WebOsClient::channelChanged, this, [this](const QString &channelType, const QString &channelName, int channelNumber){
+        m_channelType = channelType;
+        m_channelName = channelName;
+        m_channelNumber = channelNumber;
+        emit stateChanged();
+    });
+    connect(m_webOsClient, &WebOsClient::programChanged, this, [this](const QString &programName){
+        m_programName = programName;
+        emit stateChanged();
+    });
+    connect(m_webOsClient, &WebOsClient::inputSourceChanged, this, [this](int inputSourceIndex, const QString &inputSourceLabel){
+        m_inputSourceIndex = inputSourceIndex;
+        m_inputSourceLabel = inputSourceLabel;
+        emit stateChanged();
+    });
+}
+
+TvDevice::Protocol TvDevice::protocol() const
+{
+    return m_protocol;
+}
+
+WebOsClient *TvDevice::webOsClient() const
+{
+    return m_webOsClient;
 }
 
 void TvDevice::setKey(const QString &key)
 {
     m_key = key;
+    if (m_webOsClient)
+        m_webOsClient->setClientKey(key);
 }
 
 QString TvDevice::key() const
@@ -60,6 +109,8 @@ QString TvDevice::key() const
 void TvDevice::setHostAddress(const QHostAddress &hostAddress)
 {
     m_hostAddress = hostAddress;
+    if (m_webOsClient)
+        m_webOsClient->setAddress(hostAddress);
 }
 
 QHostAddress TvDevice::hostAddress() const
@@ -305,6 +356,12 @@ void TvDevice::onChannelInformationUpdate(const QByteArray &data)
     emit stateChanged();
 }
 
+void TvDevice::updateWebOsReachable()
+{
+    // The websocket stays open while the TV is in standby
+    setReachable(m_webOsClient->registered() && m_powerActive);
+}
+
 QString TvDevice::printXmlData(const QByteArray &data)
 {
     QString xmlOut;
@@ -45,12 +45,18 @@
 
 #include "integrations/integrationplugin.h"
 #include "tveventhandler.h"
+#include "webosclient.h"
 
 class TvDevice : public QObject
 {
     Q_OBJECT
 public:
-    explicit TvDevice(const QHostAddress &hostAddress, const int &port, QObject *parent = 0);
+    enum Protocol {
+        ProtocolUdap,   // Legacy NetCast TVs, polled via UDAP 2.0
+        ProtocolWebOs   // webOS TVs, state changes pushed over the SSAP websocket
+    };
+
+    explicit TvDevice(const QHostAddress &hostAddress, const int &port, Protocol protocol = ProtocolUdap, QObject *parent = 0);
 
     enum RemoteKey{
         Power           = 1,
@@ -122,6 +128,9 @@ public:
     };
 
     // propertys
+    Protocol protocol() const;
+    WebOsClient *webOsClient() const;
+
     void setKey(const QString &key);
     QString key() const;
 
@@ -166,7 +175,10 @@ public:
     void onChannelInformationUpdate(const QByteArray &data);
 
 private:
-    TvEventHandler *m_eventHandler;
+    Protocol m_protocol;
+    TvEventHandler *m_eventHandler = nullptr;
+    WebOsClient *m_webOsClient = nullptr;
+    bool m_powerActive = true;
 
     QHostAddress m_hostAddress;
     int m_port;
@@ -187,6 +199,7 @@ private:
     QString m_inputSourceLabel;
 
     QString printXmlData(const QByteArray &data);
+    void updateWebOsReachable();
 
 signals:
     void stateChanged();
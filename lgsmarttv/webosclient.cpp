@@ -0,0 +1,436 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+*
+* Copyright 2013 - 2020, nymea GmbH
+* Contact: contact@nymea.io
+*
+* This file is part of nymea.
+* This project including source code and documentation is protected by
+* copyright law, and remains the property of nymea GmbH. All rights, including
+* reproduction, publication, editing and translation, are reserved. The use of
+* this project is subject to the terms of a license agreement to be concluded
+* with nymea GmbH in accordance with the terms of use of nymea GmbH, available
+* under https://nymea.io/license
+*
+* GNU Lesser General Public License Usage
+* Alternatively, this project may be redistributed and/or modified under the
+* terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; version 3. This project is distributed in the hope that
+* it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+* warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this project. If not, see <https://www.gnu.org/licenses/>.
+*
+* For any further details and any questions please contact us under
+* contact@nymea.io or see our FAQ/Licensing Information on
+* https://nymea.io/license/faq
+*
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+#include "webosclient.h"
+#include "extern-plugininfo.h"
+
+#include <QJsonDocument>
+#include <QUrl>
+
+WebOsReply::WebOsReply(int id, const QString &uri, QObject *parent) :
+    QObject(parent),
+    m_id(id),
+    m_uri(uri)
+{
+    QTimer::singleShot(10000, this, [this]{ emit finished(false, QVariantMap()); });
+    connect(this, &WebOsReply::finished, this, &WebOsReply::deleteLater);
+}
+
+int WebOsReply::id() const
+{
+    return m_id;
+}
+
+QString WebOsReply::uri() const
+{
+    return m_uri;
+}
+
+WebOsClient::WebOsClient(const QHostAddress &address, QObject *parent) :
+    QObject(parent),
+    m_address(address)
+{
+    m_socket = new QWebSocket("nymea", QWebSocketProtocol::VersionLatest, this);
+    connect(m_socket, &QWebSocket::connected, this, &WebOsClient::onConnected);
+    connect(m_socket, &QWebSocket::disconnected, this, &WebOsClient::onDisconnected);
+    connect(m_socket, &QWebSocket::textMessageReceived, this, &WebOsClient::onTextMessageReceived);
+    connect(m_socket, &QWebSocket::sslErrors, this, &WebOsClient::onSslErrors);
+    typedef void (QWebSocket:: *errorSignal)(QAbstractSocket::SocketError);
+    connect(m_socket, static_cast<errorSignal>(&QWebSocket::error), this, [this](QAbstractSocket::SocketError error){
+        qCDebug(dcLgSmartTv()) << "webOS socket error" << m_address.toString() << error << m_socket->errorString();
+        if (m_connected || !m_enabled || m_reconnectTimer->isActive())
+            return;
+
+        // Newer firmwares only accept the TLS socket on port 3001, older ones only plain 3000.
+        // Try the other one right away before waiting for the next attempt.
+        m_useSecureSocket = !m_useSecureSocket;
+        m_reconnectTimer->start(m_useSecureSocket ? 0 : m_reconnectInterval);
+    });
+
+    m_pointerSocket = new QWebSocket("nymea", QWebSocketProtocol::VersionLatest, this);
+    connect(m_pointerSocket, &QWebSocket::sslErrors, this, &WebOsClient::onSslErrors);
+    connect(m_pointerSocket, &QWebSocket::connected, this, [this]{
+        qCDebug(dcLgSmartTv()) << "webOS pointer input socket connected";
+        while (!m_pendingButtons.isEmpty()) {
+            m_pointerSocket->sendTextMessage("type:button\nname:" + m_pendingButtons.takeFirst() + "\n\n");
+        }
+    });
+
+    m_reconnectTimer = new QTimer(this);
+    m_reconnectTimer->setSingleShot(true);
+    connect(m_reconnectTimer, &QTimer::timeout, this, &WebOsClient::openSocket);
+}
+
+WebOsClient::~WebOsClient()
+{
+    disconnectFromTv();
+}
+
+QHostAddress WebOsClient::address() const
+{
+    return m_address;
+}
+
+void WebOsClient::setAddress(const QHostAddress &address)
+{
+    if (m_address == address)
+        return;
+
+    m_address = address;
+    if (m_enabled) {
+        m_socket->abort();
+        openSocket();
+    }
+}
+
+QString WebOsClient::clientKey() const
+{
+    return m_clientKey;
+}
+
+void WebOsClient::setClientKey(const QString &clientKey)
+{
+    m_clientKey = clientKey;
+}
+
+void WebOsClient::connectToTv()
+{
+    m_enabled = true;
+    if (m_socket->state() == QAbstractSocket::UnconnectedState)
+        openSocket();
+}
+
+void WebOsClient::disconnectFromTv()
+{
+    m_enabled = false;
+    m_reconnectTimer->stop();
+    m_pointerSocket->close();
+    m_socket->close();
+}
+
+bool WebOsClient::connected() const
+{
+    return m_connected;
+}
+
+bool WebOsClient::registered() const
+{
+    return m_registered;
+}
+
+void WebOsClient::registerClient(PairingType pairingType)
+{
+    QVariantMap payload;
+    payload.insert("forcePairing", false);
+    payload.insert("pairingType", pairingType == PairingTypePin ? "PIN" : "PROMPT");
+    payload.insert("manifest", manifest());
+    if (!m_clientKey.isEmpty())
+        payload.insert("client-key", m_clientKey);
+
+    QVariantMap message;
+    message.insert("type", "register");
+    message.insert("id", "register_0");
+    message.insert("payload", payload);
+    sendMessage(message);
+}
+
+WebOsReply *WebOsClient::setPin(const QString &pin)
+{
+    QVariantMap payload;
+    payload.insert("pin", pin);
+    return sendRequest("ssap://pairing/setPin", payload);
+}
+
+WebOsReply *WebOsClient::sendRequest(const QString &uri, const QVariantMap &payload)
+{
+    int id = m_currentId++;
+    WebOsReply *reply = new WebOsReply(id, uri, this);
+    connect(reply, &WebOsReply::finished, this, [this, id]{
+        m_pendingReplies.remove(id);
+    });
+    m_pendingReplies.insert(id, reply);
+
+    if (!m_connected) {
+        qCWarning(dcLgSmartTv()) << "Could not send" << uri << "to" << m_address.toString() << "- not connected";
+        QTimer::singleShot(0, reply, [reply]{ emit reply->finished(false, QVariantMap()); });
+        return reply;
+    }
+
+    QVariantMap message;
+    message.insert("type", "request");
+    message.insert("id", QString::number(id));
+    message.insert("uri", uri);
+    if (!payload.isEmpty())
+        message.insert("payload", payload);
+
+    sendMessage(message);
+    return reply;
+}
+
+bool WebOsClient::sendButton(const QString &button)
+{
+    if (!m_registered)
+        return false;
+
+    if (m_pointerSocket->state() == QAbstractSocket::ConnectedState) {
+        m_pointerSocket->sendTextMessage("type:button\nname:" + button + "\n\n");
+        return true;
+    }
+
+    // The socket path has to be requested first, send the button once the socket is open
+    m_pendingButtons.append(button);
+    if (m_pointerSocket->state() == QAbstractSocket::UnconnectedState)
+        requestPointerSocket();
+
+    return true;
+}
+
+void WebOsClient::onConnected()
+{
+    qCDebug(dcLgSmartTv()) << "webOS socket connected to" << m_socket->requestUrl().toString();
+    setConnected(true);
+    registerClient();
+}
+
+void WebOsClient::onDisconnected()
+{
+    if (!m_connected)
+        return;
+
+    qCDebug(dcLgSmartTv()) << "webOS socket disconnected from" << m_address.toString() << m_socket->closeReason();
+    m_pointerSocket->abort();
+    m_pendingButtons.clear();
+    m_subscriptions.clear();
+    foreach (WebOsReply *reply, m_pendingReplies) {
+        emit reply->finished(false, QVariantMap());
+    }
+    setRegistered(false);
+    setConnected(false);
+
+    if (m_enabled && !m_reconnectTimer->isActive())
+        m_reconnectTimer->start(m_reconnectInterval);
+}
+
+void WebOsClient::onTextMessageReceived(const QString &message)
+{
+    QJsonParseError error;
+    QVariantMap data = QJsonDocument::fromJson(message.toUtf8(), &error).toVariant().toMap();
+    if (error.error != QJsonParseError::NoError) {
+        qCWarning(dcLgSmartTv()) << "Could not parse webOS message" << error.errorString() << message;
+        return;
+    }
+
+    QString type = data.value("type").toString();
+    QString id = data.value("id").toString();
+    QVariantMap payload = data.value("payload").toMap();
+
+    if (id == "register_0") {
+        if (type == "registered") {
+            m_clientKey = payload.value("client-key").toString();
+            qCDebug(dcLgSmartTv()) << "Registered at webOS TV" << m_address.toString();
+            setRegistered(true);
+        } else if (type == "response" && payload.value("pairingType").toString() == "PIN") {
+            emit pinRequested();
+        } else if (type == "error") {
+            qCWarning(dcLgSmartTv()) << "webOS registration failed:" << data.value("error").toString();
+            emit registrationFailed(data.value("error").toString());
+        }
+        return;
+    }
+
+    if (m_subscriptions.contains(id)) {
+        if (type == "error") {
+            qCDebug(dcLgSmartTv()) << "Subscription" << m_subscriptions.value(id) << "not supported:" << data.value("error").toString();
+            m_subscriptions.remove(id);
+            return;
+        }
+        processSubscription(m_subscriptions.value(id), payload);
+        return;
+    }
+
+    WebOsReply *reply = m_pendingReplies.value(id.toInt());
+    if (!reply) {
+        qCDebug(dcLgSmartTv()) << "Unhandled webOS message" << message;
+        return;
+    }
+
+    bool success = (type == "response" && payload.value("returnValue", true).toBool());
+    if (!success) {
+        qCWarning(dcLgSmartTv()) << "webOS request" << reply->uri() << "failed:" << data.value("error").toString() << payload.value("errorText").toString();
+    }
+    emit reply->finished(success, payload);
+}
+
+void WebOsClient::onSslErrors(const QList<QSslError> &errors)
+{
+    // The TVs use a self signed certificate
+    qCDebug(dcLgSmartTv()) << "Ignoring SSL errors of webOS TV" << m_address.toString() << errors.count();
+    QWebSocket *socket = qobject_cast<QWebSocket *>(sender());
+    if (socket)
+        socket->ignoreSslErrors();
+}
+
+void WebOsClient::openSocket()
+{
+    if (!m_enabled)
+        return;
+
+    QUrl url;
+    url.setScheme(m_useSecureSocket ? "wss" : "ws");
+    url.setHost(m_address.toString());
+    url.setPort(m_useSecureSocket ? 3001 : 3000);
+    qCDebug(dcLgSmartTv()) << "Connecting to webOS TV" << url.toString();
+    m_socket->open(url);
+}
+
+void WebOsClient::sendMessage(const QVariantMap &message)
+{
+    m_socket->sendTextMessage(QJsonDocument::fromVariant(message).toJson(QJsonDocument::Compact));
+}
+
+void WebOsClient::subscribe(const QString &uri)
+{
+    QString id = "subscribe_" + QString::number(m_currentId++);
+    m_subscriptions.insert(id, uri);
+
+    QVariantMap message;
+    message.insert("type", "subscribe");
+    message.insert("id", id);
+    message.insert("uri", uri);
+    sendMessage(message);
+}
+
+void WebOsClient::requestPointerSocket()
+{
+    WebOsReply *reply = sendRequest("ssap://com.webos.service.networkinput/getPointerInputSocket");
+    connect(reply, &WebOsReply::finished, this, [this](bool success, const QVariantMap &payload){
+        QUrl socketUrl(payload.value("socketPath").toString());
+        if (!success || !socketUrl.isValid()) {
+            qCWarning(dcLgSmartTv()) << "Could not get the pointer input socket of" << m_address.toString();
+            m_pendingButtons.clear();
+            return;
+        }
+        m_pointerSocket->open(socketUrl);
+    });
+}
+
+void WebOsClient::loadExternalInputs()
+{
+    WebOsReply *reply = sendRequest("ssap://tv/getExternalInputList");
+    connect(reply, &WebOsReply::finished, this, [this](bool success, const QVariantMap &payload){
+        if (!success)
+            return;
+
+        m_externalInputs.clear();
+        QVariantList devices = payload.value("devices").toList();
+        for (int i = 0; i < devices.count(); i++) {
+            QVariantMap device = devices.at(i).toMap();
+            m_externalInputs.insert(device.value("appId").toString(), qMakePair(i + 1, device.value("label").toString()));
+        }
+
+        // The inputs are known now, subscribe to the foreground app to follow input changes
+        subscribe("ssap://com.webos.applicationManager/getForegroundAppInfo");
+    });
+}
+
+void WebOsClient::processSubscription(const QString &uri, const QVariantMap &payload)
+{
+    if (uri == "ssap://audio/getVolume") {
+        // Newer firmwares wrap the values into volumeStatus
+        if (payload.contains("volumeStatus")) {
+            QVariantMap volumeStatus = payload.value("volumeStatus").toMap();
+            emit volumeChanged(volumeStatus.value("volume").toInt(), volumeStatus.value("muteStatus").toBool());
+        } else {
+            emit volumeChanged(payload.value("volume").toInt(), payload.value("muted").toBool());
+        }
+    } else if (uri == "ssap://tv/getCurrentChannel") {
+        // Digital channels are numbered like "5-1"
+        int channelNumber = payload.value("channelNumber").toString().split("-").first().toInt();
+        emit channelChanged(payload.value("channelTypeName").toString(), payload.value("channelName").toString(), channelNumber);
+    } else if (uri == "ssap://tv/getChannelCurrentProgramInfo") {
+        emit programChanged(payload.value("programName").toString());
+    } else if (uri == "ssap://com.webos.applicationManager/getForegroundAppInfo") {
+        processForegroundApp(payload.value("appId").toString());
+    } else if (uri == "ssap://com.webos.service.tvpower/power/getPowerState") {
+        QString state = payload.value("state").toString();
+        emit powerStateChanged(state == "Active" || state == "Screen Off");
+    }
+}
+
+void WebOsClient::processForegroundApp(const QString &appId)
+{
+    if (m_externalInputs.contains(appId)) {
+        QPair<int, QString> input = m_externalInputs.value(appId);
+        emit inputSourceChanged(input.first, input.second);
+    } else if (appId == "com.webos.app.livetv") {
+        emit inputSourceChanged(0, "TV");
+    } else {
+        emit inputSourceChanged(-1, appId);
+    }
+}
+
+void WebOsClient::setConnected(bool connected)
+{
+    if (m_connected == connected)
+        return;
+
+    m_connected = connected;
+    emit connectedChanged(m_connected);
+}
+
+void WebOsClient::setRegistered(bool registered)
+{
+    if (m_registered == registered)
+        return;
+
+    m_registered = registered;
+    if (m_registered) {
+        subscribe("ssap://audio/getVolume");
+        subscribe("ssap://tv/getCurrentChannel");
+        subscribe("ssap://tv/getChannelCurrentProgramInfo");
+        subscribe("ssap://com.webos.service.tvpower/power/getPowerState");
+        loadExternalInputs();
+    }
+    emit registeredChanged(m_registered);
+}
+
+QVariantMap WebOsClient::manifest()
+{
+    QStringList permissions;
+    permissions << "LAUNCH" << "CONTROL_AUDIO" << "CONTROL_DISPLAY" << "CONTROL_INPUT_TV"
+                << "CONTROL_POWER" << "CONTROL_INPUT_JOYSTICK" << "CONTROL_MOUSE_AND_KEYBOARD"
+                << "READ_INPUT_DEVICE_LIST" << "READ_CURRENT_CHANNEL" << "READ_RUNNING_APPS"
+                << "READ_TV_CURRENT_TIME" << "READ_POWER_STATE" << "READ_CHANNEL_LIST";
+
+    QVariantMap manifest;
+    manifest.insert("manifestVersion", 1);
+    manifest.insert("appVersion", "1.0");
+    manifest.insert("permissions", permissions);
+    return manifest;
+}
@@ -0,0 +1,144 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+*
+* Copyright 2013 - 2020, nymea GmbH
+* Contact: contact@nymea.io
+*
+* This file is part of nymea.
+* This project including source code and documentation is protected by
+* copyright law, and remains the property of nymea GmbH. All rights, including
+* reproduction, publication, editing and translation, are reserved. The use of
+* this project is subject to the terms of a license agreement to be concluded
+* with nymea GmbH in accordance with the terms of use of nymea GmbH, available
+* under https://nymea.io/license
+*
+* GNU Lesser General Public License Usage
+* Alternatively, this project may be redistributed and/or modified under the
+* terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; version 3. This project is distributed in the hope that
+* it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+* warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this project. If not, see <https://www.gnu.org/licenses/>.
+*
+* For any further details and any questions please contact us under
+* contact@nymea.io or see our FAQ/Licensing Information on
+* https://nymea.io/license/faq
+*
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+#ifndef WEBOSCLIENT_H
+#define WEBOSCLIENT_H
+
+#include <QObject>
+#include <QHostAddress>
+#include <QWebSocket>
+#include <QVariantMap>
+#include <QTimer>
+#include <QHash>
+
+class WebOsReply : public QObject
+{
+    Q_OBJECT
+public:
+    explicit WebOsReply(int id, const QString &uri, QObject *parent = nullptr);
+
+    int id() const;
+    QString uri() const;
+
+signals:
+    void finished(bool success, const QVariantMap &payload);
+
+private:
+    int m_id;
+    QString m_uri;
+};
+
+// Client for the SSAP (Simple Service Access Protocol) websocket of LG webOS TVs.
+// After registration the TV pushes volume, channel, input and power changes for
+// the subscribed URIs, so no polling is required. Remote control keys are sent
+// over the separate pointer input socket.
+class WebOsClient : public QObject
+{
+    Q_OBJECT
+public:
+    enum PairingType {
+        PairingTypePin,
+        PairingTypePrompt
+    };
+    Q_ENUM(PairingType)
+
+    explicit WebOsClient(const QHostAddress &address, QObject *parent = nullptr);
+    ~WebOsClient() override;
+
+    QHostAddress address() const;
+    void setAddress(const QHostAddress &address);
+
+    QString clientKey() const;
+    void setClientKey(const QString &clientKey);
+
+    // Connects and keeps reconnecting until disconnectFromTv() gets called
+    void connectToTv();
+    void disconnectFromTv();
+
+    bool connected() const;
+    bool registered() const;
+
+    void registerClient(PairingType pairingType = PairingTypePin);
+    WebOsReply *setPin(const QString &pin);
+
+    WebOsReply *sendRequest(const QString &uri, const QVariantMap &payload = QVariantMap());
+    bool sendButton(const QString &button);
+
+signals:
+    void connectedChanged(bool connected);
+    void pinRequested();
+    void registeredChanged(bool registered);
+    void registrationFailed(const QString &error);
+
+    void volumeChanged(int volume, bool muted);
+    void channelChanged(const QString &channelType, const QString &channelName, int channelNumber);
+    void programChanged(const QString &programName);
+    void inputSourceChanged(int inputSourceIndex, const QString &inputSourceLabel);
+    void powerStateChanged(bool active);
+
+private slots:
+    void onConnected();
+    void onDisconnected();
+    void onTextMessageReceived(const QString &message);
+    void onSslErrors(const QList<QSslError> &errors);
+
+private:
+    QWebSocket *m_socket = nullptr;
+    QWebSocket *m_pointerSocket = nullptr;
+    QTimer *m_reconnectTimer = nullptr;
+    int m_reconnectInterval = 10000;
+
+    QHostAddress m_address;
+    QString m_clientKey;
+    bool m_enabled = false;
+    bool m_connected = false;
+    bool m_registered = false;
+    bool m_useSecureSocket = false;
+    int m_currentId = 1;
+
+    QHash<int, WebOsReply *> m_pendingReplies;
+    QHash<QString, QString> m_subscriptions; // id, uri
+    QHash<QString, QPair<int, QString> > m_externalInputs; // appId, index and label
+    QStringList m_pendingButtons;
+
+    void openSocket();
+    void sendMessage(const QVariantMap &message);
+    void subscribe(const QString &uri);
+    void requestPointerSocket();
+    void loadExternalInputs();
+
+    void processSubscription(const QString &uri, const QVariantMap &payload);
+    void processForegroundApp(const QString &appId);
+    void setConnected(bool connected);
+    void setRegistered(bool registered);
+
+    static QVariantMap manifest();
+};
+
+#endif // WEBOSCLIENT_H
@@ -48,7 +48,8 @@ bool BluetoothAdapter::setAlias(const QString &alias)
     if (!m_adapterInterface->isValid())
         return false;
 
-    return m_adapterInterface->setProperty("Alias", QVariant(alias));
+    m_adapterInterface->setPropertyAsync("Alias", QVariant(alias));
+    return true;
 }
 
 QString BluetoothAdapter::address() const
@@ -76,7 +77,8 @@ bool BluetoothAdapter::setDiscoverable(const bool &discoverable)
     if (!m_adapterInterface->isValid())
         return false;
 
-    return m_adapterInterface->setProperty("Discoverable", QVariant(discoverable));
+    m_adapterInterface->setPropertyAsync("Discoverable", QVariant(discoverable));
+    return true;
 }
 
 uint BluetoothAdapter::discoverableTimeout() const
@@ -89,7 +91,8 @@ bool BluetoothAdapter::setDiscoverableTimeout(const uint &seconds)
     if (!m_adapterInterface->isValid())
         return false;
 
-    return m_adapterInterface->setProperty("DiscoverableTimeout", QVariant(seconds));
+    m_adapterInterface->setPropertyAsync("DiscoverableTimeout", QVariant(seconds));
+    return true;
 }
 
 bool BluetoothAdapter::pairable() const
@@ -102,7 +105,8 @@ bool BluetoothAdapter::setPairable(const bool &pairable)
     if (!m_adapterInterface->isValid())
         return false;
 
-    return m_adapterInterface->setProperty("Pairable", QVariant(pairable));
+    m_adapterInterface->setPropertyAsync("Pairable", QVariant(pairable));
+    return true;
 }
 
 uint BluetoothAdapter::pairableTimeout() const
@@ -115,7 +119,8 @@ bool BluetoothAdapter::setPairableTimeout(const uint &seconds)
     if (!m_adapterInterface->isValid())
         return false;
 
-    return m_adapterInterface->setProperty("PairableTimeout", QVariant(seconds));
+    m_adapterInterface->setPropertyAsync("PairableTimeout", QVariant(seconds));
+    return true;
 }
 
 uint BluetoothAdapter::adapterClass() const
@@ -144,7 +149,8 @@ bool BluetoothAdapter::setPower(const bool &power)
     if (!m_adapterInterface->isValid())
         return false;
 
-    return m_adapterInterface->setProperty("Powered", QVariant(power));
+    m_adapterInterface->setPropertyAsync("Powered", QVariant(power));
+    return true;
 }
 
 QStringList BluetoothAdapter::uuids() const
@@ -212,7 +218,7 @@ BluetoothAdapter::BluetoothAdapter(const QDBusObjectPath &path, const QVariantMa
         return;
     }
 
-    m_adapterInterface = new QDBusInterface(orgBluez, m_path.path(), orgBluezAdapter1, QDBusConnection::systemBus(), this);
+    m_adapterInterface = new BluezInterface(m_path.path(), orgBluezAdapter1, this);
     if (!m_adapterInterface->isValid()) {
         qCWarning(dcBluez()) << "Invalid DBus adapter interface for" << m_path.path();
         return;
@@ -392,11 +398,7 @@ void BluetoothAdapter::startDiscovering()
     if (discovering())
         return;
 
-    QDBusMessage query = m_adapterInterface->call("StartDiscovery");
-    if(query.type() != QDBusMessage::ReplyMessage) {
-        qCWarning(dcBluez()) << "Could not start discovery" << m_name << ":" << query.errorName() << query.errorMessage();
-        return;
-    }
+    m_adapterInterface->callAsync("StartDiscovery", "Could not start discovery on");
 }
 
 void BluetoothAdapter::stopDiscovering()
@@ -406,11 +408,7 @@ void BluetoothAdapter::stopDiscovering()
         return;
     }
 
-    QDBusMessage query = m_adapterInterface->call("StopDiscovery");
-    if(query.type() != QDBusMessage::ReplyMessage) {
-        qCWarning(dcBluez()) << "Could not start discovery" << m_name << ":" << query.errorName() << query.errorMessage();
-        return;
-    }
+    m_adapterInterface->callAsync("StopDiscovery", "Could not stop discovery on");
 }
 
 QDebug operator<<(QDebug debug, BluetoothAdapter *adapter)
@@ -33,10 +33,10 @@
 
 #include <QObject>
 #include <QDebug>
-#include <QDBusInterface>
 #include <QDBusConnection>
 #include <QDBusObjectPath>
 
+#include "bluezinterface.h"
 #include "bluetoothdevice.h"
 
 // Note: DBus documentation https://git.kernel.org/pub/scm/bluetooth/bluez.git/tree/doc/adapter-api.txt
@@ -93,7 +93,7 @@ private:
     ~BluetoothAdapter();
 
     QDBusObjectPath m_path;
-    QDBusInterface *m_adapterInterface;
+    BluezInterface *m_adapterInterface;
 
     QString m_name;
     QString m_address;
@@ -67,7 +67,8 @@ bool BluetoothDevice::setAlias(const QString &alias)
     if (!m_deviceInterface->isValid())
         return false;
 
-    return m_deviceInterface->setProperty("Alias", QVariant(alias));
+    m_deviceInterface->setPropertyAsync("Alias", QVariant(alias));
+    return true;
 }
 
 QString BluetoothDevice::modalias() const
@@ -120,7 +121,8 @@ bool BluetoothDevice::setTrusted(const bool &trusted)
     if (!m_deviceInterface->isValid())
         return false;
 
-    return m_deviceInterface->setProperty("Trusted", QVariant(trusted));
+    m_deviceInterface->setPropertyAsync("Trusted", QVariant(trusted));
+    return true;
 }
 
 bool BluetoothDevice::blocked() const
@@ -133,7 +135,8 @@ bool BluetoothDevice::setBlocked(const bool &blocked)
     if (!m_deviceInterface->isValid())
         return false;
 
-    return m_deviceInterface->setProperty("Blocked", QVariant(blocked));
+    m_deviceInterface->setPropertyAsync("Blocked", QVariant(blocked));
+    return true;
 }
 
 bool BluetoothDevice::legacyPairing() const
@@ -197,7 +200,7 @@ BluetoothDevice::BluetoothDevice(const QDBusObjectPath &path, const QVariantMap
         return;
     }
 
-    m_deviceInterface = new QDBusInterface(orgBluez, m_path.path(), orgBluezDevice1, QDBusConnection::systemBus(), this);
+    m_deviceInterface = new BluezInterface(m_path.path(), orgBluezDevice1, this);
     if (!m_deviceInterface->isValid()) {
         qCWarning(dcBluez()) << "Invalid DBus thing interface for" << m_path.path();
         return;
@@ -490,27 +493,6 @@ bool BluetoothDevice::disconnectDevice()
     return true;
 }
 
-bool BluetoothDevice::disconnectDeviceBlocking()
-{
-    if (!m_deviceInterface->isValid()) {
-        qCWarning(dcBluez()) << "Invalid DBus thing interface for" << m_path.path();
-        return false;
-    }
-
-    if (!connected() || state() == Disconnecting)
-        return true;
-
-    qCWarning(dcBluez()) << "Disconnecting blocking" << this;
-    QDBusPendingReply<void> reply = m_deviceInterface->call("Disconnect");
-    reply.waitForFinished();
-    if(reply.isError()) {
-        qCWarning(dcBluez()) << reply.error();
-        return false;
-    }
-
-    return true;
-}
-
 bool BluetoothDevice::requestPairing()
 {
     if (!m_deviceInterface->isValid()) {
@@ -543,7 +525,7 @@ bool BluetoothDevice::cancelPairingRequest()
 
     QDBusPendingCall cancelPairingCall = m_deviceInterface->asyncCall("CancelPairing");
     QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(cancelPairingCall, this);
-    connect(watcher, &QDBusPendingCallWatcher::finished, this, &BluetoothDevice::onPairingFinished);
+    connect(watcher, &QDBusPendingCallWatcher::finished, this, &BluetoothDevice::onCancelPairingFinished);
     return true;
 }
 
@@ -32,13 +32,13 @@
 #define BLUETOOTHDEVICE_H
 
 #include <QObject>
-#include <QDBusInterface>
 #include <QDBusPendingCall>
 #include <QBluetoothAddress>
 #include <QBluetoothHostInfo>
 #include <QDBusPendingCallWatcher>
 
 #include "blueztypes.h"
+#include "bluezinterface.h"
 #include "bluetoothgattservice.h"
 
 // Note: DBus documentation https://git.kernel.org/pub/scm/bluetooth/bluez.git/tree/doc/thing-api.txt
@@ -105,7 +105,7 @@ private:
     ~BluetoothDevice();
 
     QDBusObjectPath m_path;
-    QDBusInterface *m_deviceInterface;
+    BluezInterface *m_deviceInterface;
 
     QList<BluetoothGattService *> m_services;
 
@@ -182,7 +182,6 @@ private slots:
 public slots:
     bool connectDevice();
     bool disconnectDevice();
-    bool disconnectDeviceBlocking();
     bool requestPairing();
     bool cancelPairingRequest();
 };
@@ -88,7 +88,7 @@ BluetoothGattCharacteristic::BluetoothGattCharacteristic(const QDBusObjectPath &
     m_path(path),
     m_notifying(false)
 {
-    m_characteristicInterface = new QDBusInterface(orgBluez, m_path.path(), orgBluezGattCharacteristic1, QDBusConnection::systemBus(), this);
+    m_characteristicInterface = new BluezInterface(m_path.path(), orgBluezGattCharacteristic1, this);
     if (!m_characteristicInterface->isValid()) {
         qCWarning(dcBluez()) << "Invalid DBus characteristic interface for" << m_path.path();
         return;
@@ -35,11 +35,11 @@
 #include <QFlag>
 #include <QObject>
 #include <QBluetoothUuid>
-#include <QDBusInterface>
 #include <QDBusPendingCall>
 #include <QDBusPendingCallWatcher>
 
 #include "blueztypes.h"
+#include "bluezinterface.h"
 #include "bluetoothgattdescriptor.h"
 
 // Note: DBus documentation https://git.kernel.org/pub/scm/bluetooth/bluez.git/tree/doc/gatt-api.txt
@@ -88,7 +88,7 @@ private:
     explicit BluetoothGattCharacteristic(const QDBusObjectPath &path, const QVariantMap &properties, QObject *parent = 0);
 
     QDBusObjectPath m_path;
-    QDBusInterface *m_characteristicInterface;
+    BluezInterface *m_characteristicInterface;
 
     QString m_characteristicName;
     QBluetoothUuid m_uuid;
@@ -66,7 +66,7 @@ BluetoothGattDescriptor::BluetoothGattDescriptor(const QDBusObjectPath &path, co
     QObject(parent),
     m_path(path)
 {
-    m_descriptorInterface = new QDBusInterface(orgBluez, m_path.path(), orgBluezGattDescriptor1, QDBusConnection::systemBus(), this);
+    m_descriptorInterface = new BluezInterface(m_path.path(), orgBluezGattDescriptor1, this);
     if (!m_descriptorInterface->isValid()) {
         qCWarning(dcBluez()) << "Invalid DBus descriptor interface for" << m_path.path();
         return;
@@ -75,12 +75,6 @@ BluetoothGattDescriptor::BluetoothGattDescriptor(const QDBusObjectPath &path, co
     QDBusConnection::systemBus().connect(orgBluez, m_path.path(), "org.freedesktop.DBus.Properties", "PropertiesChanged", this, SLOT(onPropertiesChanged(QString,QVariantMap,QStringList)));
 
     processProperties(properties);
-
-    QDBusPendingCall readingCall = m_descriptorInterface->asyncCall("GetAll", QVariantMap());
-    QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(readingCall, this);
-    connect(watcher, &QDBusPendingCallWatcher::finished, this, [=](){
-        qCDebug(dcBluez()) << "Get descriptor properties finished";
-    });
 }
 
 void BluetoothGattDescriptor::processProperties(const QVariantMap &properties)
@@ -33,11 +33,11 @@
 
 #include <QObject>
 #include <QBluetoothUuid>
-#include <QDBusInterface>
 #include <QDBusPendingCall>
 #include <QDBusPendingCallWatcher>
 
 #include "blueztypes.h"
+#include "bluezinterface.h"
 
 // Note: DBus documentation https://git.kernel.org/pub/scm/bluetooth/bluez.git/tree/doc/gatt-api.txt
 
@@ -75,7 +75,7 @@ private:
     explicit BluetoothGattDescriptor(const QDBusObjectPath &path, const QVariantMap &properties, QObject *parent = 0);
 
     QDBusObjectPath m_path;
-    QDBusInterface *m_descriptorInterface;
+    BluezInterface *m_descriptorInterface;
 
     QBluetoothUuid m_uuid;
     QByteArray m_value;
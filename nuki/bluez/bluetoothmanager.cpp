@@ -33,6 +33,7 @@
 #include <QDBusObjectPath>
 #include <QDBusArgument>
 #include <QDBusMetaType>
+#include <QDBusPendingReply>
 
 BluetoothManager::BluetoothManager(QObject *parent) :
     QObject(parent),
@@ -52,7 +53,7 @@ BluetoothManager::BluetoothManager(QObject *parent) :
     connect(m_serviceWatcher, &QDBusServiceWatcher::serviceRegistered, this, &BluetoothManager::serviceRegistered);
     connect(m_serviceWatcher, &QDBusServiceWatcher::serviceUnregistered, this, &BluetoothManager::serviceUnregistered);
 
-    m_objectManagerInterface = new QDBusInterface(orgBluez, "/", orgFreedesktopDBusObjectManager, QDBusConnection::systemBus(), this);
+    m_objectManagerInterface = new BluezInterface("/", orgFreedesktopDBusObjectManager, this);
     if (!m_objectManagerInterface->isValid()) {
         qCWarning(dcBluez()) << "Invalid DBus ObjectManager interface.";
         return;
@@ -76,21 +77,10 @@ bool BluetoothManager::isAvailable() const
 
 void BluetoothManager::init()
 {
-    // Get current object from org.bluez
-    QDBusMessage query = m_objectManagerInterface->call("GetManagedObjects");
-    if(query.type() != QDBusMessage::ReplyMessage) {
-        qCWarning(dcBluez()) << "Could not initialize BluetoothManager:" << query.errorName() << query.errorMessage();
-        return;
-    }
-
-    const QDBusArgument &argument = query.arguments().at(0).value<QDBusArgument>();
-    ManagedObjectList objectList = qdbus_cast<ManagedObjectList>(argument);
-    processObjectList(objectList);
-
-    if (!m_adapters.isEmpty())
-        setAvailable(true);
-
-    qCDebug(dcBluez()) << "BluetoothManager initialized successfully.";
+    // Get current object from org.bluez once, afterwards the object tree gets updated using InterfacesAdded/InterfacesRemoved
+    QDBusPendingCall call = m_objectManagerInterface->asyncCall("GetManagedObjects");
+    QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(call, this);
+    connect(watcher, &QDBusPendingCallWatcher::finished, this, &BluetoothManager::onGetManagedObjectsFinished);
 }
 
 void BluetoothManager::clean()
@@ -269,6 +259,23 @@ BluetoothGattCharacteristic *BluetoothManager::findCharacteristic(const QDBusObj
     return nullptr;
 }
 
+void BluetoothManager::onGetManagedObjectsFinished(QDBusPendingCallWatcher *call)
+{
+    QDBusPendingReply<ManagedObjectList> reply = *call;
+    call->deleteLater();
+    if (reply.isError()) {
+        qCWarning(dcBluez()) << "Could not initialize BluetoothManager:" << reply.error().name() << reply.error().message();
+        return;
+    }
+
+    processObjectList(reply.value());
+
+    if (!m_adapters.isEmpty())
+        setAvailable(true);
+
+    qCDebug(dcBluez()) << "BluetoothManager initialized successfully.";
+}
+
 void BluetoothManager::serviceRegistered(const QString &serviceName)
 {
     qCDebug(dcBluez()) << "BluetoothManager: service registered" << serviceName;
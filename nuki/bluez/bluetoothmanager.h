@@ -33,10 +33,11 @@
 
 #include <QObject>
 #include <QDBusConnection>
-#include <QDBusInterface>
 #include <QDBusServiceWatcher>
+#include <QDBusPendingCallWatcher>
 
 #include "blueztypes.h"
+#include "bluezinterface.h"
 #include "bluetoothadapter.h"
 
 class BluetoothManager : public QObject
@@ -50,7 +51,7 @@ public:
     bool isAvailable() const;
 
 private:
-    QDBusInterface *m_objectManagerInterface;
+    BluezInterface *m_objectManagerInterface;
     QDBusServiceWatcher *m_serviceWatcher;
 
     QList<BluetoothAdapter *> m_adapters;
@@ -80,6 +81,8 @@ signals:
     void adapterRemoved(BluetoothAdapter *adapter);
 
 private slots:
+    void onGetManagedObjectsFinished(QDBusPendingCallWatcher *call);
+
     void serviceRegistered(const QString &serviceName);
     void serviceUnregistered(const QString &serviceName);
 
@@ -0,0 +1,72 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+*
+* Copyright 2013 - 2020, nymea GmbH
+* Contact: contact@nymea.io
+*
+* This file is part of nymea.
+* This project including source code and documentation is protected by
+* copyright law, and remains the property of nymea GmbH. All rights, including
+* reproduction, publication, editing and translation, are reserved. The use of
+* this project is subject to the terms of a license agreement to be concluded
+* with nymea GmbH in accordance with the terms of use of nymea GmbH, available
+* under https://nymea.io/license
+*
+* GNU Lesser General Public License Usage
+* Alternatively, this project may be redistributed and/or modified under the
+* terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; version 3. This project is distributed in the hope that
+* it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+* warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this project. If not, see <https://www.gnu.org/licenses/>.
+*
+* For any further details and any questions please contact us under
+* contact@nymea.io or see our FAQ/Licensing Information on
+* https://nymea.io/license/faq
+*
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "bluezinterface.h"
+#include "blueztypes.h"
+
+#include <QDBusConnection>
+#include <QDBusPendingReply>
+#include <QDBusVariant>
+
+BluezInterface::BluezInterface(const QString &path, const QString &interface, QObject *parent) :
+    QDBusAbstractInterface(orgBluez, path, interface.toUtf8().constData(), QDBusConnection::systemBus(), parent)
+{
+
+}
+
+QDBusPendingCall BluezInterface::setPropertyAsync(const QString &propertyName, const QVariant &value)
+{
+    QDBusMessage message = QDBusMessage::createMethodCall(service(), path(), "org.freedesktop.DBus.Properties", "Set");
+    message << interface() << propertyName << QVariant::fromValue(QDBusVariant(value));
+
+    QDBusPendingCall call = connection().asyncCall(message);
+    QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(call, this);
+    connect(watcher, &QDBusPendingCallWatcher::finished, this, [this, propertyName](QDBusPendingCallWatcher *call){
+        QDBusPendingReply<void> reply = *call;
+        if (reply.isError()) {
+            qCWarning(dcBluez()) << "Could not set property" << propertyName << "on" << path() << reply.error().name() << reply.error().message();
+        }
+        call->deleteLater();
+    });
+    return call;
+}
+
+void BluezInterface::callAsync(const QString &method, const QString &errorDescription)
+{
+    QDBusPendingCall call = asyncCall(method);
+    QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(call, this);
+    connect(watcher, &QDBusPendingCallWatcher::finished, this, [this, errorDescription](QDBusPendingCallWatcher *call){
+        QDBusPendingReply<void> reply = *call;
+        if (reply.isError()) {
+            qCWarning(dcBluez()) << errorDescription << path() << reply.error().name() << reply.error().message();
+        }
+        call->deleteLater();
+    });
+}
@@ -0,0 +1,55 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+*
+* Copyright 2013 - 2020, nymea GmbH
+* Contact: contact@nymea.io
+*
+* This file is part of nymea.
+* This project including source code and documentation is protected by
+* copyright law, and remains the property of nymea GmbH. All rights, including
+* reproduction, publication, editing and translation, are reserved. The use of
+* this project is subject to the terms of a license agreement to be concluded
+* with nymea GmbH in accordance with the terms of use of nymea GmbH, available
+* under https://nymea.io/license
+*
+* GNU Lesser General Public License Usage
+* Alternatively, this project may be redistributed and/or modified under the
+* terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; version 3. This project is distributed in the hope that
+* it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+* warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this project. If not, see <https://www.gnu.org/licenses/>.
+*
+* For any further details and any questions please contact us under
+* contact@nymea.io or see our FAQ/Licensing Information on
+* https://nymea.io/license/faq
+*
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef BLUEZINTERFACE_H
+#define BLUEZINTERFACE_H
+
+#include <QObject>
+#include <QDBusAbstractInterface>
+#include <QDBusPendingCallWatcher>
+
+// DBus interface to a bluez object which never blocks the event loop.
+// Unlike QDBusInterface it does not introspect the remote object on creation,
+// the interface description is known from the ObjectManager already.
+class BluezInterface : public QDBusAbstractInterface
+{
+    Q_OBJECT
+public:
+    explicit BluezInterface(const QString &path, const QString &interface, QObject *parent = nullptr);
+
+    // Sets a property using org.freedesktop.DBus.Properties.Set, the new value arrives with PropertiesChanged
+    QDBusPendingCall setPropertyAsync(const QString &propertyName, const QVariant &value);
+
+    // Calls a method and logs errors once the reply arrives
+    void callAsync(const QString &method, const QString &errorDescription);
+
+};
+
+#endif // BLUEZINTERFACE_H
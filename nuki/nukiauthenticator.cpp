@@ -59,6 +59,7 @@ NukiAuthenticator::NukiAuthenticator(const QBluetoothHostInfo &hostInfo, Bluetoo
     loadData();
     if (isValid()) {
         qCDebug(dcNuki()) << "Found valid authroization data for" << hostInfo.address().toString();
+        calculateSharedKey();
         setState(AuthenticationStateAuthenticated);
     } else {
         setState(AuthenticationStateUnauthenticated);
@@ -67,6 +68,11 @@ NukiAuthenticator::NukiAuthenticator(const QBluetoothHostInfo &hostInfo, Bluetoo
     connect(m_pairingCharacteristic, &BluetoothGattCharacteristic::valueChanged, this, &NukiAuthenticator::onPairingDataCharacteristicChanged);
 }
 
+NukiAuthenticator::~NukiAuthenticator()
+{
+    clearSharedKey();
+}
+
 NukiUtils::ErrorCode NukiAuthenticator::error() const
 {
     return m_error;
@@ -114,78 +120,81 @@ QByteArray NukiAuthenticator::authorizationIdRawData() const
 
 QByteArray NukiAuthenticator::encryptData(const QByteArray &data, const QByteArray &nonce)
 {
-    // Calculate shared key
-    qCDebug(dcNuki()) << "Authenticator: Encrypt data";
     Q_ASSERT_X(nonce.length() == crypto_box_NONCEBYTES, "data length", "The nonce does not have the correct length.");
 
+    if (m_sharedKey.isEmpty() && !calculateSharedKey()) {
+        qCWarning(dcNuki()) << "Could not encrypt data. There is no shared key available.";
+        return QByteArray();
+    }
+
     /* Note: https://download.libsodium.org/doc/public-key_cryptography/authenticated_encryption.html
      *      unsigned char *c         The encrypted message (length of the data + crypto_box_MACBYTES)
      *      const unsigned char *m   The message to encrypt
      *      unsigned long long mlen  The length of the message to encrypt
      *      const unsigned char *n   The nonce (must also sent unencrypted)
-     *      const unsigned char *pk  The public key of the Nuki
-     *      const unsigned char *sk  The private key of nymea for this Nuki
+     *      const unsigned char *k   The shared key calculated once from the public key of the Nuki and the private key of nymea
      */
 
-    unsigned char encrypted[crypto_box_MACBYTES + data.length()];
-    int result = crypto_box_easy(encrypted,
-                                 reinterpret_cast<const unsigned char *>(data.data()),
-                                 static_cast<unsigned long long>(data.length()),
-                                 reinterpret_cast<const unsigned char *>(nonce.data()),
-                                 reinterpret_cast<const unsigned char *>(m_publicKeyNuki.data()),
-                                 reinterpret_cast<const unsigned char *>(m_privateKey.data()));
+    QByteArray encryptedData(crypto_box_MACBYTES + data.length(), '\0');
+    int result = crypto_box_easy_afternm(reinterpret_cast<unsigned char *>(encryptedData.data()),
+                                         reinterpret_cast<const unsigned char *>(data.constData()),
+                                         static_cast<unsigned long long>(data.length()),
+                                         reinterpret_cast<const unsigned char *>(nonce.constData()),
+                                         reinterpret_cast<const unsigned char *>(m_sharedKey.constData()));
 
     if (result < 0) {
         qCWarning(dcNuki()) << "Could not encrypt data. Something went wrong";
         return QByteArray();
     }
 
-    QByteArray encryptedData = QByteArray(reinterpret_cast<const char*>(encrypted), crypto_box_MACBYTES + data.length());
-
-    if (m_debug) qCDebug(dcNuki()) << "    Private key     :" << NukiUtils::convertByteArrayToHexStringCompact(m_privateKey);
-    if (m_debug) qCDebug(dcNuki()) << "    Public key      :" << NukiUtils::convertByteArrayToHexStringCompact(m_publicKey);
-    if (m_debug) qCDebug(dcNuki()) << "    Nuki public key :" << NukiUtils::convertByteArrayToHexStringCompact(m_publicKeyNuki);
-    if (m_debug) qCDebug(dcNuki()) << "    Unencrypted data:" << NukiUtils::convertByteArrayToHexStringCompact(data);
-    if (m_debug) qCDebug(dcNuki()) << "    Encrypted data  :" << NukiUtils::convertByteArrayToHexStringCompact(encryptedData);
+    if (m_debug) {
+        qCDebug(dcNuki()) << "Authenticator: Encrypt data";
+        qCDebug(dcNuki()) << "    Unencrypted data:" << NukiUtils::convertByteArrayToHexStringCompact(data);
+        qCDebug(dcNuki()) << "    Encrypted data  :" << NukiUtils::convertByteArrayToHexStringCompact(encryptedData);
+    }
 
     return encryptedData;
 }
 
 QByteArray NukiAuthenticator::decryptData(const QByteArray &data, const QByteArray &nonce)
 {
-    qCDebug(dcNuki()) << "Authenticator: Decrypt data";
     Q_ASSERT_X(nonce.length() == crypto_box_NONCEBYTES, "data length", "The nonce does not have the correct length.");
-    Q_ASSERT_X(static_cast<uint>(data.length()) >= crypto_box_MACBYTES, "data length", "The encrypted data is to short.");
+
+    if (static_cast<uint>(data.length()) < crypto_box_MACBYTES) {
+        qCWarning(dcNuki()) << "Could not decrypt data. The encrypted data is to short.";
+        return QByteArray();
+    }
+
+    if (m_sharedKey.isEmpty() && !calculateSharedKey()) {
+        qCWarning(dcNuki()) << "Could not decrypt data. There is no shared key available.";
+        return QByteArray();
+    }
 
     /* Note: https://download.libsodium.org/doc/public-key_cryptography/authenticated_encryption.html
      *      unsigned char *m         The decrypted message result
      *      const unsigned char *c   The message to decrypt / cyphertext (length of the encrypted data + crypto_box_MACBYTES)
      *      unsigned long long clen  The length of the message to decrypt
      *      const unsigned char *n   The nonce used while encryption (received in the unencrypted ADATA)
-     *      const unsigned char *pk  The public key of the Nuki
-     *      const unsigned char *sk  The private key of nymea for this Nuki
+     *      const unsigned char *k   The shared key calculated once from the public key of the Nuki and the private key of nymea
      */
 
-    unsigned char decrypted[data.length() - crypto_box_MACBYTES];
-    int result = crypto_box_open_easy(decrypted,
-                                      reinterpret_cast<const unsigned char *>(data.data()),
-                                      static_cast<unsigned long long>(data.length()),
-                                      reinterpret_cast<const unsigned char *>(nonce.data()),
-                                      reinterpret_cast<const unsigned char *>(m_publicKeyNuki.data()),
-                                      reinterpret_cast<const unsigned char *>(m_privateKey.data()));
+    QByteArray decryptedData(data.length() - static_cast<int>(crypto_box_MACBYTES), '\0');
+    int result = crypto_box_open_easy_afternm(reinterpret_cast<unsigned char *>(decryptedData.data()),
+                                              reinterpret_cast<const unsigned char *>(data.constData()),
+                                              static_cast<unsigned long long>(data.length()),
+                                              reinterpret_cast<const unsigned char *>(nonce.constData()),
+                                              reinterpret_cast<const unsigned char *>(m_sharedKey.constData()));
 
     if (result < 0) {
         qCWarning(dcNuki()) << "Could not decrypt data. Something went wrong";
         return QByteArray();
     }
 
-    QByteArray decryptedData = QByteArray(reinterpret_cast<const char*>(decrypted), data.length() - crypto_box_MACBYTES);
-
-    if (m_debug) qCDebug(dcNuki()) << "    Private key     :" << NukiUtils::convertByteArrayToHexStringCompact(m_privateKey);
-    if (m_debug) qCDebug(dcNuki()) << "    Public key      :" << NukiUtils::convertByteArrayToHexStringCompact(m_publicKey);
-    if (m_debug) qCDebug(dcNuki()) << "    Nuki public key :" << NukiUtils::convertByteArrayToHexStringCompact(m_publicKeyNuki);
-    if (m_debug) qCDebug(dcNuki()) << "    Encrypted data  :" << NukiUtils::convertByteArrayToHexStringCompact(data);
-    if (m_debug) qCDebug(dcNuki()) << "    Decrypted data  :" << NukiUtils::convertByteArrayToHexStringCompact(decryptedData);
+    if (m_debug) {
+        qCDebug(dcNuki()) << "Authenticator: Decrypt data";
+        qCDebug(dcNuki()) << "    Encrypted data  :" << NukiUtils::convertByteArrayToHexStringCompact(data);
+        qCDebug(dcNuki()) << "    Decrypted data  :" << NukiUtils::convertByteArrayToHexStringCompact(decryptedData);
+    }
 
     return decryptedData;
 }
@@ -258,18 +267,44 @@ void NukiAuthenticator::setState(NukiAuthenticator::AuthenticationState state)
     }
 }
 
-bool NukiAuthenticator::createAuthenticator(const QByteArray content)
+bool NukiAuthenticator::calculateSharedKey()
 {
-    // Create shared key
+    // The shared key depends only on the key pair and the Nuki public key, so the expensive
+    // X25519 calculation is done once and reused for every encrypted message of this Nuki.
+    clearSharedKey();
+    if (m_privateKey.length() != crypto_box_SECRETKEYBYTES || m_publicKeyNuki.length() != crypto_box_PUBLICKEYBYTES)
+        return false;
+
     qCDebug(dcNuki()) << "Authenticator: Calculate shared key";
-    unsigned char sharedKey[crypto_box_BEFORENMBYTES];
-    int result = crypto_box_beforenm(sharedKey, reinterpret_cast<const unsigned char *>(m_publicKeyNuki.data()), reinterpret_cast<const unsigned char *>(m_privateKey.data()));
+    QByteArray sharedKey(crypto_box_BEFORENMBYTES, '\0');
+    int result = crypto_box_beforenm(reinterpret_cast<unsigned char *>(sharedKey.data()),
+                                     reinterpret_cast<const unsigned char *>(m_publicKeyNuki.constData()),
+                                     reinterpret_cast<const unsigned char *>(m_privateKey.constData()));
     if (result < 0) {
+        qCWarning(dcNuki()) << "Could not create shared key.";
+        return false;
+    }
+
+    m_sharedKey = sharedKey;
+    return true;
+}
+
+void NukiAuthenticator::clearSharedKey()
+{
+    if (!m_sharedKey.isEmpty())
+        sodium_memzero(m_sharedKey.data(), static_cast<size_t>(m_sharedKey.length()));
+
+    m_sharedKey.clear();
+}
+
+bool NukiAuthenticator::createAuthenticator(const QByteArray content)
+{
+    // Create shared key
+    if (!calculateSharedKey()) {
         qCWarning(dcNuki()) << "Could not create shared key for autorization authenticator.";
         return false;
     }
 
-    m_sharedKey = QByteArray(reinterpret_cast<const char*>(sharedKey), crypto_box_BEFORENMBYTES);
     Q_ASSERT_X(m_sharedKey.length() == 32, "data length", "The shared key does not have the correct length.");
 
     if (m_debug) qCDebug(dcNuki()) << "Authenticator: Calculate authenticator hash HMAC-SHA-256";
@@ -279,7 +314,7 @@ bool NukiAuthenticator::createAuthenticator(const QByteArray content)
     // Calculate authenticator hash input for HMAC-SHA-256
     qCDebug(dcNuki()) << "Authenticator: Calculate authenticator data";
     unsigned char authenticator[crypto_auth_hmacsha256_BYTES];
-    result = crypto_auth_hmacsha256(authenticator, reinterpret_cast<const unsigned char *>(content.data()), content.length(), reinterpret_cast<const unsigned char *>(m_sharedKey.data()));
+    int result = crypto_auth_hmacsha256(authenticator, reinterpret_cast<const unsigned char *>(content.data()), content.length(), reinterpret_cast<const unsigned char *>(m_sharedKey.data()));
     if (result < 0) {
         qCWarning(dcNuki()) << "Could not create authenticator hash for autorization authenticator.";
         return false;
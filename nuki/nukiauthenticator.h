@@ -60,6 +60,7 @@ public:
     Q_ENUM(AuthenticationState)
 
     explicit NukiAuthenticator(const QBluetoothHostInfo &hostInfo, BluetoothGattCharacteristic *pairingCharacteristic, QObject *parent = nullptr);
+    ~NukiAuthenticator();
 
     NukiUtils::ErrorCode error() const;
     AuthenticationState state() const;
@@ -112,6 +113,8 @@ private:
     void setState(AuthenticationState state);
 
     // Helper methods
+    bool calculateSharedKey();
+    void clearSharedKey();
     bool createAuthenticator(const QByteArray content);
 
     // State action methods
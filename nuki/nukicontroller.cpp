@@ -283,6 +283,10 @@ void NukiController::processNukiErrorReport(const QByteArray &data)
 void NukiController::processUserDataNotification(const QByteArray nonce, quint32 authorizationIdentifier, const QByteArray &privateData)
 {
     QByteArray decryptedMessage = m_nukiAuthenticator->decryptData(privateData, nonce);
+    if (decryptedMessage.isEmpty()) {
+        qCWarning(dcNuki()) << "Controller: Could not decrypt user notification data. Rejecting data.";
+        return;
+    }
 
     // Process decrypted data
     if (!NukiUtils::validateMessageCrc(decryptedMessage)) {
@@ -445,30 +449,8 @@ void NukiController::sendReadLockStateRequest()
     stream.setByteOrder(QDataStream::LittleEndian);
     stream << static_cast<quint16>(NukiUtils::CommandNukiStates);
 
-    // Create unencrypted PDATA
-    QByteArray unencryptedMessage = NukiUtils::createRequestMessageForUnencryptedForEncryption(m_nukiAuthenticator->authorizationId(), NukiUtils::CommandRequestData, payload);
-
-    // Encrypt PDATA
-    QByteArray nonce = m_nukiAuthenticator->generateNonce(crypto_box_NONCEBYTES);
-    QByteArray encryptedMessage = m_nukiAuthenticator->encryptData(unencryptedMessage, nonce);
-
-    // Create ADATA
-    QByteArray header;
-    header.append(nonce);
-    header.append(m_nukiAuthenticator->authorizationIdRawData());
-    header.append(NukiUtils::converUint16ToByteArrayLittleEndian(static_cast<quint16>(encryptedMessage.length())));
-
-    // Message ADATA + PDATA
-    QByteArray message;
-    message.append(header);
-    message.append(encryptedMessage);
-
-    // Send data
     qCDebug(dcNuki()) << "Controller: Sending read lock states request";
-    if (m_debug) qCDebug(dcNuki()) << "    Nonce          :" << NukiUtils::convertByteArrayToHexStringCompact(nonce);
-    if (m_debug) qCDebug(dcNuki()) << "    Header         :" << NukiUtils::convertByteArrayToHexStringCompact(header);
-    if (m_debug) qCDebug(dcNuki()) << "Controller: -->" << NukiUtils::convertByteArrayToHexStringCompact(message);
-    m_userDataCharacteristic->writeCharacteristic(message);
+    sendEncryptedMessage(NukiUtils::CommandRequestData, payload);
 }
 
 void NukiController::sendReadConfigurationRequest()
@@ -484,30 +466,8 @@ void NukiController::sendReadConfigurationRequest()
         stream << static_cast<quint8>(m_nukiNonce.at(i));
     }
 
-    // Create unencrypted PDATA
-    QByteArray unencryptedMessage = NukiUtils::createRequestMessageForUnencryptedForEncryption(m_nukiAuthenticator->authorizationId(), NukiUtils::CommandRequestData, payload);
-
-    // Encrypt PDATA
-    QByteArray nonce = m_nukiAuthenticator->generateNonce(crypto_box_NONCEBYTES);
-    QByteArray encryptedMessage = m_nukiAuthenticator->encryptData(unencryptedMessage, nonce);
-
-    // Create ADATA
-    QByteArray header;
-    header.append(nonce);
-    header.append(m_nukiAuthenticator->authorizationIdRawData());
-    header.append(NukiUtils::converUint16ToByteArrayLittleEndian(static_cast<quint16>(encryptedMessage.length())));
-
-    // Message ADATA + PDATA
-    QByteArray message;
-    message.append(header);
-    message.append(encryptedMessage);
-
-    // Send data
     qCDebug(dcNuki()) << "Controller: Sending get config request";
-    if (m_debug) qCDebug(dcNuki()) << "    Nonce          :" << NukiUtils::convertByteArrayToHexStringCompact(nonce);
-    if (m_debug) qCDebug(dcNuki()) << "    Header         :" << NukiUtils::convertByteArrayToHexStringCompact(header);
-    if (m_debug) qCDebug(dcNuki()) << "Controller: -->" << NukiUtils::convertByteArrayToHexStringCompact(message);
-    m_userDataCharacteristic->writeCharacteristic(message);
+    sendEncryptedMessage(NukiUtils::CommandRequestData, payload);
 }
 
 void NukiController::sendRequestChallengeRequest()
@@ -520,38 +480,14 @@ void NukiController::sendRequestChallengeRequest()
     stream.setByteOrder(QDataStream::LittleEndian);
     stream << static_cast<quint16>(NukiUtils::CommandChallenge);
 
-    // Create unencrypted PDATA
-    QByteArray unencryptedMessage = NukiUtils::createRequestMessageForUnencryptedForEncryption(m_nukiAuthenticator->authorizationId(), NukiUtils::CommandRequestData, payload);
-
-    // Encrypt PDATA
-    QByteArray nonce = m_nukiAuthenticator->generateNonce(crypto_box_NONCEBYTES);
-    QByteArray encryptedMessage = m_nukiAuthenticator->encryptData(unencryptedMessage, nonce);
-
-    // Create ADATA
-    QByteArray header;
-    header.append(nonce);
-    header.append(m_nukiAuthenticator->authorizationIdRawData());
-    header.append(NukiUtils::converUint16ToByteArrayLittleEndian(static_cast<quint16>(encryptedMessage.length())));
-
-    // Message ADATA + PDATA
-    QByteArray message;
-    message.append(header);
-    message.append(encryptedMessage);
-
-    // Send data
     qCDebug(dcNuki()) << "Controller: Sending challange request";
-    if (m_debug) qCDebug(dcNuki()) << "    Nonce          :" << NukiUtils::convertByteArrayToHexStringCompact(nonce);
-    if (m_debug) qCDebug(dcNuki()) << "    Header         :" << NukiUtils::convertByteArrayToHexStringCompact(header);
-    if (m_debug) qCDebug(dcNuki()) << "Controller: -->" << NukiUtils::convertByteArrayToHexStringCompact(message);
-    m_userDataCharacteristic->writeCharacteristic(message);
+    sendEncryptedMessage(NukiUtils::CommandRequestData, payload);
 }
 
 void NukiController::sendLockActionRequest(NukiUtils::LockAction lockAction, quint8 flag)
 {
     qCDebug(dcNuki()) << "Controller: Send lock request" << lockAction;
 
-    QByteArray nonce = m_nukiAuthenticator->generateNonce(crypto_box_NONCEBYTES);
-
     // Create data for encryption
     QByteArray payload;
     QDataStream stream(&payload, QIODevice::WriteOnly);
@@ -564,29 +500,34 @@ void NukiController::sendLockActionRequest(NukiUtils::LockAction lockAction, qui
         stream << static_cast<quint8>(m_nukiNonce.at(i));
     }
 
+    qCDebug(dcNuki()) << "Controller: Sending lock request";
+    sendEncryptedMessage(NukiUtils::CommandLockAction, payload);
+}
+
+void NukiController::sendEncryptedMessage(NukiUtils::Command command, const QByteArray &payload)
+{
     // Create unencrypted PDATA
-    QByteArray unencryptedMessage = NukiUtils::createRequestMessageForUnencryptedForEncryption(m_nukiAuthenticator->authorizationId(), NukiUtils::CommandLockAction, payload);
+    QByteArray unencryptedMessage = NukiUtils::createRequestMessageForUnencryptedForEncryption(m_nukiAuthenticator->authorizationId(), command, payload);
 
-    // Encrypt PDATA
+    // Encrypt PDATA using the precalculated shared key of the authenticator
+    QByteArray nonce = m_nukiAuthenticator->generateNonce(crypto_box_NONCEBYTES);
     QByteArray encryptedMessage = m_nukiAuthenticator->encryptData(unencryptedMessage, nonce);
+    if (encryptedMessage.isEmpty()) {
+        qCWarning(dcNuki()) << "Controller: Could not encrypt" << command << "message.";
+        return;
+    }
 
-    // Create ADATA
-    QByteArray header;
-    header.append(nonce);
-    header.append(m_nukiAuthenticator->authorizationIdRawData());
-    header.append(NukiUtils::converUint16ToByteArrayLittleEndian(static_cast<quint16>(encryptedMessage.length())));
-
-    // Message ADATA + PDATA
+    // Message ADATA (nonce, authorization id, PDATA length) + PDATA
     QByteArray message;
-    message.append(header);
+    message.reserve(nonce.length() + 6 + encryptedMessage.length());
+    message.append(nonce);
+    message.append(m_nukiAuthenticator->authorizationIdRawData());
+    message.append(NukiUtils::converUint16ToByteArrayLittleEndian(static_cast<quint16>(encryptedMessage.length())));
     message.append(encryptedMessage);
 
     // Send data
-    qCDebug(dcNuki()) << "Controller: Sending lock request";
     if (m_debug) qCDebug(dcNuki()) << "    Nonce          :" << NukiUtils::convertByteArrayToHexStringCompact(nonce);
-    if (m_debug) qCDebug(dcNuki()) << "    Header         :" << NukiUtils::convertByteArrayToHexStringCompact(header);
     if (m_debug) qCDebug(dcNuki()) << "Controller: -->" << NukiUtils::convertByteArrayToHexStringCompact(message);
-
     m_userDataCharacteristic->writeCharacteristic(message);
 }
 
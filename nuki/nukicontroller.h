@@ -134,6 +134,7 @@ private:
     void sendReadConfigurationRequest();
     void sendRequestChallengeRequest();
     void sendLockActionRequest(NukiUtils::LockAction lockAction, quint8 flag = 0);
+    void sendEncryptedMessage(NukiUtils::Command command, const QByteArray &payload);
 
 signals:
     void stateChanged(NukiControllerState state);
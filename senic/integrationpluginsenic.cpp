@@ -40,6 +40,8 @@ IntegrationPluginSenic::IntegrationPluginSenic()
 
 void IntegrationPluginSenic::init()
 {
+    m_connectionArbiter = new BluetoothConnectionArbiter(this);
+
     // Initialize plugin configurations
     m_autoSymbolMode = configValue(senicPluginAutoSymbolsParamTypeId).toBool();
     connect(this, &IntegrationPluginSenic::configValueChanged, this, &IntegrationPluginSenic::onPluginConfigurationChanged);
@@ -97,6 +99,8 @@ void IntegrationPluginSenic::setupThing(ThingSetupInfo *info)
 
     BluetoothLowEnergyDevice *bluetoothDevice = hardwareManager()->bluetoothLowEnergyManager()->registerDevice(deviceInfo, QLowEnergyController::RandomAddress);
 
+    m_connectionArbiter->registerDevice(bluetoothDevice, true);
+
     Nuimo *nuimo = new Nuimo(bluetoothDevice, this);
     nuimo->setLongPressTime(configValue(senicPluginLongPressTimeParamTypeId).toInt());
     connect(nuimo, &Nuimo::buttonPressed, this, &IntegrationPluginSenic::onButtonPressed);
@@ -118,6 +122,7 @@ void IntegrationPluginSenic::setupThing(ThingSetupInfo *info)
             } else {
                 m_nuimos.take(nuimo);
 
+                m_connectionArbiter->unregisterDevice(nuimo->bluetoothDevice());
                 hardwareManager()->bluetoothLowEnergyManager()->unregisterDevice(nuimo->bluetoothDevice());
                 nuimo->deleteLater();
 
@@ -128,7 +133,7 @@ void IntegrationPluginSenic::setupThing(ThingSetupInfo *info)
     });
 
 
-    nuimo->bluetoothDevice()->connectDevice();
+    m_connectionArbiter->requestConnection(nuimo->bluetoothDevice(), BluetoothConnectionArbiter::PriorityUserAction);
 }
 
 void IntegrationPluginSenic::postSetupThing(Thing *thing)
@@ -197,6 +202,7 @@ void IntegrationPluginSenic::thingRemoved(Thing *thing)
     Nuimo *nuimo = m_nuimos.key(thing);
     m_nuimos.take(nuimo);
 
+    m_connectionArbiter->unregisterDevice(nuimo->bluetoothDevice());
     hardwareManager()->bluetoothLowEnergyManager()->unregisterDevice(nuimo->bluetoothDevice());
     nuimo->deleteLater();
 
@@ -211,7 +217,7 @@ void IntegrationPluginSenic::onReconnectTimeout()
 {
     foreach (Nuimo *nuimo, m_nuimos.keys()) {
         if (!nuimo->bluetoothDevice()->connected()) {
-            nuimo->bluetoothDevice()->connectDevice();
+            m_connectionArbiter->requestConnection(nuimo->bluetoothDevice(), BluetoothConnectionArbiter::PriorityPoll);
         }
     }
 }
@@ -34,6 +34,7 @@
 #include "plugintimer.h"
 #include "integrations/integrationplugin.h"
 #include "hardware/bluetoothlowenergy/bluetoothlowenergydevice.h"
+#include "bluetoothconnectionarbiter.h"
 
 #include "nuimo.h"
 
@@ -58,6 +59,7 @@ public:
 private:
     QHash<Nuimo *, Thing *> m_nuimos;
     PluginTimer *m_reconnectTimer = nullptr;
+    BluetoothConnectionArbiter *m_connectionArbiter = nullptr;
     bool m_autoSymbolMode = true;
 
 private slots:
@@ -33,6 +33,8 @@
 #include "network/networkaccessmanager.h"
 #include "plugininfo.h"
 #include "types/mediabrowseritem.h"
+#include "network/upnp/upnpdiscovery.h"
+#include "network/upnp/upnpdiscoveryreply.h"
 
 
 #include <QNetworkRequest>
@@ -195,6 +197,10 @@ void IntegrationPluginSonos::postSetupThing(Thing *thing)
                     if (groupDevice->thingClassId() == sonosGroupThingClassId) {
                         //get playback status of each group
                         QString groupId = groupDevice->paramValue(sonosGroupThingGroupIdParamTypeId).toString();
+                        // Groups with a subscribed local coordinator get their states pushed
+                        if (sonos->localEventsActive(groupId))
+                            continue;
+
                         sonos->getGroupPlaybackStatus(groupId);
                         sonos->getGroupMetadataStatus(groupId);
                         sonos->getGroupVolume(groupId);
@@ -215,13 +221,18 @@ void IntegrationPluginSonos::postSetupThing(Thing *thing)
                 }
                 //get groups for each household in order to add or remove groups
                 sonos->getHouseholds();
+
+                Sonos::RequestStatistics statistics = sonos->requestStatistics();
+                qCDebug(dcSonos()) << "Cloud requests of" << thing->name() << "queued:" << statistics.queued << "dropped:" << statistics.dropped << "sent:" << statistics.sent;
             }
+            discoverLocalPlayers();
         });
     }
 
     if (thing->thingClassId() == sonosConnectionThingClassId) {
         Sonos *sonos = m_sonosConnections.value(thing);
         sonos->getHouseholds();
+        discoverLocalPlayers();
     }
 
     if (thing->thingClassId() == sonosGroupThingClassId) {
@@ -430,6 +441,35 @@ void IntegrationPluginSonos::executeBrowserItem(BrowserActionInfo *info)
     }
 }
 
+void IntegrationPluginSonos::discoverLocalPlayers()
+{
+    if (!hardwareManager()->upnpDiscovery()->available()) {
+        qCDebug(dcSonos()) << "UPnP discovery not available, using the cloud API only";
+        return;
+    }
+
+    UpnpDiscoveryReply *reply = hardwareManager()->upnpDiscovery()->discoverDevices("urn:schemas-upnp-org:device:ZonePlayer:1");
+    connect(reply, &UpnpDiscoveryReply::finished, reply, &UpnpDiscoveryReply::deleteLater);
+    connect(reply, &UpnpDiscoveryReply::finished, this, [this, reply] {
+        if (reply->error() != UpnpDiscoveryReply::UpnpDiscoveryReplyErrorNoError) {
+            qCWarning(dcSonos()) << "UPnP discovery error" << reply->error();
+            return;
+        }
+
+        foreach (const UpnpDeviceDescriptor &upnpDevice, reply->deviceDescriptors()) {
+            // The UPnP UUID of a player is its cloud player id, e.g. uuid:RINCON_000E58A0123401400
+            QString playerId = upnpDevice.uuid();
+            playerId.remove("uuid:");
+            if (!playerId.startsWith("RINCON_"))
+                continue;
+
+            foreach (Sonos *sonos, m_sonosConnections) {
+                sonos->setLocalPlayerAddress(playerId, upnpDevice.hostAddress());
+            }
+        }
+    });
+}
+
 void IntegrationPluginSonos::onConnectionChanged(bool connected)
 {
     Sonos *sonos = static_cast<Sonos *>(sender());
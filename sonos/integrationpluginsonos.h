@@ -79,6 +79,8 @@ private:
 
     const QString m_browseFavoritesPrefix = "/favorites";
 
+    void discoverLocalPlayers();
+
 private slots:
     void onConnectionChanged(bool connected);
     void onAuthenticationStatusChanged(bool authenticated);
@@ -29,12 +29,15 @@
 * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
 
 #include "sonos.h"
+#include "upnpeventserver.h"
+#include "sonosupnpplayer.h"
 #include "extern-plugininfo.h"
 
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QJsonArray>
 #include <QUrlQuery>
+#include <QDateTime>
 
 Sonos::Sonos(NetworkAccessManager *networkmanager,  const QByteArray &clientKey,  const QByteArray &clientSecret, QObject *parent) :
     QObject(parent),
@@ -47,6 +50,10 @@ Sonos::Sonos(NetworkAccessManager *networkmanager,  const QByteArray &clientKey,
         m_tokenRefreshTimer->setSingleShot(true);
         connect(m_tokenRefreshTimer, &QTimer::timeout, this, &Sonos::onRefreshTimeout);
     }
+
+    m_requestQueueTimer = new QTimer(this);
+    m_requestQueueTimer->setInterval(m_householdRequestInterval);
+    connect(m_requestQueueTimer, &QTimer::timeout, this, &Sonos::processRequestQueues);
 }
 
 QUrl Sonos::getLoginUrl(const QUrl &redirectUrl)
@@ -90,9 +97,8 @@ void Sonos::getHouseholds()
     request.setRawHeader("Authorization", "Bearer " + m_accessToken);
     request.setRawHeader("X-Sonos-Api-Key", m_clientKey);
     request.setUrl(QUrl(m_baseControlUrl + "/households"));
-    QNetworkReply *reply = m_networkManager->get(request);
     qDebug(dcSonos()) << "Sending request" << request.url() << request.rawHeaderList() << request.rawHeader("Authorization");
-    connect(reply, &QNetworkReply::finished, this, [reply, this] {
+    queueRequest(QString(), request, "GET", QByteArray(), [this](QNetworkReply *reply) {
         reply->deleteLater();
         int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
 
@@ -142,8 +148,7 @@ QUuid Sonos::loadFavorite(const QString &groupId, const QString &favouriteId)
     QJsonDocument doc(object);
     qDebug(dcSonos()) << "Sending request" << doc.toJson();
 
-    QNetworkReply *reply = m_networkManager->post(request, doc.toJson(QJsonDocument::Compact));
-    connect(reply, &QNetworkReply::finished, this, [reply, actionId, this] {
+    queueRequest(m_households.value(groupId), request, "POST", doc.toJson(QJsonDocument::Compact), [actionId, this](QNetworkReply *reply) {
         reply->deleteLater();
         int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
 
@@ -175,8 +180,7 @@ QUuid Sonos::getFavorites(const QString &householdId)
     request.setUrl(QUrl(m_baseControlUrl + "/households/" + householdId + "/favorites"));
     QUuid requestId = QUuid::createUuid();
 
-    QNetworkReply *reply = m_networkManager->get(request);
-    connect(reply, &QNetworkReply::finished, this, [reply, requestId, householdId, this] {
+    queueRequest(householdId, request, "GET", QByteArray(), [requestId, householdId, this](QNetworkReply *reply) {
         reply->deleteLater();
         int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
 
@@ -230,8 +234,7 @@ void Sonos::getGroups(const QString &householdId)
     request.setRawHeader("Authorization", "Bearer " + m_accessToken);
     request.setRawHeader("X-Sonos-Api-Key", m_clientKey);
     request.setUrl(QUrl(m_baseControlUrl + "/households/" + householdId + "/groups"));
-    QNetworkReply *reply = m_networkManager->get(request);
-    connect(reply, &QNetworkReply::finished, this, [reply, householdId, this] {
+    queueRequest(householdId, request, "GET", QByteArray(), [householdId, this](QNetworkReply *reply) {
         reply->deleteLater();
         int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
 
@@ -274,233 +277,110 @@ void Sonos::getGroups(const QString &householdId)
             }
             groupObjects.append(group);
         }
+
+        foreach (const QString &groupId, m_householdGroups.take(householdId)) {
+            m_groupCoordinators.remove(groupId);
+        }
+        foreach (const GroupObject &group, groupObjects) {
+            m_householdGroups[householdId].append(group.groupId);
+            m_groupCoordinators.insert(group.groupId, group.CoordinatorId);
+            m_households.insert(group.groupId, householdId);
+            foreach (const QString &playerId, group.playerIds) {
+                m_households.insert(playerId, householdId);
+            }
+        }
+        updateLocalGroups();
+
         emit groupsReceived(householdId, groupObjects);
     });
 }
 
 void Sonos::getGroupVolume(const QString &groupId)
 {
-    QNetworkRequest request;
-    request.setHeader(QNetworkRequest::KnownHeaders::ContentTypeHeader, "application/json");
-    request.setRawHeader("Authorization", "Bearer " + m_accessToken);
-    request.setRawHeader("X-Sonos-Api-Key", m_clientKey);
-    request.setUrl(QUrl(m_baseControlUrl + "/groups/" + groupId + "/groupVolume"));
-    QNetworkReply *reply = m_networkManager->get(request);
-    connect(reply, &QNetworkReply::finished, this, [reply, groupId, this] {
-        reply->deleteLater();
-        int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
-
-        // Check HTTP status code
-        if (status != 200 || reply->error() != QNetworkReply::NoError) {
-            if (reply->error() == QNetworkReply::HostNotFoundError) {
-                emit connectionChanged(false);
-            }
-            if (status == 400 || status == 401) {
-                emit authenticationStatusChanged(false);
-            }
-            qCWarning(dcSonos()) << "Request error:" << status << reply->errorString();
-            return;
-        }
-        emit connectionChanged(true);
-        emit authenticationStatusChanged(true);
+    enqueueRequest(QueuedRequestGetGroupVolume, groupId);
+}
 
-        //qDebug(dcSonos()) << "Received response from Sonos" << reply->readAll();
-        QJsonParseError error;
-        QJsonDocument data = QJsonDocument::fromJson(reply->readAll(), &error);
-        if (error.error != QJsonParseError::NoError) {
-            qCWarning(dcSonos()) << "JSON Parse error" << error.errorString();
-            return;
-        }
+void Sonos::processGroupVolume(const QString &groupId, const QByteArray &payload)
+{
+    QJsonParseError error;
+    QJsonDocument data = QJsonDocument::fromJson(payload, &error);
+    if (error.error != QJsonParseError::NoError) {
+        qCWarning(dcSonos()) << "JSON Parse error" << error.errorString();
+        return;
+    }
 
-        VolumeObject volume;
+    VolumeObject volume;
 
-        QVariantMap variant = data.toVariant().toMap();
-        volume.volume = variant["volume"].toInt();
-        volume.muted  = variant["muted"].toBool();
-        volume.fixed  = variant["fixed"].toBool();
+    QVariantMap variant = data.toVariant().toMap();
+    volume.volume = variant["volume"].toInt();
+    volume.muted  = variant["muted"].toBool();
+    volume.fixed  = variant["fixed"].toBool();
 
-        emit volumeReceived(groupId, volume);
-    });
+    emit volumeReceived(groupId, volume);
 }
 
 QUuid Sonos::setGroupVolume(const QString &groupId, int volume)
 {
-    QNetworkRequest request;
-    request.setHeader(QNetworkRequest::KnownHeaders::ContentTypeHeader, "application/json");
-    request.setRawHeader("Authorization", "Bearer " + m_accessToken);
-    request.setRawHeader("X-Sonos-Api-Key", m_clientKey);
-    request.setUrl(QUrl(m_baseControlUrl + "/groups/" + groupId + "/groupVolume"));
-    QUuid actionId = QUuid::createUuid();
-
-    QJsonObject object;
-    object.insert("volume", volume);
-    QJsonDocument doc(object);
-    qDebug(dcSonos()) << "Set volume:" << groupId << doc.toJson(QJsonDocument::Compact);
-
-    QNetworkReply *reply = m_networkManager->post(request, doc.toJson(QJsonDocument::Compact));
-    connect(reply, &QNetworkReply::finished, this, [reply, actionId, groupId, this] {
-        reply->deleteLater();
-        int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    SonosUpnpPlayer *localPlayer = localCoordinator(groupId);
+    if (localPlayer)
+        return localPlayer->setGroupVolume(volume);
 
-        // Check HTTP status code
-        if (status != 200 || reply->error() != QNetworkReply::NoError) {
-            if (reply->error() == QNetworkReply::HostNotFoundError) {
-                emit connectionChanged(false);
-            }
-            if (status == 400 || status == 401) {
-                emit authenticationStatusChanged(false);
-            }
-            emit actionExecuted(actionId, false);
-            qCWarning(dcSonos()) << "Request error:" << status << reply->errorString();
-            return;
-        }
-        emit connectionChanged(true);
-        emit authenticationStatusChanged(true);
-        emit actionExecuted(actionId, true);
-        getGroupVolume(groupId);
-    });
-    return actionId;
+    return enqueueRequest(QueuedRequestSetGroupVolume, groupId, volume);
 }
 
 QUuid Sonos::setGroupMute(const QString &groupId, bool mute)
 {
-    QNetworkRequest request;
-    request.setHeader(QNetworkRequest::KnownHeaders::ContentTypeHeader, "application/json");
-    request.setRawHeader("Authorization", "Bearer " + m_accessToken);
-    request.setRawHeader("X-Sonos-Api-Key", m_clientKey);
-    request.setUrl(QUrl(m_baseControlUrl + "/groups/" + groupId + "/groupVolume/mute"));
-    QUuid actionId = QUuid::createUuid();
+    SonosUpnpPlayer *localPlayer = localCoordinator(groupId);
+    if (localPlayer)
+        return localPlayer->setGroupMute(mute);
 
-    QJsonObject object;
-    object.insert("muted", mute);
-    QJsonDocument doc(object);
-
-    qDebug(dcSonos()) << "Set mute:" << groupId << doc.toJson(QJsonDocument::Compact);
-
-    QNetworkReply *reply = m_networkManager->post(request, doc.toJson(QJsonDocument::Compact));
-    connect(reply, &QNetworkReply::finished, this, [reply, actionId, groupId, this] {
-        reply->deleteLater();
-        int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
-
-        // Check HTTP status code
-        if (status != 200 || reply->error() != QNetworkReply::NoError) {
-            if (reply->error() == QNetworkReply::HostNotFoundError) {
-                emit connectionChanged(false);
-            }
-            if (status == 400 || status == 401) {
-                emit authenticationStatusChanged(false);
-            }
-            emit actionExecuted(actionId, false);
-            qCWarning(dcSonos()) << "Request error:" << status << reply->errorString();
-            return;
-        }
-        emit connectionChanged(true);
-        emit authenticationStatusChanged(true);
-        emit actionExecuted(actionId, true);
-        getGroupVolume(groupId);
-    });
-    return actionId;
+    return enqueueRequest(QueuedRequestSetGroupMute, groupId, mute);
 }
 
 QUuid Sonos::setGroupRelativeVolume(const QString &groupId, int volumeDelta)
 {
-    QNetworkRequest request;
-    request.setHeader(QNetworkRequest::KnownHeaders::ContentTypeHeader, "application/json");
-    request.setRawHeader("Authorization", "Bearer " + m_accessToken);
-    request.setRawHeader("X-Sonos-Api-Key", m_clientKey);
-    request.setUrl(QUrl(m_baseControlUrl + "/groups/" + groupId + "/groupVolume/relative"));
-    QUuid actionId = QUuid::createUuid();
-
-    QJsonObject object;
-    object.insert("volumeDelta", QJsonValue::fromVariant(volumeDelta));
-    QJsonDocument doc(object);
-
-    qDebug(dcSonos()) << "Relative volume:" << groupId << volumeDelta;
-
-    QNetworkReply *reply = m_networkManager->post(request, doc.toJson(QJsonDocument::Compact));
-    connect(reply, &QNetworkReply::finished, this, [reply, actionId, groupId, this] {
-        reply->deleteLater();
-        int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
-
-        // Check HTTP status code
-        if (status != 200 || reply->error() != QNetworkReply::NoError) {
-            if (reply->error() == QNetworkReply::HostNotFoundError) {
-                emit connectionChanged(false);
-            }
-            if (status == 400 || status == 401) {
-                emit authenticationStatusChanged(false);
-            }
-            emit actionExecuted(actionId, false);
-            qCWarning(dcSonos()) << "Request error:" << status << reply->errorString();
-            return;
-        }
-        emit connectionChanged(true);
-        emit authenticationStatusChanged(true);
-        emit actionExecuted(actionId, true);
-        getGroupVolume(groupId);
-    });
-    return actionId;
+    return enqueueRequest(QueuedRequestSetGroupRelativeVolume, groupId, volumeDelta);
 }
 
 void Sonos::getGroupPlaybackStatus(const QString &groupId)
 {
-    QNetworkRequest request;
-    request.setHeader(QNetworkRequest::KnownHeaders::ContentTypeHeader, "application/json");
-    request.setRawHeader("Authorization", "Bearer " + m_accessToken);
-    request.setRawHeader("X-Sonos-Api-Key", m_clientKey);
-    request.setUrl(QUrl(m_baseControlUrl + "/groups/" + groupId + "/playback"));
-    QNetworkReply *reply = m_networkManager->get(request);
-    connect(reply, &QNetworkReply::finished, this, [reply, this, groupId] {
-        reply->deleteLater();
-        int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
-
-        // Check HTTP status code
-        if (status != 200 || reply->error() != QNetworkReply::NoError) {
-            if (reply->error() == QNetworkReply::HostNotFoundError) {
-                emit connectionChanged(false);
-            }
-            if (status == 400 || status == 401) {
-                emit authenticationStatusChanged(false);
-            }
-            qCWarning(dcSonos()) << "Request error:" << status << reply->errorString();
-            return;
-        }
-        emit connectionChanged(true);
-        emit authenticationStatusChanged(true);
+    enqueueRequest(QueuedRequestGetPlaybackStatus, groupId);
+}
 
-        QJsonDocument data = QJsonDocument::fromJson(reply->readAll());
-        if (!data.isObject())
-            return;
+void Sonos::processGroupPlaybackStatus(const QString &groupId, const QByteArray &payload)
+{
+    QJsonDocument data = QJsonDocument::fromJson(payload);
+    if (!data.isObject())
+        return;
 
-        PlayBackObject playBack;
-        QJsonObject object = data.object();
-        playBack.itemId = object["itemId"].toString();
-        playBack.positionMillis = object["positionMillis"].toInt();
-        playBack.previousItemId = object["previousItemId"].toInt();
-        playBack.previousPositionMillis = object["previousPositionMillis"].toInt();
-        QString playBackState = object["playbackState"].toString();
-        if (playBackState.contains("BUFFERING")) {
-            playBack.playbackState = PlayBackStateBuffering;
-        } else if (playBackState.contains("IDLE")) {
-            playBack.playbackState = PlayBackStateIdle;
-        } else if (playBackState.contains("PAUSE")) {
-            playBack.playbackState = PlayBackStatePause;
-        } else if (playBackState.contains("PLAYING")) {
-            playBack.playbackState = PlayBackStatePlaying;
-        }
-        playBack.isDucking = object["isDucking"].toBool();
-        playBack.queueVersion = object["queueVersion"].toString();
-        if (object.contains("playModes")) {
-            PlayMode playMode;
-            QJsonObject playModeObject = object["playModes"].toObject();
-            playMode.repeat = playModeObject["repeat"].toBool();
-            playMode.repeatOne = playModeObject["repeatOne"].toBool();
-            playMode.crossfade = playModeObject["crossfade"].toBool();
-            playMode.shuffle = playModeObject["shuffle"].toBool();
-            playBack.playMode = playMode;
-        }
-        emit playBackStatusReceived(groupId, playBack);
-    });
+    PlayBackObject playBack;
+    QJsonObject object = data.object();
+    playBack.itemId = object["itemId"].toString();
+    playBack.positionMillis = object["positionMillis"].toInt();
+    playBack.previousItemId = object["previousItemId"].toInt();
+    playBack.previousPositionMillis = object["previousPositionMillis"].toInt();
+    QString playBackState = object["playbackState"].toString();
+    if (playBackState.contains("BUFFERING")) {
+        playBack.playbackState = PlayBackStateBuffering;
+    } else if (playBackState.contains("IDLE")) {
+        playBack.playbackState = PlayBackStateIdle;
+    } else if (playBackState.contains("PAUSE")) {
+        playBack.playbackState = PlayBackStatePause;
+    } else if (playBackState.contains("PLAYING")) {
+        playBack.playbackState = PlayBackStatePlaying;
+    }
+    playBack.isDucking = object["isDucking"].toBool();
+    playBack.queueVersion = object["queueVersion"].toString();
+    if (object.contains("playModes")) {
+        PlayMode playMode;
+        QJsonObject playModeObject = object["playModes"].toObject();
+        playMode.repeat = playModeObject["repeat"].toBool();
+        playMode.repeatOne = playModeObject["repeatOne"].toBool();
+        playMode.crossfade = playModeObject["crossfade"].toBool();
+        playMode.shuffle = playModeObject["shuffle"].toBool();
+        playBack.playMode = playMode;
+    }
+    emit playBackStatusReceived(groupId, playBack);
 }
 
 QUuid Sonos::groupLoadLineIn(const QString &groupId)
@@ -513,8 +393,7 @@ QUuid Sonos::groupLoadLineIn(const QString &groupId)
     request.setUrl(QUrl(m_baseControlUrl + "/groups/" + groupId + "/playback/lineIn"));
     QUuid actionId = QUuid::createUuid();
 
-    QNetworkReply *reply = m_networkManager->post(request, "");
-    connect(reply, &QNetworkReply::finished, this, [reply, actionId, groupId, this] {
+    queueRequest(m_households.value(groupId), request, "POST", QByteArray(), [actionId, groupId, this](QNetworkReply *reply) {
         reply->deleteLater();
         int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
 
@@ -540,6 +419,10 @@ QUuid Sonos::groupLoadLineIn(const QString &groupId)
 
 QUuid Sonos::groupPlay(const QString &groupId)
 {
+    SonosUpnpPlayer *localPlayer = localCoordinator(groupId);
+    if (localPlayer)
+        return localPlayer->play();
+
     QNetworkRequest request;
     request.setHeader(QNetworkRequest::KnownHeaders::ContentTypeHeader, "application/json");
     request.setRawHeader("Authorization", "Bearer " + m_accessToken);
@@ -549,8 +432,7 @@ QUuid Sonos::groupPlay(const QString &groupId)
 
     qDebug(dcSonos()) << "Play:" << groupId;
 
-    QNetworkReply *reply = m_networkManager->post(request, "");
-    connect(reply, &QNetworkReply::finished, this, [reply, actionId, groupId, this] {
+    queueRequest(m_households.value(groupId), request, "POST", QByteArray(), [actionId, groupId, this](QNetworkReply *reply) {
         reply->deleteLater();
         int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
 
@@ -576,6 +458,10 @@ QUuid Sonos::groupPlay(const QString &groupId)
 
 QUuid Sonos::groupPause(const QString &groupId)
 {
+    SonosUpnpPlayer *localPlayer = localCoordinator(groupId);
+    if (localPlayer)
+        return localPlayer->pause();
+
     QNetworkRequest request;
     request.setHeader(QNetworkRequest::KnownHeaders::ContentTypeHeader, "application/json");
     request.setRawHeader("Authorization", "Bearer " + m_accessToken);
@@ -585,8 +471,7 @@ QUuid Sonos::groupPause(const QString &groupId)
 
     qDebug(dcSonos()) << "Pause:" << groupId;
 
-    QNetworkReply *reply = m_networkManager->post(request, "");
-    connect(reply, &QNetworkReply::finished, this, [reply, actionId, groupId, this] {
+    queueRequest(m_households.value(groupId), request, "POST", QByteArray(), [actionId, groupId, this](QNetworkReply *reply) {
         reply->deleteLater();
         int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
 
@@ -624,8 +509,7 @@ QUuid Sonos::groupSeek(const QString &groupId, int possitionMillis)
     object.insert("positionMillis", QJsonValue::fromVariant(possitionMillis));
     QJsonDocument doc(object);
 
-    QNetworkReply *reply = m_networkManager->post(request, doc.toJson(QJsonDocument::Compact));
-    connect(reply, &QNetworkReply::finished, this, [reply, actionId, this] {
+    queueRequest(m_households.value(groupId), request, "POST", doc.toJson(QJsonDocument::Compact), [actionId, this](QNetworkReply *reply) {
         reply->deleteLater();
         int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
 
@@ -661,8 +545,7 @@ QUuid Sonos::groupSeekRelative(const QString &groupId, int deltaMillis)
     object.insert("deltaMillis", QJsonValue::fromVariant(deltaMillis));
     QJsonDocument doc(object);
 
-    QNetworkReply *reply = m_networkManager->post(request, doc.toJson(QJsonDocument::Compact));
-    connect(reply, &QNetworkReply::finished, this, [reply, actionId, this] {
+    queueRequest(m_households.value(groupId), request, "POST", doc.toJson(QJsonDocument::Compact), [actionId, this](QNetworkReply *reply) {
         reply->deleteLater();
         int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
 
@@ -703,8 +586,7 @@ QUuid Sonos::groupSetPlayModes(const QString &groupId, PlayMode playMode)
     object.insert("playModes", playModesObject);
     QJsonDocument doc(object);
 
-    QNetworkReply *reply = m_networkManager->post(request, doc.toJson(QJsonDocument::Compact));
-    connect(reply, &QNetworkReply::finished, this, [reply, actionId, groupId, this] {
+    queueRequest(m_households.value(groupId), request, "POST", doc.toJson(QJsonDocument::Compact), [actionId, groupId, this](QNetworkReply *reply) {
         reply->deleteLater();
         int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
 
@@ -730,6 +612,10 @@ QUuid Sonos::groupSetPlayModes(const QString &groupId, PlayMode playMode)
 
 QUuid Sonos::groupSetShuffle(const QString &groupId, bool shuffle)
 {
+    SonosUpnpPlayer *localPlayer = localCoordinator(groupId);
+    if (localPlayer)
+        return localPlayer->setShuffle(shuffle);
+
     QNetworkRequest request;
     request.setHeader(QNetworkRequest::KnownHeaders::ContentTypeHeader, "application/json");
     request.setRawHeader("Authorization", "Bearer " + m_accessToken);
@@ -743,8 +629,7 @@ QUuid Sonos::groupSetShuffle(const QString &groupId, bool shuffle)
     object.insert("playModes", playModesObject);
     QJsonDocument doc(object);
 
-    QNetworkReply *reply = m_networkManager->post(request, doc.toJson(QJsonDocument::Compact));
-    connect(reply, &QNetworkReply::finished, this, [reply, actionId, groupId, this] {
+    queueRequest(m_households.value(groupId), request, "POST", doc.toJson(QJsonDocument::Compact), [actionId, groupId, this](QNetworkReply *reply) {
         reply->deleteLater();
         int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
 
@@ -770,6 +655,10 @@ QUuid Sonos::groupSetShuffle(const QString &groupId, bool shuffle)
 
 QUuid Sonos::groupSetRepeat(const QString &groupId, RepeatMode repeatMode)
 {
+    SonosUpnpPlayer *localPlayer = localCoordinator(groupId);
+    if (localPlayer)
+        return localPlayer->setRepeat(repeatMode);
+
     QNetworkRequest request;
     request.setHeader(QNetworkRequest::KnownHeaders::ContentTypeHeader, "application/json");
     request.setRawHeader("Authorization", "Bearer " + m_accessToken);
@@ -795,8 +684,7 @@ QUuid Sonos::groupSetRepeat(const QString &groupId, RepeatMode repeatMode)
     object.insert("playModes", playModesObject);
     QJsonDocument doc(object);
 
-    QNetworkReply *reply = m_networkManager->post(request, doc.toJson(QJsonDocument::Compact));
-    connect(reply, &QNetworkReply::finished, this, [reply, actionId, groupId, this] {
+    queueRequest(m_households.value(groupId), request, "POST", doc.toJson(QJsonDocument::Compact), [actionId, groupId, this](QNetworkReply *reply) {
         reply->deleteLater();
         int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
 
@@ -835,8 +723,7 @@ QUuid Sonos::groupSetCrossfade(const QString &groupId, bool crossfade)
     object.insert("playModes", playModesObject);
     QJsonDocument doc(object);
 
-    QNetworkReply *reply = m_networkManager->post(request, doc.toJson(QJsonDocument::Compact));
-    connect(reply, &QNetworkReply::finished, this, [reply, actionId, groupId, this] {
+    queueRequest(m_households.value(groupId), request, "POST", doc.toJson(QJsonDocument::Compact), [actionId, groupId, this](QNetworkReply *reply) {
         reply->deleteLater();
         int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
 
@@ -862,6 +749,10 @@ QUuid Sonos::groupSetCrossfade(const QString &groupId, bool crossfade)
 
 QUuid Sonos::groupSkipToNextTrack(const QString &groupId)
 {
+    SonosUpnpPlayer *localPlayer = localCoordinator(groupId);
+    if (localPlayer)
+        return localPlayer->next();
+
     QNetworkRequest request;
     request.setHeader(QNetworkRequest::KnownHeaders::ContentTypeHeader, "application/json");
     request.setRawHeader("Authorization", "Bearer " + m_accessToken);
@@ -869,8 +760,7 @@ QUuid Sonos::groupSkipToNextTrack(const QString &groupId)
     request.setUrl(QUrl(m_baseControlUrl + "/groups/" + groupId + "/playback/skipToNextTrack"));
     QUuid actionId = QUuid::createUuid();
 
-    QNetworkReply *reply = m_networkManager->post(request, "");
-    connect(reply, &QNetworkReply::finished, this, [reply, actionId, groupId, this] {
+    queueRequest(m_households.value(groupId), request, "POST", QByteArray(), [actionId, groupId, this](QNetworkReply *reply) {
         reply->deleteLater();
         int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
 
@@ -896,6 +786,10 @@ QUuid Sonos::groupSkipToNextTrack(const QString &groupId)
 
 QUuid Sonos::groupSkipToPreviousTrack(const QString &groupId)
 {
+    SonosUpnpPlayer *localPlayer = localCoordinator(groupId);
+    if (localPlayer)
+        return localPlayer->previous();
+
     QNetworkRequest request;
     request.setHeader(QNetworkRequest::KnownHeaders::ContentTypeHeader, "application/json");
     request.setRawHeader("Authorization", "Bearer " + m_accessToken);
@@ -903,8 +797,7 @@ QUuid Sonos::groupSkipToPreviousTrack(const QString &groupId)
     request.setUrl(QUrl(m_baseControlUrl + "/groups/" + groupId + "/playback/skipToPreviousTrack"));
     QUuid actionId = QUuid::createUuid();
 
-    QNetworkReply *reply = m_networkManager->post(request, "");
-    connect(reply, &QNetworkReply::finished, this, [reply, actionId, groupId, this] {
+    queueRequest(m_households.value(groupId), request, "POST", QByteArray(), [actionId, groupId, this](QNetworkReply *reply) {
         reply->deleteLater();
         int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
 
@@ -937,8 +830,7 @@ QUuid Sonos::groupTogglePlayPause(const QString &groupId)
     request.setUrl(QUrl(m_baseControlUrl + "/groups/" + groupId + "/playback/togglePlayPause"));
     QUuid actionId = QUuid::createUuid();
 
-    QNetworkReply *reply = m_networkManager->post(request, "");
-    connect(reply, &QNetworkReply::finished, this, [reply, actionId, groupId, this] {
+    queueRequest(m_households.value(groupId), request, "POST", QByteArray(), [actionId, groupId, this](QNetworkReply *reply) {
         reply->deleteLater();
         int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
 
@@ -964,141 +856,121 @@ QUuid Sonos::groupTogglePlayPause(const QString &groupId)
 
 void Sonos::getGroupMetadataStatus(const QString &groupId)
 {
-    QNetworkRequest request;
-    request.setHeader(QNetworkRequest::KnownHeaders::ContentTypeHeader, "application/json");
-    request.setRawHeader("Authorization", "Bearer " + m_accessToken);
-    request.setRawHeader("X-Sonos-Api-Key", m_clientKey);
-    request.setUrl(QUrl(m_baseControlUrl + "/groups/" + groupId + "/playbackMetadata"));
-    QNetworkReply *reply = m_networkManager->get(request);
-    connect(reply, &QNetworkReply::finished, this, [reply, groupId, this] {
-        reply->deleteLater();
-        int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
-
-        // Check HTTP status code
-        if (status != 200 || reply->error() != QNetworkReply::NoError) {
-            if (reply->error() == QNetworkReply::HostNotFoundError) {
-                emit connectionChanged(false);
-            }
-            if (status == 400 || status == 401) {
-                emit authenticationStatusChanged(false);
-            }
-            qCWarning(dcSonos()) << "Request error:" << status << reply->errorString();
-            return;
-        }
-        emit connectionChanged(true);
-        emit authenticationStatusChanged(true);
+    enqueueRequest(QueuedRequestGetMetadataStatus, groupId);
+}
 
-        QJsonDocument data = QJsonDocument::fromJson(reply->readAll());
-        if (!data.isObject())
-            return;
+void Sonos::processGroupMetadataStatus(const QString &groupId, const QByteArray &payload)
+{
+    QJsonDocument data = QJsonDocument::fromJson(payload);
+    if (!data.isObject())
+        return;
 
-        MetadataStatus metaDataStatus;
-        QJsonObject object = data.object();
+    MetadataStatus metaDataStatus;
+    QJsonObject object = data.object();
+
+    if (object.contains("container")) {
+        ContainerObject container;
+        QJsonObject containerObject = object["container"].toObject();
+        container.name = containerObject["name"].toString();
+        container.type = containerObject["type"].toString();
+        container.imageUrl = containerObject["imageUrl"].toString();
+        if (containerObject.contains("service")) {
+            ServiceObject service;
+            QJsonObject serviceObject = containerObject.value("artist").toObject();
+            service.name = serviceObject["name"].toString();
+            container.service = service;
+        }
+        if (containerObject.contains("id")) {
+            //TODO parse ID
+        }
+        metaDataStatus.container = container;
+    }
 
-        if (object.contains("container")) {
-            ContainerObject container;
-            QJsonObject containerObject = object["container"].toObject();
-            container.name = containerObject["name"].toString();
-            container.type = containerObject["type"].toString();
-            container.imageUrl = containerObject["imageUrl"].toString();
-            if (containerObject.contains("service")) {
+    if (object.contains("currentItem")) {
+        QJsonObject currentItemObject = object["currentItem"].toObject();
+        ItemObject currentItem;
+        if (currentItemObject.contains("track")) {
+            TrackObject track;
+            QJsonObject trackObject = currentItemObject["track"].toObject();
+
+            if (trackObject.contains("artist")) {
+                ArtistObject artist;
+                QJsonObject artistObject = trackObject["artist"].toObject();
+                artist.name = artistObject["name"].toString();
+                //qDebug(dcSonos()) << "Track object contains artist" << artist.name;
+                track.artist = artist;
+            }
+            if (trackObject.contains("album")) {
+                AlbumObject album;
+                QJsonObject albumObject = trackObject["album"].toObject();
+                album.name = albumObject["name"].toString();
+                //qDebug(dcSonos()) << "Track object contains album" << album.name;
+                track.album = album;
+            }
+            if (trackObject.contains("service")) {
                 ServiceObject service;
-                QJsonObject serviceObject = containerObject.value("artist").toObject();
+                QJsonObject serviceObject = trackObject["service"].toObject();
                 service.name = serviceObject["name"].toString();
-                container.service = service;
+                //qDebug(dcSonos()) << "Track object contains service" << service.name;
+                track.service = service;
             }
-            if (containerObject.contains("id")) {
-                //TODO parse ID
+            if (trackObject.contains("id")) {
+                //TODO parse id
             }
-            metaDataStatus.container = container;
-        }
-
-        if (object.contains("currentItem")) {
-            QJsonObject currentItemObject = object["currentItem"].toObject();
-            ItemObject currentItem;
-            if (currentItemObject.contains("track")) {
-                TrackObject track;
-                QJsonObject trackObject = currentItemObject["track"].toObject();
-
-                if (trackObject.contains("artist")) {
-                    ArtistObject artist;
-                    QJsonObject artistObject = trackObject["artist"].toObject();
-                    artist.name = artistObject["name"].toString();
-                    //qDebug(dcSonos()) << "Track object contains artist" << artist.name;
-                    track.artist = artist;
-                }
-                if (trackObject.contains("album")) {
-                    AlbumObject album;
-                    QJsonObject albumObject = trackObject["album"].toObject();
-                    album.name = albumObject["name"].toString();
-                    //qDebug(dcSonos()) << "Track object contains album" << album.name;
-                    track.album = album;
-                }
-                if (trackObject.contains("service")) {
-                    ServiceObject service;
-                    QJsonObject serviceObject = trackObject["service"].toObject();
-                    service.name = serviceObject["name"].toString();
-                    //qDebug(dcSonos()) << "Track object contains service" << service.name;
-                    track.service = service;
-                }
-                if (trackObject.contains("id")) {
-                    //TODO parse id
-                }
 
-                track.type = trackObject["type"].toString();
-                track.name = trackObject["name"].toString();
-                track.imageUrl = trackObject["imageUrl"].toString();
-                track.trackNumber = trackObject["trackNumber"].toInt();
-                track.durationMillis = trackObject["durationMillis"].toInt();
+            track.type = trackObject["type"].toString();
+            track.name = trackObject["name"].toString();
+            track.imageUrl = trackObject["imageUrl"].toString();
+            track.trackNumber = trackObject["trackNumber"].toInt();
+            track.durationMillis = trackObject["durationMillis"].toInt();
 
-                currentItem.track = track;
-            }
-            metaDataStatus.currentItem = currentItem;
+            currentItem.track = track;
         }
+        metaDataStatus.currentItem = currentItem;
+    }
 
-        if (object.contains("nextItem")) {
-            ItemObject nextItem;
-            QJsonObject nextItemObject = object["nextItem"].toObject();
-            if (nextItemObject.contains("track")) {
-                TrackObject track;
-                QJsonObject trackObject = nextItemObject.value("track").toObject();
-
-                if (trackObject.contains("artist")) {
-                    ArtistObject artist;
-                    QJsonObject artistObject = trackObject.value("artist").toObject();
-                    artist.name = artistObject["name"].toString();
-                    //qDebug(dcSonos()) << "Track object contains artist" << artist.name;
-                    track.artist = artist;
-                }
-                if (trackObject.contains("album")) {
-                    AlbumObject album;
-                    QJsonObject albumObject = trackObject.value("album").toObject();
-                    album.name = albumObject["name"].toString();
-                    //qDebug(dcSonos()) << "Track object contains album" << album.name;
-                    track.album = album;
-                }
-                if (trackObject.contains("service")) {
-                    ServiceObject service;
-                    QJsonObject serviceObject = trackObject.value("service").toObject();
-                    service.name = serviceObject["name"].toString();
-                    //qDebug(dcSonos()) << "Track object contains service" << service.name;
-                    track.service = service;
-                }
-                if (trackObject.contains("id")) {
-                    //TODO parse id
-                }
-                track.type = trackObject["type"].toString();
-                track.name = trackObject["name"].toString();
-                track.imageUrl = trackObject["imageUrl"].toString();
-                track.trackNumber = trackObject["trackNumber"].toInt();
-                track.durationMillis = trackObject["durationMillis"].toInt();
-
-                nextItem.track = track;
+    if (object.contains("nextItem")) {
+        ItemObject nextItem;
+        QJsonObject nextItemObject = object["nextItem"].toObject();
+        if (nextItemObject.contains("track")) {
+            TrackObject track;
+            QJsonObject trackObject = nextItemObject.value("track").toObject();
+
+            if (trackObject.contains("artist")) {
+                ArtistObject artist;
+                QJsonObject artistObject = trackObject.value("artist").toObject();
+                artist.name = artistObject["name"].toString();
+                //qDebug(dcSonos()) << "Track object contains artist" << artist.name;
+                track.artist = artist;
+            }
+            if (trackObject.contains("album")) {
+                AlbumObject album;
+                QJsonObject albumObject = trackObject.value("album").toObject();
+                album.name = albumObject["name"].toString();
+                //qDebug(dcSonos()) << "Track object contains album" << album.name;
+                track.album = album;
+            }
+            if (trackObject.contains("service")) {
+                ServiceObject service;
+                QJsonObject serviceObject = trackObject.value("service").toObject();
+                service.name = serviceObject["name"].toString();
+                //qDebug(dcSonos()) << "Track object contains service" << service.name;
+                track.service = service;
+            }
+            if (trackObject.contains("id")) {
+                //TODO parse id
             }
-            metaDataStatus.nextItem = nextItem;
+            track.type = trackObject["type"].toString();
+            track.name = trackObject["name"].toString();
+            track.imageUrl = trackObject["imageUrl"].toString();
+            track.trackNumber = trackObject["trackNumber"].toInt();
+            track.durationMillis = trackObject["durationMillis"].toInt();
+
+            nextItem.track = track;
         }
-        emit metadataStatusReceived(groupId, metaDataStatus);
-    });
+        metaDataStatus.nextItem = nextItem;
+    }
+    emit metadataStatusReceived(groupId, metaDataStatus);
 }
 
 void Sonos::getPlayerVolume(const QByteArray &playerId)
@@ -1108,8 +980,7 @@ void Sonos::getPlayerVolume(const QByteArray &playerId)
     request.setRawHeader("Authorization", "Bearer " + m_accessToken);
     request.setRawHeader("X-Sonos-Api-Key", m_clientKey);
     request.setUrl(QUrl(m_baseControlUrl + "/players/" + playerId + "/playerVolume"));
-    QNetworkReply *reply = m_networkManager->get(request);
-    connect(reply, &QNetworkReply::finished, this, [reply, playerId, this] {
+    queueRequest(m_households.value(QString::fromUtf8(playerId)), request, "GET", QByteArray(), [playerId, this](QNetworkReply *reply) {
         reply->deleteLater();
         int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
 
@@ -1146,118 +1017,17 @@ void Sonos::getPlayerVolume(const QByteArray &playerId)
 
 QUuid Sonos::setPlayerVolume(const QByteArray &playerId, int volume)
 {
-    QNetworkRequest request;
-    request.setHeader(QNetworkRequest::KnownHeaders::ContentTypeHeader, "application/json");
-    request.setRawHeader("Authorization", "Bearer " + m_accessToken);
-    request.setRawHeader("X-Sonos-Api-Key", m_clientKey);
-    request.setUrl(QUrl(m_baseControlUrl + "/players/" + playerId + "/playerVolume"));
-    QUuid actionId = QUuid::createUuid();
-
-    qDebug(dcSonos()) << "Setting volume:" << playerId << volume;
-
-    QJsonObject object;
-    object.insert("volume", QJsonValue::fromVariant(volume));
-    QJsonDocument doc(object);
-
-    QNetworkReply *reply = m_networkManager->post(request, doc.toJson(QJsonDocument::Compact));
-    connect(reply, &QNetworkReply::finished, this, [reply, actionId, playerId, this] {
-        reply->deleteLater();
-        int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
-
-        // Check HTTP status code
-        if (status != 200 || reply->error() != QNetworkReply::NoError) {
-            if (reply->error() == QNetworkReply::HostNotFoundError) {
-                emit connectionChanged(false);
-            }
-            if (status == 400 || status == 401) {
-                emit authenticationStatusChanged(false);
-            }
-            emit actionExecuted(actionId, false);
-            qCWarning(dcSonos()) << "Request error:" << status << reply->errorString();
-            return;
-        }
-        emit connectionChanged(true);
-        emit authenticationStatusChanged(true);
-        emit actionExecuted(actionId, true);
-        getPlayerVolume(playerId);
-    });
-    return actionId;
+    return enqueueRequest(QueuedRequestSetPlayerVolume, playerId, volume);
 }
 
 QUuid Sonos::setPlayerRelativeVolume(const QByteArray &playerId, int volumeDelta)
 {
-    QNetworkRequest request;
-    request.setHeader(QNetworkRequest::KnownHeaders::ContentTypeHeader, "application/json");
-    request.setRawHeader("Authorization", "Bearer " + m_accessToken);
-    request.setRawHeader("X-Sonos-Api-Key", m_clientKey);
-    request.setUrl(QUrl(m_baseControlUrl + "/players/" + playerId + "/playerVolume/relative"));
-    QUuid actionId = QUuid::createUuid();
-
-    QJsonObject object;
-    object.insert("volumeDelta", QJsonValue::fromVariant(volumeDelta));
-    QJsonDocument doc(object);
-
-    QNetworkReply *reply = m_networkManager->post(request, doc.toJson(QJsonDocument::Compact));
-    connect(reply, &QNetworkReply::finished, this, [reply, actionId, playerId, this] {
-        reply->deleteLater();
-        int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
-
-        // Check HTTP status code
-        if (status != 200 || reply->error() != QNetworkReply::NoError) {
-            if (reply->error() == QNetworkReply::HostNotFoundError) {
-                emit connectionChanged(false);
-            }
-            if (status == 400 || status == 401) {
-                emit authenticationStatusChanged(false);
-            }
-            emit actionExecuted(actionId, false);
-            qCWarning(dcSonos()) << "Request error:" << status << reply->errorString();
-            return;
-        }
-        emit connectionChanged(true);
-        emit authenticationStatusChanged(true);
-        emit actionExecuted(actionId, true);
-        getPlayerVolume(playerId);
-    });
-    return actionId;
+    return enqueueRequest(QueuedRequestSetPlayerRelativeVolume, playerId, volumeDelta);
 }
 
 QUuid Sonos::setPlayerMute(const QByteArray &playerId, bool mute)
 {
-    QNetworkRequest request;
-    request.setHeader(QNetworkRequest::KnownHeaders::ContentTypeHeader, "application/json");
-    request.setRawHeader("Authorization", "Bearer " + m_accessToken);
-    request.setRawHeader("X-Sonos-Api-Key", m_clientKey);
-    request.setUrl(QUrl(m_baseControlUrl + "/players/" + playerId + "/playerVolume"));
-    QUuid actionId = QUuid::createUuid();
-
-    QJsonObject object;
-    object.insert("muted", QJsonValue::fromVariant(mute));
-    QJsonDocument doc(object);
-
-    QNetworkReply *reply = m_networkManager->post(request, doc.toJson(QJsonDocument::Compact));
-    connect(reply, &QNetworkReply::finished, this, [reply, actionId, playerId, this] {
-        reply->deleteLater();
-        int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
-
-        // Check HTTP status code
-        if (status != 200 || reply->error() != QNetworkReply::NoError) {
-            if (reply->error() == QNetworkReply::HostNotFoundError) {
-                emit connectionChanged(false);
-            }
-            if (status == 400 || status == 401) {
-                emit authenticationStatusChanged(false);
-            }
-            emit actionExecuted(actionId, false);
-            qCWarning(dcSonos()) << "Request error:" << status << reply->errorString();
-            return;
-        }
-        emit connectionChanged(true);
-        emit authenticationStatusChanged(true);
-        emit actionExecuted(actionId, true);
-        getPlayerVolume(playerId);
-    });
-    return actionId;
+    return enqueueRequest(QueuedRequestSetPlayerMute, playerId, mute);
 }
 
 void Sonos::getPlaylist(const QString &householdId, const QString &playlistId)
@@ -1273,8 +1043,7 @@ void Sonos::getPlaylist(const QString &householdId, const QString &playlistId)
     object["playlistId"] = playlistId;
     QJsonDocument doc(object);
 
-    QNetworkReply *reply = m_networkManager->post(request, doc.toJson(QJsonDocument::Compact));
-    connect(reply, &QNetworkReply::finished, this, [reply, householdId, this] {
+    queueRequest(householdId, request, "POST", doc.toJson(QJsonDocument::Compact), [householdId, this](QNetworkReply *reply) {
         reply->deleteLater();
         int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
 
@@ -1326,8 +1095,7 @@ void Sonos::getPlaylists(const QString &householdId)
     request.setRawHeader("Authorization", "Bearer " + m_accessToken);
     request.setRawHeader("X-Sonos-Api-Key", m_clientKey);
     request.setUrl(QUrl(m_baseControlUrl + "/households/" + householdId + "/playlists"));
-    QNetworkReply *reply = m_networkManager->get(request);
-    connect(reply, &QNetworkReply::finished, this, [reply, householdId, this] {
+    queueRequest(householdId, request, "GET", QByteArray(), [householdId, this](QNetworkReply *reply) {
         reply->deleteLater();
         int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
 
@@ -1386,8 +1154,7 @@ QUuid Sonos::loadPlaylist(const QString &groupId, const QString &playlistId)
     object.insert("playOnCompletion", true);
     QJsonDocument doc(object);
 
-    QNetworkReply *reply = m_networkManager->post(request, doc.toJson(QJsonDocument::Compact));
-    connect(reply, &QNetworkReply::finished, this, [reply, actionId, this] {
+    queueRequest(m_households.value(groupId), request, "POST", doc.toJson(QJsonDocument::Compact), [actionId, this](QNetworkReply *reply) {
         reply->deleteLater();
         int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
 
@@ -1417,8 +1184,7 @@ void Sonos::getPlayerSettings(const QString &playerId)
     request.setRawHeader("Authorization", "Bearer " + m_accessToken);
     request.setRawHeader("X-Sonos-Api-Key", m_clientKey);
     request.setUrl(QUrl(m_baseControlUrl + "/players/" + playerId + "/settings/player"));
-    QNetworkReply *reply = m_networkManager->get(request);
-    connect(reply, &QNetworkReply::finished, this, [reply, playerId, this] {
+    queueRequest(m_households.value(playerId), request, "GET", QByteArray(), [playerId, this](QNetworkReply *reply) {
         reply->deleteLater();
         int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
 
@@ -1469,8 +1235,7 @@ QUuid Sonos::setPlayerSettings(const QString &playerId, PlayerSettingsObject set
     object["wifiDisable"] = settings.wifiDisabled;
     QJsonDocument doc(object);
 
-    QNetworkReply *reply = m_networkManager->post(request, doc.toJson(QJsonDocument::Compact));
-    connect(reply, &QNetworkReply::finished, this, [reply, actionId, playerId, this] {
+    queueRequest(m_households.value(playerId), request, "POST", doc.toJson(QJsonDocument::Compact), [actionId, playerId, this](QNetworkReply *reply) {
         reply->deleteLater();
         int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
 
@@ -1494,6 +1259,337 @@ QUuid Sonos::setPlayerSettings(const QString &playerId, PlayerSettingsObject set
     return actionId;
 }
 
+void Sonos::setLocalPlayerAddress(const QString &playerId, const QHostAddress &address)
+{
+    SonosUpnpPlayer *player = m_localPlayers.value(playerId);
+    if (player) {
+        if (player->address() != address || !player->reachable()) {
+            qCDebug(dcSonos()) << "Local player" << playerId << "is reachable at" << address.toString();
+            player->setAddress(address);
+        }
+        return;
+    }
+
+    if (!m_eventServer) {
+        m_eventServer = new UpnpEventServer(this);
+    }
+
+    qCDebug(dcSonos()) << "Found local player" << playerId << address.toString();
+    player = new SonosUpnpPlayer(m_networkManager, m_eventServer, playerId, address, this);
+    m_localPlayers.insert(playerId, player);
+    connect(player, &SonosUpnpPlayer::actionExecuted, this, &Sonos::actionExecuted);
+    connect(player, &SonosUpnpPlayer::playBackStatusReceived, this, [this, player] (const PlayBackObject &playBack) {
+        if (!player->groupId().isEmpty())
+            emit playBackStatusReceived(player->groupId(), playBack);
+    });
+    connect(player, &SonosUpnpPlayer::metadataStatusReceived, this, [this, player] (const MetadataStatus &metadataStatus) {
+        if (!player->groupId().isEmpty())
+            emit metadataStatusReceived(player->groupId(), metadataStatus);
+    });
+    connect(player, &SonosUpnpPlayer::volumeReceived, this, [this, player] (const VolumeObject &volume) {
+        if (!player->groupId().isEmpty())
+            emit volumeReceived(player->groupId(), volume);
+    });
+    updateLocalGroups();
+}
+
+bool Sonos::localEventsActive(const QString &groupId) const
+{
+    SonosUpnpPlayer *player = localCoordinator(groupId);
+    return player && player->eventsActive();
+}
+
+SonosUpnpPlayer *Sonos::localCoordinator(const QString &groupId) const
+{
+    SonosUpnpPlayer *player = m_localPlayers.value(m_groupCoordinators.value(groupId));
+    if (!player || !player->reachable() || player->groupId() != groupId)
+        return nullptr;
+
+    return player;
+}
+
+void Sonos::updateLocalGroups()
+{
+    foreach (SonosUpnpPlayer *player, m_localPlayers) {
+        player->setGroupId(m_groupCoordinators.key(player->playerId()));
+    }
+}
+
+Sonos::RequestStatistics Sonos::requestStatistics() const
+{
+    return m_requestStatistics;
+}
+
+QUuid Sonos::enqueueRequest(QueuedRequestType type, const QString &targetId, const QVariant &value)
+{
+    QUuid actionId;
+    if (type != QueuedRequestGetGroupVolume && type != QueuedRequestGetPlaybackStatus && type != QueuedRequestGetMetadataStatus)
+        actionId = QUuid::createUuid();
+
+    QueuedRequest queuedRequest;
+    queuedRequest.type = type;
+    queuedRequest.targetId = targetId;
+    queuedRequest.value = value;
+    if (!actionId.isNull())
+        queuedRequest.actionIds.append(actionId);
+
+    m_requestStatistics.queued++;
+
+    // Collapse with a pending request for the same property, only the latest value matters
+    QList<QueuedRequest> &queue = m_requestQueues[m_households.value(targetId)];
+    QString key = coalescingKey(queuedRequest);
+    for (int i = 0; i < queue.count(); i++) {
+        QueuedRequest &pending = queue[i];
+        if (pending.type == QueuedRequestGeneric || coalescingKey(pending) != key)
+            continue;
+
+        if (type == QueuedRequestSetGroupRelativeVolume || type == QueuedRequestSetPlayerRelativeVolume) {
+            if (pending.type == type) {
+                pending.value = pending.value.toInt() + value.toInt();
+            } else {
+                // Apply the delta to the absolute volume not sent yet
+                pending.value = qBound(0, pending.value.toInt() + value.toInt(), 100);
+            }
+        } else {
+            pending.type = type;
+            pending.value = value;
+        }
+        pending.actionIds.append(queuedRequest.actionIds);
+        m_requestStatistics.dropped++;
+        return actionId;
+    }
+
+    queue.append(queuedRequest);
+    processRequestQueues();
+    return actionId;
+}
+
+void Sonos::queueRequest(const QString &householdId, const QNetworkRequest &request, const QByteArray &verb, const QByteArray &body, std::function<void (QNetworkReply *)> replyHandler)
+{
+    QueuedRequest queuedRequest;
+    queuedRequest.type = QueuedRequestGeneric;
+    queuedRequest.request = request;
+    queuedRequest.verb = verb;
+    queuedRequest.body = body;
+    queuedRequest.replyHandler = replyHandler;
+
+    m_requestStatistics.queued++;
+    m_requestQueues[householdId].append(queuedRequest);
+    processRequestQueues();
+}
+
+QString Sonos::coalescingKey(const QueuedRequest &queuedRequest)
+{
+    switch (queuedRequest.type) {
+    case QueuedRequestGeneric:
+        return QString();
+    case QueuedRequestGetGroupVolume:
+        return queuedRequest.targetId + "/getvolume";
+    case QueuedRequestGetPlaybackStatus:
+        return queuedRequest.targetId + "/getplayback";
+    case QueuedRequestGetMetadataStatus:
+        return queuedRequest.targetId + "/getmetadata";
+    case QueuedRequestSetGroupVolume:
+    case QueuedRequestSetGroupRelativeVolume:
+    case QueuedRequestSetPlayerVolume:
+    case QueuedRequestSetPlayerRelativeVolume:
+        return queuedRequest.targetId + "/volume";
+    case QueuedRequestSetGroupMute:
+    case QueuedRequestSetPlayerMute:
+        return queuedRequest.targetId + "/mute";
+    }
+    return queuedRequest.targetId;
+}
+
+void Sonos::processRequestQueues()
+{
+    qint64 now = QDateTime::currentMSecsSinceEpoch();
+    bool pending = false;
+    foreach (const QString &householdId, m_requestQueues.keys()) {
+        QList<QueuedRequest> &queue = m_requestQueues[householdId];
+        if (queue.isEmpty())
+            continue;
+
+        pending = true;
+        // One request per interval and household, longer if the API asked us to back off
+        if (now < m_householdNextRequest.value(householdId))
+            continue;
+
+        m_householdNextRequest.insert(householdId, now + m_householdRequestInterval);
+        sendQueuedRequest(householdId, queue.takeFirst());
+        if (!queue.isEmpty())
+            pending = true;
+    }
+
+    if (pending && !m_requestQueueTimer->isActive()) {
+        m_requestQueueTimer->start();
+    } else if (!pending) {
+        m_requestQueueTimer->stop();
+    }
+}
+
+void Sonos::sendQueuedRequest(const QString &householdId, const QueuedRequest &queuedRequest)
+{
+    QNetworkRequest request = queuedRequest.request;
+    request.setHeader(QNetworkRequest::KnownHeaders::ContentTypeHeader, "application/json");
+    // The token might have been refreshed while the request was waiting
+    request.setRawHeader("Authorization", "Bearer " + m_accessToken);
+    request.setRawHeader("X-Sonos-Api-Key", m_clientKey);
+
+    QString targetId = queuedRequest.targetId;
+    QJsonObject object;
+    switch (queuedRequest.type) {
+    case QueuedRequestGeneric:
+        break;
+    case QueuedRequestGetGroupVolume:
+        request.setUrl(QUrl(m_baseControlUrl + "/groups/" + targetId + "/groupVolume"));
+        break;
+    case QueuedRequestGetPlaybackStatus:
+        request.setUrl(QUrl(m_baseControlUrl + "/groups/" + targetId + "/playback"));
+        break;
+    case QueuedRequestGetMetadataStatus:
+        request.setUrl(QUrl(m_baseControlUrl + "/groups/" + targetId + "/playbackMetadata"));
+        break;
+    case QueuedRequestSetGroupVolume:
+        request.setUrl(QUrl(m_baseControlUrl + "/groups/" + targetId + "/groupVolume"));
+        object.insert("volume", queuedRequest.value.toInt());
+        break;
+    case QueuedRequestSetGroupRelativeVolume:
+        request.setUrl(QUrl(m_baseControlUrl + "/groups/" + targetId + "/groupVolume/relative"));
+        object.insert("volumeDelta", queuedRequest.value.toInt());
+        break;
+    case QueuedRequestSetGroupMute:
+        request.setUrl(QUrl(m_baseControlUrl + "/groups/" + targetId + "/groupVolume/mute"));
+        object.insert("muted", queuedRequest.value.toBool());
+        break;
+    case QueuedRequestSetPlayerVolume:
+        request.setUrl(QUrl(m_baseControlUrl + "/players/" + targetId + "/playerVolume"));
+        object.insert("volume", queuedRequest.value.toInt());
+        break;
+    case QueuedRequestSetPlayerRelativeVolume:
+        request.setUrl(QUrl(m_baseControlUrl + "/players/" + targetId + "/playerVolume/relative"));
+        object.insert("volumeDelta", queuedRequest.value.toInt());
+        break;
+    case QueuedRequestSetPlayerMute:
+        request.setUrl(QUrl(m_baseControlUrl + "/players/" + targetId + "/playerVolume"));
+        object.insert("muted", queuedRequest.value.toBool());
+        break;
+    }
+
+    QNetworkReply *reply;
+    if (queuedRequest.type == QueuedRequestGeneric) {
+        if (queuedRequest.verb == "GET") {
+            reply = m_networkManager->get(request);
+        } else {
+            reply = m_networkManager->post(request, queuedRequest.body);
+        }
+    } else if (queuedRequest.actionIds.isEmpty()) {
+        reply = m_networkManager->get(request);
+    } else {
+        QJsonDocument doc(object);
+        qDebug(dcSonos()) << "Sending" << request.url().path() << doc.toJson(QJsonDocument::Compact) << "for" << queuedRequest.actionIds.count() << "actions";
+        reply = m_networkManager->post(request, doc.toJson(QJsonDocument::Compact));
+    }
+    m_requestStatistics.sent++;
+
+    connect(reply, &QNetworkReply::finished, this, [reply, householdId, queuedRequest, this] {
+        reply->deleteLater();
+        int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+
+        if (status == 429) {
+            // Rate limited, pause the whole household and send the request again afterwards
+            int retryAfter = reply->rawHeader("Retry-After").toInt();
+            if (retryAfter <= 0)
+                retryAfter = 10;
+
+            qCWarning(dcSonos()) << "Rate limited by the Sonos API, pausing requests for" << retryAfter << "seconds";
+            m_householdNextRequest.insert(householdId, QDateTime::currentMSecsSinceEpoch() + retryAfter * 1000);
+            requeueRequest(householdId, queuedRequest);
+            return;
+        }
+
+        if (queuedRequest.type == QueuedRequestGeneric) {
+            queuedRequest.replyHandler(reply);
+            return;
+        }
+
+        // Check HTTP status code
+        if (status != 200 || reply->error() != QNetworkReply::NoError) {
+            if (reply->error() == QNetworkReply::HostNotFoundError) {
+                emit connectionChanged(false);
+            }
+            if (status == 400 || status == 401) {
+                emit authenticationStatusChanged(false);
+            }
+            foreach (const QUuid &actionId, queuedRequest.actionIds) {
+                emit actionExecuted(actionId, false);
+            }
+            qCWarning(dcSonos()) << "Request error:" << status << reply->errorString();
+            return;
+        }
+        emit connectionChanged(true);
+        emit authenticationStatusChanged(true);
+        foreach (const QUuid &actionId, queuedRequest.actionIds) {
+            emit actionExecuted(actionId, true);
+        }
+
+        switch (queuedRequest.type) {
+        case QueuedRequestGeneric:
+            break;
+        case QueuedRequestGetGroupVolume:
+            processGroupVolume(queuedRequest.targetId, reply->readAll());
+            break;
+        case QueuedRequestGetPlaybackStatus:
+            processGroupPlaybackStatus(queuedRequest.targetId, reply->readAll());
+            break;
+        case QueuedRequestGetMetadataStatus:
+            processGroupMetadataStatus(queuedRequest.targetId, reply->readAll());
+            break;
+        case QueuedRequestSetGroupVolume:
+        case QueuedRequestSetGroupRelativeVolume:
+        case QueuedRequestSetGroupMute:
+            getGroupVolume(queuedRequest.targetId);
+            break;
+        case QueuedRequestSetPlayerVolume:
+        case QueuedRequestSetPlayerRelativeVolume:
+        case QueuedRequestSetPlayerMute:
+            getPlayerVolume(queuedRequest.targetId.toUtf8());
+            break;
+        }
+    });
+}
+
+void Sonos::requeueRequest(const QString &householdId, const QueuedRequest &queuedRequest)
+{
+    QList<QueuedRequest> &queue = m_requestQueues[householdId];
+
+    // A newer value for the same property is waiting already, it supersedes the rejected one
+    QString key = coalescingKey(queuedRequest);
+    if (!key.isEmpty()) {
+        for (int i = 0; i < queue.count(); i++) {
+            QueuedRequest &pending = queue[i];
+            if (pending.type == QueuedRequestGeneric || coalescingKey(pending) != key)
+                continue;
+
+            // A pending delta still needs the rejected value it was meant to be applied to
+            if (pending.type == QueuedRequestSetGroupRelativeVolume || pending.type == QueuedRequestSetPlayerRelativeVolume) {
+                if (queuedRequest.type == pending.type) {
+                    pending.value = pending.value.toInt() + queuedRequest.value.toInt();
+                } else {
+                    pending.type = queuedRequest.type;
+                    pending.value = qBound(0, queuedRequest.value.toInt() + pending.value.toInt(), 100);
+                }
+            }
+            pending.actionIds.append(queuedRequest.actionIds);
+            m_requestStatistics.dropped++;
+            return;
+        }
+    }
+
+    queue.prepend(queuedRequest);
+    processRequestQueues();
+}
+
 void Sonos::onRefreshTimeout()
 {
     qCDebug(dcSonos) << "Refresh authentication token";
@@ -33,10 +33,18 @@
 
 #include <QObject>
 #include <QTimer>
+#include <QHash>
+#include <QHostAddress>
+#include <QVariant>
+
+#include <functional>
 
 #include "network/networkaccessmanager.h"
 #include "integrations/thing.h"
 
+class UpnpEventServer;
+class SonosUpnpPlayer;
+
 class Sonos : public QObject
 {
     Q_OBJECT
@@ -215,6 +223,12 @@ public:
         QList<PlaylistTrackObject> tracks;
     };
 
+    struct RequestStatistics {
+        int queued = 0;     //Requests accepted by the cloud request queue
+        int dropped = 0;    //Requests merged into a pending request for the same property
+        int sent = 0;       //Requests actually sent to the cloud API
+    };
+
     explicit Sonos(NetworkAccessManager *networkManager, const QByteArray &clientId,  const QByteArray &clientSecret, QObject *parent = nullptr);
 
     QUrl getLoginUrl(const QUrl &redirectUrl);
@@ -271,6 +285,12 @@ public:
     void getPlayerSettings(const QString &playerId);
     QUuid setPlayerSettings(const QString &playerId, PlayerSettingsObject settings);
 
+    RequestStatistics requestStatistics() const;
+
+    //Local control
+    void setLocalPlayerAddress(const QString &playerId, const QHostAddress &address);
+    bool localEventsActive(const QString &groupId) const;
+
 private:
     QByteArray m_baseAuthorizationUrl = "https://api.sonos.com/login/v3/oauth/access";
     QByteArray m_baseControlUrl = "https://api.ws.sonos.com/control/api/v1";
@@ -283,8 +303,63 @@ private:
 
     NetworkAccessManager *m_networkManager = nullptr;
     QTimer *m_tokenRefreshTimer = nullptr;
+
+    // Players found in the LAN, group actions of their groups are sent directly to the coordinator
+    UpnpEventServer *m_eventServer = nullptr;
+    QHash<QString, SonosUpnpPlayer *> m_localPlayers;
+    QHash<QString, QString> m_groupCoordinators;            // groupId, coordinatorId
+    QHash<QString, QList<QString> > m_householdGroups;      // householdId, groupIds
+
+    SonosUpnpPlayer *localCoordinator(const QString &groupId) const;
+    void updateLocalGroups();
+
+    // All cloud requests are queued per household. Pending status polls and volume/mute writes for
+    // the same property get collapsed, e.g. a volume slider drag only sends the latest volume.
+    enum QueuedRequestType {
+        QueuedRequestGeneric,       // Sent as given and never collapsed
+        QueuedRequestGetGroupVolume,
+        QueuedRequestGetPlaybackStatus,
+        QueuedRequestGetMetadataStatus,
+        QueuedRequestSetGroupVolume,
+        QueuedRequestSetGroupRelativeVolume,
+        QueuedRequestSetGroupMute,
+        QueuedRequestSetPlayerVolume,
+        QueuedRequestSetPlayerRelativeVolume,
+        QueuedRequestSetPlayerMute
+    };
+
+    struct QueuedRequest {
+        QueuedRequestType type;
+        QString targetId;           // groupId or playerId
+        QVariant value;
+        QList<QUuid> actionIds;     // All actions collapsed into this request
+
+        // QueuedRequestGeneric only
+        QNetworkRequest request;
+        QByteArray verb;
+        QByteArray body;
+        std::function<void(QNetworkReply *reply)> replyHandler;
+    };
+
+    int m_householdRequestInterval = 200; // ms between two requests of a household
+    QTimer *m_requestQueueTimer = nullptr;
+    QHash<QString, QList<QueuedRequest> > m_requestQueues;  // householdId, pending requests
+    QHash<QString, qint64> m_householdNextRequest;          // householdId, earliest time for the next request
+    QHash<QString, QString> m_households;                   // groupId or playerId, householdId
+    RequestStatistics m_requestStatistics;
+
+    QUuid enqueueRequest(QueuedRequestType type, const QString &targetId, const QVariant &value = QVariant());
+    void queueRequest(const QString &householdId, const QNetworkRequest &request, const QByteArray &verb, const QByteArray &body, std::function<void(QNetworkReply *reply)> replyHandler);
+    static QString coalescingKey(const QueuedRequest &queuedRequest);
+    void sendQueuedRequest(const QString &householdId, const QueuedRequest &queuedRequest);
+    void requeueRequest(const QString &householdId, const QueuedRequest &queuedRequest);
+
+    void processGroupVolume(const QString &groupId, const QByteArray &payload);
+    void processGroupPlaybackStatus(const QString &groupId, const QByteArray &payload);
+    void processGroupMetadataStatus(const QString &groupId, const QByteArray &payload);
 private slots:
     void onRefreshTimeout();
+    void processRequestQueues();
 
 signals:
     void connectionChanged(bool connected);
@@ -1,4 +1,5 @@
 include(../plugins.pri)
+include(../common/upnpeventserver.pri)
 
 QT += network
 
@@ -7,7 +8,9 @@ TARGET = $$qtLibraryTarget(nymea_integrationpluginsonos)
 SOURCES += \
     integrationpluginsonos.cpp \
     sonos.cpp \
+    sonosupnpplayer.cpp \
 
 HEADERS += \
     integrationpluginsonos.h \
     sonos.h \
+    sonosupnpplayer.h \
@@ -0,0 +1,634 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+*
+* Copyright 2013 - 2020, nymea GmbH
+* Contact: contact@nymea.io
+*
+* This file is part of nymea.
+* This project including source code and documentation is protected by
+* copyright law, and remains the property of nymea GmbH. All rights, including
+* reproduction, publication, editing and translation, are reserved. The use of
+* this project is subject to the terms of a license agreement to be concluded
+* with nymea GmbH in accordance with the terms of use of nymea GmbH, available
+* under https://nymea.io/license
+*
+* GNU Lesser General Public License Usage
+* Alternatively, this project may be redistributed and/or modified under the
+* terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; version 3. This project is distributed in the hope that
+* it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+* warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this project. If not, see <https://www.gnu.org/licenses/>.
+*
+* For any further details and any questions please contact us under
+* contact@nymea.io or see our FAQ/Licensing Information on
+* https://nymea.io/license/faq
+*
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+#include "sonosupnpplayer.h"
+#include "upnpeventserver.h"
+#include "extern-plugininfo.h"
+
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QXmlStreamReader>
+#include <QXmlStreamWriter>
+
+static const QString soapEnvelopeNamespace = QStringLiteral("http://schemas.xmlsoap.org/soap/envelope/");
+
+SonosUpnpPlayer::SonosUpnpPlayer(NetworkAccessManager *networkManager, UpnpEventServer *eventServer, const QString &playerId, const QHostAddress &address, QObject *parent) :
+    QObject(parent),
+    m_networkManager(networkManager),
+    m_eventServer(eventServer),
+    m_playerId(playerId),
+    m_address(address)
+{
+    m_playBack = Sonos::PlayBackObject();
+    m_volume = Sonos::VolumeObject();
+    connect(m_eventServer, &UpnpEventServer::notificationReceived, this, &SonosUpnpPlayer::onNotificationReceived);
+
+    m_livenessTimer = new QTimer(this);
+    m_livenessTimer->setInterval(60000);
+    connect(m_livenessTimer, &QTimer::timeout, this, &SonosUpnpPlayer::checkLiveness);
+    m_livenessTimer->start();
+}
+
+SonosUpnpPlayer::~SonosUpnpPlayer()
+{
+    unsubscribeAll();
+}
+
+QString SonosUpnpPlayer::playerId() const
+{
+    return m_playerId;
+}
+
+QHostAddress SonosUpnpPlayer::address() const
+{
+    return m_address;
+}
+
+void SonosUpnpPlayer::setAddress(const QHostAddress &address)
+{
+    if (address == m_address && m_reachable)
+        return;
+
+    // Subscriptions of the old address are gone, start over
+    unsubscribeAll();
+    m_address = address;
+    setReachable(true);
+    resubscribeAll();
+}
+
+QString SonosUpnpPlayer::groupId() const
+{
+    return m_groupId;
+}
+
+void SonosUpnpPlayer::setGroupId(const QString &groupId)
+{
+    if (m_groupId == groupId)
+        return;
+
+    qCDebug(dcSonos()) << "Local player" << m_playerId << "is coordinator of group" << (groupId.isEmpty() ? "none" : groupId);
+    m_groupId = groupId;
+    if (m_groupId.isEmpty()) {
+        unsubscribeAll();
+    } else if (m_reachable) {
+        if (m_subscriptions.value(ServiceAVTransport).sid.isEmpty())
+            subscribe(ServiceAVTransport);
+        if (m_subscriptions.value(ServiceGroupRenderingControl).sid.isEmpty())
+            subscribe(ServiceGroupRenderingControl);
+    }
+}
+
+bool SonosUpnpPlayer::reachable() const
+{
+    return m_reachable;
+}
+
+bool SonosUpnpPlayer::eventsActive() const
+{
+    return m_reachable && !m_groupId.isEmpty()
+            && !m_subscriptions.value(ServiceAVTransport).sid.isEmpty()
+            && !m_subscriptions.value(ServiceGroupRenderingControl).sid.isEmpty();
+}
+
+QUuid SonosUpnpPlayer::play()
+{
+    QList<QPair<QString, QString> > arguments;
+    arguments.append(qMakePair(QString("InstanceID"), QString("0")));
+    arguments.append(qMakePair(QString("Speed"), QString("1")));
+    return sendAction(ServiceAVTransport, "Play", arguments);
+}
+
+QUuid SonosUpnpPlayer::pause()
+{
+    QList<QPair<QString, QString> > arguments;
+    arguments.append(qMakePair(QString("InstanceID"), QString("0")));
+    return sendAction(ServiceAVTransport, "Pause", arguments);
+}
+
+QUuid SonosUpnpPlayer::next()
+{
+    QList<QPair<QString, QString> > arguments;
+    arguments.append(qMakePair(QString("InstanceID"), QString("0")));
+    return sendAction(ServiceAVTransport, "Next", arguments);
+}
+
+QUuid SonosUpnpPlayer::previous()
+{
+    QList<QPair<QString, QString> > arguments;
+    arguments.append(qMakePair(QString("InstanceID"), QString("0")));
+    return sendAction(ServiceAVTransport, "Previous", arguments);
+}
+
+QUuid SonosUpnpPlayer::setGroupVolume(int volume)
+{
+    QList<QPair<QString, QString> > arguments;
+    arguments.append(qMakePair(QString("InstanceID"), QString("0")));
+    arguments.append(qMakePair(QString("DesiredVolume"), QString::number(qBound(0, volume, 100))));
+    return sendAction(ServiceGroupRenderingControl, "SetGroupVolume", arguments);
+}
+
+QUuid SonosUpnpPlayer::setGroupMute(bool mute)
+{
+    QList<QPair<QString, QString> > arguments;
+    arguments.append(qMakePair(QString("InstanceID"), QString("0")));
+    arguments.append(qMakePair(QString("DesiredMute"), QString(mute ? "1" : "0")));
+    return sendAction(ServiceGroupRenderingControl, "SetGroupMute", arguments);
+}
+
+QUuid SonosUpnpPlayer::setShuffle(bool shuffle)
+{
+    return setPlayMode(shuffle, m_playBack.playMode.repeat, m_playBack.playMode.repeatOne);
+}
+
+QUuid SonosUpnpPlayer::setRepeat(Sonos::RepeatMode repeatMode)
+{
+    return setPlayMode(m_playBack.playMode.shuffle, repeatMode == Sonos::RepeatModeAll, repeatMode == Sonos::RepeatModeOne);
+}
+
+QUuid SonosUpnpPlayer::sendAction(Service service, const QString &action, const QList<QPair<QString, QString> > &arguments)
+{
+    QUuid actionId = QUuid::createUuid();
+
+    qCDebug(dcSonos()) << "Local action" << action << "on" << m_playerId;
+    QNetworkReply *reply = postSoapRequest(service, action, arguments);
+    connect(reply, &QNetworkReply::finished, reply, &QNetworkReply::deleteLater);
+    connect(reply, &QNetworkReply::finished, this, [this, reply, actionId, action] {
+        int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+        if (status == 0) {
+            // No HTTP response at all, the player is gone
+            qCWarning(dcSonos()) << "Local player" << m_playerId << "not reachable:" << reply->errorString();
+            setReachable(false);
+            emit actionExecuted(actionId, false);
+            return;
+        }
+        if (status != 200) {
+            // UPnP errors are reported as SOAP faults with status 500
+            qCWarning(dcSonos()) << "Local action" << action << "failed:" << status << reply->readAll();
+            emit actionExecuted(actionId, false);
+            return;
+        }
+        emit actionExecuted(actionId, true);
+    });
+    return actionId;
+}
+
+QNetworkReply *SonosUpnpPlayer::postSoapRequest(Service service, const QString &action, const QList<QPair<QString, QString> > &arguments)
+{
+    QByteArray content;
+    QXmlStreamWriter xml(&content);
+    xml.writeStartDocument();
+    xml.writeNamespace(soapEnvelopeNamespace, "s");
+    xml.writeStartElement(soapEnvelopeNamespace, "Envelope");
+    xml.writeAttribute(soapEnvelopeNamespace, "encodingStyle", "http://schemas.xmlsoap.org/soap/encoding/");
+    xml.writeStartElement(soapEnvelopeNamespace, "Body");
+    xml.writeNamespace(serviceType(service), "u");
+    xml.writeStartElement(serviceType(service), action);
+    for (int i = 0; i < arguments.count(); i++) {
+        xml.writeTextElement(arguments.at(i).first, arguments.at(i).second);
+    }
+    xml.writeEndElement(); // action
+    xml.writeEndElement(); // Body
+    xml.writeEndElement(); // Envelope
+    xml.writeEndDocument();
+
+    QUrl url;
+    url.setScheme("http");
+    url.setHost(m_address.toString());
+    url.setPort(m_port);
+    url.setPath(controlPath(service));
+    QNetworkRequest request(url);
+    request.setHeader(QNetworkRequest::ContentTypeHeader, "text/xml; charset=\"utf-8\"");
+    request.setRawHeader("SOAPACTION", "\"" + serviceType(service).toUtf8() + "#" + action.toUtf8() + "\"");
+
+    return m_networkManager->post(request, content);
+}
+
+QUuid SonosUpnpPlayer::setPlayMode(bool shuffle, bool repeat, bool repeatOne)
+{
+    QString playMode;
+    if (shuffle) {
+        playMode = repeatOne ? "SHUFFLE_REPEAT_ONE" : (repeat ? "SHUFFLE" : "SHUFFLE_NOREPEAT");
+    } else {
+        playMode = repeatOne ? "REPEAT_ONE" : (repeat ? "REPEAT_ALL" : "NORMAL");
+    }
+
+    QList<QPair<QString, QString> > arguments;
+    arguments.append(qMakePair(QString("InstanceID"), QString("0")));
+    arguments.append(qMakePair(QString("NewPlayMode"), playMode));
+    return sendAction(ServiceAVTransport, "SetPlayMode", arguments);
+}
+
+void SonosUpnpPlayer::setReachable(bool reachable)
+{
+    if (m_reachable == reachable)
+        return;
+
+    m_reachable = reachable;
+    if (!m_reachable) {
+        // Drop the subscriptions without telling the player, it is not there anyway
+        foreach (Service service, m_subscriptions.keys()) {
+            Subscription &subscription = m_subscriptions[service];
+            subscription.sid.clear();
+            subscription.renewTimer->stop();
+            subscription.retries = 0;
+            if (subscription.reply) {
+                QNetworkReply *reply = subscription.reply;
+                subscription.reply = nullptr;
+                reply->abort();
+            }
+        }
+        m_transportStateKnown = false;
+    }
+    emit reachableChanged(m_reachable);
+}
+
+void SonosUpnpPlayer::subscribe(Service service)
+{
+    Subscription &subscription = m_subscriptions[service];
+    if (subscription.reply) {
+        qCDebug(dcSonos()) << "Subscription" << eventPath(service) << "on" << m_playerId << "already pending";
+        return;
+    }
+    if (!subscription.renewTimer) {
+        subscription.renewTimer = new QTimer(this);
+        subscription.renewTimer->setSingleShot(true);
+        connect(subscription.renewTimer, &QTimer::timeout, this, [this, service] {
+            subscribe(service);
+        });
+    }
+
+    QUrl url;
+    url.setScheme("http");
+    url.setHost(m_address.toString());
+    url.setPort(m_port);
+    url.setPath(eventPath(service));
+    QNetworkRequest request(url);
+    if (subscription.sid.isEmpty()) {
+        QHostAddress callbackAddress = m_eventServer->callbackAddress(m_address);
+        if (callbackAddress.isNull() || !m_eventServer->isListening()) {
+            qCWarning(dcSonos()) << "No local callback address for" << m_address.toString() << "- events not available";
+            return;
+        }
+        QByteArray callback = "<http://" + callbackAddress.toString().toUtf8() + ":" + QByteArray::number(m_eventServer->serverPort()) + callbackPath(service) + ">";
+        request.setRawHeader("CALLBACK", callback);
+        request.setRawHeader("NT", "upnp:event");
+    } else {
+        // Renewal of the existing subscription
+        request.setRawHeader("SID", subscription.sid);
+    }
+    request.setRawHeader("TIMEOUT", "Second-" + QByteArray::number(m_subscriptionTimeout));
+
+    QNetworkReply *reply = m_networkManager->sendCustomRequest(request, "SUBSCRIBE");
+    subscription.reply = reply;
+    connect(reply, &QNetworkReply::finished, reply, &QNetworkReply::deleteLater);
+    connect(reply, &QNetworkReply::finished, this, [this, reply, service] {
+        // Replies of aborted requests or of a group we no longer coordinate are stale
+        Subscription &subscription = m_subscriptions[service];
+        if (subscription.reply != reply)
+            return;
+
+        subscription.reply = nullptr;
+        if (m_groupId.isEmpty())
+            return;
+
+        int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+        if (status != 200) {
+            qCWarning(dcSonos()) << "Event subscription" << eventPath(service) << "on" << m_playerId << "failed:" << status << reply->errorString();
+            bool renewal = !subscription.sid.isEmpty();
+            subscription.sid.clear();
+            if (status == 0) {
+                setReachable(false);
+            } else if (renewal) {
+                // The player forgot about us, subscribe again
+                subscribe(service);
+            } else {
+                // Retry with back off, 5 seconds doubled up to 5 minutes
+                int delay = qMin(300, 5 << qMin(subscription.retries, 6));
+                subscription.retries++;
+                qCDebug(dcSonos()) << "Retrying subscription" << eventPath(service) << "on" << m_playerId << "in" << delay << "seconds";
+                subscription.renewTimer->start(delay * 1000);
+            }
+            return;
+        }
+
+        subscription.retries = 0;
+        subscription.sid = reply->rawHeader("SID");
+        int timeout = m_subscriptionTimeout;
+        QByteArray timeoutHeader = reply->rawHeader("TIMEOUT");
+        if (timeoutHeader.toLower().startsWith("second-")) {
+            timeout = timeoutHeader.mid(7).toInt();
+        }
+        // Renew well before the subscription expires
+        subscription.renewTimer->start(qMax(30, timeout * 4 / 5) * 1000);
+        qCDebug(dcSonos()) << "Subscribed to" << eventPath(service) << "on" << m_playerId << subscription.sid << "for" << timeout << "seconds";
+    });
+}
+
+void SonosUpnpPlayer::unsubscribe(Service service)
+{
+    if (!m_subscriptions.contains(service))
+        return;
+
+    Subscription &subscription = m_subscriptions[service];
+    subscription.renewTimer->stop();
+    subscription.retries = 0;
+    if (subscription.reply) {
+        QNetworkReply *reply = subscription.reply;
+        subscription.reply = nullptr;
+        reply->abort();
+    }
+    if (service == ServiceAVTransport)
+        m_transportStateKnown = false;
+
+    if (subscription.sid.isEmpty())
+        return;
+
+    QUrl url;
+    url.setScheme("http");
+    url.setHost(m_address.toString());
+    url.setPort(m_port);
+    url.setPath(eventPath(service));
+    QNetworkRequest request(url);
+    request.setRawHeader("SID", subscription.sid);
+    QNetworkReply *reply = m_networkManager->sendCustomRequest(request, "UNSUBSCRIBE");
+    connect(reply, &QNetworkReply::finished, reply, &QNetworkReply::deleteLater);
+    subscription.sid.clear();
+}
+
+void SonosUpnpPlayer::unsubscribeAll()
+{
+    unsubscribe(ServiceAVTransport);
+    unsubscribe(ServiceGroupRenderingControl);
+}
+
+void SonosUpnpPlayer::resubscribeAll()
+{
+    unsubscribeAll();
+    if (m_reachable && !m_groupId.isEmpty()) {
+        subscribe(ServiceAVTransport);
+        subscribe(ServiceGroupRenderingControl);
+    }
+}
+
+void SonosUpnpPlayer::checkLiveness()
+{
+    // Without active events the plugin polls the cloud anyway
+    if (!eventsActive() || m_livenessReply)
+        return;
+
+    QList<QPair<QString, QString> > arguments;
+    arguments.append(qMakePair(QString("InstanceID"), QString("0")));
+    QNetworkReply *reply = postSoapRequest(ServiceAVTransport, "GetTransportInfo", arguments);
+    m_livenessReply = reply;
+    connect(reply, &QNetworkReply::finished, reply, &QNetworkReply::deleteLater);
+    connect(reply, &QNetworkReply::finished, this, [this, reply] {
+        m_livenessReply = nullptr;
+        if (!eventsActive())
+            return;
+
+        int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+        if (status == 0) {
+            qCWarning(dcSonos()) << "Local player" << m_playerId << "not reachable:" << reply->errorString();
+            setReachable(false);
+            return;
+        }
+        if (status != 200) {
+            qCWarning(dcSonos()) << "Liveness check of" << m_playerId << "failed:" << status << "- subscribing again";
+            resubscribeAll();
+            return;
+        }
+
+        QString transportState;
+        QXmlStreamReader xml(reply->readAll());
+        while (!xml.atEnd()) {
+            xml.readNext();
+            if (xml.isStartElement() && xml.name() == "CurrentTransportState") {
+                transportState = xml.readElementText();
+                break;
+            }
+        }
+
+        // Events would have told us about a change, they got lost if the state differs
+        Sonos::PlayBackState playbackState = parseTransportState(transportState);
+        if (transportState.isEmpty() || !m_transportStateKnown
+                || playbackState == Sonos::PlayBackStateBuffering || m_playBack.playbackState == Sonos::PlayBackStateBuffering
+                || playbackState == m_playBack.playbackState)
+            return;
+
+        qCWarning(dcSonos()) << "Missed transport state change of" << m_playerId << transportState << "- subscribing again";
+        m_playBack.playbackState = playbackState;
+        emit playBackStatusReceived(m_playBack);
+        resubscribeAll();
+    });
+}
+
+QByteArray SonosUpnpPlayer::callbackPath(Service service) const
+{
+    switch (service) {
+    case ServiceAVTransport:
+        return "/" + m_playerId.toUtf8() + "/avtransport";
+    case ServiceGroupRenderingControl:
+        return "/" + m_playerId.toUtf8() + "/grouprenderingcontrol";
+    }
+    return QByteArray();
+}
+
+void SonosUpnpPlayer::processAVTransportEvent(const QByteArray &body)
+{
+    // The state changes are wrapped as escaped XML in the LastChange property
+    QString lastChange;
+    QXmlStreamReader propertySet(body);
+    while (!propertySet.atEnd()) {
+        propertySet.readNext();
+        if (propertySet.isStartElement() && propertySet.name() == "LastChange") {
+            lastChange = propertySet.readElementText();
+            break;
+        }
+    }
+    if (lastChange.isEmpty())
+        return;
+
+    bool playBackChanged = false;
+    bool metadataChanged = false;
+    QString trackMetadata;
+
+    QXmlStreamReader xml(lastChange);
+    while (!xml.atEnd()) {
+        xml.readNext();
+        if (!xml.isStartElement())
+            continue;
+
+        QString value = xml.attributes().value("val").toString();
+        if (xml.name() == "TransportState") {
+            m_playBack.playbackState = parseTransportState(value);
+            m_transportStateKnown = true;
+            playBackChanged = true;
+        } else if (xml.name() == "CurrentPlayMode") {
+            m_playBack.playMode.shuffle = value.startsWith("SHUFFLE");
+            m_playBack.playMode.repeat = (value == "REPEAT_ALL" || value == "SHUFFLE");
+            m_playBack.playMode.repeatOne = (value == "REPEAT_ONE" || value == "SHUFFLE_REPEAT_ONE");
+            playBackChanged = true;
+        } else if (xml.name() == "CurrentCrossfadeMode") {
+            m_playBack.playMode.crossfade = (value == "1");
+            playBackChanged = true;
+        } else if (xml.name() == "CurrentTrackMetaData") {
+            trackMetadata = value;
+            metadataChanged = true;
+        }
+    }
+    if (xml.hasError()) {
+        qCWarning(dcSonos()) << "Could not parse AVTransport event of" << m_playerId << xml.errorString();
+    }
+
+    if (playBackChanged)
+        emit playBackStatusReceived(m_playBack);
+
+    if (metadataChanged)
+        emit metadataStatusReceived(parseTrackMetadata(trackMetadata));
+}
+
+void SonosUpnpPlayer::processGroupRenderingControlEvent(const QByteArray &body)
+{
+    bool volumeChanged = false;
+    QXmlStreamReader xml(body);
+    while (!xml.atEnd()) {
+        xml.readNext();
+        if (!xml.isStartElement())
+            continue;
+
+        if (xml.name() == "GroupVolume") {
+            m_volume.volume = xml.readElementText().toInt();
+            volumeChanged = true;
+        } else if (xml.name() == "GroupMute") {
+            m_volume.muted = (xml.readElementText() == "1");
+            volumeChanged = true;
+        } else if (xml.name() == "GroupVolumeChangeable") {
+            m_volume.fixed = (xml.readElementText() == "0");
+            volumeChanged = true;
+        }
+    }
+
+    if (volumeChanged)
+        emit volumeReceived(m_volume);
+}
+
+Sonos::MetadataStatus SonosUpnpPlayer::parseTrackMetadata(const QString &didl)
+{
+    Sonos::MetadataStatus metadata = Sonos::MetadataStatus();
+    QString streamContent;
+
+    // <DIDL-Lite><item><dc:title/><dc:creator/><upnp:album/><upnp:albumArtURI/></item></DIDL-Lite>
+    QXmlStreamReader xml(didl);
+    while (!xml.atEnd()) {
+        xml.readNext();
+        if (!xml.isStartElement())
+            continue;
+
+        if (xml.name() == "title") {
+            metadata.currentItem.track.name = xml.readElementText();
+        } else if (xml.name() == "creator") {
+            metadata.currentItem.track.artist.name = xml.readElementText();
+        } else if (xml.name() == "album") {
+            metadata.currentItem.track.album.name = xml.readElementText();
+        } else if (xml.name() == "albumArtURI") {
+            QString imageUrl = xml.readElementText();
+            if (imageUrl.startsWith("/")) {
+                imageUrl.prepend(QString("http://%1:%2").arg(m_address.toString()).arg(m_port));
+            }
+            metadata.currentItem.track.imageUrl = imageUrl;
+        } else if (xml.name() == "streamContent") {
+            streamContent = xml.readElementText();
+        }
+    }
+
+    // Radio stations put the current title into the stream content
+    if (!streamContent.isEmpty())
+        metadata.currentItem.track.name = streamContent;
+
+    return metadata;
+}
+
+Sonos::PlayBackState SonosUpnpPlayer::parseTransportState(const QString &transportState)
+{
+    if (transportState == "PLAYING") {
+        return Sonos::PlayBackStatePlaying;
+    } else if (transportState == "PAUSED_PLAYBACK") {
+        return Sonos::PlayBackStatePause;
+    } else if (transportState == "TRANSITIONING") {
+        return Sonos::PlayBackStateBuffering;
+    }
+    return Sonos::PlayBackStateIdle;
+}
+
+QString SonosUpnpPlayer::serviceType(Service service)
+{
+    switch (service) {
+    case ServiceAVTransport:
+        return "urn:schemas-upnp-org:service:AVTransport:1";
+    case ServiceGroupRenderingControl:
+        return "urn:schemas-upnp-org:service:GroupRenderingControl:1";
+    }
+    return QString();
+}
+
+QString SonosUpnpPlayer::controlPath(Service service)
+{
+    switch (service) {
+    case ServiceAVTransport:
+        return "/MediaRenderer/AVTransport/Control";
+    case ServiceGroupRenderingControl:
+        return "/MediaRenderer/GroupRenderingControl/Control";
+    }
+    return QString();
+}
+
+QString SonosUpnpPlayer::eventPath(Service service)
+{
+    switch (service) {
+    case ServiceAVTransport:
+        return "/MediaRenderer/AVTransport/Event";
+    case ServiceGroupRenderingControl:
+        return "/MediaRenderer/GroupRenderingControl/Event";
+    }
+    return QString();
+}
+
+void SonosUpnpPlayer::onNotificationReceived(const QByteArray &path, const QByteArray &sid, const QByteArray &body)
+{
+    // The initial event may arrive before the SUBSCRIBE response delivered the SID
+    if (path == callbackPath(ServiceAVTransport)) {
+        QByteArray expectedSid = m_subscriptions.value(ServiceAVTransport).sid;
+        if (expectedSid.isEmpty() || sid == expectedSid)
+            processAVTransportEvent(body);
+    } else if (path == callbackPath(ServiceGroupRenderingControl)) {
+        QByteArray expectedSid = m_subscriptions.value(ServiceGroupRenderingControl).sid;
+        if (expectedSid.isEmpty() || sid == expectedSid)
+            processGroupRenderingControlEvent(body);
+    }
+}
@@ -0,0 +1,141 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+*
+* Copyright 2013 - 2020, nymea GmbH
+* Contact: contact@nymea.io
+*
+* This file is part of nymea.
+* This project including source code and documentation is protected by
+* copyright law, and remains the property of nymea GmbH. All rights, including
+* reproduction, publication, editing and translation, are reserved. The use of
+* this project is subject to the terms of a license agreement to be concluded
+* with nymea GmbH in accordance with the terms of use of nymea GmbH, available
+* under https://nymea.io/license
+*
+* GNU Lesser General Public License Usage
+* Alternatively, this project may be redistributed and/or modified under the
+* terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; version 3. This project is distributed in the hope that
+* it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+* warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this project. If not, see <https://www.gnu.org/licenses/>.
+*
+* For any further details and any questions please contact us under
+* contact@nymea.io or see our FAQ/Licensing Information on
+* https://nymea.io/license/faq
+*
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+#ifndef SONOSUPNPPLAYER_H
+#define SONOSUPNPPLAYER_H
+
+#include <QObject>
+#include <QHostAddress>
+#include <QTimer>
+#include <QUuid>
+
+#include "sonos.h"
+#include "network/networkaccessmanager.h"
+
+class UpnpEventServer;
+
+// Local LAN control of a single Sonos player via UPnP.
+// Transport and group volume actions are sent as SOAP requests to port 1400 of the
+// player, state changes arrive as GENA events on the UpnpEventServer callback server.
+// Only group coordinators get subscribed, their events describe the whole group.
+class SonosUpnpPlayer : public QObject
+{
+    Q_OBJECT
+public:
+    explicit SonosUpnpPlayer(NetworkAccessManager *networkManager, UpnpEventServer *eventServer, const QString &playerId, const QHostAddress &address, QObject *parent = nullptr);
+    ~SonosUpnpPlayer();
+
+    QString playerId() const;
+
+    QHostAddress address() const;
+    void setAddress(const QHostAddress &address);
+
+    // The cloud group this player is currently coordinating, empty if none
+    QString groupId() const;
+    void setGroupId(const QString &groupId);
+
+    bool reachable() const;
+    bool eventsActive() const;
+
+    QUuid play();
+    QUuid pause();
+    QUuid next();
+    QUuid previous();
+    QUuid setGroupVolume(int volume);
+    QUuid setGroupMute(bool mute);
+    QUuid setShuffle(bool shuffle);
+    QUuid setRepeat(Sonos::RepeatMode repeatMode);
+
+signals:
+    void reachableChanged(bool reachable);
+    void actionExecuted(QUuid actionId, bool success);
+
+    void playBackStatusReceived(const Sonos::PlayBackObject &playBack);
+    void metadataStatusReceived(const Sonos::MetadataStatus &metadataStatus);
+    void volumeReceived(const Sonos::VolumeObject &volume);
+
+private:
+    enum Service {
+        ServiceAVTransport,
+        ServiceGroupRenderingControl
+    };
+
+    struct Subscription {
+        QByteArray sid;
+        QNetworkReply *reply = nullptr; // Pending SUBSCRIBE request
+        QTimer *renewTimer = nullptr;   // Renewal, or retry after a failure
+        int retries = 0;
+    };
+
+    NetworkAccessManager *m_networkManager = nullptr;
+    UpnpEventServer *m_eventServer = nullptr;
+    QString m_playerId;
+    QHostAddress m_address;
+    int m_port = 1400;
+    QString m_groupId;
+    bool m_reachable = true;
+    int m_subscriptionTimeout = 1800; // seconds
+
+    QHash<Service, Subscription> m_subscriptions;
+
+    // Cheap SOAP request while events are active, a player that rebooted
+    // silently dropped our subscriptions and the SIDs would look valid forever
+    QTimer *m_livenessTimer = nullptr;
+    QNetworkReply *m_livenessReply = nullptr;
+    bool m_transportStateKnown = false;
+
+    Sonos::PlayBackObject m_playBack;
+    Sonos::VolumeObject m_volume;
+
+    QNetworkReply *postSoapRequest(Service service, const QString &action, const QList<QPair<QString, QString> > &arguments);
+    QUuid sendAction(Service service, const QString &action, const QList<QPair<QString, QString> > &arguments);
+    QUuid setPlayMode(bool shuffle, bool repeat, bool repeatOne);
+    void setReachable(bool reachable);
+
+    void subscribe(Service service);
+    void unsubscribe(Service service);
+    void unsubscribeAll();
+    void resubscribeAll();
+    void checkLiveness();
+    QByteArray callbackPath(Service service) const;
+
+    void processAVTransportEvent(const QByteArray &body);
+    void processGroupRenderingControlEvent(const QByteArray &body);
+    Sonos::MetadataStatus parseTrackMetadata(const QString &didl);
+    static Sonos::PlayBackState parseTransportState(const QString &transportState);
+
+    static QString serviceType(Service service);
+    static QString controlPath(Service service);
+    static QString eventPath(Service service);
+
+private slots:
+    void onNotificationReceived(const QByteArray &path, const QByteArray &sid, const QByteArray &body);
+};
+
+#endif // SONOSUPNPPLAYER_H
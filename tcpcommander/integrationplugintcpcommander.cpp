@@ -80,6 +80,14 @@ void IntegrationPluginTcpCommander::setupThing(ThingSetupInfo *info)
     if (thing->thingClassId() == tcpServerThingClassId) {
         int port = thing->paramValue(tcpServerThingPortParamTypeId).toInt();
 
+        // A fixed length command has to fit into the buffer, otherwise it could never be completed
+        if (framingFromSetting(thing->setting(tcpServerSettingsFramingParamTypeId).toString()) == TcpServer::FramingFixedLength &&
+                thing->setting(tcpServerSettingsFixedLengthParamTypeId).toInt() > thing->setting(tcpServerSettingsMaxBufferSizeParamTypeId).toInt()) {
+            qCWarning(dcTCPCommander()) << "The fixed command length" << thing->setting(tcpServerSettingsFixedLengthParamTypeId).toInt() << "exceeds the maximum buffer size" << thing->setting(tcpServerSettingsMaxBufferSizeParamTypeId).toInt();
+            info->finish(Thing::ThingErrorInvalidParameter, QT_TR_NOOP("The fixed command length must not be bigger than the maximum buffer size."));
+            return;
+        }
+
         TcpServer *tcpServer = m_tcpServers.value(thing);
         if (tcpServer) {
             // In case of reconfigure, make sure to re-setup the server
@@ -88,12 +96,28 @@ void IntegrationPluginTcpCommander::setupThing(ThingSetupInfo *info)
 
         tcpServer = new TcpServer(port, this);
         tcpServer->setConfirmCommands(thing->setting(tcpServerSettingsConfirmCommandParamTypeId).toBool());
+        tcpServer->setFraming(framingFromSetting(thing->setting(tcpServerSettingsFramingParamTypeId).toString()));
+        tcpServer->setDelimiter(delimiterFromSetting(thing->setting(tcpServerSettingsDelimiterParamTypeId).toString()));
+        tcpServer->setFixedLength(thing->setting(tcpServerSettingsFixedLengthParamTypeId).toInt());
+        tcpServer->setMaxBufferSize(thing->setting(tcpServerSettingsMaxBufferSizeParamTypeId).toInt());
 
         if (tcpServer->isValid()) {
             m_tcpServers.insert(thing, tcpServer);
             connect(thing, &Thing::settingChanged, tcpServer, [=](const ParamTypeId &paramTypeId, const QVariant &value){
                 if (paramTypeId == tcpServerSettingsConfirmCommandParamTypeId) {
                     tcpServer->setConfirmCommands(value.toBool());
+                } else if (paramTypeId == tcpServerSettingsFramingParamTypeId) {
+                    tcpServer->setFraming(framingFromSetting(value.toString()));
+                } else if (paramTypeId == tcpServerSettingsDelimiterParamTypeId) {
+                    tcpServer->setDelimiter(delimiterFromSetting(value.toString()));
+                } else if (paramTypeId == tcpServerSettingsFixedLengthParamTypeId) {
+                    tcpServer->setFixedLength(value.toInt());
+                } else if (paramTypeId == tcpServerSettingsMaxBufferSizeParamTypeId) {
+                    tcpServer->setMaxBufferSize(value.toInt());
+                }
+
+                if (tcpServer->framing() == TcpServer::FramingFixedLength && tcpServer->fixedLength() > tcpServer->maxBufferSize()) {
+                    qCWarning(dcTCPCommander()) << "The fixed command length" << tcpServer->fixedLength() << "exceeds the maximum buffer size" << tcpServer->maxBufferSize() << "- commands can't be completed";
                 }
             });
 
@@ -188,3 +212,63 @@ void IntegrationPluginTcpCommander::onTcpServerCommandReceived(const QString &cl
     params.append(Param(tcpServerTriggeredEventClientIpParamTypeId, clientIp));
     emit emitEvent(Event(tcpServerTriggeredEventTypeId, thing->id(), params));
 }
+
+TcpServer::Framing IntegrationPluginTcpCommander::framingFromSetting(const QString &framing)
+{
+    if (framing == "Newline") {
+        return TcpServer::FramingNewline;
+    } else if (framing == "Delimiter") {
+        return TcpServer::FramingDelimiter;
+    } else if (framing == "Fixed length") {
+        return TcpServer::FramingFixedLength;
+    } else if (framing == "Length prefix (16 bit)") {
+        return TcpServer::FramingLengthPrefix16;
+    } else if (framing == "Length prefix (32 bit)") {
+        return TcpServer::FramingLengthPrefix32;
+    }
+    return TcpServer::FramingNone;
+}
+
+QByteArray IntegrationPluginTcpCommander::delimiterFromSetting(const QString &delimiter)
+{
+    // Allow entering non printable delimiters as escape sequences, e.g. "\r\n" or "\x03"
+    QByteArray input = delimiter.toUtf8();
+    QByteArray result;
+    for (int i = 0; i < input.length(); i++) {
+        if (input.at(i) != '\\' || i + 1 >= input.length()) {
+            result.append(input.at(i));
+            continue;
+        }
+        char escaped = input.at(++i);
+        switch (escaped) {
+        case 'n':
+            result.append('\n');
+            break;
+        case 'r':
+            result.append('\r');
+            break;
+        case 't':
+            result.append('\t');
+            break;
+        case '0':
+            result.append('\0');
+            break;
+        case 'x':
+            if (i + 2 < input.length()) {
+                bool ok = false;
+                char value = static_cast<char>(input.mid(i + 1, 2).toInt(&ok, 16));
+                if (ok) {
+                    result.append(value);
+                    i += 2;
+                    break;
+                }
+            }
+            result.append("\\x");
+            break;
+        default:
+            result.append(escaped);
+            break;
+        }
+    }
+    return result;
+}
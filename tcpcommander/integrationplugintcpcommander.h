@@ -54,6 +54,9 @@ private:
     QHash<Thing*, QTcpSocket*> m_tcpSockets;
     QHash<Thing*, TcpServer*> m_tcpServers;
 
+    static TcpServer::Framing framingFromSetting(const QString &framing);
+    static QByteArray delimiterFromSetting(const QString &delimiter);
+
 private slots:
     void onTcpSocketConnectionChanged(bool connected);
 
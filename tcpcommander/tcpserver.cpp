@@ -31,6 +31,7 @@
 #include "tcpserver.h"
 #include "extern-plugininfo.h"
 #include <QNetworkInterface>
+#include <QtEndian>
 
 
 TcpServer::TcpServer(const QHostAddress address, const quint16 &port, QObject *parent) :
@@ -76,6 +77,60 @@ void TcpServer::setConfirmCommands(bool confirmCommands)
     m_confirmCommands = confirmCommands;
 }
 
+TcpServer::Framing TcpServer::framing() const
+{
+    return m_framing;
+}
+
+void TcpServer::setFraming(Framing framing)
+{
+    m_framing = framing;
+    // Partial commands received with the old framing can't be interpreted any more
+    foreach (QTcpSocket *client, m_clients) {
+        m_buffers[client].clear();
+    }
+}
+
+QByteArray TcpServer::delimiter() const
+{
+    return m_delimiter;
+}
+
+void TcpServer::setDelimiter(const QByteArray &delimiter)
+{
+    if (delimiter.isEmpty()) {
+        qCWarning(dcTCPCommander()) << "Empty delimiter given, using \\n";
+        m_delimiter = "\n";
+        return;
+    }
+    m_delimiter = delimiter;
+}
+
+int TcpServer::fixedLength() const
+{
+    return m_fixedLength;
+}
+
+void TcpServer::setFixedLength(int fixedLength)
+{
+    m_fixedLength = qMax(1, fixedLength);
+}
+
+int TcpServer::maxBufferSize() const
+{
+    return m_maxBufferSize;
+}
+
+void TcpServer::setMaxBufferSize(int maxBufferSize)
+{
+    m_maxBufferSize = maxBufferSize;
+    // Limit what Qt reads from the kernel at once, so a flooding client
+    // is throttled by the TCP window instead of growing our memory.
+    foreach (QTcpSocket *client, m_clients) {
+        client->setReadBufferSize(m_maxBufferSize);
+    }
+}
+
 QHostAddress TcpServer::serverAddress()
 {
     return m_tcpServer->serverAddress();
@@ -117,7 +172,9 @@ void TcpServer::newConnection()
     QTcpSocket *socket = m_tcpServer->nextPendingConnection();
     socket->flush();
 
+    socket->setReadBufferSize(m_maxBufferSize);
     m_clients.append(socket);
+    m_buffers.insert(socket, QByteArray());
     emit connectionCountChanged(m_clients.count());
     connect(socket, &QTcpSocket::disconnected, this, &TcpServer::onDisconnected);
     connect(socket, &QTcpSocket::readyRead, this, &TcpServer::readData);
@@ -130,7 +187,9 @@ void TcpServer::onDisconnected()
     QTcpSocket *client = qobject_cast<QTcpSocket*>(sender());
     qDebug(dcTCPCommander()) << "TCP client disconnected";
     m_clients.removeAll(client);
+    m_buffers.remove(client);
     emit connectionCountChanged(m_clients.count());
+    client->deleteLater();
 }
 
 void TcpServer::readData()
@@ -138,11 +197,107 @@ void TcpServer::readData()
     QTcpSocket *socket = static_cast<QTcpSocket *>(sender());
     QByteArray data = socket->readAll();
     qDebug(dcTCPCommander()) << "TCP Server data received: " << data;
+
+    if (m_framing == FramingNone) {
+        processCommand(socket, data);
+        return;
+    }
+
+    QByteArray &buffer = m_buffers[socket];
+    buffer.append(data);
+
+    // Commands are cut from the front of the buffer in place, the remainder
+    // is moved only once per read
+    int position = 0;
+    QByteArray command;
+    QByteArray remaining = QByteArray::fromRawData(buffer.constData(), buffer.size());
+    while (takeCommand(&remaining, &command)) {
+        position = buffer.size() - remaining.size();
+        processCommand(socket, command);
+        if (!m_buffers.contains(socket)) {
+            // Client has been disconnected meanwhile
+            return;
+        }
+    }
+    buffer.remove(0, position);
+
+    if (buffer.size() > m_maxBufferSize) {
+        qCWarning(dcTCPCommander()) << "Client" << socket->peerAddress().toString() << "exceeded the maximum buffer size of" << m_maxBufferSize << "bytes without completing a command. Dropping connection.";
+        buffer.clear();
+        socket->abort();
+    }
+}
+
+bool TcpServer::takeCommand(QByteArray *buffer, QByteArray *command) const
+{
+    switch (m_framing) {
+    case FramingNone:
+        if (buffer->isEmpty()) {
+            return false;
+        }
+        *command = *buffer;
+        buffer->clear();
+        return true;
+    case FramingNewline: {
+        int index = buffer->indexOf('\n');
+        if (index < 0) {
+            return false;
+        }
+        // Accept both \n and \r\n line endings
+        int length = index > 0 && buffer->at(index - 1) == '\r' ? index - 1 : index;
+        *command = QByteArray(buffer->constData(), length);
+        *buffer = QByteArray::fromRawData(buffer->constData() + index + 1, buffer->size() - index - 1);
+        return true;
+    }
+    case FramingDelimiter: {
+        int index = buffer->indexOf(m_delimiter);
+        if (index < 0) {
+            return false;
+        }
+        *command = QByteArray(buffer->constData(), index);
+        int end = index + m_delimiter.size();
+        *buffer = QByteArray::fromRawData(buffer->constData() + end, buffer->size() - end);
+        return true;
+    }
+    case FramingFixedLength:
+        if (buffer->size() < m_fixedLength) {
+            return false;
+        }
+        *command = QByteArray(buffer->constData(), m_fixedLength);
+        *buffer = QByteArray::fromRawData(buffer->constData() + m_fixedLength, buffer->size() - m_fixedLength);
+        return true;
+    case FramingLengthPrefix16:
+    case FramingLengthPrefix32: {
+        // Big endian length prefix, not including the prefix itself
+        int prefixSize = m_framing == FramingLengthPrefix16 ? 2 : 4;
+        if (buffer->size() < prefixSize) {
+            return false;
+        }
+        const uchar *prefix = reinterpret_cast<const uchar *>(buffer->constData());
+        quint32 length = prefixSize == 2 ? qFromBigEndian<quint16>(prefix) : qFromBigEndian<quint32>(prefix);
+        if (length > static_cast<quint32>(m_maxBufferSize)) {
+            // Can never be completed, let the buffer limit drop the client
+            return false;
+        }
+        if (static_cast<quint32>(buffer->size() - prefixSize) < length) {
+            return false;
+        }
+        *command = QByteArray(buffer->constData() + prefixSize, length);
+        int end = prefixSize + length;
+        *buffer = QByteArray::fromRawData(buffer->constData() + end, buffer->size() - end);
+        return true;
+    }
+    }
+    return false;
+}
+
+void TcpServer::processCommand(QTcpSocket *socket, const QByteArray &command)
+{
     if (m_confirmCommands) {
         socket->write("OK\n");
     }
 
-    emit commandReceived(socket->peerAddress().toString(), data);
+    emit commandReceived(socket->peerAddress().toString(), command);
 }
 
 void TcpServer::onError(QAbstractSocket::SocketError error)
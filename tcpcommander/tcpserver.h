@@ -34,11 +34,22 @@
 #include <QObject>
 #include <QTcpSocket>
 #include <QTcpServer>
+#include <QHash>
 
 class TcpServer : public QObject
 {
     Q_OBJECT
 public:
+    enum Framing {
+        FramingNone,
+        FramingNewline,
+        FramingDelimiter,
+        FramingFixedLength,
+        FramingLengthPrefix16,
+        FramingLengthPrefix32
+    };
+    Q_ENUM(Framing)
+
     explicit TcpServer(const QHostAddress address, const quint16 &port, QObject *parent = nullptr);
     explicit TcpServer(const quint16 &port, QObject *parent = nullptr);
     ~TcpServer();
@@ -52,6 +63,18 @@ public:
     bool confirmCommands() const;
     void setConfirmCommands(bool confirmCommands);
 
+    Framing framing() const;
+    void setFraming(Framing framing);
+
+    QByteArray delimiter() const;
+    void setDelimiter(const QByteArray &delimiter);
+
+    int fixedLength() const;
+    void setFixedLength(int fixedLength);
+
+    int maxBufferSize() const;
+    void setMaxBufferSize(int maxBufferSize);
+
     int connectionCount() const;
 
     bool sendCommand(const QString &clientIp, const QByteArray &data);
@@ -70,7 +93,15 @@ private slots:
 private:
     QTcpServer *m_tcpServer = nullptr;
     bool m_confirmCommands = false;
+    Framing m_framing = FramingNone;
+    QByteArray m_delimiter = "\r\n";
+    int m_fixedLength = 8;
+    int m_maxBufferSize = 65536;
     QList<QTcpSocket*> m_clients;
+    QHash<QTcpSocket*, QByteArray> m_buffers;
+
+    bool takeCommand(QByteArray *buffer, QByteArray *command) const;
+    void processCommand(QTcpSocket *socket, const QByteArray &command);
 
 };
 
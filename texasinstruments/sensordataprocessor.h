@@ -73,8 +73,8 @@ private:
     bool m_magnetDetected = false;
 
     // Log sensor data for debugging filters
-    // Note: set this to true for enable sensor filter logging
-    bool m_filterDebug = true;
+    // Note: set this to true for enable sensor filter logging into /tmp/multisensor.log
+    bool m_filterDebug = false;
     QFile *m_logFile = nullptr;
 
     SensorFilter *m_temperatureFilter = nullptr;
@@ -36,7 +36,8 @@ SensorFilter::SensorFilter(Type filterType, QObject *parent) :
     QObject(parent),
     m_filterType(filterType)
 {
-
+    m_inputData.resize(static_cast<int>(m_filterWindowSize));
+    m_outputData.resize(static_cast<int>(m_filterWindowSize));
 }
 
 float SensorFilter::filterValue(float value)
@@ -56,19 +57,24 @@ float SensorFilter::filterValue(float value)
         break;
     }
 
+    m_lastInput = value;
+    m_lastOutput = resultValue;
     return resultValue;
 }
 
 bool SensorFilter::isReady() const
 {
     // Note: filter is ready once 10% of window filled
-    return m_inputData.size() >= m_filterWindowSize * 0.1;
+    return m_count >= m_filterWindowSize * 0.1;
 }
 
 void SensorFilter::reset()
 {
     m_averageSum = 0;
-    m_inputData.clear();
+    m_lastInput = 0;
+    m_lastOutput = 0;
+    m_head = 0;
+    m_count = 0;
 }
 
 SensorFilter::Type SensorFilter::filterType() const
@@ -78,12 +84,12 @@ SensorFilter::Type SensorFilter::filterType() const
 
 QVector<float> SensorFilter::inputData() const
 {
-    return m_inputData;
+    return orderedData(m_inputData);
 }
 
 QVector<float> SensorFilter::outputData() const
 {
-    return m_outputData;
+    return orderedData(m_outputData);
 }
 
 uint SensorFilter::windowSize() const
@@ -94,7 +100,13 @@ uint SensorFilter::windowSize() const
 void SensorFilter::setFilterWindowSize(uint windowSize)
 {
     Q_ASSERT_X(windowSize > 0, "value out of range", "The filter window size must be bigger than 0");
+    if (m_filterWindowSize == windowSize)
+        return;
+
     m_filterWindowSize = windowSize;
+    m_inputData.resize(static_cast<int>(m_filterWindowSize));
+    m_outputData.resize(static_cast<int>(m_filterWindowSize));
+    reset();
 }
 
 float SensorFilter::lowPassAlpha() const
@@ -119,68 +131,77 @@ void SensorFilter::setHighPassAlpha(float alpha)
     m_highPassAlpha = alpha;
 }
 
-void SensorFilter::addInputValue(float value)
+QVector<float> SensorFilter::orderedData(const QVector<float> &ringBuffer) const
 {
-    m_inputData.append(value);
-    if (static_cast<uint>(m_inputData.size()) > m_filterWindowSize) {
-        m_inputData.removeFirst();
+    QVector<float> data;
+    data.reserve(m_count);
+    int index = (m_head - m_count + ringBuffer.size()) % ringBuffer.size();
+    for (int i = 0; i < m_count; i++) {
+        data.append(ringBuffer.at(index));
+        index = (index + 1) % ringBuffer.size();
     }
+    return data;
 }
 
-float SensorFilter::lowPassFilterValue(float value)
+float SensorFilter::addValue(float input, float output)
 {
-    addInputValue(value);
-
-    // Check if we have enough data for filtering
-    if (m_inputData.size() < 2) {
-        return value;
+    // Returns the input value which dropped out of the window, 0 if the window was not full yet
+    float droppedValue = 0;
+    if (static_cast<uint>(m_count) >= m_filterWindowSize) {
+        droppedValue = m_inputData.at(m_head);
+    } else {
+        m_count++;
     }
 
-    QVector<float> outputData;
-    outputData.append(m_inputData.at(0));
-    for (int i = 1; i < m_inputData.size(); i++) {
-        // y[i] := y[i-1] + α * (x[i] - y[i-1])
-        outputData.append(outputData.at(i - 1) + m_lowPassAlpha * (m_inputData.at(i) - outputData.at(i - 1)));
-    }
+    m_inputData[m_head] = input;
+    m_outputData[m_head] = output;
+    m_head = (m_head + 1) % m_inputData.size();
+    return droppedValue;
+}
 
-    m_outputData = outputData;
+float SensorFilter::lowPassFilterValue(float value)
+{
+    // Seed the filter with the first value
+    if (m_count == 0) {
+        addValue(value, value);
+        return value;
+    }
 
-    return m_outputData.last();
+    // y[i] := y[i-1] + α * (x[i] - y[i-1])
+    float output = m_lastOutput + m_lowPassAlpha * (value - m_lastOutput);
+    addValue(value, output);
+    return output;
 }
 
 float SensorFilter::highPassFilterValue(float value)
 {
-    addInputValue(value);
-
-    // Check if we have enough data for filtering
-    if (m_inputData.size() < 2) {
+    // Seed the filter with the first value
+    if (m_count == 0) {
+        addValue(value, value);
         return value;
     }
 
-    QVector<float> outputData;
-    outputData.append(m_inputData.at(0));
-    for (int i = 1; i < m_inputData.size(); i++) {
-        // y[i] := α * y[i-1] + α * (x[i] - x[i-1])
-        outputData.append(m_highPassAlpha * outputData.at(i - 1) + m_highPassAlpha * (m_inputData.at(i) - m_inputData.at(i - 1)));
-    }
-
-    m_outputData = outputData;
-    return m_outputData.last();
+    // y[i] := α * y[i-1] + α * (x[i] - x[i-1])
+    float output = m_highPassAlpha * m_lastOutput + m_highPassAlpha * (value - m_lastInput);
+    addValue(value, output);
+    return output;
 }
 
 float SensorFilter::averageFilterValue(float value)
 {
-    if (m_inputData.isEmpty()) {
-        addInputValue(value);
-        m_averageSum = value;
-        return value;
-    }
+    // Note: the output is stored once the mean is known, the dropped input is removed from the running sum
+    int index = m_head;
+    m_averageSum += value - addValue(value, 0);
 
-    if (static_cast<uint>(m_inputData.size()) >= m_filterWindowSize) {
-        m_averageSum -= m_inputData.takeFirst();
+    // Rebuild the running sum once per window cycle to prevent accumulating float rounding errors
+    if (m_head == 0 && static_cast<uint>(m_count) >= m_filterWindowSize) {
+        m_averageSum = 0;
+        for (int i = 0; i < m_count; i++) {
+            m_averageSum += m_inputData.at(i);
+        }
     }
 
-    addInputValue(value);
-    m_averageSum += value;
-    return m_averageSum / m_inputData.size();
+    float output = m_averageSum / m_count;
+    m_outputData[index] = output;
+    return output;
 }
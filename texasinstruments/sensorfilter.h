@@ -73,12 +73,19 @@ private:
     float m_lowPassAlpha = 0.2f;
     float m_highPassAlpha = 0.2f;
 
+    // Recursive filter state
     float m_averageSum = 0;
+    float m_lastInput = 0;
+    float m_lastOutput = 0;
 
+    // Fixed size ring buffers holding the last windowSize values
     QVector<float> m_inputData;
     QVector<float> m_outputData;
+    int m_head = 0;
+    int m_count = 0;
 
-    void addInputValue(float value);
+    QVector<float> orderedData(const QVector<float> &ringBuffer) const;
+    float addValue(float input, float output);
 
     // Filter methods
     float lowPassFilterValue(float value);
@@ -44,17 +44,36 @@ void IntegrationPluginUdpCommander::setupThing(ThingSetupInfo *info)
     qCDebug(dcUdpCommander()) << "Setup thing" << thing->name() << thing->params();
 
     if (thing->thingClassId() == udpReceiverThingClassId) {
-        QUdpSocket *udpSocket = new QUdpSocket(this);
+        UdpReceiver *receiver = new UdpReceiver(this);
         int port = thing->paramValue(udpReceiverThingPortParamTypeId).toInt();
-        if (!udpSocket->bind(QHostAddress::Any, port, QUdpSocket::ShareAddress)) {
+        if (!receiver->bind(port)) {
             qCWarning(dcUdpCommander()) << thing->name() << "cannot bind to port" << port;
-            delete udpSocket;
+            delete receiver;
             return info->finish(Thing::ThingErrorHardwareNotAvailable, QT_TR_NOOP("Error opening UDP port."));
         }
         qCDebug(dcUdpCommander()) << "Listening on port" << port;
 
-        connect(udpSocket, SIGNAL(readyRead()), this, SLOT(readPendingDatagrams()));
-        m_receiverList.insert(udpSocket, thing);
+        receiver->setSendReply(thing->setting(udpReceiverSettingsSendReplyParamTypeId).toBool());
+        receiver->setRateLimit(thing->setting(udpReceiverSettingsRateLimitParamTypeId).toInt());
+        receiver->setSuppressDuplicates(thing->setting(udpReceiverSettingsSuppressDuplicatesParamTypeId).toBool());
+        connect(thing, &Thing::settingChanged, receiver, [receiver](const ParamTypeId &paramTypeId, const QVariant &value){
+            if (paramTypeId == udpReceiverSettingsSendReplyParamTypeId) {
+                receiver->setSendReply(value.toBool());
+            } else if (paramTypeId == udpReceiverSettingsRateLimitParamTypeId) {
+                receiver->setRateLimit(value.toInt());
+            } else if (paramTypeId == udpReceiverSettingsSuppressDuplicatesParamTypeId) {
+                receiver->setSuppressDuplicates(value.toBool());
+            }
+        });
+
+        connect(receiver, &UdpReceiver::datagramReceived, this, &IntegrationPluginUdpCommander::onDatagramReceived);
+        m_receiverList.insert(receiver, thing);
+
+        if (!m_statisticsTimer) {
+            m_statisticsTimer = hardwareManager()->pluginTimerManager()->registerTimer(5);
+            connect(m_statisticsTimer, &PluginTimer::timeout, this, &IntegrationPluginUdpCommander::updateStatistics);
+            m_statisticsClock.start();
+        }
 
         return info->finish(Thing::ThingErrorNoError);
     } else if (thing->thingClassId() == udpCommanderThingClassId) {
@@ -85,10 +104,16 @@ void IntegrationPluginUdpCommander::executeAction(ThingActionInfo *info)
 void IntegrationPluginUdpCommander::thingRemoved(Thing *thing)
 {
     if (thing->thingClassId() == udpReceiverThingClassId) {
-        QUdpSocket *socket = m_receiverList.key(thing);
-        m_receiverList.remove(socket);
-        socket->close();
-        socket->deleteLater();
+        UdpReceiver *receiver = m_receiverList.key(thing);
+        m_receiverList.remove(receiver);
+        m_lastReceivedCount.remove(receiver);
+        receiver->close();
+        receiver->deleteLater();
+
+        if (m_receiverList.isEmpty()) {
+            hardwareManager()->pluginTimerManager()->unregisterTimer(m_statisticsTimer);
+            m_statisticsTimer = nullptr;
+        }
 
     } else if (thing->thingClassId() == udpCommanderThingClassId) {
         QUdpSocket *socket = m_commanderList.key(thing);
@@ -98,34 +123,36 @@ void IntegrationPluginUdpCommander::thingRemoved(Thing *thing)
     }
 }
 
-void IntegrationPluginUdpCommander::readPendingDatagrams()
+void IntegrationPluginUdpCommander::onDatagramReceived(const QByteArray &datagram, const QHostAddress &senderAddress, quint16 senderPort)
 {
-    qCDebug(dcUdpCommander()) << "UDP datagram received";
-    QUdpSocket *socket= static_cast<QUdpSocket *>(sender());
-    Thing *thing = m_receiverList.value(socket);
+    UdpReceiver *receiver = static_cast<UdpReceiver *>(sender());
+    Thing *thing = m_receiverList.value(receiver);
 
     if (!thing) {
         qCWarning(dcUdpCommander()) << "Received a datagram from a socket we don't know";
         return;
     }
 
-    QByteArray datagram;
-    QHostAddress sender;
-    quint16 senderPort = 0;
+    qCDebug(dcUdpCommander()) << "Incoming datatram" << datagram << "on" << thing->name() << "from" << senderAddress.toString() << senderPort;
 
-    while (socket->hasPendingDatagrams()) {
-        datagram.resize(socket->pendingDatagramSize());
-        socket->readDatagram(datagram.data(), datagram.size(), &sender, &senderPort);
-        qCDebug(dcUdpCommander()) << "Incoming datatram" << datagram << "on" << thing->name() << "from" << sender.toString() << senderPort;
-
-        Event ev = Event(udpReceiverTriggeredEventTypeId, thing->id());
-        ParamList params;
-        params.append(Param(udpReceiverTriggeredEventDataParamTypeId, datagram));
-        ev.setParams(params);
-        emit emitEvent(ev);
+    Event ev = Event(udpReceiverTriggeredEventTypeId, thing->id());
+    ParamList params;
+    params.append(Param(udpReceiverTriggeredEventDataParamTypeId, datagram));
+    ev.setParams(params);
+    emit emitEvent(ev);
+}
 
-        // Send response for verification
-        socket->writeDatagram("OK\n", sender, senderPort);
+void IntegrationPluginUdpCommander::updateStatistics()
+{
+    double seconds = m_statisticsClock.restart() / 1000.0;
+    foreach (UdpReceiver *receiver, m_receiverList.keys()) {
+        Thing *thing = m_receiverList.value(receiver);
+        quint64 received = receiver->receivedCount();
+        if (seconds > 0) {
+            thing->setStateValue(udpReceiverPacketsPerSecondStateTypeId, (received - m_lastReceivedCount.value(receiver)) / seconds);
+        }
+        m_lastReceivedCount.insert(receiver, received);
+        thing->setStateValue(udpReceiverDroppedPacketsStateTypeId, static_cast<uint>(receiver->droppedCount()));
+        thing->setStateValue(udpReceiverDuplicatePacketsStateTypeId, static_cast<uint>(receiver->duplicateCount()));
     }
-
 }
@@ -32,10 +32,13 @@
 #define INTEGRATIONPLUGINUDPCOMMANDER_H
 
 #include "integrations/integrationplugin.h"
+#include "plugintimer.h"
+#include "udpreceiver.h"
 
 #include <QHash>
 #include <QDebug>
 #include <QUdpSocket>
+#include <QElapsedTimer>
 
 class IntegrationPluginUdpCommander : public IntegrationPlugin
 {
@@ -52,11 +55,16 @@ public:
     void executeAction(ThingActionInfo *info) override;
 
 private:
-    QHash<QUdpSocket *, Thing *> m_receiverList;
+    QHash<UdpReceiver *, Thing *> m_receiverList;
     QHash<QUdpSocket *, Thing *> m_commanderList;
 
+    PluginTimer *m_statisticsTimer = nullptr;
+    QHash<UdpReceiver *, quint64> m_lastReceivedCount;
+    QElapsedTimer m_statisticsClock;
+
 private slots:
-    void readPendingDatagrams();
+    void onDatagramReceived(const QByteArray &datagram, const QHostAddress &senderAddress, quint16 senderPort);
+    void updateStatistics();
 
 };
 
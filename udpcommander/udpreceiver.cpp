@@ -0,0 +1,291 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+*
+* Copyright 2013 - 2020, nymea GmbH
+* Contact: contact@nymea.io
+*
+* This file is part of nymea.
+* This project including source code and documentation is protected by
+* copyright law, and remains the property of nymea GmbH. All rights, including
+* reproduction, publication, editing and translation, are reserved. The use of
+* this project is subject to the terms of a license agreement to be concluded
+* with nymea GmbH in accordance with the terms of use of nymea GmbH, available
+* under https://nymea.io/license
+*
+* GNU Lesser General Public License Usage
+* Alternatively, this project may be redistributed and/or modified under the
+* terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; version 3. This project is distributed in the hope that
+* it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+* warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this project. If not, see <https://www.gnu.org/licenses/>.
+*
+* For any further details and any questions please contact us under
+* contact@nymea.io or see our FAQ/Licensing Information on
+* https://nymea.io/license/faq
+*
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "udpreceiver.h"
+#include "extern-plugininfo.h"
+
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <unistd.h>
+#include <string.h>
+#include <errno.h>
+
+#define BATCH_SIZE 32
+// Largest possible UDP payload, QUdpSocket delivered datagrams of any size as well
+#define MAX_DATAGRAM_SIZE 65535
+// Give other event sources a chance while a sender is flooding us
+#define MAX_BATCHES_PER_NOTIFICATION 16
+#define SENDER_TIMEOUT 60000
+#define PRUNE_INTERVAL 10000
+
+UdpReceiver::UdpReceiver(QObject *parent) : QObject(parent)
+{
+    m_buffers.resize(BATCH_SIZE * MAX_DATAGRAM_SIZE);
+    m_clock.start();
+}
+
+UdpReceiver::~UdpReceiver()
+{
+    close();
+}
+
+bool UdpReceiver::bind(quint16 port)
+{
+    close();
+
+    // Dual stack socket, equivalent to QHostAddress::Any
+    bool ipv6 = true;
+    m_socket = socket(AF_INET6, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (m_socket < 0) {
+        ipv6 = false;
+        m_socket = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    }
+    if (m_socket < 0) {
+        qCWarning(dcUdpCommander()) << "Cannot create UDP socket:" << strerror(errno);
+        return false;
+    }
+
+    // Equivalent to QUdpSocket::ShareAddress
+    int on = 1;
+    setsockopt(m_socket, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+
+    int ret;
+    if (ipv6) {
+        int off = 0;
+        setsockopt(m_socket, IPPROTO_IPV6, IPV6_V6ONLY, &off, sizeof(off));
+        struct sockaddr_in6 address;
+        memset(&address, 0, sizeof(address));
+        address.sin6_family = AF_INET6;
+        address.sin6_addr = in6addr_any;
+        address.sin6_port = htons(port);
+        ret = ::bind(m_socket, reinterpret_cast<struct sockaddr *>(&address), sizeof(address));
+    } else {
+        struct sockaddr_in address;
+        memset(&address, 0, sizeof(address));
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_ANY);
+        address.sin_port = htons(port);
+        ret = ::bind(m_socket, reinterpret_cast<struct sockaddr *>(&address), sizeof(address));
+    }
+    if (ret < 0) {
+        qCWarning(dcUdpCommander()) << "Cannot bind UDP socket to port" << port << strerror(errno);
+        ::close(m_socket);
+        m_socket = -1;
+        return false;
+    }
+
+    m_notifier = new QSocketNotifier(m_socket, QSocketNotifier::Read, this);
+    connect(m_notifier, &QSocketNotifier::activated, this, &UdpReceiver::onReadyRead);
+    return true;
+}
+
+void UdpReceiver::close()
+{
+    if (m_notifier) {
+        delete m_notifier;
+        m_notifier = nullptr;
+    }
+    if (m_socket >= 0) {
+        ::close(m_socket);
+        m_socket = -1;
+    }
+    m_senders.clear();
+}
+
+bool UdpReceiver::sendReply() const
+{
+    return m_sendReply;
+}
+
+void UdpReceiver::setSendReply(bool sendReply)
+{
+    m_sendReply = sendReply;
+}
+
+int UdpReceiver::rateLimit() const
+{
+    return m_rateLimit;
+}
+
+void UdpReceiver::setRateLimit(int rateLimit)
+{
+    m_rateLimit = qMax(0, rateLimit);
+}
+
+bool UdpReceiver::suppressDuplicates() const
+{
+    return m_suppressDuplicates;
+}
+
+void UdpReceiver::setSuppressDuplicates(bool suppressDuplicates)
+{
+    m_suppressDuplicates = suppressDuplicates;
+    if (!m_suppressDuplicates) {
+        for (auto it = m_senders.begin(); it != m_senders.end(); ++it) {
+            it->lastPayload.clear();
+        }
+    }
+}
+
+quint64 UdpReceiver::receivedCount() const
+{
+    return m_receivedCount;
+}
+
+quint64 UdpReceiver::droppedCount() const
+{
+    return m_droppedCount;
+}
+
+quint64 UdpReceiver::duplicateCount() const
+{
+    return m_duplicateCount;
+}
+
+void UdpReceiver::onReadyRead()
+{
+    struct mmsghdr messages[BATCH_SIZE];
+    struct iovec iovecs[BATCH_SIZE];
+    struct sockaddr_storage addresses[BATCH_SIZE];
+    char *buffers = m_buffers.data();
+
+    for (int batch = 0; batch < MAX_BATCHES_PER_NOTIFICATION && m_socket >= 0; batch++) {
+        memset(messages, 0, sizeof(messages));
+        for (int i = 0; i < BATCH_SIZE; i++) {
+            iovecs[i].iov_base = buffers + i * MAX_DATAGRAM_SIZE;
+            iovecs[i].iov_len = MAX_DATAGRAM_SIZE;
+            messages[i].msg_hdr.msg_iov = &iovecs[i];
+            messages[i].msg_hdr.msg_iovlen = 1;
+            messages[i].msg_hdr.msg_name = &addresses[i];
+            messages[i].msg_hdr.msg_namelen = sizeof(addresses[i]);
+        }
+
+        int count = recvmmsg(m_socket, messages, BATCH_SIZE, MSG_DONTWAIT, nullptr);
+        if (count < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                qCWarning(dcUdpCommander()) << "Error reading from UDP socket:" << strerror(errno);
+            }
+            break;
+        }
+
+        for (int i = 0; i < count && m_socket >= 0; i++) {
+            m_receivedCount++;
+            const char *data = buffers + i * MAX_DATAGRAM_SIZE;
+            int length = static_cast<int>(messages[i].msg_len);
+            if (messages[i].msg_hdr.msg_flags & MSG_TRUNC) {
+                qCDebug(dcUdpCommander()) << "Dropping datagram exceeding" << MAX_DATAGRAM_SIZE << "bytes";
+                m_droppedCount++;
+                continue;
+            }
+
+            struct sockaddr *senderAddress = reinterpret_cast<struct sockaddr *>(&addresses[i]);
+            QHostAddress sender(senderAddress);
+            quint16 senderPort = 0;
+            if (senderAddress->sa_family == AF_INET6) {
+                senderPort = ntohs(reinterpret_cast<struct sockaddr_in6 *>(senderAddress)->sin6_port);
+                // Show IPv4 clients on the dual stack socket as plain IPv4
+                bool isIPv4 = false;
+                quint32 ipv4Address = sender.toIPv4Address(&isIPv4);
+                if (isIPv4) {
+                    sender = QHostAddress(ipv4Address);
+                }
+            } else {
+                senderPort = ntohs(reinterpret_cast<struct sockaddr_in *>(senderAddress)->sin_port);
+            }
+
+            if (!acceptDatagram(sender, data, length)) {
+                continue;
+            }
+
+            if (m_sendReply) {
+                // Send response for verification
+                sendto(m_socket, "OK\n", 3, MSG_DONTWAIT, senderAddress, messages[i].msg_hdr.msg_namelen);
+            }
+
+            emit datagramReceived(QByteArray(data, length), sender, senderPort);
+        }
+
+        if (count < BATCH_SIZE) {
+            // Socket is drained
+            break;
+        }
+    }
+
+    pruneSenders();
+}
+
+bool UdpReceiver::acceptDatagram(const QHostAddress &sender, const char *data, int length)
+{
+    qint64 now = m_clock.elapsed();
+    SenderInfo &info = m_senders[sender];
+    info.lastSeen = now;
+
+    // Duplicates are checked first so they don't use up the rate limit
+    if (m_suppressDuplicates && info.lastPayload.size() == length && memcmp(info.lastPayload.constData(), data, length) == 0) {
+        m_duplicateCount++;
+        return false;
+    }
+
+    if (m_rateLimit > 0) {
+        if (now - info.windowStart >= 1000) {
+            info.windowStart = now;
+            info.windowCount = 0;
+        }
+        if (info.windowCount >= m_rateLimit) {
+            m_droppedCount++;
+            return false;
+        }
+        info.windowCount++;
+    }
+
+    if (m_suppressDuplicates) {
+        // Reuses the allocation as long as payloads don't grow
+        info.lastPayload.resize(length);
+        memcpy(info.lastPayload.data(), data, length);
+    }
+    return true;
+}
+
+void UdpReceiver::pruneSenders()
+{
+    qint64 now = m_clock.elapsed();
+    if (now - m_lastPrune < PRUNE_INTERVAL) {
+        return;
+    }
+    m_lastPrune = now;
+
+    for (auto it = m_senders.begin(); it != m_senders.end(); ) {
+        if (now - it->lastSeen > SENDER_TIMEOUT) {
+            it = m_senders.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
@@ -0,0 +1,103 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+*
+* Copyright 2013 - 2020, nymea GmbH
+* Contact: contact@nymea.io
+*
+* This file is part of nymea.
+* This project including source code and documentation is protected by
+* copyright law, and remains the property of nymea GmbH. All rights, including
+* reproduction, publication, editing and translation, are reserved. The use of
+* this project is subject to the terms of a license agreement to be concluded
+* with nymea GmbH in accordance with the terms of use of nymea GmbH, available
+* under https://nymea.io/license
+*
+* GNU Lesser General Public License Usage
+* Alternatively, this project may be redistributed and/or modified under the
+* terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; version 3. This project is distributed in the hope that
+* it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+* warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this project. If not, see <https://www.gnu.org/licenses/>.
+*
+* For any further details and any questions please contact us under
+* contact@nymea.io or see our FAQ/Licensing Information on
+* https://nymea.io/license/faq
+*
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef UDPRECEIVER_H
+#define UDPRECEIVER_H
+
+#include <QObject>
+#include <QHash>
+#include <QHostAddress>
+#include <QElapsedTimer>
+#include <QSocketNotifier>
+
+// Receives datagrams in batches using recvmmsg(). Rate limiting and duplicate
+// suppression are applied on the raw receive buffers, so filtered datagrams
+// never cause any allocation.
+class UdpReceiver : public QObject
+{
+    Q_OBJECT
+public:
+    explicit UdpReceiver(QObject *parent = nullptr);
+    ~UdpReceiver() override;
+
+    bool bind(quint16 port);
+    void close();
+
+    bool sendReply() const;
+    void setSendReply(bool sendReply);
+
+    // Maximum datagrams per second and sender, 0 for unlimited
+    int rateLimit() const;
+    void setRateLimit(int rateLimit);
+
+    bool suppressDuplicates() const;
+    void setSuppressDuplicates(bool suppressDuplicates);
+
+    quint64 receivedCount() const;
+    quint64 droppedCount() const;
+    quint64 duplicateCount() const;
+
+signals:
+    void datagramReceived(const QByteArray &datagram, const QHostAddress &sender, quint16 senderPort);
+
+private slots:
+    void onReadyRead();
+
+private:
+    struct SenderInfo {
+        qint64 windowStart = 0;
+        int windowCount = 0;
+        qint64 lastSeen = 0;
+        QByteArray lastPayload;
+    };
+
+    bool acceptDatagram(const QHostAddress &sender, const char *data, int length);
+    void pruneSenders();
+
+    int m_socket = -1;
+    QSocketNotifier *m_notifier = nullptr;
+
+    // Preallocated receive buffers, reused for every batch
+    QByteArray m_buffers;
+
+    bool m_sendReply = true;
+    int m_rateLimit = 0;
+    bool m_suppressDuplicates = false;
+
+    QElapsedTimer m_clock;
+    qint64 m_lastPrune = 0;
+    QHash<QHostAddress, SenderInfo> m_senders;
+
+    quint64 m_receivedCount = 0;
+    quint64 m_droppedCount = 0;
+    quint64 m_duplicateCount = 0;
+};
+
+#endif // UDPRECEIVER_H
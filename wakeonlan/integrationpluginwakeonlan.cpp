@@ -36,13 +36,20 @@
 #include "network/networkdevicediscovery.h"
 
 #include <QDebug>
+#include <QDateTime>
 #include <QStringList>
-#include <QUdpSocket>
+#include <QTimer>
 
 IntegrationPluginWakeOnLan::IntegrationPluginWakeOnLan()
 {
 }
 
+void IntegrationPluginWakeOnLan::init()
+{
+    // One sender for all things, so waking many devices at once ends up in one batch
+    m_sender = new WakeOnLanSender(this);
+}
+
 void IntegrationPluginWakeOnLan::discoverThings(ThingDiscoveryInfo *info)
 {
     if (!hardwareManager()->networkDeviceDiscovery()->available()) {
@@ -89,22 +96,100 @@ void IntegrationPluginWakeOnLan::discoverThings(ThingDiscoveryInfo *info)
     });
 }
 
+void IntegrationPluginWakeOnLan::setupThing(ThingSetupInfo *info)
+{
+    Thing *thing = info->thing();
+
+    if (!MacAddress(thing->paramValue(wolThingMacParamTypeId).toString()).isValid()) {
+        qCWarning(dcWakeOnLan()) << "The MAC address is not valid" << thing->params();
+        info->finish(Thing::ThingErrorInvalidParameter, QT_TR_NOOP("The MAC address is not valid."));
+        return;
+    }
+
+    if (!WakeOnLanSender::validSecureOnPassword(thing->paramValue(wolThingSecureOnPasswordParamTypeId).toString())) {
+        qCWarning(dcWakeOnLan()) << "The SecureOn password is not valid" << thing->name();
+        info->finish(Thing::ThingErrorInvalidParameter, QT_TR_NOOP("The SecureOn password must consist of 6 bytes written like a MAC address."));
+        return;
+    }
+
+    updateMonitor(thing);
+    connect(thing, &Thing::settingChanged, this, [this, thing](const ParamTypeId &settingId){
+        if (settingId == wolSettingsConfirmWakeupParamTypeId) {
+            updateMonitor(thing);
+        }
+    });
+
+    info->finish(Thing::ThingErrorNoError);
+}
+
 void IntegrationPluginWakeOnLan::executeAction(ThingActionInfo *info)
 {
-    qCDebug(dcWakeOnLan) << "Wake up" << info->thing()->name();
-    wakeup(info->thing()->paramValue(wolThingMacParamTypeId).toString());
-    return info->finish(Thing::ThingErrorNoError);
+    Thing *thing = info->thing();
+    qCDebug(dcWakeOnLan) << "Wake up" << thing->name();
+    m_sender->wakeup(thing->paramValue(wolThingMacParamTypeId).toString(),
+                     thing->paramValue(wolThingSecureOnPasswordParamTypeId).toString(),
+                     thing->setting(wolSettingsPortParamTypeId).toUInt(),
+                     thing->setting(wolSettingsRepeatCountParamTypeId).toInt());
+
+    NetworkDeviceMonitor *monitor = m_monitors.value(thing);
+    if (monitor && !m_pendingWakeups.contains(thing)) {
+        if (monitor->reachable()) {
+            qCDebug(dcWakeOnLan()) << thing->name() << "is already reachable";
+        } else {
+            qint64 startTime = QDateTime::currentMSecsSinceEpoch();
+            m_pendingWakeups.insert(thing, startTime);
+            QTimer::singleShot(thing->setting(wolSettingsConfirmTimeoutParamTypeId).toUInt() * 1000, thing, [this, thing, startTime](){
+                if (m_pendingWakeups.value(thing) != startTime) {
+                    return;
+                }
+                qCWarning(dcWakeOnLan()) << thing->name() << "did not become reachable after sending the magic packet";
+                m_pendingWakeups.remove(thing);
+                emitEvent(Event(wolWakeupTimedOutEventTypeId, thing->id()));
+            });
+        }
+    }
+
+    info->finish(Thing::ThingErrorNoError);
 }
 
-void IntegrationPluginWakeOnLan::wakeup(const QString &macAddress)
+void IntegrationPluginWakeOnLan::thingRemoved(Thing *thing)
 {
-    const char header[] = {char(0xff), char(0xff), char(0xff), char(0xff), char(0xff), char(0xff)};
-    QByteArray packet = QByteArray::fromRawData(header, sizeof(header));
-    for(int i = 0; i < 16; ++i) {
-        packet.append(QByteArray::fromHex(QString(macAddress).remove(':').toLocal8Bit()));
+    m_pendingWakeups.remove(thing);
+    if (m_monitors.contains(thing)) {
+        hardwareManager()->networkDeviceDiscovery()->unregisterMonitor(m_monitors.take(thing));
     }
-    qCDebug(dcWakeOnLan) << "Created magic packet:" << packet.toHex();
-    QUdpSocket udpSocket;
-    udpSocket.writeDatagram(packet.data(), packet.size(), QHostAddress::Broadcast, 9);
 }
 
+void IntegrationPluginWakeOnLan::updateMonitor(Thing *thing)
+{
+    bool confirm = thing->setting(wolSettingsConfirmWakeupParamTypeId).toBool();
+    if (!confirm) {
+        m_pendingWakeups.remove(thing);
+        if (m_monitors.contains(thing)) {
+            hardwareManager()->networkDeviceDiscovery()->unregisterMonitor(m_monitors.take(thing));
+        }
+        return;
+    }
+
+    if (m_monitors.contains(thing)) {
+        return;
+    }
+
+    if (!hardwareManager()->networkDeviceDiscovery()->available()) {
+        qCWarning(dcWakeOnLan()) << "Cannot confirm wake ups of" << thing->name() << "because the network device discovery is not available.";
+        return;
+    }
+
+    NetworkDeviceMonitor *monitor = hardwareManager()->networkDeviceDiscovery()->registerMonitor(MacAddress(thing->paramValue(wolThingMacParamTypeId).toString()));
+    m_monitors.insert(thing, monitor);
+    connect(monitor, &NetworkDeviceMonitor::reachableChanged, thing, [this, thing](bool reachable){
+        qCDebug(dcWakeOnLan()) << "Network device monitor reachable changed for" << thing->name() << reachable;
+        if (!reachable || !m_pendingWakeups.contains(thing)) {
+            return;
+        }
+
+        qint64 latency = QDateTime::currentMSecsSinceEpoch() - m_pendingWakeups.take(thing);
+        qCDebug(dcWakeOnLan()) << thing->name() << "woke up after" << latency << "ms";
+        emitEvent(Event(wolWokeUpEventTypeId, thing->id(), ParamList() << Param(wolWokeUpEventLatencyParamTypeId, latency)));
+    });
+}
@@ -32,8 +32,11 @@
 #define INTEGRATIONPLUGINWAKEONLAN_H
 
 #include "integrations/integrationplugin.h"
+#include "network/networkdevicemonitor.h"
 
-#include <QProcess>
+#include "wakeonlansender.h"
+
+#include <QHash>
 
 class IntegrationPluginWakeOnLan : public IntegrationPlugin
 {
@@ -45,13 +48,20 @@ class IntegrationPluginWakeOnLan : public IntegrationPlugin
 public:
     explicit IntegrationPluginWakeOnLan();
 
+    void init() override;
     void discoverThings(ThingDiscoveryInfo *info) override;
-
+    void setupThing(ThingSetupInfo *info) override;
     void executeAction(ThingActionInfo *info) override;
+    void thingRemoved(Thing *thing) override;
+
+private:
+    WakeOnLanSender *m_sender = nullptr;
 
-private slots:
-    void wakeup(const QString &macAddress);
+    // Used to confirm the wake up
+    QHash<Thing *, NetworkDeviceMonitor *> m_monitors;
+    QHash<Thing *, qint64> m_pendingWakeups;
 
+    void updateMonitor(Thing *thing);
 };
 
 #endif // INTEGRATIONPLUGINWAKEONLAN_H
@@ -5,9 +5,11 @@ TARGET = $$qtLibraryTarget(nymea_integrationpluginwakeonlan)
 QT += network
 
 SOURCES += \
-    integrationpluginwakeonlan.cpp
+    integrationpluginwakeonlan.cpp \
+    wakeonlansender.cpp
 
 HEADERS += \
-    integrationpluginwakeonlan.h
+    integrationpluginwakeonlan.h \
+    wakeonlansender.h
 
 
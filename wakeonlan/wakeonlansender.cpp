@@ -0,0 +1,143 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+*
+* Copyright 2013 - 2020, nymea GmbH
+* Contact: contact@nymea.io
+*
+* This file is part of nymea.
+* This project including source code and documentation is protected by
+* copyright law, and remains the property of nymea GmbH. All rights, including
+* reproduction, publication, editing and translation, are reserved. The use of
+* this project is subject to the terms of a license agreement to be concluded
+* with nymea GmbH in accordance with the terms of use of nymea GmbH, available
+* under https://nymea.io/license
+*
+* GNU Lesser General Public License Usage
+* Alternatively, this project may be redistributed and/or modified under the
+* terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; version 3. This project is distributed in the hope that
+* it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+* warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this project. If not, see <https://www.gnu.org/licenses/>.
+*
+* For any further details and any questions please contact us under
+* contact@nymea.io or see our FAQ/Licensing Information on
+* https://nymea.io/license/faq
+*
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "wakeonlansender.h"
+#include "extern-plugininfo.h"
+
+#include <QNetworkInterface>
+
+// Time between the repeated rounds
+static const int repeatInterval = 200;
+
+WakeOnLanSender::WakeOnLanSender(QObject *parent) :
+    QObject(parent)
+{
+    m_socket = new QUdpSocket(this);
+
+    m_timer = new QTimer(this);
+    m_timer->setSingleShot(true);
+    connect(m_timer, &QTimer::timeout, this, &WakeOnLanSender::sendRound);
+}
+
+bool WakeOnLanSender::validSecureOnPassword(const QString &secureOnPassword)
+{
+    if (secureOnPassword.isEmpty()) {
+        return true;
+    }
+
+    QString password = QString(secureOnPassword).remove(':').remove('-');
+    return password.length() == 12 && QByteArray::fromHex(password.toLatin1()).toHex() == password.toLower().toLatin1();
+}
+
+QByteArray WakeOnLanSender::createMagicPacket(const QString &macAddress, const QString &secureOnPassword)
+{
+    const char header[] = {char(0xff), char(0xff), char(0xff), char(0xff), char(0xff), char(0xff)};
+    QByteArray packet = QByteArray(header, sizeof(header));
+    QByteArray mac = QByteArray::fromHex(QString(macAddress).remove(':').toLocal8Bit());
+    for(int i = 0; i < 16; ++i) {
+        packet.append(mac);
+    }
+    if (!secureOnPassword.isEmpty()) {
+        packet.append(QByteArray::fromHex(QString(secureOnPassword).remove(':').remove('-').toLatin1()));
+    }
+    return packet;
+}
+
+void WakeOnLanSender::wakeup(const QString &macAddress, const QString &secureOnPassword, quint16 port, int repeatCount)
+{
+    // Waking a host which is still being woken up only restarts its rounds
+    for (int i = 0; i < m_jobs.count(); i++) {
+        if (m_jobs.at(i).macAddress == macAddress && m_jobs.at(i).port == port) {
+            m_jobs[i].remaining = qMax(1, repeatCount);
+            return;
+        }
+    }
+
+    Job job;
+    job.macAddress = macAddress;
+    job.packet = createMagicPacket(macAddress, secureOnPassword);
+    job.port = port;
+    job.remaining = qMax(1, repeatCount);
+    qCDebug(dcWakeOnLan) << "Created magic packet:" << job.packet.toHex();
+    m_jobs.append(job);
+
+    if (!m_timer->isActive()) {
+        m_timer->start(0);
+    }
+}
+
+QList<QHostAddress> WakeOnLanSender::broadcastAddresses() const
+{
+    // The limited broadcast only leaves through the default route, send to the directed broadcast of each network instead
+    QList<QHostAddress> addresses;
+    foreach (const QNetworkInterface &networkInterface, QNetworkInterface::allInterfaces()) {
+        if (!networkInterface.flags().testFlag(QNetworkInterface::IsUp) ||
+                !networkInterface.flags().testFlag(QNetworkInterface::IsRunning) ||
+                !networkInterface.flags().testFlag(QNetworkInterface::CanBroadcast) ||
+                networkInterface.flags().testFlag(QNetworkInterface::IsLoopBack)) {
+            continue;
+        }
+
+        foreach (const QNetworkAddressEntry &entry, networkInterface.addressEntries()) {
+            if (entry.ip().protocol() == QAbstractSocket::IPv4Protocol && !entry.broadcast().isNull() && !addresses.contains(entry.broadcast())) {
+                addresses.append(entry.broadcast());
+            }
+        }
+    }
+
+    if (addresses.isEmpty()) {
+        addresses.append(QHostAddress(QHostAddress::Broadcast));
+    }
+    return addresses;
+}
+
+void WakeOnLanSender::sendRound()
+{
+    QList<QHostAddress> addresses = broadcastAddresses();
+    qCDebug(dcWakeOnLan) << "Sending" << m_jobs.count() << "magic packets to" << addresses;
+
+    QMutableListIterator<Job> iterator(m_jobs);
+    while (iterator.hasNext()) {
+        Job &job = iterator.next();
+        foreach (const QHostAddress &address, addresses) {
+            if (m_socket->writeDatagram(job.packet, address, job.port) < 0) {
+                qCWarning(dcWakeOnLan) << "Failed to send magic packet for" << job.macAddress << "to" << address.toString() << m_socket->errorString();
+            }
+        }
+
+        if (--job.remaining <= 0) {
+            iterator.remove();
+        }
+    }
+
+    if (!m_jobs.isEmpty()) {
+        m_timer->start(repeatInterval);
+    }
+}
@@ -0,0 +1,71 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+*
+* Copyright 2013 - 2020, nymea GmbH
+* Contact: contact@nymea.io
+*
+* This file is part of nymea.
+* This project including source code and documentation is protected by
+* copyright law, and remains the property of nymea GmbH. All rights, including
+* reproduction, publication, editing and translation, are reserved. The use of
+* this project is subject to the terms of a license agreement to be concluded
+* with nymea GmbH in accordance with the terms of use of nymea GmbH, available
+* under https://nymea.io/license
+*
+* GNU Lesser General Public License Usage
+* Alternatively, this project may be redistributed and/or modified under the
+* terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; version 3. This project is distributed in the hope that
+* it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+* warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this project. If not, see <https://www.gnu.org/licenses/>.
+*
+* For any further details and any questions please contact us under
+* contact@nymea.io or see our FAQ/Licensing Information on
+* https://nymea.io/license/faq
+*
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef WAKEONLANSENDER_H
+#define WAKEONLANSENDER_H
+
+#include <QObject>
+#include <QTimer>
+#include <QUdpSocket>
+#include <QHostAddress>
+
+class WakeOnLanSender : public QObject
+{
+    Q_OBJECT
+public:
+    explicit WakeOnLanSender(QObject *parent = nullptr);
+
+    // The SecureOn password is optional and consists of 6 bytes written like a MAC address
+    static bool validSecureOnPassword(const QString &secureOnPassword);
+    static QByteArray createMagicPacket(const QString &macAddress, const QString &secureOnPassword = QString());
+
+    // Packets queued within the same event loop run are sent together,
+    // repeatCount rounds to the broadcast address of every network.
+    void wakeup(const QString &macAddress, const QString &secureOnPassword, quint16 port, int repeatCount);
+
+private:
+    struct Job {
+        QString macAddress;
+        QByteArray packet;
+        quint16 port = 9;
+        int remaining = 1;
+    };
+
+    QUdpSocket *m_socket = nullptr;
+    QTimer *m_timer = nullptr;
+    QList<Job> m_jobs;
+
+    QList<QHostAddress> broadcastAddresses() const;
+
+private slots:
+    void sendRound();
+};
+
+#endif // WAKEONLANSENDER_H
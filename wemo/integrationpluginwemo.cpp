@@ -41,6 +41,7 @@
 #include <QXmlStreamReader>
 #include <QXmlStreamWriter>
 #include <QXmlStreamAttributes>
+#include <QDateTime>
 
 IntegrationPluginWemo::IntegrationPluginWemo()
 {
@@ -98,7 +99,13 @@ void IntegrationPluginWemo::discoverThings(ThingDiscoveryInfo *info)
 
 void IntegrationPluginWemo::setupThing(ThingSetupInfo *info)
 {
+    if (!m_eventServer) {
+        m_eventServer = new UpnpEventServer(this);
+        connect(m_eventServer, &UpnpEventServer::notificationReceived, this, &IntegrationPluginWemo::onEventNotificationReceived);
+    }
+
     refresh(info->thing());
+    subscribe(info->thing());
     info->finish(Thing::ThingErrorNoError);
 }
 
@@ -123,15 +130,8 @@ void IntegrationPluginWemo::executeAction(ThingActionInfo *info)
         return;
     }
 
-    QByteArray setPowerMessage("<?xml version=\"1.0\" encoding=\"utf-8\"?><s:Envelope xmlns:s=\"http://schemas.xmlsoap.org/soap/envelope/\" s:encodingStyle=\"http://schemas.xmlsoap.org/soap/encoding/\"><s:Body><u:SetBinaryState xmlns:u=\"urn:Belkin:service:basicevent:1\"><BinaryState>" + QByteArray::number((int)power) + "</BinaryState></u:SetBinaryState></s:Body></s:Envelope>");
-
-    QNetworkRequest request;
-    request.setUrl(QUrl("http://" + thing->paramValue(wemoSwitchThingHostParamTypeId).toString() + ":" + thing->paramValue(wemoSwitchThingPortParamTypeId).toString() + "/upnp/control/basicevent1"));
-    request.setHeader(QNetworkRequest::ContentTypeHeader,QVariant("text/xml; charset=\"utf-8\""));
-    request.setHeader(QNetworkRequest::UserAgentHeader,QVariant("nymea"));
-    request.setRawHeader("SOAPACTION", "\"urn:Belkin:service:basicevent:1#SetBinaryState\"");
-
-    QNetworkReply *reply = hardwareManager()->networkManager()->post(request, setPowerMessage);
+    QNetworkRequest request = createSoapRequest(thing, "SetBinaryState");
+    QNetworkReply *reply = hardwareManager()->networkManager()->post(request, createSoapBody("SetBinaryState", power ? 1 : 0));
 
     connect(reply, &QNetworkReply::finished, reply, &QNetworkReply::deleteLater);
 
@@ -142,10 +142,13 @@ void IntegrationPluginWemo::executeAction(ThingActionInfo *info)
         }
         QByteArray data = reply->readAll();
 
-        if (data.contains("<BinaryState>1</BinaryState>") || data.contains("<BinaryState>0</BinaryState>")) {
+        bool power = false;
+        if (parseBinaryState(data, &power)) {
             info->finish(Thing::ThingErrorNoError);
             info->thing()->setStateValue(wemoSwitchConnectedStateTypeId, true);
-            refresh(info->thing());
+            // The switch reports the change as event
+            if (m_subscriptions.value(info->thing()).sid.isEmpty())
+                refresh(info->thing());
         } else {
             info->finish(Thing::ThingErrorHardwareNotAvailable);
             info->thing()->setStateValue(wemoSwitchConnectedStateTypeId, false);
@@ -164,36 +167,197 @@ void IntegrationPluginWemo::thingRemoved(Thing *thing)
             // Note: delete will be done in networkManagerReplyReady()
         }
     }
+
+    unsubscribe(thing);
+    Subscription subscription = m_subscriptions.take(thing);
+    delete subscription.renewTimer;
+    if (subscription.reply) {
+        // The reply handler finds no subscription any more and does nothing
+        subscription.reply->abort();
+    }
 }
 
 void IntegrationPluginWemo::refresh(Thing *thing)
 {
-    QByteArray getBinarayStateMessage("<?xml version=\"1.0\" encoding=\"utf-8\"?><s:Envelope xmlns:s=\"http://schemas.xmlsoap.org/soap/envelope/\" s:encodingStyle=\"http://schemas.xmlsoap.org/soap/encoding/\"><s:Body><u:GetBinaryState xmlns:u=\"urn:Belkin:service:basicevent:1\"><BinaryState>1</BinaryState></u:GetBinaryState></s:Body></s:Envelope>");
-
-    QNetworkRequest request;
-    request.setUrl(QUrl("http://" + thing->paramValue(wemoSwitchThingHostParamTypeId).toString() + ":" + thing->paramValue(wemoSwitchThingPortParamTypeId).toString() + "/upnp/control/basicevent1"));
-    request.setHeader(QNetworkRequest::ContentTypeHeader,QVariant("text/xml; charset=\"utf-8\""));
-    request.setHeader(QNetworkRequest::UserAgentHeader,QVariant("nymea"));
-    request.setRawHeader("SOAPACTION", "\"urn:Belkin:service:basicevent:1#GetBinaryState\"");
-
-    QNetworkReply *reply = hardwareManager()->networkManager()->post(request, getBinarayStateMessage);
+    QNetworkRequest request = createSoapRequest(thing, "GetBinaryState");
+    QNetworkReply *reply = hardwareManager()->networkManager()->post(request, createSoapBody("GetBinaryState", 1));
     connect(reply, &QNetworkReply::finished, this, &IntegrationPluginWemo::onNetworkReplyFinished);
     m_refreshReplies.insert(reply, thing);
 }
 
 void IntegrationPluginWemo::processRefreshData(const QByteArray &data, Thing *thing)
 {
-    if (data.contains("<BinaryState>0</BinaryState>")) {
-        thing->setStateValue(wemoSwitchPowerStateTypeId, false);
-        thing->setStateValue(wemoSwitchConnectedStateTypeId, true);
-    } else if (data.contains("<BinaryState>1</BinaryState>")) {
-        thing->setStateValue(wemoSwitchPowerStateTypeId, true);
+    bool power = false;
+    if (parseBinaryState(data, &power)) {
+        bool wasConnected = thing->stateValue(wemoSwitchConnectedStateTypeId).toBool();
+        thing->setStateValue(wemoSwitchPowerStateTypeId, power);
         thing->setStateValue(wemoSwitchConnectedStateTypeId, true);
+
+        // A switch which was gone has most likely been power cycled and lost the subscription
+        auto subscription = m_subscriptions.find(thing);
+        if (!wasConnected && subscription != m_subscriptions.end() && !subscription->sid.isEmpty() && !subscription->pending) {
+            qCDebug(dcWemo()) << thing->name() << "is back, subscribing again";
+            subscription->sid.clear();
+            subscribe(thing);
+        }
     } else {
         thing->setStateValue(wemoSwitchConnectedStateTypeId, false);
     }
 }
 
+void IntegrationPluginWemo::subscribe(Thing *thing)
+{
+    Subscription &subscription = m_subscriptions[thing];
+    if (subscription.pending)
+        return;
+
+    if (!subscription.renewTimer) {
+        subscription.renewTimer = new QTimer(this);
+        subscription.renewTimer->setSingleShot(true);
+        connect(subscription.renewTimer, &QTimer::timeout, thing, [this, thing](){
+            subscribe(thing);
+        });
+    }
+
+    QNetworkRequest request(serviceUrl(thing, "/upnp/event/basicevent1"));
+    request.setHeader(QNetworkRequest::UserAgentHeader, QVariant("nymea"));
+    if (subscription.sid.isEmpty()) {
+        QHostAddress host(thing->paramValue(wemoSwitchThingHostParamTypeId).toString());
+        QHostAddress callbackAddress = m_eventServer->callbackAddress(host);
+        if (callbackAddress.isNull() || !m_eventServer->isListening()) {
+            qCWarning(dcWemo()) << "No callback address for" << thing->name() << "- polling the switch";
+            subscription.nextRetry = QDateTime::currentMSecsSinceEpoch() + m_subscriptionRetryInterval * 1000;
+            return;
+        }
+        request.setRawHeader("CALLBACK", "<http://" + callbackAddress.toString().toUtf8() + ":" + QByteArray::number(m_eventServer->serverPort()) + callbackPath(thing) + ">");
+        request.setRawHeader("NT", "upnp:event");
+    } else {
+        request.setRawHeader("SID", subscription.sid);
+    }
+    request.setRawHeader("TIMEOUT", "Second-" + QByteArray::number(m_subscriptionTimeout));
+
+    subscription.pending = true;
+    QNetworkReply *reply = hardwareManager()->networkManager()->sendCustomRequest(request, "SUBSCRIBE");
+    subscription.reply = reply;
+    connect(reply, &QNetworkReply::finished, reply, &QNetworkReply::deleteLater);
+    connect(reply, &QNetworkReply::finished, thing, [this, thing, reply](){
+        // The thing might have been removed meanwhile
+        auto it = m_subscriptions.find(thing);
+        if (it == m_subscriptions.end() || it->reply != reply)
+            return;
+
+        Subscription &subscription = *it;
+        subscription.pending = false;
+        subscription.reply = nullptr;
+
+        int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+        if (status != 200) {
+            bool renewal = !subscription.sid.isEmpty();
+            subscription.sid.clear();
+            if (renewal && status == 412) {
+                // The switch forgot the subscription (e.g. after a reboot), start a new one
+                qCDebug(dcWemo()) << "Subscription of" << thing->name() << "expired, subscribing again";
+                subscribe(thing);
+                return;
+            }
+            qCWarning(dcWemo()) << "Could not subscribe to events of" << thing->name() << status << reply->errorString() << "- polling the switch";
+            subscription.nextRetry = QDateTime::currentMSecsSinceEpoch() + m_subscriptionRetryInterval * 1000;
+            return;
+        }
+
+        subscription.sid = reply->rawHeader("SID");
+        int timeout = m_subscriptionTimeout;
+        QByteArray timeoutHeader = reply->rawHeader("TIMEOUT");
+        if (timeoutHeader.toLower().startsWith("second-"))
+            timeout = timeoutHeader.mid(7).toInt();
+
+        // Renew well before the subscription expires
+        subscription.renewTimer->start(qMax(30, timeout * 4 / 5) * 1000);
+        qCDebug(dcWemo()) << "Subscribed to events of" << thing->name() << subscription.sid << "for" << timeout << "seconds";
+    });
+}
+
+void IntegrationPluginWemo::unsubscribe(Thing *thing)
+{
+    if (!m_subscriptions.contains(thing))
+        return;
+
+    Subscription &subscription = m_subscriptions[thing];
+    subscription.renewTimer->stop();
+    if (subscription.sid.isEmpty())
+        return;
+
+    QNetworkRequest request(serviceUrl(thing, "/upnp/event/basicevent1"));
+    request.setRawHeader("SID", subscription.sid);
+    QNetworkReply *reply = hardwareManager()->networkManager()->sendCustomRequest(request, "UNSUBSCRIBE");
+    connect(reply, &QNetworkReply::finished, reply, &QNetworkReply::deleteLater);
+    subscription.sid.clear();
+}
+
+QByteArray IntegrationPluginWemo::callbackPath(Thing *thing) const
+{
+    return "/wemo/" + thing->id().toString().remove('{').remove('}').toUtf8();
+}
+
+QUrl IntegrationPluginWemo::serviceUrl(Thing *thing, const QString &path) const
+{
+    QUrl url;
+    url.setScheme("http");
+    url.setHost(thing->paramValue(wemoSwitchThingHostParamTypeId).toString());
+    url.setPort(thing->paramValue(wemoSwitchThingPortParamTypeId).toInt());
+    url.setPath(path);
+    return url;
+}
+
+QNetworkRequest IntegrationPluginWemo::createSoapRequest(Thing *thing, const QString &action) const
+{
+    QNetworkRequest request(serviceUrl(thing, "/upnp/control/basicevent1"));
+    request.setHeader(QNetworkRequest::ContentTypeHeader, QVariant("text/xml; charset=\"utf-8\""));
+    request.setHeader(QNetworkRequest::UserAgentHeader, QVariant("nymea"));
+    request.setRawHeader("SOAPACTION", "\"urn:Belkin:service:basicevent:1#" + action.toUtf8() + "\"");
+    return request;
+}
+
+QByteArray IntegrationPluginWemo::createSoapBody(const QString &action, int binaryState)
+{
+    QByteArray body;
+    QXmlStreamWriter xml(&body);
+    xml.writeStartDocument();
+    xml.writeNamespace("http://schemas.xmlsoap.org/soap/envelope/", "s");
+    xml.writeStartElement("http://schemas.xmlsoap.org/soap/envelope/", "Envelope");
+    xml.writeAttribute("http://schemas.xmlsoap.org/soap/envelope/", "encodingStyle", "http://schemas.xmlsoap.org/soap/encoding/");
+    xml.writeStartElement("http://schemas.xmlsoap.org/soap/envelope/", "Body");
+    xml.writeNamespace("urn:Belkin:service:basicevent:1", "u");
+    xml.writeStartElement("urn:Belkin:service:basicevent:1", action);
+    xml.writeTextElement("BinaryState", QString::number(binaryState));
+    xml.writeEndElement(); // action
+    xml.writeEndElement(); // Body
+    xml.writeEndElement(); // Envelope
+    xml.writeEndDocument();
+    return body;
+}
+
+bool IntegrationPluginWemo::parseBinaryState(const QByteArray &data, bool *power)
+{
+    // Used for SOAP responses and event notifications, both carry a BinaryState element.
+    // Insight switches append their power data: "8|1612345678|...", 8 means on in standby.
+    QXmlStreamReader xml(data);
+    while (!xml.atEnd()) {
+        xml.readNext();
+        if (xml.isStartElement() && xml.name() == "BinaryState") {
+            QString state = xml.readElementText().split('|').first();
+            bool ok = false;
+            int value = state.toInt(&ok);
+            if (!ok)
+                return false;
+
+            *power = (value != 0);
+            return true;
+        }
+    }
+    return false;
+}
+
 void IntegrationPluginWemo::onNetworkReplyFinished()
 {
     QNetworkReply *reply = static_cast<QNetworkReply *>(sender());
@@ -202,6 +366,9 @@ void IntegrationPluginWemo::onNetworkReplyFinished()
     // check HTTP status code
     if (status != 200 || reply->error() != QNetworkReply::NoError) {
         qCWarning(dcWemo()) << "Request error:" << status << reply->errorString();
+        if (m_refreshReplies.contains(reply)) {
+            m_refreshReplies.take(reply)->setStateValue(wemoSwitchConnectedStateTypeId, false);
+        }
         reply->deleteLater();
         return;
     }
@@ -217,8 +384,20 @@ void IntegrationPluginWemo::onNetworkReplyFinished()
 
 void IntegrationPluginWemo::onPluginTimer()
 {
+    qint64 now = QDateTime::currentMSecsSinceEpoch();
+    bool livenessPoll = (++m_timerTicks % m_livenessPollTicks) == 0;
     foreach (Thing* thing, myThings()) {
+        // Subscribed switches push their changes, poll them less often only to see if they are still there
+        Subscription subscription = m_subscriptions.value(thing);
+        if (!subscription.sid.isEmpty()) {
+            if (livenessPoll)
+                refresh(thing);
+            continue;
+        }
+
         refresh(thing);
+        if (!subscription.pending && now >= subscription.nextRetry)
+            subscribe(thing);
     }
 }
 
@@ -230,3 +409,27 @@ void IntegrationPluginWemo::onUpnpNotifyReceived(const QByteArray &notification)
 {
     Q_UNUSED(notification)
 }
+
+void IntegrationPluginWemo::onEventNotificationReceived(const QByteArray &path, const QByteArray &sid, const QByteArray &body)
+{
+    foreach (Thing *thing, myThings()) {
+        if (callbackPath(thing) != path)
+            continue;
+
+        // The initial event may arrive before the SUBSCRIBE response
+        Subscription subscription = m_subscriptions.value(thing);
+        if (subscription.sid != sid && !subscription.pending) {
+            qCDebug(dcWemo()) << "Ignoring event of unknown subscription" << sid << "for" << thing->name();
+            return;
+        }
+
+        // Events also carry other properties, e.g. insight parameters, only handle the binary state
+        bool power = false;
+        if (parseBinaryState(body, &power)) {
+            qCDebug(dcWemo()) << thing->name() << "power changed to" << power;
+            thing->setStateValue(wemoSwitchPowerStateTypeId, power);
+            thing->setStateValue(wemoSwitchConnectedStateTypeId, true);
+        }
+        return;
+    }
+}
@@ -33,8 +33,10 @@
 
 #include "plugintimer.h"
 #include "integrations/integrationplugin.h"
+#include "upnpeventserver.h"
 
 #include <QNetworkReply>
+#include <QTimer>
 
 class IntegrationPluginWemo : public IntegrationPlugin
 {
@@ -54,18 +56,45 @@ public:
     void thingRemoved(Thing *thing) override;
 
 private:
+    // GENA subscription to the basicevent service of a switch
+    struct Subscription {
+        QByteArray sid;
+        QTimer *renewTimer = nullptr;
+        QNetworkReply *reply = nullptr;
+        bool pending = false;
+        qint64 nextRetry = 0;
+    };
+
     PluginTimer *m_pluginTimer = nullptr;
     QHash<QNetworkReply *, Thing *> m_refreshReplies;
 
+    UpnpEventServer *m_eventServer = nullptr;
+    QHash<Thing *, Subscription> m_subscriptions;
+    int m_subscriptionTimeout = 600; // seconds
+    int m_subscriptionRetryInterval = 60; // seconds
+    // Subscribed switches are only polled every few timer ticks to notice when they disappear
+    int m_livenessPollTicks = 3;
+    int m_timerTicks = 0;
+
     void refresh(Thing* thing);
 
     void processRefreshData(const QByteArray &data, Thing *thing);
 
+    void subscribe(Thing *thing);
+    void unsubscribe(Thing *thing);
+    QByteArray callbackPath(Thing *thing) const;
+
+    QUrl serviceUrl(Thing *thing, const QString &path) const;
+    QNetworkRequest createSoapRequest(Thing *thing, const QString &action) const;
+    static QByteArray createSoapBody(const QString &action, int binaryState);
+    static bool parseBinaryState(const QByteArray &data, bool *power);
+
 private slots:
     void onNetworkReplyFinished();
     void onPluginTimer();
     void onUpnpDiscoveryFinished();
     void onUpnpNotifyReceived(const QByteArray &notification);
+    void onEventNotificationReceived(const QByteArray &path, const QByteArray &sid, const QByteArray &body);
 
 };
 
@@ -1,4 +1,5 @@
 include(../plugins.pri)
+include(../common/upnpeventserver.pri)
 
 TARGET = $$qtLibraryTarget(nymea_integrationpluginwemo)
 